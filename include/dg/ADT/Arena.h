@@ -0,0 +1,158 @@
+#ifndef _DG_ADT_ARENA_H_
+#define _DG_ADT_ARENA_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dg {
+namespace ADT {
+
+///
+// Bump allocator. Objects are placed one after another
+// into big slabs of memory and the slabs are freed all at once
+// when the arena is destroyed. Single objects are never freed.
+//
+// The arena does not call the destructors of the objects,
+// the owner of an object either destroys it via ArenaPtr
+// (which leaves the memory to the arena) or uses ArenaOwner.
+class Arena {
+    std::vector<std::unique_ptr<char[]>> slabs;
+    char *cur{nullptr};
+    char *end{nullptr};
+    size_t slab_size;
+    size_t allocated{0};
+
+    static size_t _padding(const char *p, size_t align) {
+        auto addr = reinterpret_cast<uintptr_t>(p);
+        return (align - addr % align) % align;
+    }
+
+    void *_allocateSlab(size_t size) {
+        slabs.emplace_back(new char[size]);
+        return slabs.back().get();
+    }
+
+public:
+    Arena(size_t slabSize = 64 * 1024) : slab_size(slabSize) {}
+
+    Arena(Arena&& rhs)
+    : slabs(std::move(rhs.slabs)), cur(rhs.cur), end(rhs.end),
+      slab_size(rhs.slab_size), allocated(rhs.allocated) {
+        rhs.cur = rhs.end = nullptr;
+        rhs.allocated = 0;
+    }
+
+    Arena& operator=(Arena&& rhs) {
+        slabs = std::move(rhs.slabs);
+        cur = rhs.cur;
+        end = rhs.end;
+        slab_size = rhs.slab_size;
+        allocated = rhs.allocated;
+        rhs.cur = rhs.end = nullptr;
+        rhs.allocated = 0;
+        return *this;
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void *allocate(size_t size, size_t align) {
+        assert(align <= alignof(std::max_align_t) && "Unsupported alignment");
+        allocated += size;
+
+        // big objects get their own slab, so that
+        // we do not waste the rest of the current slab
+        if (size > slab_size / 4)
+            return _allocateSlab(size);
+
+        size_t pad = cur ? _padding(cur, align) : 0;
+        if (!cur || static_cast<size_t>(end - cur) < size + pad) {
+            cur = static_cast<char *>(_allocateSlab(slab_size));
+            end = cur + slab_size;
+            pad = 0;
+        }
+
+        void *mem = cur + pad;
+        cur += pad + size;
+        return mem;
+    }
+
+    template <typename T, typename... Args>
+    T *create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // the number of bytes requested from the arena
+    size_t getAllocatedBytes() const { return allocated; }
+    size_t getSlabsNum() const { return slabs.size(); }
+};
+
+///
+// Destroys an object allocated in an arena,
+// the memory stays in the arena.
+template <typename T>
+struct ArenaDeleter {
+    void operator()(T *p) const { p->~T(); }
+};
+
+template <typename T>
+using ArenaPtr = std::unique_ptr<T, ArenaDeleter<T>>;
+
+///
+// An arena that owns the objects created in it:
+// it calls their destructors when it is destroyed.
+// Objects with trivial destructors are not tracked at all,
+// their memory is just freed with the arena.
+template <typename T>
+class ArenaOwner {
+    Arena arena;
+    // declared after the arena, so the objects
+    // are destroyed before the arena frees the memory
+    std::vector<ArenaPtr<T>> objects;
+    size_t objects_num{0};
+
+    template <typename U>
+    void _track(U *obj, std::false_type) { objects.emplace_back(obj); }
+    template <typename U>
+    void _track(U *, std::true_type) {}
+
+public:
+    ArenaOwner(size_t slabSize = 64 * 1024) : arena(slabSize) {}
+    ArenaOwner(ArenaOwner&& rhs)
+    : arena(std::move(rhs.arena)), objects(std::move(rhs.objects)),
+      objects_num(rhs.objects_num) {
+        rhs.objects_num = 0;
+    }
+
+    ArenaOwner& operator=(ArenaOwner&& rhs) {
+        // destroy our objects while we still have the memory
+        objects.clear();
+        arena = std::move(rhs.arena);
+        objects = std::move(rhs.objects);
+        objects_num = rhs.objects_num;
+        rhs.objects_num = 0;
+        return *this;
+    }
+
+    template <typename U = T, typename... Args>
+    U *create(Args&&... args) {
+        U *obj = arena.create<U>(std::forward<Args>(args)...);
+        _track(obj, std::is_trivially_destructible<U>());
+        ++objects_num;
+        return obj;
+    }
+
+    size_t size() const { return objects_num; }
+    const Arena& getArena() const { return arena; }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_ADT_ARENA_H_
@@ -3,6 +3,9 @@
 
 #include <cstddef> // size_t
 #include <cassert>
+#include <type_traits>
+
+#include "dg/ADT/WordOps.h"
 
 namespace dg {
 namespace ADT {
@@ -13,6 +16,8 @@ namespace ADT {
 template <typename InnerT = uint64_t,
           typename ShiftT = uint64_t>
 class ShiftedBits {
+    static_assert(sizeof(InnerT) <= sizeof(uint64_t), "Unsupported bits type");
+
     InnerT _bits{0};
     ShiftT _shift;
 
@@ -28,12 +33,8 @@ public:
     }
 
     size_t size() const {
-        size_t num = 0;
-        for (size_t i = 0; i < bitsNum(); ++i)
-            if (_bits & (static_cast<InnerT>(1) << i))
-                ++num;
-
-        return num;
+        using UnsignedT = typename std::make_unsigned<InnerT>::type;
+        return words::popcount(static_cast<UnsignedT>(_bits));
     }
 
     bool empty() const { return _bits == 0; }
@@ -125,6 +126,8 @@ public:
 // of ShiftedBits with _shift = 0
 template <typename InnerT = uint64_t>
 class Bits {
+    static_assert(sizeof(InnerT) <= sizeof(uint64_t), "Unsupported bits type");
+
     InnerT _bits{0};
 
 public:
@@ -136,12 +139,8 @@ public:
     bool mayContain(size_t i) const { return i < bitsNum(); }
 
     size_t size() const {
-        size_t num = 0;
-        for (size_t i = 0; i < bitsNum(); ++i)
-            if (_bits & (static_cast<InnerT>(1) << i))
-                ++num;
-
-        return num;
+        using UnsignedT = typename std::make_unsigned<InnerT>::type;
+        return words::popcount(static_cast<UnsignedT>(_bits));
     }
 
     bool get(size_t i) const {
@@ -1,39 +1,78 @@
 #ifndef _DG_SPARSE_BITVECTOR_H_
 #define _DG_SPARSE_BITVECTOR_H_
 
-#include <map>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
 #include <cassert>
+#include <cstdint>
+
+#include "dg/ADT/WordOps.h"
 
 namespace dg {
 namespace ADT {
 
+///
+// Sparse bitvector. The bits are stored in a sorted sequence
+// of elements, where every element holds SCALE words of bits
+// (i.e., a contiguous run of SCALE*64 bits) along with its shift.
+// Elements that contain no set bit are never kept in the sequence.
+// Operations on whole bitvectors (union, intersection, ...) are
+// linear merges of the sequences that process the words
+// of matching elements at once (see WordOps.h).
 template <typename BitsT = uint64_t, typename ShiftT = uint64_t, size_t SCALE = 1>
 class SparseBitvectorImpl {
-    // mapping from shift to bits
-    using BitsContainerT = std::map<ShiftT, BitsT>;
+    static_assert(std::is_same<BitsT, uint64_t>::value,
+                  "Only 64-bit words are supported");
+    static_assert(SCALE > 0, "Invalid scale");
+
+    struct Element {
+        ShiftT shift;
+        BitsT bits[SCALE]{};
+
+        Element(ShiftT s) : shift(s) {}
+
+        bool empty() const { return words::isZero(bits, SCALE); }
+        size_t size() const {
+            return SCALE == 1 ? words::popcount(bits[0])
+                              : words::popcountWords(bits, SCALE);
+        }
+    };
+
+    using BitsContainerT = std::vector<Element>;
     BitsContainerT _bits{};
 
     static size_t _bitsNum() { return sizeof(BitsT) * 8; }
-    static ShiftT _shift(size_t i) { return i - (i % _bitsNum()); }
+    static size_t _elemBitsNum() { return _bitsNum() * SCALE; }
+    static ShiftT _shift(size_t i) { return i - (i % _elemBitsNum()); }
 
-    static size_t _countBits(BitsT bits) {
-        size_t num = 0;
-        while (bits) {
-            if (bits & 0x1)
-                ++num;
+    static bool _getBit(const Element& E, size_t i) {
+        auto pos = i - E.shift;
+        return E.bits[pos / _bitsNum()] & (BitsT(1) << (pos % _bitsNum()));
+    }
 
-            bits = bits >> 1;
-        }
+    static void _setBit(Element& E, size_t i) {
+        auto pos = i - E.shift;
+        E.bits[pos / _bitsNum()] |= (BitsT(1) << (pos % _bitsNum()));
+    }
 
-        return num;
+    static void _unsetBit(Element& E, size_t i) {
+        auto pos = i - E.shift;
+        E.bits[pos / _bitsNum()] &= ~(BitsT(1) << (pos % _bitsNum()));
     }
 
-    void _addBits(size_t i) {
-        // for now we just push it back,
-        // but we would rather do it somehow
-        // more smartly (probably not using the vector)
-        auto sft = _shift(i);
-        _bits.emplace(sft, (1UL << (i - sft)));
+    typename BitsContainerT::const_iterator _find(ShiftT sft) const {
+        return std::lower_bound(_bits.begin(), _bits.end(), sft,
+                                [](const Element& E, ShiftT s) {
+                                    return E.shift < s;
+                                });
+    }
+
+    typename BitsContainerT::iterator _find(ShiftT sft) {
+        return std::lower_bound(_bits.begin(), _bits.end(), sft,
+                                [](const Element& E, ShiftT s) {
+                                    return E.shift < s;
+                                });
     }
 
 public:
@@ -42,6 +81,8 @@ public:
 
     SparseBitvectorImpl(const SparseBitvectorImpl&) = default;
     SparseBitvectorImpl(SparseBitvectorImpl&&) = default;
+    SparseBitvectorImpl& operator=(const SparseBitvectorImpl&) = default;
+    SparseBitvectorImpl& operator=(SparseBitvectorImpl&&) = default;
 
     void reset() { _bits.clear(); }
     bool empty() const { return _bits.empty(); }
@@ -49,73 +90,217 @@ public:
 
     bool get(size_t i) const {
         auto sft = _shift(i);
-        assert(sft % _bitsNum() == 0);
+        assert(sft % _elemBitsNum() == 0);
 
-        auto it = _bits.find(sft);
-        if (it == _bits.end()) {
+        auto it = _find(sft);
+        if (it == _bits.end() || it->shift != sft) {
             return false;
         }
 
-        return (it->second & (1UL << (i - sft)));
+        return _getBit(*it, i);
     }
 
     // returns the previous value of the i-th bit
     bool set(size_t i) {
         auto sft = _shift(i);
-        auto it = _bits.find(sft);
-        if (it == _bits.end()) {
-            _addBits(i);
+        auto it = _find(sft);
+        if (it == _bits.end() || it->shift != sft) {
+            it = _bits.insert(it, Element(sft));
+            _setBit(*it, i);
             return false;
         }
 
-        bool prev = (it->second & (1UL << (i - sft)));
-        it->second |= (1UL << (i - sft));
+        bool prev = _getBit(*it, i);
+        _setBit(*it, i);
 
         return prev;
     }
 
     // union operation
     bool set(const SparseBitvectorImpl& rhs) {
+        if (rhs._bits.empty())
+            return false;
+
+        if (_bits.empty()) {
+            _bits = rhs._bits;
+            return true;
+        }
+
+        // unite the elements that we already have in place
+        // and find out how many elements are missing, so that
+        // we do not reallocate the container if not needed
+        bool changed = false;
+        size_t missing = 0;
+        auto it = _bits.begin(), et = _bits.end();
+        for (const auto& E : rhs._bits) {
+            while (it != et && it->shift < E.shift)
+                ++it;
+            if (it != et && it->shift == E.shift)
+                changed |= words::orWords(it->bits, E.bits, SCALE);
+            else
+                ++missing;
+        }
+
+        if (missing == 0)
+            return changed;
+
+        BitsContainerT tmp;
+        tmp.reserve(_bits.size() + missing);
+        auto lit = _bits.begin();
+        auto rit = rhs._bits.begin();
+        while (lit != _bits.end() && rit != rhs._bits.end()) {
+            if (lit->shift < rit->shift) {
+                tmp.push_back(*lit++);
+            } else if (rit->shift < lit->shift) {
+                tmp.push_back(*rit++);
+            } else {
+                // already united in the previous loop
+                tmp.push_back(*lit++);
+                ++rit;
+            }
+        }
+        tmp.insert(tmp.end(), lit, _bits.end());
+        tmp.insert(tmp.end(), rit, rhs._bits.end());
+
+        assert(tmp.size() == _bits.size() + missing);
+        _bits.swap(tmp);
+        return true;
+    }
+
+    // intersection operation, returns true if this bitvector changed
+    bool intersect(const SparseBitvectorImpl& rhs) {
+        bool changed = false;
+        auto rit = rhs._bits.begin();
+        auto out = _bits.begin();
+        for (auto it = _bits.begin(); it != _bits.end(); ++it) {
+            while (rit != rhs._bits.end() && rit->shift < it->shift)
+                ++rit;
+
+            if (rit == rhs._bits.end() || rit->shift != it->shift) {
+                changed = true;
+                continue;
+            }
+
+            changed |= words::andWords(it->bits, rit->bits, SCALE);
+            if (it->empty())
+                continue;
+
+            if (out != it)
+                *out = *it;
+            ++out;
+        }
+
+        _bits.erase(out, _bits.end());
+        return changed;
+    }
+
+    // difference operation (unset all bits that are set in rhs),
+    // returns true if this bitvector changed
+    bool unset(const SparseBitvectorImpl& rhs) {
         bool changed = false;
-        for (auto& pair : rhs._bits) {
-            auto& B = _bits[pair.first];
-            auto old = B;
-            B |= pair.second;
-            changed |= (old != B);
+        auto rit = rhs._bits.begin();
+        auto out = _bits.begin();
+        for (auto it = _bits.begin(); it != _bits.end(); ++it) {
+            while (rit != rhs._bits.end() && rit->shift < it->shift)
+                ++rit;
+
+            if (rit != rhs._bits.end() && rit->shift == it->shift) {
+                changed |= words::andNotWords(it->bits, rit->bits, SCALE);
+                if (it->empty())
+                    continue;
+            }
+
+            if (out != it)
+                *out = *it;
+            ++out;
         }
 
+        _bits.erase(out, _bits.end());
         return changed;
     }
 
+    // is every bit of this bitvector set also in rhs?
+    bool isSubsetOf(const SparseBitvectorImpl& rhs) const {
+        if (_bits.size() > rhs._bits.size())
+            return false;
+
+        auto rit = rhs._bits.begin();
+        for (const auto& E : _bits) {
+            while (rit != rhs._bits.end() && rit->shift < E.shift)
+                ++rit;
+            if (rit == rhs._bits.end() || rit->shift != E.shift)
+                return false;
+            if (!words::isSubset(E.bits, rit->bits, SCALE))
+                return false;
+        }
+
+        return true;
+    }
+
+    // do the bitvectors have a common bit?
+    bool intersects(const SparseBitvectorImpl& rhs) const {
+        auto rit = rhs._bits.begin();
+        for (const auto& E : _bits) {
+            while (rit != rhs._bits.end() && rit->shift < E.shift)
+                ++rit;
+            if (rit == rhs._bits.end())
+                return false;
+            if (rit->shift == E.shift &&
+                words::intersects(E.bits, rit->bits, SCALE))
+                return true;
+        }
+
+        return false;
+    }
+
+    bool operator==(const SparseBitvectorImpl& rhs) const {
+        if (_bits.size() != rhs._bits.size())
+            return false;
+
+        for (size_t i = 0; i < _bits.size(); ++i) {
+            if (_bits[i].shift != rhs._bits[i].shift ||
+                !std::equal(_bits[i].bits, _bits[i].bits + SCALE,
+                            rhs._bits[i].bits))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool operator!=(const SparseBitvectorImpl& rhs) const {
+        return !operator==(rhs);
+    }
+
     // returns the previous value of the i-th bit
     bool unset(size_t i) {
         auto sft = _shift(i);
-        auto it = _bits.find(sft);
-        if (it == _bits.end()) {
+        auto it = _find(sft);
+        if (it == _bits.end() || it->shift != sft) {
             return false;
         }
 
-        it->second &= ~(1UL << (i - sft));
-        if (it->second == 0) {
+        bool prev = _getBit(*it, i);
+        _unsetBit(*it, i);
+        if (it->empty()) {
             _bits.erase(it);
         }
 
-        return true;
+        return prev;
     }
 
     // FIXME: track the number of elements
     // in a variable, to avoid this search...
     size_t size() const {
         size_t num = 0;
-        for (auto& it : _bits)
-            num += _countBits(it.second);
+        for (auto& E : _bits)
+            num += E.size();
 
         return num;
     }
 
     class const_iterator {
-        typename BitsContainerT::const_iterator container_it;
-        typename BitsContainerT::const_iterator container_end;
+        typename BitsContainerT::const_iterator container_it{};
+        typename BitsContainerT::const_iterator container_end{};
         size_t pos{0};
 
         const_iterator(const BitsContainerT& cont, bool end = false)
@@ -126,11 +311,18 @@ public:
                 _findClosestBit();
         }
 
+        // find the first set bit at position >= pos
+        // in the current element (or move pos to the end of the element)
         void _findClosestBit() {
-            assert(pos < (sizeof(BitsT)*8));
-            while (!(container_it->second & (1UL << pos))) {
-                if (++pos == sizeof(BitsT)*8)
+            while (pos < _elemBitsNum()) {
+                auto w = container_it->bits[pos / _bitsNum()]
+                            >> (pos % _bitsNum());
+                if (w != 0) {
+                    pos += words::ctz(w);
                     return;
+                }
+                // go to the beginning of the next word
+                pos += _bitsNum() - (pos % _bitsNum());
             }
         }
 
@@ -138,11 +330,11 @@ public:
         const_iterator() = default;
         const_iterator& operator++() {
             // shift to the next bit in the current bits
-            assert(pos < (sizeof(BitsT)*8));
-            if (++pos != 64)
+            assert(pos < _elemBitsNum());
+            if (++pos != _elemBitsNum())
                 _findClosestBit();
 
-            if (pos == 64) {
+            if (pos == _elemBitsNum()) {
                 ++container_it;
                 pos = 0;
                 if (container_it != container_end) {
@@ -159,7 +351,7 @@ public:
         }
 
         size_t operator*() const {
-            return container_it->first + pos;
+            return container_it->shift + pos;
         }
 
         bool operator==(const const_iterator& rhs) const {
@@ -3,22 +3,25 @@
 
 #include <set>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <algorithm>
+#include <iterator>
+#include <type_traits>
 
 namespace dg {
 
 /// ------------------------------------------------------------------
-// - DGContainer
+// - SetContainer
 //
-//   This is basically just a wrapper for real container, so that
-//   we have the container defined on one place for all edges.
-//   It may have more implementations depending on available features
+//   The original edges container -- a wrapper around std::set.
+//   Use it by defining DG_SET_CONTAINERS (the cmake option
+//   SET_CONTAINERS).
 /// ------------------------------------------------------------------
 template <typename ValueT, unsigned int EXPECTED_ELEMENTS_NUM = 8>
-class DGContainer
+class SetContainer
 {
 public:
-    // XXX use llvm ADTs when available, or BDDs?
     using ContainerT = typename std::set<ValueT>;
     using iterator = typename ContainerT::iterator;
     using const_iterator = typename ContainerT::const_iterator;
@@ -39,6 +42,12 @@ public:
         return container.insert(n).second;
     }
 
+    template <typename It>
+    void insert(It first, It last)
+    {
+        container.insert(first, last);
+    }
+
     bool contains(ValueT n) const
     {
         return container.count(n) != 0;
@@ -54,19 +63,19 @@ public:
         container.clear();
     }
 
-    bool empty()
+    bool empty() const
     {
         return container.empty();
     }
 
-    void swap(DGContainer<ValueT, EXPECTED_ELEMENTS_NUM>& oth)
+    void swap(SetContainer& oth)
     {
         container.swap(oth.container);
     }
 
-    void intersect(const DGContainer<ValueT, EXPECTED_ELEMENTS_NUM>& oth)
+    void intersect(const SetContainer& oth)
     {
-        DGContainer<ValueT, EXPECTED_ELEMENTS_NUM> tmp;
+        SetContainer tmp;
 
         std::set_intersection(container.begin(), container.end(),
                               oth.container.begin(),
@@ -78,22 +87,17 @@ public:
         container.swap(tmp.container);
     }
 
-    bool operator==(const DGContainer<ValueT, EXPECTED_ELEMENTS_NUM>& oth) const
+    bool operator==(const SetContainer& oth) const
     {
         if (container.size() != oth.size())
             return false;
 
         // the sets are ordered, so this will work
-        iterator snd = oth.container.begin();
-        for (iterator fst = container.begin(), efst = container.end();
-             fst != efst; ++fst, ++snd)
-            if (*fst != *snd)
-                return false;
-
-        return true;
+        return std::equal(container.begin(), container.end(),
+                          oth.container.begin());
     }
 
-    bool operator!=(const DGContainer<ValueT, EXPECTED_ELEMENTS_NUM>& oth) const
+    bool operator!=(const SetContainer& oth) const
     {
         return !operator==(oth);
     }
@@ -102,6 +106,245 @@ private:
     ContainerT container;
 };
 
+/// ------------------------------------------------------------------
+// - SortedVectorContainer
+//
+//   Sorted array of unique elements. The first EXPECTED_ELEMENTS_NUM
+//   elements are stored inline in the container, bigger containers
+//   move the elements to the heap. Most of the edge containers
+//   in the graph are (almost) empty, so this saves a lot of memory
+//   and allocations in comparison to std::set and the lookup is
+//   a binary search over a contiguous memory.
+//
+//   Elements are compared only using operator<. The elements must be
+//   trivially copyable (pointers, small structures). Like in std::set,
+//   the elements cannot be modified via iterators. Unlike in std::set,
+//   insert() and erase() invalidate the iterators.
+/// ------------------------------------------------------------------
+template <typename ValueT, unsigned int EXPECTED_ELEMENTS_NUM = 8>
+class SortedVectorContainer
+{
+    static_assert(EXPECTED_ELEMENTS_NUM > 0, "Need some inline storage");
+    static_assert(std::is_trivially_copyable<ValueT>::value,
+                  "Elements must be trivially copyable");
+
+    using StorageT = typename std::aligned_storage<sizeof(ValueT),
+                                                   alignof(ValueT)>::type;
+
+    StorageT inline_storage[EXPECTED_ELEMENTS_NUM];
+    ValueT *data;
+    uint32_t num{0};
+    uint32_t capacity{EXPECTED_ELEMENTS_NUM};
+
+    ValueT *_inline() { return reinterpret_cast<ValueT *>(inline_storage); }
+    bool _isInline() const {
+        return data == reinterpret_cast<const ValueT *>(inline_storage);
+    }
+
+    static bool _equal(const ValueT& a, const ValueT& b) {
+        return !(a < b) && !(b < a);
+    }
+
+    void _reserve(size_t n) {
+        if (n <= capacity)
+            return;
+
+        size_t newcap = std::max<size_t>(n, 2 * capacity);
+        ValueT *mem = static_cast<ValueT *>(::operator new(newcap * sizeof(ValueT)));
+        if (num > 0)
+            std::memcpy(static_cast<void *>(mem), data, num * sizeof(ValueT));
+        _free();
+        data = mem;
+        capacity = newcap;
+    }
+
+    void _free() {
+        if (!_isInline())
+            ::operator delete(data);
+    }
+
+    void _copyFrom(const SortedVectorContainer& oth) {
+        num = 0;
+        _reserve(oth.num);
+        if (oth.num > 0)
+            std::memcpy(static_cast<void *>(data), oth.data, oth.num * sizeof(ValueT));
+        num = oth.num;
+    }
+
+    // take the elements of 'oth', 'oth' becomes empty
+    void _moveFrom(SortedVectorContainer& oth) {
+        if (oth._isInline()) {
+            data = _inline();
+            capacity = EXPECTED_ELEMENTS_NUM;
+            if (oth.num > 0)
+                std::memcpy(static_cast<void *>(data), oth.data, oth.num * sizeof(ValueT));
+        } else {
+            data = oth.data;
+            capacity = oth.capacity;
+            oth.data = oth._inline();
+            oth.capacity = EXPECTED_ELEMENTS_NUM;
+        }
+
+        num = oth.num;
+        oth.num = 0;
+    }
+
+public:
+    using iterator = const ValueT *;
+    using const_iterator = const ValueT *;
+    using size_type = size_t;
+
+    SortedVectorContainer() : data(_inline()) {}
+    SortedVectorContainer(const SortedVectorContainer& oth) : data(_inline()) {
+        _copyFrom(oth);
+    }
+    SortedVectorContainer(SortedVectorContainer&& oth) : data(_inline()) {
+        _moveFrom(oth);
+    }
+
+    SortedVectorContainer& operator=(const SortedVectorContainer& oth) {
+        if (this != &oth)
+            _copyFrom(oth);
+        return *this;
+    }
+
+    SortedVectorContainer& operator=(SortedVectorContainer&& oth) {
+        if (this != &oth) {
+            _free();
+            _moveFrom(oth);
+        }
+        return *this;
+    }
+
+    ~SortedVectorContainer() { _free(); }
+
+    const_iterator begin() const { return data; }
+    const_iterator end() const { return data + num; }
+
+    size_type size() const
+    {
+        return num;
+    }
+
+    bool insert(ValueT n)
+    {
+        ValueT *it = std::lower_bound(data, data + num, n);
+        if (it != data + num && !(n < *it))
+            return false;
+
+        size_t pos = it - data;
+        _reserve(num + 1);
+        it = data + pos;
+        std::memmove(static_cast<void *>(it + 1), it, (num - pos) * sizeof(ValueT));
+        *it = n;
+        ++num;
+        return true;
+    }
+
+    // insert several elements at once -- the elements are appended
+    // and then the container is sorted and made unique only once
+    template <typename It>
+    void insert(It first, It last)
+    {
+        size_t old = num;
+        for (; first != last; ++first) {
+            _reserve(num + 1);
+            data[num++] = *first;
+        }
+
+        if (num == old)
+            return;
+
+        std::sort(data + old, data + num);
+        std::inplace_merge(data, data + old, data + num);
+        num = std::unique(data, data + num, _equal) - data;
+    }
+
+    bool contains(ValueT n) const
+    {
+        const ValueT *it = std::lower_bound(data, data + num, n);
+        return it != data + num && !(n < *it);
+    }
+
+    size_t erase(ValueT n)
+    {
+        ValueT *it = std::lower_bound(data, data + num, n);
+        if (it == data + num || n < *it)
+            return 0;
+
+        std::memmove(static_cast<void *>(it), it + 1,
+                     (data + num - it - 1) * sizeof(ValueT));
+        --num;
+        return 1;
+    }
+
+    void clear()
+    {
+        num = 0;
+    }
+
+    bool empty() const
+    {
+        return num == 0;
+    }
+
+    void swap(SortedVectorContainer& oth)
+    {
+        SortedVectorContainer tmp(std::move(oth));
+        oth = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    void intersect(const SortedVectorContainer& oth)
+    {
+        // both arrays are sorted, so we can do it in place
+        ValueT *out = data;
+        const ValueT *snd = oth.data, *esnd = oth.data + oth.num;
+        for (ValueT *fst = data, *efst = data + num;
+             fst != efst && snd != esnd;) {
+            if (*fst < *snd) {
+                ++fst;
+            } else if (*snd < *fst) {
+                ++snd;
+            } else {
+                *out++ = *fst++;
+                ++snd;
+            }
+        }
+
+        num = out - data;
+    }
+
+    bool operator==(const SortedVectorContainer& oth) const
+    {
+        if (num != oth.num)
+            return false;
+
+        // the arrays are sorted, so this will work
+        return std::equal(begin(), end(), oth.begin(), _equal);
+    }
+
+    bool operator!=(const SortedVectorContainer& oth) const
+    {
+        return !operator==(oth);
+    }
+};
+
+/// ------------------------------------------------------------------
+// - DGContainer
+//
+//   This is basically just a wrapper for real container, so that
+//   we have the container defined on one place for all edges.
+//   It may have more implementations depending on available features
+/// ------------------------------------------------------------------
+#ifdef DG_SET_CONTAINERS
+template <typename ValueT, unsigned int EXPECTED_ELEMENTS_NUM = 8>
+using DGContainer = SetContainer<ValueT, EXPECTED_ELEMENTS_NUM>;
+#else
+template <typename ValueT, unsigned int EXPECTED_ELEMENTS_NUM = 8>
+using DGContainer = SortedVectorContainer<ValueT, EXPECTED_ELEMENTS_NUM>;
+#endif
+
 // Edges are pointers to other nodes
 template <typename NodeT, unsigned int EXPECTED_EDGES_NUM = 4>
 class EdgesContainer : public DGContainer<NodeT *, EXPECTED_EDGES_NUM>
@@ -12,7 +12,9 @@ namespace ADT {
 // There is no possibility to remove elements from the set.
 class BitvectorNumberSet {
     using NumT = uint64_t;
-    using ContainerT = SparseBitvectorImpl<uint64_t, NumT>;
+    // the numbers tend to be clustered (e.g. IDs of nodes),
+    // so keep them in 512-bit chunks
+    using ContainerT = SparseBitvectorImpl<uint64_t, NumT, 8>;
 
     ContainerT _bitvector;
 public:
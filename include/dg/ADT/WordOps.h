@@ -0,0 +1,273 @@
+#ifndef _DG_ADT_WORD_OPS_H_
+#define _DG_ADT_WORD_OPS_H_
+
+#include <cstddef> // size_t
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DG_WORD_OPS_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+///
+// Operations over runs of 64-bit words that are used by bitvectors.
+// On x86 we check (once, at runtime) whether the CPU supports
+// the popcnt and AVX2 instructions and use the vectorized
+// versions of the operations if it does. Otherwise (or on other
+// architectures) we fall back to portable code.
+namespace dg {
+namespace ADT {
+namespace words {
+
+inline unsigned popcountPortable(uint64_t w) {
+    w = w - ((w >> 1) & 0x5555555555555555ULL);
+    w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+    w = (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return static_cast<unsigned>((w * 0x0101010101010101ULL) >> 56);
+}
+
+// index of the lowest set bit, w must not be 0
+inline unsigned ctz(uint64_t w) {
+#ifdef __GNUC__
+    return static_cast<unsigned>(__builtin_ctzll(w));
+#else
+    unsigned n = 0;
+    while (!(w & 1)) {
+        w >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+inline unsigned popcount(uint64_t w) {
+#ifdef __GNUC__
+    return static_cast<unsigned>(__builtin_popcountll(w));
+#else
+    return popcountPortable(w);
+#endif
+}
+
+///
+// Portable implementations
+inline size_t popcountWordsPortable(const uint64_t *w, size_t n) {
+    size_t num = 0;
+    for (size_t i = 0; i < n; ++i)
+        num += popcount(w[i]);
+    return num;
+}
+
+// dst |= src, returns true if dst changed
+inline bool orWordsPortable(uint64_t *dst, const uint64_t *src, size_t n) {
+    uint64_t changed = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t old = dst[i];
+        dst[i] = old | src[i];
+        changed |= dst[i] ^ old;
+    }
+    return changed != 0;
+}
+
+// dst &= src, returns true if dst changed
+inline bool andWordsPortable(uint64_t *dst, const uint64_t *src, size_t n) {
+    uint64_t changed = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t old = dst[i];
+        dst[i] = old & src[i];
+        changed |= dst[i] ^ old;
+    }
+    return changed != 0;
+}
+
+// dst &= ~src, returns true if dst changed
+inline bool andNotWordsPortable(uint64_t *dst, const uint64_t *src, size_t n) {
+    uint64_t changed = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t old = dst[i];
+        dst[i] = old & ~src[i];
+        changed |= dst[i] ^ old;
+    }
+    return changed != 0;
+}
+
+// (a & ~b) == 0
+inline bool isSubsetPortable(const uint64_t *a, const uint64_t *b, size_t n) {
+    uint64_t diff = 0;
+    for (size_t i = 0; i < n; ++i)
+        diff |= a[i] & ~b[i];
+    return diff == 0;
+}
+
+// (a & b) != 0
+inline bool intersectsPortable(const uint64_t *a, const uint64_t *b, size_t n) {
+    uint64_t common = 0;
+    for (size_t i = 0; i < n; ++i)
+        common |= a[i] & b[i];
+    return common != 0;
+}
+
+inline bool isZeroPortable(const uint64_t *w, size_t n) {
+    uint64_t all = 0;
+    for (size_t i = 0; i < n; ++i)
+        all |= w[i];
+    return all == 0;
+}
+
+#ifdef DG_WORD_OPS_X86_DISPATCH
+
+inline bool cpuHasPopcnt() {
+    static const bool has = __builtin_cpu_supports("popcnt");
+    return has;
+}
+
+inline bool cpuHasAVX2() {
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+
+__attribute__((target("popcnt")))
+inline size_t popcountWordsHW(const uint64_t *w, size_t n) {
+    size_t num = 0;
+    for (size_t i = 0; i < n; ++i)
+        num += static_cast<size_t>(__builtin_popcountll(w[i]));
+    return num;
+}
+
+__attribute__((target("avx2")))
+inline bool orWordsAVX2(uint64_t *dst, const uint64_t *src, size_t n) {
+    __m256i changed = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i r = _mm256_or_si256(d, s);
+        changed = _mm256_or_si256(changed, _mm256_xor_si256(r, d));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), r);
+    }
+
+    bool tail = orWordsPortable(dst + i, src + i, n - i);
+    return !_mm256_testz_si256(changed, changed) || tail;
+}
+
+__attribute__((target("avx2")))
+inline bool andWordsAVX2(uint64_t *dst, const uint64_t *src, size_t n) {
+    __m256i changed = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i r = _mm256_and_si256(d, s);
+        changed = _mm256_or_si256(changed, _mm256_xor_si256(r, d));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), r);
+    }
+
+    bool tail = andWordsPortable(dst + i, src + i, n - i);
+    return !_mm256_testz_si256(changed, changed) || tail;
+}
+
+__attribute__((target("avx2")))
+inline bool andNotWordsAVX2(uint64_t *dst, const uint64_t *src, size_t n) {
+    __m256i changed = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        // andnot computes ~s & d
+        __m256i r = _mm256_andnot_si256(s, d);
+        changed = _mm256_or_si256(changed, _mm256_xor_si256(r, d));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), r);
+    }
+
+    bool tail = andNotWordsPortable(dst + i, src + i, n - i);
+    return !_mm256_testz_si256(changed, changed) || tail;
+}
+
+__attribute__((target("avx2")))
+inline bool isSubsetAVX2(const uint64_t *a, const uint64_t *b, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        // testc returns 1 iff (~vb & va) == 0
+        if (!_mm256_testc_si256(vb, va))
+            return false;
+    }
+
+    return isSubsetPortable(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+inline bool intersectsAVX2(const uint64_t *a, const uint64_t *b, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        if (!_mm256_testz_si256(va, vb))
+            return true;
+    }
+
+    return intersectsPortable(a + i, b + i, n - i);
+}
+
+#endif // DG_WORD_OPS_X86_DISPATCH
+
+///
+// Dispatching versions. Runs shorter than one AVX2 register
+// are not worth the dispatch, so these go to the portable code.
+inline size_t popcountWords(const uint64_t *w, size_t n) {
+#ifdef DG_WORD_OPS_X86_DISPATCH
+    if (cpuHasPopcnt())
+        return popcountWordsHW(w, n);
+#endif
+    return popcountWordsPortable(w, n);
+}
+
+inline bool orWords(uint64_t *dst, const uint64_t *src, size_t n) {
+#ifdef DG_WORD_OPS_X86_DISPATCH
+    if (n >= 4 && cpuHasAVX2())
+        return orWordsAVX2(dst, src, n);
+#endif
+    return orWordsPortable(dst, src, n);
+}
+
+inline bool andWords(uint64_t *dst, const uint64_t *src, size_t n) {
+#ifdef DG_WORD_OPS_X86_DISPATCH
+    if (n >= 4 && cpuHasAVX2())
+        return andWordsAVX2(dst, src, n);
+#endif
+    return andWordsPortable(dst, src, n);
+}
+
+inline bool andNotWords(uint64_t *dst, const uint64_t *src, size_t n) {
+#ifdef DG_WORD_OPS_X86_DISPATCH
+    if (n >= 4 && cpuHasAVX2())
+        return andNotWordsAVX2(dst, src, n);
+#endif
+    return andNotWordsPortable(dst, src, n);
+}
+
+inline bool isSubset(const uint64_t *a, const uint64_t *b, size_t n) {
+#ifdef DG_WORD_OPS_X86_DISPATCH
+    if (n >= 4 && cpuHasAVX2())
+        return isSubsetAVX2(a, b, n);
+#endif
+    return isSubsetPortable(a, b, n);
+}
+
+inline bool intersects(const uint64_t *a, const uint64_t *b, size_t n) {
+#ifdef DG_WORD_OPS_X86_DISPATCH
+    if (n >= 4 && cpuHasAVX2())
+        return intersectsAVX2(a, b, n);
+#endif
+    return intersectsPortable(a, b, n);
+}
+
+inline bool isZero(const uint64_t *w, size_t n) {
+    return isZeroPortable(w, n);
+}
+
+} // namespace words
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_ADT_WORD_OPS_H_
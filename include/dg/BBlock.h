@@ -149,24 +149,31 @@ public:
             // and create new edges to all successors. The new edges
             // will have the same label as the found one
             DGContainer<BBlockEdge> new_edges;
-            for (auto I = pred->nextBBs.begin(),E = pred->nextBBs.end(); I != E;) {
-                auto cur = I++;
-                if (cur->target == this) {
-                    // create edges that will go from the predecessor
-                    // to every successor of this node
-                    for (const BBlockEdge& succ : nextBBs) {
-                        // we cannot create an edge to this bblock (we're isolating _this_ bblock),
-                        // that would be incorrect. It can occur when we're isolatin a bblock
-                        // with self-loop
-                        if (succ.target != this)
-                            new_edges.insert(BBlockEdge(succ.target, cur->label));
-                    }
-
-                    // remove the edge from predecessor
-                    pred->nextBBs.erase(*cur);
+            // labels of the edges going from the predecessor to this node.
+            // We cannot remove the edges while iterating over them
+            // (and with a self-loop, pred->nextBBs are our nextBBs)
+            DGContainer<uint8_t> labels;
+            for (const BBlockEdge& edge : pred->nextBBs) {
+                if (edge.target == this)
+                    labels.insert(edge.label);
+            }
+
+            for (uint8_t label : labels) {
+                // create edges that will go from the predecessor
+                // to every successor of this node
+                for (const BBlockEdge& succ : nextBBs) {
+                    // we cannot create an edge to this bblock (we're isolating _this_ bblock),
+                    // that would be incorrect. It can occur when we're isolatin a bblock
+                    // with self-loop
+                    if (succ.target != this)
+                        new_edges.insert(BBlockEdge(succ.target, label));
                 }
             }
 
+            // remove the edges from predecessor
+            for (uint8_t label : labels)
+                pred->nextBBs.erase(BBlockEdge(this, label));
+
             // add newly created edges to predecessor
             for (const BBlockEdge& edge : new_edges) {
                 assert(edge.target != this
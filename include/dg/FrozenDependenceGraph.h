@@ -0,0 +1,194 @@
+#ifndef _DG_FROZEN_DEPENDENCE_GRAPH_H_
+#define _DG_FROZEN_DEPENDENCE_GRAPH_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "dg/DependenceGraph.h"
+#include "dg/DGParameters.h"
+
+#ifdef ENABLE_CFG
+#include "dg/BBlock.h"
+#endif
+
+namespace dg {
+
+/// ------------------------------------------------------------------
+// - FrozenDependenceGraph
+//
+//   Read-only copy of the edges of dependence graphs (the graphs
+//   and all their subgraphs) that are followed by the backward slicing,
+//   stored in the compressed sparse row format. Nodes get dense
+//   indices and the predecessors of the node 'i' in the slicing walk
+//   are edges[offsets[i]] ... edges[offsets[i + 1] - 1].
+//
+//   The frozen graph does not follow changes of the original graph,
+//   it must be created again if the original graph changes.
+/// ------------------------------------------------------------------
+template <typename NodeT>
+class FrozenDependenceGraph
+{
+public:
+    using IndexT = uint32_t;
+    using DependenceGraphT = typename NodeT::DependenceGraphType;
+
+    enum : IndexT { NO_INDEX = ~static_cast<IndexT>(0) };
+
+private:
+    std::vector<NodeT *> nodes;
+    std::vector<IndexT> offsets;
+    std::vector<IndexT> edges;
+
+    // the index of the graph of the node
+    std::vector<IndexT> graph_of;
+    std::vector<DependenceGraphT *> graphs;
+    // entry nodes of the graphs
+    std::vector<IndexT> graph_entries;
+
+    std::unordered_map<const NodeT *, IndexT> indices;
+    std::unordered_map<const DependenceGraphT *, IndexT> graph_indices;
+
+    IndexT _getOrCreateIndex(NodeT *n) {
+        auto it = indices.find(n);
+        if (it != indices.end())
+            return it->second;
+
+        IndexT idx = nodes.size();
+        nodes.push_back(n);
+        indices.emplace(n, idx);
+        return idx;
+    }
+
+    template <typename ContainerT>
+    void _addNodes(const ContainerT& container) {
+        for (const auto& it : container)
+            _getOrCreateIndex(it.second);
+    }
+
+    void _addParameters(DGParameters<NodeT> *params) {
+        if (!params)
+            return;
+
+        auto addPair = [this](const DGParameterPair<NodeT>& p) {
+            if (p.in)
+                _getOrCreateIndex(p.in);
+            if (p.out)
+                _getOrCreateIndex(p.out);
+        };
+
+        for (const auto& it : *params)
+            addPair(it.second);
+        for (auto I = params->global_begin(), E = params->global_end(); I != E; ++I)
+            addPair(I->second);
+        if (auto *va = params->getVarArg())
+            addPair(*va);
+        if (NodeT *noret = params->getNoReturn())
+            _getOrCreateIndex(noret);
+    }
+
+    void _addGraph(DependenceGraphT *dg) {
+        if (!graph_indices.emplace(dg, graphs.size()).second)
+            return;
+
+        graphs.push_back(dg);
+        _addNodes(*dg);
+        if (const auto& globals = dg->getGlobalNodes())
+            _addNodes(*globals);
+        if (NodeT *entry = dg->getEntry())
+            _getOrCreateIndex(entry);
+    }
+
+    template <typename IT>
+    void _addEdges(IT I, IT E, std::vector<NodeT *>& to) {
+        for (; I != E; ++I)
+            to.push_back(*I);
+    }
+
+    // gather the nodes that the backward slicing
+    // walks to from the node 'n' (the same edges
+    // as analysis::Slicer::mark() uses)
+    void _getEdges(NodeT *n, std::vector<NodeT *>& to) {
+        _addEdges(n->rev_control_begin(), n->rev_control_end(), to);
+        _addEdges(n->rev_data_begin(), n->rev_data_end(), to);
+        _addEdges(n->user_begin(), n->user_end(), to);
+        _addEdges(n->interference_begin(), n->interference_end(), to);
+        _addEdges(n->rev_interference_begin(), n->rev_interference_end(), to);
+#ifdef ENABLE_CFG
+        if (BBlock<NodeT> *BB = n->getBBlock()) {
+            for (BBlock<NodeT> *CD : BB->revControlDependence())
+                to.push_back(CD->getLastNode());
+        }
+#endif
+    }
+
+public:
+    // freeze the given graphs and all graphs reachable from them
+    FrozenDependenceGraph(const std::vector<DependenceGraphT *>& roots) {
+        for (DependenceGraphT *dg : roots)
+            _addGraph(dg);
+
+        // the nodes get indices as we find them,
+        // so this loop goes over all reachable nodes
+        std::vector<NodeT *> succs;
+        offsets.push_back(0);
+        for (IndexT i = 0; i < nodes.size(); ++i) {
+            NodeT *n = nodes[i];
+
+            for (DependenceGraphT *sub : n->getSubgraphs())
+                _addGraph(sub);
+            _addParameters(n->getParameters());
+
+            DependenceGraphT *ndg = n->getDG();
+            if (ndg) {
+                _addGraph(ndg);
+                graph_of.push_back(graph_indices[ndg]);
+            } else {
+                graph_of.push_back(NO_INDEX);
+            }
+
+            succs.clear();
+            _getEdges(n, succs);
+            std::sort(succs.begin(), succs.end());
+            succs.erase(std::unique(succs.begin(), succs.end()), succs.end());
+            for (NodeT *s : succs) {
+                if (s)
+                    edges.push_back(_getOrCreateIndex(s));
+            }
+            offsets.push_back(edges.size());
+        }
+
+        graph_entries.reserve(graphs.size());
+        for (DependenceGraphT *dg : graphs) {
+            NodeT *entry = dg->getEntry();
+            graph_entries.push_back(entry ? indices[entry] : NO_INDEX);
+        }
+    }
+
+    FrozenDependenceGraph(DependenceGraphT *dg)
+    : FrozenDependenceGraph(std::vector<DependenceGraphT *>{dg}) {}
+
+    size_t size() const { return nodes.size(); }
+    size_t edgesNum() const { return edges.size(); }
+    size_t graphsNum() const { return graphs.size(); }
+
+    IndexT getIndex(const NodeT *n) const {
+        auto it = indices.find(n);
+        return it == indices.end() ? NO_INDEX : it->second;
+    }
+
+    NodeT *getNode(IndexT i) const { return nodes[i]; }
+
+    const IndexT *edges_begin(IndexT i) const { return edges.data() + offsets[i]; }
+    const IndexT *edges_end(IndexT i) const { return edges.data() + offsets[i + 1]; }
+
+    IndexT getGraphIndex(IndexT i) const { return graph_of[i]; }
+    DependenceGraphT *getGraph(IndexT g) const { return graphs[g]; }
+    IndexT getGraphEntry(IndexT g) const { return graph_entries[g]; }
+};
+
+} // namespace dg
+
+#endif // _DG_FROZEN_DEPENDENCE_GRAPH_H_
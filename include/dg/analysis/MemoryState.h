@@ -27,6 +27,16 @@ public:
         _memory[k].reset(o);
     }
 
+    // make the entry for k point to the object o
+    // (the object is shared until one of the states
+    // asks for a writable copy of it)
+    void share(Key k, const cow_shared_ptr<Object>& o) {
+        _memory[k] = o;
+    }
+
+    size_t size() const { return _memory.size(); }
+    bool empty() const { return _memory.empty(); }
+
     // take the memory state rhs and copy
     // entries for which this state does not have entry
     bool copyMissing(const MemoryState& rhs) {
@@ -68,8 +78,8 @@ public:
 
     auto begin() -> decltype(_memory.begin()) { return _memory.begin(); }
     auto end() -> decltype(_memory.end()) { return _memory.end(); }
-    auto begin() const -> decltype(_memory.begin()) { return _memory.begin(); }
-    auto end() const -> decltype(_memory.end()) { return _memory.end(); }
+    typename Map::const_iterator begin() const { return _memory.begin(); }
+    typename Map::const_iterator end() const { return _memory.end(); }
 
     // FIXME: add proper iterator
 };
@@ -77,8 +87,10 @@ public:
 // copy-on-write container around MemoryState
 template <typename Key, typename Object>
 class COWMemoryState {
-    cow_shared_ptr<MemoryState<Key, Object>> state;
+    using StateT = MemoryState<Key, Object>;
+    cow_shared_ptr<StateT> state;
 
+public:
     const Object *get(Key k) const { return state->get(k); };
 
     Object *getWritable(Key k) {
@@ -91,20 +103,20 @@ class COWMemoryState {
 
     // take the memory state rhs and copy
     // entries for which this state does not have entry
-    bool copyMissing(const MemoryState& rhs) {
+    bool copyMissing(const StateT& rhs) {
         return state.getWritable()->copyMissing(rhs);
     }
 
     bool copyMissing(const COWMemoryState& rhs) {
-        return state.getWritable()->copyMissing(rhs.state);
+        return state.getWritable()->copyMissing(*rhs.state);
     }
 
-    bool merge(const MemoryState& rhs) {
+    bool merge(const StateT& rhs) {
         return state.getWritable()->merge(rhs);
     }
 
     bool merge(const COWMemoryState& rhs) {
-        return state.getWritable()->merge(rhs.state);
+        return state.getWritable()->merge(*rhs.state);
     }
 };
 
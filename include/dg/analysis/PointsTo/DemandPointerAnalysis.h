@@ -0,0 +1,146 @@
+#ifndef _DG_DEMAND_POINTER_ANALYSIS_H_
+#define _DG_DEMAND_POINTER_ANALYSIS_H_
+
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "dg/analysis/PointsTo/Pointer.h"
+#include "dg/analysis/PointsTo/PointsToSet.h"
+#include "dg/analysis/PointsTo/PointerSubgraph.h"
+#include "dg/analysis/PointsTo/PointerAnalysisOptions.h"
+#include "dg/ADT/Queue.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+struct DemandPointerAnalysisStatistics
+{
+    // the number of queries that were not answered from the cache
+    uint64_t queries{0};
+    // the number of queries that did not finish in the budget
+    uint64_t exceeded{0};
+    // the number of steps of all the queries
+    uint64_t steps{0};
+    // the number of nodes with computed points-to sets
+    uint64_t resolvedNodes{0};
+};
+
+///
+// Demand-driven flow-insensitive pointer analysis. It computes
+// the points-to set of the queried node by exploring only the nodes
+// that the set depends on: the operands of the node and for loads
+// also the stores (and memcpy) that may write to the loaded memory.
+// The candidate stores are found by a reverse flows-to walk from
+// the loaded memory: along the users that copy the pointers (GEP, CAST,
+// PHI, ...) to the stores whose address operand is reached. If some
+// of the reached pointers is stored to memory, any load may return it,
+// so the walk continues from all the loads. The points-to sets of
+// the addresses of the candidate stores are then queried on demand
+// (a load gets the values of the stores whose address may alias
+// with its address). The explored nodes are solved
+// to a fixpoint with a worklist and their points-to sets are kept
+// for the following queries. The order of the nodes in the graph
+// is ignored, so the points-to sets contain the points-to sets
+// computed by PointerAnalysisFI (without preprocessing geps),
+// but they may be bigger. For example, a load from zero-initialized
+// memory always gets null, because it may read the memory before
+// any store to it.
+//
+// If a query takes more than PointerAnalysisOptions::queryBudget steps,
+// the queried node points to unknown memory and the nodes explored by
+// the query are forgotten. The unknown pointer is not kept either,
+// so the following queries compute the node again.
+//
+// The calls via function pointers are resolved (and inserted into
+// the graph by functionPointerCall()) before the first query
+// without the budget, since all the queries depend on the call graph.
+// Threads and invalidated memory are not supported.
+class DemandPointerAnalysis
+{
+    // the state of one query
+    struct Query {
+        std::unordered_map<PSNode *, PointsToSetT> pointsTo;
+        // the nodes whose points-to sets were computed
+        // from the points-to set of the key
+        std::unordered_map<PSNode *, std::set<PSNode *>> users;
+        ADT::QueueFIFO<PSNode *> worklist;
+        std::unordered_set<PSNode *> queued;
+        uint64_t steps{0};
+
+        void enqueue(PSNode *n) {
+            if (queued.insert(n).second)
+                worklist.push(n);
+        }
+    };
+
+    PointerSubgraph *PS{nullptr};
+    const PointerAnalysisOptions options{};
+
+    // the computed points-to sets
+    std::unordered_map<PSNode *, PointsToSetT> resolved;
+    // the result of the queries that did not finish in the budget
+    PointsToSetT unknown;
+
+    // the nodes reachable from the root of the graph
+    std::unordered_set<PSNode *> reachable;
+    // the nodes that got a pointer to the key when building the graph
+    std::unordered_map<PSNode *, std::vector<PSNode *>> initialPointers;
+    std::vector<PSNode *> loads;
+    // the stores and memcpy that may write to the memory (the key)
+    std::unordered_map<PSNode *, std::vector<PSNode *>> writersOf;
+    // the stores and memcpy whose address may come from a load
+    std::vector<PSNode *> loadedWriters;
+    bool loadedWritersFound{false};
+    bool prepared{false};
+
+    DemandPointerAnalysisStatistics statistics;
+
+    void gatherNodes();
+    void prepare();
+    bool findWriters(std::vector<PSNode *> nodes, std::vector<PSNode *>& out);
+    const std::vector<PSNode *>& getWriters(PSNode *target);
+
+    const PointsToSetT& solve(PSNode *node, uint64_t budget);
+    const PointsToSetT& get(PSNode *node, PSNode *user, Query& q);
+    void transfer(PSNode *node, Query& q, PointsToSetT& out);
+    void loadFrom(PSNode *node, PSNode *target, Offset offset,
+                  Query& q, PointsToSetT& out, std::set<PSNode *>& visited);
+    Offset gepOffset(PSNode *gep, const Pointer& ptr) const;
+
+public:
+    DemandPointerAnalysis(PointerSubgraph *ps,
+                          const PointerAnalysisOptions& opts)
+    : PS(ps), options(opts) {
+        unknown.add(UnknownPointer);
+    }
+
+    // default options
+    DemandPointerAnalysis(PointerSubgraph *ps) : DemandPointerAnalysis(ps, {}) {}
+
+    virtual ~DemandPointerAnalysis() = default;
+
+    // get the points-to set of the node, compute it if it has not
+    // been computed by some of the previous queries
+    const PointsToSetT& query(PSNode *node);
+
+    // has the points-to set of the node been computed?
+    bool isResolved(PSNode *node) const { return resolved.count(node) > 0; }
+
+    const DemandPointerAnalysisStatistics& getStatistics() const { return statistics; }
+
+    // the same hook as PointerAnalysis::functionPointerCall(),
+    // returns true if the graph was changed
+    virtual bool functionPointerCall(PSNode * /*where*/, PSNode * /*what*/) {
+        return false;
+    }
+};
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_DEMAND_POINTER_ANALYSIS_H_
@@ -0,0 +1,213 @@
+#ifndef _DG_FLAT_POINTS_TO_SET_H_
+#define _DG_FLAT_POINTS_TO_SET_H_
+
+#include "dg/analysis/PointsTo/Pointer.h"
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+///
+// Points-to set that keeps the pointers in one sorted
+// contiguous array (ordered by target and then by the offset).
+// Lookups are binary searches and union of two sets
+// is a linear merge, so there are no per-element allocations
+// and the data are cache friendly. Since Offset::UNKNOWN
+// is the greatest offset, a pointer with unknown offset is always
+// the last pointer in the range of pointers to the same target.
+class FlatPointsToSet {
+    using ContainerT = std::vector<Pointer>;
+    ContainerT pointers;
+
+    using iterator = ContainerT::iterator;
+
+    ContainerT::const_iterator _lowerBound(const Pointer& ptr) const {
+        return std::lower_bound(pointers.begin(), pointers.end(), ptr);
+    }
+
+    iterator _lowerBound(const Pointer& ptr) {
+        return std::lower_bound(pointers.begin(), pointers.end(), ptr);
+    }
+
+    // the range of pointers that point to the target
+    std::pair<iterator, iterator> _targetRange(PSNode *target) {
+        auto b = _lowerBound(Pointer(target, 0));
+        auto e = b;
+        while (e != pointers.end() && e->target == target)
+            ++e;
+        return {b, e};
+    }
+
+    bool addWithUnknownOffset(PSNode *target) {
+        auto range = _targetRange(target);
+        if (range.first != range.second &&
+            (range.second - 1)->offset.isUnknown())
+            return false;
+
+        // get rid of other offsets and keep
+        // only the unknown offset
+        auto it = pointers.erase(range.first, range.second);
+        pointers.insert(it, Pointer(target, Offset::UNKNOWN));
+        return true;
+    }
+
+public:
+    using const_iterator = ContainerT::const_iterator;
+
+    FlatPointsToSet() = default;
+    FlatPointsToSet(std::initializer_list<Pointer> elems) { add(elems); }
+
+    bool add(PSNode *target, Offset off) {
+        if (off.isUnknown())
+            return addWithUnknownOffset(target);
+
+        Pointer ptr(target, off);
+        auto it = _lowerBound(ptr);
+        if (it != pointers.end() && *it == ptr)
+            return false;
+
+        // do we have the same target with unknown offset?
+        // It would be in the range after 'it'.
+        auto unk = std::lower_bound(it, pointers.end(),
+                                    Pointer(target, Offset::UNKNOWN));
+        if (unk != pointers.end() && unk->target == target)
+            return false;
+
+        pointers.insert(it, ptr);
+        return true;
+    }
+
+    bool add(const Pointer& ptr) {
+        return add(ptr.target, ptr.offset);
+    }
+
+    // union (unite S into this set)
+    bool add(const FlatPointsToSet& S) {
+        if (S.pointers.empty())
+            return false;
+
+        if (pointers.empty()) {
+            pointers = S.pointers;
+            return true;
+        }
+
+        // find out whether we add something first,
+        // so that we do not reallocate the container
+        // in the (most common) case when nothing changes
+        size_t newNum = 0;
+        auto it = pointers.begin(), et = pointers.end();
+        for (const Pointer& ptr : S.pointers) {
+            while (it != et && *it < ptr)
+                ++it;
+            if (it == et || !(*it == ptr))
+                ++newNum;
+        }
+
+        if (newNum == 0)
+            return false;
+
+        ContainerT tmp;
+        tmp.reserve(pointers.size() + newNum);
+        std::set_union(pointers.begin(), pointers.end(),
+                       S.pointers.begin(), S.pointers.end(),
+                       std::back_inserter(tmp));
+        assert(tmp.size() == pointers.size() + newNum);
+        pointers.swap(tmp);
+        return true;
+    }
+
+    bool add(std::initializer_list<Pointer> elems) {
+        bool changed = false;
+        for (const auto& e : elems) {
+            changed |= add(e);
+        }
+        return changed;
+    }
+
+    bool remove(const Pointer& ptr) {
+        auto it = _lowerBound(ptr);
+        if (it == pointers.end() || !(*it == ptr))
+            return false;
+
+        pointers.erase(it);
+        return true;
+    }
+
+    ///
+    // Remove pointer to this target with this offset.
+    // This is method really removes the pair
+    // (target, off) even when the off is unknown
+    bool remove(PSNode *target, Offset offset) {
+        return remove(Pointer(target, offset));
+    }
+
+    ///
+    // Remove pointers pointing to this target
+    bool removeAny(PSNode *target) {
+        auto range = _targetRange(target);
+        if (range.first == range.second)
+            return false;
+
+        pointers.erase(range.first, range.second);
+        return true;
+    }
+
+    void clear() { pointers.clear(); }
+
+    bool pointsTo(const Pointer& ptr) const {
+        return std::binary_search(pointers.begin(), pointers.end(), ptr);
+    }
+
+    // points to the pointer or the the same target
+    // with unknown offset? Note: we do not count
+    // unknown memory here...
+    bool mayPointTo(const Pointer& ptr) const {
+        return pointsTo(ptr) ||
+                pointsTo(Pointer(ptr.target, Offset::UNKNOWN));
+    }
+
+    bool mustPointTo(const Pointer& ptr) const {
+        assert(!ptr.offset.isUnknown() && "Makes no sense");
+        return pointsTo(ptr) && isSingleton();
+    }
+
+    bool pointsToTarget(PSNode *target) const {
+        auto it = _lowerBound(Pointer(target, 0));
+        return it != pointers.end() && it->target == target;
+    }
+
+    bool isSingleton() const {
+        return pointers.size() == 1;
+    }
+
+    bool empty() const { return pointers.empty(); }
+
+    size_t count(const Pointer& ptr) const {
+        return pointsTo(ptr) ? 1 : 0;
+    }
+
+    bool has(const Pointer& ptr) const {
+        return count(ptr) > 0;
+    }
+
+    bool hasUnknown() const { return pointsToTarget(UNKNOWN_MEMORY); }
+    bool hasNull() const { return pointsToTarget(NULLPTR); }
+    bool hasInvalidated() const { return pointsToTarget(INVALIDATED); }
+
+    size_t size() const { return pointers.size(); }
+
+    void swap(FlatPointsToSet& rhs) { pointers.swap(rhs.pointers); }
+
+    const_iterator begin() const { return pointers.begin(); }
+    const_iterator end() const { return pointers.end(); }
+};
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_FLAT_POINTS_TO_SET_H_
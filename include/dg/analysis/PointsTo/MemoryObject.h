@@ -29,7 +29,17 @@ struct MemoryObject
     // possible pointers stored in this memory object
     PointsToMapT pointsTo;
 
-    PointsToSetT& getPointsTo(const Offset off) { return pointsTo[off]; }
+    // get the set for the offset, a new set gets
+    // the representation of the set of the allocation
+    PointsToSetT& getPointsTo(const Offset off) {
+        auto it = pointsTo.find(off);
+        if (it != pointsTo.end())
+            return it->second;
+
+        auto repr = node ? node->pointsTo.getRepresentation()
+                         : PointsToSetT::getDefaultRepresentation();
+        return pointsTo.emplace(off, PointsToSetT(repr)).first->second;
+    }
 
     PointsToMapT::iterator find(const Offset off) {
         return pointsTo.find(off);
@@ -49,7 +59,7 @@ struct MemoryObject
         for (auto& rit : rhs.pointsTo) {
             if (rit.second.empty())
                 continue;
-            changed |= pointsTo[rit.first].add(rit.second);
+            changed |= getPointsTo(rit.first).add(rit.second);
         }
 
         return changed;
@@ -60,14 +70,14 @@ struct MemoryObject
         assert(ptr.target != nullptr
                && "Cannot have NULL target, use unknown instead");
 
-        return pointsTo[off].add(ptr);
+        return getPointsTo(off).add(ptr);
     }
 
     bool addPointsTo(const Offset& off, const PointsToSetT& pointers)
     {
         if (pointers.empty())
             return false;
-        return pointsTo[off].add(pointers);
+        return getPointsTo(off).add(pointers);
     }
 
     bool addPointsTo(const Offset& off,
@@ -75,7 +85,7 @@ struct MemoryObject
     {
         if (pointers.size() == 0)
             return false;
-        return pointsTo[off].add(pointers);
+        return getPointsTo(off).add(pointers);
     }
 
 #ifndef NDEBUG
@@ -46,6 +46,26 @@ protected:
     std::vector<PSNode *> to_process;
     std::vector<PSNode *> changed;
 
+    bool isOnLoop(const PSNode *n) const {
+        unsigned idx = n->getSCCId();
+        const auto& scc = getSCCs()[idx];
+
+        // if the scc's size > 1, the node is in loop
+        return scc.size() > 1;
+    }
+
+    bool pointsToAllocationInLoop(PSNode *n) const {
+        for (const auto& ptr : n->pointsTo) {
+            // skip invalidated, null and unknown memory
+            if (!ptr.isValid() || ptr.isInvalidated())
+                continue;
+
+            if (isOnLoop(ptr.target))
+                return true;
+        }
+        return false;
+    }
+
 public:
 
     PointerAnalysis(PointerSubgraph *ps,
@@ -86,6 +106,7 @@ public:
     }
 
     PointerSubgraph *getPS() const { return PS; }
+    const PointerAnalysisOptions& getOptions() const { return options; }
 
     const std::vector<std::vector<PSNode *> > &getSCCs() const { return SCCs; }
 
@@ -143,7 +164,7 @@ public:
         }
     }
 
-    void run()
+    virtual void run()
     {
         // do preprocessing and queue the nodes
         preprocess();
@@ -212,7 +233,7 @@ public:
         return false;
     }
 
-private:
+protected:
 
     // check the sanity of results of pointer analysis
     void sanityCheck();
@@ -236,8 +257,18 @@ private:
 
     bool processNode(PSNode *);
     bool processLoad(PSNode *node);
+    // load pointers from the given addresses into 'out'
+    bool processLoad(PSNode *node, const PointsToSetT& addresses,
+                     PointsToSetT& out);
+    // store the given values to the given addresses
+    bool processStore(PSNode *node, const PointsToSetT& addresses,
+                      const PointsToSetT& values);
     bool processGep(PSNode *node);
+    // the offset of the pointer 'ptr' shifted by the GEP
+    Offset gepOffset(PSNodeGep *gep, const Pointer& ptr) const;
     bool processMemcpy(PSNode *node);
+
+private:
     bool processMemcpy(std::vector<MemoryObject *>& srcObjects,
                        std::vector<MemoryObject *>& destObjects,
                        const Pointer& sptr, const Pointer& dptr,
@@ -1,11 +1,19 @@
 #ifndef _DG_ANALYSIS_POINTS_TO_FLOW_INSENSITIVE_H_
 #define _DG_ANALYSIS_POINTS_TO_FLOW_INSENSITIVE_H_
 
+#include <algorithm>
 #include <cassert>
+#include <functional>
 #include <vector>
 #include <memory>
+#include <queue>
+#include <set>
+#include <tuple>
+#include <unordered_map>
 
 #include "PointerAnalysis.h"
+#include "dg/ADT/Arena.h"
+#include "dg/util/ThreadPool.h"
 
 namespace dg {
 namespace analysis {
@@ -16,22 +24,501 @@ namespace pta {
 //
 class PointerAnalysisFI : public PointerAnalysis
 {
-    std::vector<std::unique_ptr<MemoryObject>> memory_objects;
+    ADT::ArenaOwner<MemoryObject> memory_objects;
 
-public:
-    PointerAnalysisFI(PointerSubgraph *ps)
-    : PointerAnalysis(ps) {
-        memory_objects.reserve(std::max(ps->size() / 100, static_cast<size_t>(8)));
+    ///
+    // Difference propagation (see PointerAnalysisOptions::diffPropagation).
+    // Every node remembers the pointers that its operands gained since
+    // the node was processed the last time and processes only those.
+    struct DiffState {
+        PSNode *node{nullptr};
+        // new pointers of the operands (for STORE, new pointers of the
+        // address operand, the new stored values are in 'pendingValues')
+        PointsToSetT pending;
+        PointsToSetT pendingValues;
+        // the number of operands the last time we have seen the node
+        // (function pointer calls may add operands)
+        size_t operandsNum{0};
+        bool reachable{false};
+        bool queued{false};
+        // process the node from scratch (e.g., the memory that it reads
+        // changed, so the pending pointers are not enough)
+        bool full{false};
+        // push the whole points-to set of the node to its users
+        // after processing (someone else than the transfer
+        // function may have changed the points-to set)
+        bool pushAll{false};
+        // the representative of the collapsed cycle that
+        // contains this node (nullptr if the node was not collapsed)
+        PSNode *rep{nullptr};
+        // if this node is a representative, these are the other
+        // nodes of the collapsed cycle
+        std::vector<PSNode *> members;
+    };
+
+    // the worklist is ordered by the topological order of SCCs.
+    // The SCC ids are assigned in the reverse topological order,
+    // so the greater id, the sooner we process the node.
+    // Inside a SCC, we process nodes in the order of creation.
+    struct DiffPriority {
+        bool operator()(const std::pair<unsigned, unsigned>& a,
+                        const std::pair<unsigned, unsigned>& b) const {
+            return a.first < b.first ||
+                    (a.first == b.first && a.second > b.second);
+        }
+    };
+
+    std::vector<DiffState> diff_states;
+    std::priority_queue<std::pair<unsigned, unsigned>,
+                        std::vector<std::pair<unsigned, unsigned>>,
+                        DiffPriority> worklist;
+
+    // nodes that read the memory object (loads and memcpy)
+    std::unordered_map<MemoryObject *, std::set<PSNode *>> readers;
+    // memory objects written by the currently processed node
+    std::vector<MemoryObject *> written;
+    bool track_memory{false};
+
+    // copy edges (operand's representative, node's representative)
+    // that we already checked for being on a cycle
+    std::set<std::pair<unsigned, unsigned>> checked_edges;
+
+    // statistics
+    size_t processed_num{0};
+    size_t collapsed_num{0};
+
+    DiffState& _state(PSNode *n) {
+        if (n->getID() >= diff_states.size())
+            diff_states.resize(n->getID() + 1);
+
+        auto& st = diff_states[n->getID()];
+        st.node = n;
+        return st;
     }
 
-    void getMemoryObjects(PSNode *where, const Pointer& pointer,
-                          std::vector<MemoryObject *>& objects) override
-    {
-        // irrelevant in flow-insensitive
-        (void) where;
-        PSNode *n = pointer.target;
+    PSNode *_rep(PSNode *n) {
+        PSNode *r = n;
+        while (r->getID() < diff_states.size() && diff_states[r->getID()].rep)
+            r = diff_states[r->getID()].rep;
+
+        // path compression
+        while (n != r) {
+            PSNode *next = diff_states[n->getID()].rep;
+            diff_states[n->getID()].rep = r;
+            n = next;
+        }
+
+        return r;
+    }
+
+    // the nodes represented by the representative 'r' (including 'r')
+    std::vector<PSNode *> _group(PSNode *r) {
+        assert(_rep(r) == r);
+        std::vector<PSNode *> group{r};
+        const auto& members = _state(r).members;
+        group.insert(group.end(), members.begin(), members.end());
+        return group;
+    }
+
+    void _schedule(PSNode *n, bool full) {
+        n = _rep(n);
+        auto& st = _state(n);
+        if (!st.reachable)
+            return;
+
+        st.full |= full;
+        if (!st.queued) {
+            st.queued = true;
+            worklist.push({n->getSCCId(), n->getID()});
+        }
+    }
+
+    // find nodes that were not reachable before and nodes
+    // whose operands changed (the graph may change on function
+    // pointer calls or threads handling) and schedule them
+    void _rescan() {
+        diff_states.resize(std::max(diff_states.size(), getPS()->size()));
+
+        for (PSNode *n : getPS()->getNodes(getPS()->getRoot())) {
+            auto& st = _state(n);
+            if (!st.reachable) {
+                st.reachable = true;
+                st.pushAll = true;
+            } else if (st.operandsNum == n->getOperandsNum()) {
+                continue;
+            }
+
+            st.operandsNum = n->getOperandsNum();
+            _schedule(n, true);
+        }
+    }
+
+    static void _addNew(PSNode *n, const PointsToSetT& ptrs,
+                        PointsToSetT& newPtrs) {
+        for (const Pointer& ptr : ptrs) {
+            if (n->addPointsTo(ptr))
+                newPtrs.add(ptr);
+        }
+    }
+
+    bool _isCopy(PSNode *n) const {
+        switch (n->getType()) {
+            case PSNodeType::CAST:
+            case PSNodeType::PHI:
+            case PSNodeType::RETURN:
+                return true;
+            case PSNodeType::CALL_RETURN:
+                // with invalidated nodes the call return does more work
+                return !getOptions().invalidateNodes;
+            default:
+                return false;
+        }
+    }
+
+    // push the new pointers of 'n' (and of the nodes that it represents)
+    // to its users
+    void _propagate(PSNode *n, const PointsToSetT& newPtrs) {
+        for (PSNode *m : _group(n)) {
+            for (PSNode *user : m->getUsers()) {
+                PSNode *urep = _rep(user);
+                // an edge inside a collapsed cycle
+                if (urep == n)
+                    continue;
+
+                auto& st = _state(urep);
+                if (!st.reachable)
+                    continue;
+
+                if (user->getType() == PSNodeType::STORE) {
+                    if (user->getOperand(0) == m)
+                        st.pendingValues.add(newPtrs);
+                    if (user->getOperand(1) == m)
+                        st.pending.add(newPtrs);
+                } else if (_isCopy(user) ||
+                           user->getType() == PSNodeType::GEP ||
+                           user->getType() == PSNodeType::LOAD) {
+                    st.pending.add(newPtrs);
+                } else {
+                    st.full = true;
+                }
+
+                _schedule(urep, false);
+            }
+        }
+    }
+
+    ///
+    // Lazy cycle detection: if the copy node 'r' has now the same
+    // points-to set as its (copy) operand 'op', it is likely that
+    // they lie on a cycle. Check that (only once for each edge)
+    // and if they do, collapse the cycle.
+    void _detectCycles(PSNode *r) {
+        for (PSNode *m : _group(r)) {
+            for (PSNode *op : m->getOperands()) {
+                PSNode *orep = _rep(op);
+                if (orep == r || !_isCopy(orep) || !_state(orep).reachable)
+                    continue;
+
+                if (orep->pointsTo.empty() ||
+                    orep->pointsTo.size() != r->pointsTo.size())
+                    continue;
+
+                if (!checked_edges.insert({orep->getID(), r->getID()}).second)
+                    continue;
+
+                auto cycle = _findCycle(r, orep);
+                if (!cycle.empty()) {
+                    _collapse(r, cycle);
+                    // the operands of the group changed,
+                    // so start the search again later
+                    return;
+                }
+            }
+        }
+    }
+
+    // copy nodes (representatives) that use the group of 'r'
+    // or that the group of 'r' uses
+    template <typename F>
+    void _copyNeighbours(PSNode *r, bool users, F f) {
+        for (PSNode *m : _group(r)) {
+            for (PSNode *x : users ? m->getUsers() : m->getOperands()) {
+                PSNode *xrep = _rep(x);
+                if (xrep != r && _isCopy(xrep) && _state(xrep).reachable)
+                    f(xrep);
+            }
+        }
+    }
+
+    // Find the nodes on cycles of copy edges that go through 'to -> from'
+    // (that is, the nodes reachable from 'from' that reach 'to').
+    std::set<PSNode *> _findCycle(PSNode *from, PSNode *to) {
+        std::set<PSNode *> forward{from};
+        std::vector<PSNode *> stack{from};
+        while (!stack.empty()) {
+            PSNode *cur = stack.back();
+            stack.pop_back();
+            _copyNeighbours(cur, true, [&](PSNode *x) {
+                if (forward.insert(x).second)
+                    stack.push_back(x);
+            });
+        }
+
+        if (forward.count(to) == 0)
+            return {};
+
+        std::set<PSNode *> cycle{to};
+        stack.push_back(to);
+        while (!stack.empty()) {
+            PSNode *cur = stack.back();
+            stack.pop_back();
+            _copyNeighbours(cur, false, [&](PSNode *x) {
+                if (forward.count(x) > 0 && cycle.insert(x).second)
+                    stack.push_back(x);
+            });
+        }
+
+        assert(cycle.count(from) > 0);
+        return cycle;
+    }
+
+    // make 'r' the representative of all the nodes in 'cycle'
+    void _collapse(PSNode *r, const std::set<PSNode *>& cycle) {
+        for (PSNode *x : cycle) {
+            if (x == r)
+                continue;
+
+            assert(_rep(x) == x);
+            std::vector<PSNode *> members;
+            PointsToSetT pending;
+            {
+                auto& st = _state(x);
+                st.rep = r;
+                members.swap(st.members);
+                pending.swap(st.pending);
+            }
+
+            auto& rst = _state(r);
+            rst.members.push_back(x);
+            rst.members.insert(rst.members.end(), members.begin(), members.end());
+            rst.pending.add(pending);
+            r->addPointsTo(x->pointsTo);
+            ++collapsed_num;
+        }
+
+        // recompute the representative from all the operands
+        // of the cycle and make all the nodes have the same set
+        _state(r).pushAll = true;
+        _schedule(r, true);
+    }
+
+    void _processDiff(PSNode *n) {
+        bool full, pushAll;
+        PointsToSetT pending, pendingValues;
+        {
+            auto& st = _state(n);
+            assert(st.queued);
+            st.queued = false;
+            full = st.full;
+            st.full = false;
+            pushAll = st.pushAll;
+            st.pushAll = false;
+            pending.swap(st.pending);
+            pendingValues.swap(st.pendingValues);
+        }
+
+        ++processed_num;
+        written.clear();
+
+        bool changed = false;
+        PointsToSetT newPtrs;
+
+        if (_isCopy(n)) {
+            if (full) {
+                for (PSNode *m : _group(n)) {
+                    // the points-to set of a collapsed node
+                    // may have been changed from outside
+                    if (m != n)
+                        _addNew(n, m->pointsTo, newPtrs);
+                    for (PSNode *op : m->getOperands()) {
+                        if (_rep(op) != n)
+                            _addNew(n, op->pointsTo, newPtrs);
+                    }
+                }
+            } else {
+                _addNew(n, pending, newPtrs);
+            }
+
+            if (getOptions().collapseCycles && !newPtrs.empty())
+                _detectCycles(n);
+        } else if (PSNodeGep *gep = PSNodeGep::get(n)) {
+            const auto& ptrs = full ? gep->getSource()->pointsTo : pending;
+            for (const Pointer& ptr : ptrs) {
+                Pointer newPtr(ptr.target, gepOffset(gep, ptr));
+                if (n->addPointsTo(newPtr))
+                    newPtrs.add(newPtr);
+            }
+        } else if (n->getType() == PSNodeType::LOAD) {
+            PSNode *operand = n->getOperand(0);
+            PointsToSetT loaded;
+            if (!full)
+                processLoad(n, pending, loaded);
+            else if (operand->pointsTo.empty())
+                error(operand, "Load's operand has no points-to set");
+            else
+                processLoad(n, operand->pointsTo, loaded);
+
+            _addNew(n, loaded, newPtrs);
+        } else if (n->getType() == PSNodeType::STORE) {
+            PSNode *values = n->getOperand(0);
+            PSNode *addresses = n->getOperand(1);
+            if (full) {
+                changed = processStore(n, addresses->pointsTo,
+                                       values->pointsTo);
+            } else {
+                // new addresses get all the values,
+                // all addresses get the new values
+                if (!pending.empty())
+                    changed |= processStore(n, pending, values->pointsTo);
+                if (!pendingValues.empty())
+                    changed |= processStore(n, addresses->pointsTo,
+                                            pendingValues);
+            }
+        } else {
+            // other nodes are rare or have small points-to sets,
+            // so just use the generic transfer function for them
+            changed |= beforeProcessed(n);
+            changed |= processNode(n);
+            changed |= afterProcessed(n);
+
+            if (changed)
+                pushAll = true;
+
+            if (changed && (n->getType() == PSNodeType::CALL_FUNCPTR ||
+                            n->getType() == PSNodeType::FORK ||
+                            n->getType() == PSNodeType::JOIN)) {
+                // the graph may have changed. Also, the handling of function
+                // pointer call may add pointers directly to the call return
+                if (PSNode *paired = n->getPairedNode()) {
+                    _state(_rep(paired)).pushAll = true;
+                    _schedule(paired, true);
+                }
+                _rescan();
+            }
+        }
+
+        // wake up the nodes that read the memory that we changed
+        if (changed) {
+            for (MemoryObject *mo : written) {
+                auto it = readers.find(mo);
+                if (it == readers.end())
+                    continue;
+                for (PSNode *reader : it->second)
+                    _schedule(reader, true);
+            }
+        }
+
+        // the collapsed nodes have the same points-to set
+        // as their representative
+        const auto& members = _state(n).members;
+        for (PSNode *m : members) {
+            m->addPointsTo(pushAll ? n->pointsTo : newPtrs);
+        }
+
+        if (pushAll)
+            _propagate(n, n->pointsTo);
+        else if (!newPtrs.empty())
+            _propagate(n, newPtrs);
+    }
+
+    void _runDiffPropagation() {
+        preprocess();
+
+        // check that the current state of pointer analysis makes sense
+        sanityCheck();
+
+        track_memory = true;
+        _rescan();
+
+        while (!worklist.empty()) {
+            unsigned id = worklist.top().second;
+            worklist.pop();
+
+            PSNode *n = diff_states[id].node;
+            // collapsed into some other node
+            if (_rep(n) != n)
+                continue;
+
+            _processDiff(n);
+        }
+
+        track_memory = false;
+        readers.clear();
+        checked_edges.clear();
+        diff_states.clear();
+
+        sanityCheck();
+    }
+
+    ///
+    // Parallel solver (see PointerAnalysisOptions::solverThreads).
+    // The nodes are split into levels by the topological order
+    // of the SCCs of the graph (the level of a SCC is the length
+    // of the longest path to it from the root in the DAG of SCCs).
+    // The dirty nodes of one level are processed in rounds: in every
+    // round, the threads take the SCCs of the level and compute the new
+    // points-to sets and the stores of their nodes from the state
+    // at the beginning of the round. The threads only read the shared
+    // data, the results are stored aside and committed when all threads
+    // finish. The analysis is monotone, so the fixpoint (and thus the
+    // result) does not depend on the order of processing.
+    // Nodes that may change the graph (calls via pointers, threads)
+    // and other rare nodes are processed sequentially after the commit.
+    struct ParallelUpdates {
+        // new points-to sets of nodes
+        std::vector<std::pair<PSNode *, PointsToSetT>> pointsTo;
+        // pointers stored to memory (object, offset, stored pointers)
+        std::vector<std::tuple<MemoryObject *, Offset, const PointsToSetT *>> stores;
+        // memory objects read by loads
+        std::vector<std::pair<MemoryObject *, PSNode *>> reads;
+        // nodes that must be processed sequentially
+        std::vector<PSNode *> serial;
+        // what changed during the commit
+        std::vector<PSNode *> changedNodes;
+        std::vector<MemoryObject *> changedObjects;
+
+        void clear() {
+            pointsTo.clear();
+            stores.clear();
+            reads.clear();
+            serial.clear();
+            changedNodes.clear();
+            changedObjects.clear();
+        }
+    };
 
-        // we want to have memory in allocation sites
+    // smaller rounds are not worth waking up the threads
+    static const size_t PARALLEL_MIN_NODES = 32;
+    enum : unsigned { NO_LEVEL = ~0U };
+
+    // indexed by IDs of nodes
+    std::vector<unsigned> par_levels;
+    std::vector<size_t> par_operands_num;
+    std::vector<bool> par_dirty;
+    // the dirty nodes of every level
+    std::vector<std::vector<PSNode *>> par_buckets;
+    size_t par_dirty_num{0};
+    // are the threads running?
+    bool parallel{false};
+
+    static bool _canBeDereferenced(const Pointer& ptr) {
+        return ptr.isValid() && !ptr.isInvalidated() && !ptr.isUnknown() &&
+               ptr.target->getType() != PSNodeType::FUNCTION;
+    }
+
+    // the node that keeps the memory object of the target
+    // (we want to have memory in allocation sites)
+    static PSNode *_getAllocationSite(PSNode *n) {
         if (n->getType() == PSNodeType::CAST || n->getType() == PSNodeType::GEP)
             n = n->getOperand(0);
         else if (n->getType() == PSNodeType::CONSTANT) {
@@ -39,6 +526,385 @@ public:
             n = (*n->pointsTo.begin()).target;
         }
 
+        return n;
+    }
+
+    // do all the targets that can be dereferenced have memory objects?
+    // The threads must not create them, so the nodes that would need
+    // a new memory object are left to the sequential processing
+    static bool _haveMemoryObjects(const PointsToSetT& S) {
+        for (const Pointer& ptr : S) {
+            if (!_canBeDereferenced(ptr))
+                continue;
+
+            PSNode *n = _getAllocationSite(ptr.target);
+            if (n->getType() != PSNodeType::FUNCTION && !n->getData<MemoryObject>())
+                return false;
+        }
+
+        return true;
+    }
+
+    MemoryObject *_createMemoryObject(PSNode *n) {
+        MemoryObject *mo = memory_objects.create(n);
+        n->setData<MemoryObject>(mo);
+        return mo;
+    }
+
+    void _markDirty(PSNode *n) {
+        unsigned id = n->getID();
+        if (id >= par_levels.size() || par_levels[id] == NO_LEVEL || par_dirty[id])
+            return;
+
+        par_dirty[id] = true;
+        par_buckets[par_levels[id]].push_back(n);
+        ++par_dirty_num;
+    }
+
+    // (re)compute the levels and schedule the nodes that were not reachable
+    // before and the nodes whose operands changed (the graph may change
+    // on function pointer calls or threads handling)
+    void _parallelRescan() {
+        PointerSubgraph *PS = getPS();
+
+        // the threads must not create memory objects
+        for (const auto& nd : PS->getNodes()) {
+            if (nd && !nd->getData<MemoryObject>() &&
+                (nd->getType() == PSNodeType::ALLOC ||
+                 nd->getType() == PSNodeType::DYN_ALLOC ||
+                 nd->getType() == PSNodeType::UNKNOWN_MEM))
+                _createMemoryObject(nd.get());
+        }
+
+        // the SCCs are numbered in the reverse topological order
+        const auto& SCCs = getSCCs();
+        std::vector<unsigned> sccLevels(SCCs.size(), 0);
+        unsigned maxLevel = 0;
+        for (size_t i = SCCs.size(); i-- > 0;) {
+            maxLevel = std::max(maxLevel, sccLevels[i]);
+            for (PSNode *n : SCCs[i]) {
+                for (PSNode *succ : n->getSuccessors()) {
+                    unsigned j = succ->getSCCId();
+                    if (j != i)
+                        sccLevels[j] = std::max(sccLevels[j], sccLevels[i] + 1);
+                }
+            }
+        }
+
+        std::vector<PSNode *> dirty;
+        for (auto& bucket : par_buckets)
+            dirty.insert(dirty.end(), bucket.begin(), bucket.end());
+
+        par_levels.assign(PS->size(), NO_LEVEL);
+        par_operands_num.resize(PS->size(), ~static_cast<size_t>(0));
+        par_dirty.resize(PS->size(), false);
+        par_buckets.clear();
+        par_buckets.resize(maxLevel + 1);
+        par_dirty_num = 0;
+
+        for (size_t i = 0; i < SCCs.size(); ++i) {
+            for (PSNode *n : SCCs[i])
+                par_levels[n->getID()] = sccLevels[i];
+        }
+
+        for (PSNode *n : dirty) {
+            par_dirty[n->getID()] = false;
+            _markDirty(n);
+        }
+
+        for (const auto& scc : SCCs) {
+            for (PSNode *n : scc) {
+                if (par_operands_num[n->getID()] != n->getOperandsNum()) {
+                    par_operands_num[n->getID()] = n->getOperandsNum();
+                    _markDirty(n);
+                }
+            }
+        }
+    }
+
+    // compute the new state of the node into 'U'.
+    // Runs in parallel, so it must not change anything shared
+    void _computeParallel(PSNode *n, ParallelUpdates& U) {
+        std::vector<MemoryObject *> objects;
+
+        switch (n->getType()) {
+            case PSNodeType::LOAD: {
+                PSNode *operand = n->getOperand(0);
+                if (operand->pointsTo.empty()) {
+                    error(operand, "Load's operand has no points-to set");
+                    break;
+                }
+
+                if (!_haveMemoryObjects(operand->pointsTo)) {
+                    U.serial.push_back(n);
+                    break;
+                }
+
+                PointsToSetT loaded;
+                processLoad(n, operand->pointsTo, loaded);
+                U.pointsTo.emplace_back(n, std::move(loaded));
+
+                for (const Pointer& ptr : operand->pointsTo) {
+                    if (!_canBeDereferenced(ptr))
+                        continue;
+                    objects.clear();
+                    getMemoryObjects(n, ptr, objects);
+                    for (MemoryObject *o : objects)
+                        U.reads.emplace_back(o, n);
+                }
+                break;
+            }
+            case PSNodeType::STORE: {
+                const PointsToSetT& values = n->getOperand(0)->pointsTo;
+                if (values.empty())
+                    break;
+
+                if (!_haveMemoryObjects(n->getOperand(1)->pointsTo)) {
+                    U.serial.push_back(n);
+                    break;
+                }
+
+                for (const Pointer& ptr : n->getOperand(1)->pointsTo) {
+                    if (!_canBeDereferenced(ptr))
+                        continue;
+                    objects.clear();
+                    getMemoryObjects(n, ptr, objects);
+                    for (MemoryObject *o : objects)
+                        U.stores.emplace_back(o, ptr.offset, &values);
+                }
+                break;
+            }
+            case PSNodeType::GEP: {
+                PSNodeGep *gep = PSNodeGep::get(n);
+                PointsToSetT ptrs;
+                for (const Pointer& ptr : gep->getSource()->pointsTo)
+                    ptrs.add(ptr.target, gepOffset(gep, ptr));
+                U.pointsTo.emplace_back(n, std::move(ptrs));
+                break;
+            }
+            case PSNodeType::CALL_RETURN:
+                if (getOptions().invalidateNodes) {
+                    U.serial.push_back(n);
+                    break;
+                }
+                // fall-through
+            case PSNodeType::CAST:
+            case PSNodeType::PHI:
+            case PSNodeType::RETURN: {
+                PointsToSetT ptrs;
+                for (PSNode *op : n->getOperands())
+                    ptrs.add(op->pointsTo);
+                U.pointsTo.emplace_back(n, std::move(ptrs));
+                break;
+            }
+            default:
+                U.serial.push_back(n);
+        }
+    }
+
+    // process the node the usual way, return true
+    // if the graph may have changed
+    bool _processSerial(PSNode *n) {
+        written.clear();
+
+        bool changed = false;
+        changed |= beforeProcessed(n);
+        changed |= processNode(n);
+        changed |= afterProcessed(n);
+
+        if (!changed)
+            return false;
+
+        for (PSNode *user : n->getUsers())
+            _markDirty(user);
+
+        for (MemoryObject *mo : written) {
+            auto it = readers.find(mo);
+            if (it == readers.end())
+                continue;
+            for (PSNode *reader : it->second)
+                _markDirty(reader);
+        }
+
+        if (n->getType() == PSNodeType::CALL_FUNCPTR ||
+            n->getType() == PSNodeType::FORK ||
+            n->getType() == PSNodeType::JOIN) {
+            // the handling of function pointer call
+            // may add pointers directly to the call return
+            if (PSNode *paired = n->getPairedNode()) {
+                for (PSNode *user : paired->getUsers())
+                    _markDirty(user);
+            }
+            return true;
+        }
+
+        return false;
+    }
+
+    // process one round of the dirty nodes from the given level,
+    // return true if the graph may have changed
+    bool _parallelRound(ThreadPool& pool, std::vector<ParallelUpdates>& updates,
+                        unsigned level) {
+        std::vector<PSNode *> nodes;
+        nodes.swap(par_buckets[level]);
+        par_dirty_num -= nodes.size();
+        processed_num += nodes.size();
+        for (PSNode *n : nodes)
+            par_dirty[n->getID()] = false;
+
+        // group the nodes by SCCs
+        std::sort(nodes.begin(), nodes.end(), [](PSNode *a, PSNode *b) {
+            return a->getSCCId() < b->getSCCId() ||
+                    (a->getSCCId() == b->getSCCId() && a->getID() < b->getID());
+        });
+
+        std::vector<size_t> sccStarts;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (i == 0 || nodes[i]->getSCCId() != nodes[i - 1]->getSCCId())
+                sccStarts.push_back(i);
+        }
+        sccStarts.push_back(nodes.size());
+
+        for (auto& U : updates)
+            U.clear();
+
+        auto computeSCC = [&](size_t i, unsigned tid) {
+            for (size_t k = sccStarts[i]; k < sccStarts[i + 1]; ++k)
+                _computeParallel(nodes[k], updates[tid]);
+        };
+
+        auto commitNodes = [&](unsigned tid) {
+            auto& U = updates[tid];
+            for (auto& it : U.pointsTo) {
+                if (it.first->addPointsTo(it.second))
+                    U.changedNodes.push_back(it.first);
+            }
+        };
+
+        // every thread writes the objects from its own partition
+        std::hash<MemoryObject *> hash;
+        auto commitStores = [&](unsigned tid) {
+            for (const auto& U : updates) {
+                for (const auto& st : U.stores) {
+                    MemoryObject *mo = std::get<0>(st);
+                    if (hash(mo) % updates.size() != tid)
+                        continue;
+                    if (mo->addPointsTo(std::get<1>(st), *std::get<2>(st)))
+                        updates[tid].changedObjects.push_back(mo);
+                }
+            }
+        };
+
+        size_t sccsNum = sccStarts.size() - 1;
+        if (sccsNum > 1 && nodes.size() >= PARALLEL_MIN_NODES) {
+            parallel = true;
+            pool.parallelFor(sccsNum, computeSCC);
+            parallel = false;
+
+            pool.runOnAll(commitNodes);
+            pool.runOnAll(commitStores);
+        } else {
+            for (size_t i = 0; i < sccsNum; ++i)
+                computeSCC(i, 0);
+            for (unsigned tid = 0; tid < updates.size(); ++tid) {
+                commitNodes(tid);
+                commitStores(tid);
+            }
+        }
+
+        for (const auto& U : updates) {
+            for (const auto& it : U.reads)
+                readers[it.first].insert(it.second);
+        }
+
+        for (const auto& U : updates) {
+            for (PSNode *n : U.changedNodes) {
+                for (PSNode *user : n->getUsers())
+                    _markDirty(user);
+            }
+
+            for (MemoryObject *mo : U.changedObjects) {
+                auto it = readers.find(mo);
+                if (it == readers.end())
+                    continue;
+                for (PSNode *reader : it->second)
+                    _markDirty(reader);
+            }
+        }
+
+        bool graphChanged = false;
+        track_memory = true;
+        for (const auto& U : updates) {
+            for (PSNode *n : U.serial)
+                graphChanged |= _processSerial(n);
+        }
+        track_memory = false;
+
+        return graphChanged;
+    }
+
+    void _runParallel() {
+        preprocess();
+
+        // check that the current state of pointer analysis makes sense
+        sanityCheck();
+
+        ThreadPool pool(getOptions().solverThreads);
+        std::vector<ParallelUpdates> updates(pool.size());
+
+        _parallelRescan();
+        while (par_dirty_num > 0) {
+            unsigned level = 0;
+            while (level < par_buckets.size()) {
+                if (par_buckets[level].empty()) {
+                    ++level;
+                    continue;
+                }
+
+                if (_parallelRound(pool, updates, level)) {
+                    // start again with the new levels
+                    _parallelRescan();
+                    level = 0;
+                }
+            }
+        }
+
+        readers.clear();
+        par_levels.clear();
+        par_operands_num.clear();
+        par_dirty.clear();
+        par_buckets.clear();
+
+        sanityCheck();
+    }
+
+public:
+    PointerAnalysisFI(PointerSubgraph *ps,
+                      const PointerAnalysisOptions& opts)
+    : PointerAnalysis(ps, opts) {}
+
+    // default options
+    PointerAnalysisFI(PointerSubgraph *ps) : PointerAnalysisFI(ps, {}) {}
+
+    void run() override {
+        if (getOptions().solverThreads > 1)
+            _runParallel();
+        else if (getOptions().diffPropagation)
+            _runDiffPropagation();
+        else
+            PointerAnalysis::run();
+    }
+
+    // the number of processed nodes in difference propagation
+    // (or in the parallel solver)
+    size_t getProcessedNodesNum() const { return processed_num; }
+    // the number of nodes that were collapsed into some other node
+    size_t getCollapsedNodesNum() const { return collapsed_num; }
+
+    void getMemoryObjects(PSNode *where, const Pointer& pointer,
+                          std::vector<MemoryObject *>& objects) override
+    {
+        PSNode *n = _getAllocationSite(pointer.target);
         if (n->getType() == PSNodeType::FUNCTION)
             return;
 
@@ -48,12 +914,25 @@ public:
 
         MemoryObject *mo = n->getData<MemoryObject>();
         if (!mo) {
-            mo = new MemoryObject(n);
-            memory_objects.emplace_back(mo);
-            n->setData<MemoryObject>(mo);
+            // the parallel solver leaves the nodes that need
+            // a new memory object to the sequential processing
+            assert(!parallel && "Creating a memory object in a thread");
+            mo = _createMemoryObject(n);
         }
 
         objects.push_back(mo);
+
+        // the location is irrelevant in flow-insensitive analysis,
+        // but with difference propagation we need to know who reads
+        // and writes the memory
+        if (track_memory) {
+            if (where->getType() == PSNodeType::LOAD ||
+                where->getType() == PSNodeType::MEMCPY)
+                readers[mo].insert(where);
+            if (where->getType() == PSNodeType::STORE ||
+                where->getType() == PSNodeType::MEMCPY)
+                written.push_back(mo);
+        }
     }
 };
 
@@ -62,4 +941,3 @@ public:
 } // namespace dg
 
 #endif // _DG_ANALYSIS_POINTS_TO_FLOW_INSENSITIVE_H_
-
@@ -4,6 +4,7 @@
 #include <cassert>
 #include <memory>
 
+#include "dg/analysis/MemoryState.h"
 #include "MemoryObject.h"
 #include "PointerSubgraph.h"
 
@@ -17,11 +18,11 @@ namespace pta {
 class PointerAnalysisFS : public PointerAnalysis
 {
 public:
-    //using MemoryObjectsSetT = std::set<MemoryObject *>;
-    using MemoryMapT = std::map<PSNode *, std::unique_ptr<MemoryObject>>;
+    // Memory maps are copy-on-write: the memory objects are shared
+    // between the memory maps until some node writes to them,
+    // so merging the maps copies only the objects that differ.
+    using MemoryMapT = MemoryState<PSNode *, MemoryObject>;
 
-    // this is an easy but not very efficient implementation,
-    // works for testing
     PointerAnalysisFS(PointerSubgraph *ps,
                       PointerAnalysisOptions opts)
     : PointerAnalysis(ps, opts.setPreprocessGeps(false))
@@ -101,18 +102,15 @@ public:
         MemoryMapT *mm = where->getData<MemoryMapT>();
         assert(mm && "Node does not have memory map");
 
-        auto I = mm->find(pointer.target);
-        if (I != mm->end()) {
-            objects.push_back(I->second.get());
-        }
-
-        // if we haven't found any memory object, but this psnode
-        // is a write to memory, create a new one, so that
-        // the write has something to write to
-        if (objects.empty() && canChangeMM(where)) {
-            MemoryObject *mo = new MemoryObject(pointer.target);
-            mm->emplace(pointer.target, std::unique_ptr<MemoryObject>(mo));
-            objects.push_back(mo);
+        // the nodes that can change the memory map have their
+        // own memory map, so they get their own copy of the object
+        // (if we haven't found any memory object, create a new one,
+        // so that the write has something to write to).
+        // Other nodes only read the objects.
+        if (canChangeMM(where)) {
+            objects.push_back(getOrCreateMO(mm, pointer.target));
+        } else if (const MemoryObject *mo = mm->get(pointer.target)) {
+            objects.push_back(const_cast<MemoryObject *>(mo));
         }
     }
 
@@ -145,18 +143,25 @@ protected:
             return false;
     }
 
+    static MemoryObject *getOrCreateMO(MemoryMapT *mm, PSNode *target) {
+        if (!mm->get(target))
+            mm->put(target, new MemoryObject(target));
+
+        return mm->getWritable(target);
+    }
+
     static bool mergeObjects(PSNode *node,
                              MemoryObject *to,
-                             MemoryObject *from,
+                             const MemoryObject *from,
                              PointsToSetT *overwritten) {
         bool changed = false;
 
-        for (auto& fromIt : from->pointsTo) {
+        for (const auto& fromIt : from->pointsTo) {
             if (overwritten &&
                 overwritten->count(Pointer(node, fromIt.first)))
                 continue;
 
-            auto& S = to->pointsTo[fromIt.first];
+            auto& S = to->getPointsTo(fromIt.first);
             for (const auto& ptr : fromIt.second)
                 changed |= S.add(ptr);
         }
@@ -164,19 +169,68 @@ protected:
         return changed;
     }
 
+    // would merging 'from' into 'to' add any pointer to 'to'?
+    // (used to avoid copying shared objects when not needed)
+    static bool addsPointers(PSNode *node,
+                             const MemoryObject *to,
+                             const MemoryObject *from,
+                             PointsToSetT *overwritten) {
+        for (const auto& fromIt : from->pointsTo) {
+            if (fromIt.second.empty())
+                continue;
+
+            if (overwritten &&
+                overwritten->count(Pointer(node, fromIt.first)))
+                continue;
+
+            auto it = to->pointsTo.find(fromIt.first);
+            if (it == to->pointsTo.end())
+                return true;
+
+            for (const auto& ptr : fromIt.second) {
+                if (!it->second.mayPointTo(ptr))
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+    static bool hasPointers(const MemoryObject *mo) {
+        for (const auto& it : mo->pointsTo) {
+            if (!it.second.empty())
+                return true;
+        }
+        return false;
+    }
+
     // Merge two Memory maps, return true if any new information was created,
     // otherwise return false
-    static bool mergeMaps(MemoryMapT *mm, MemoryMapT *from,
+    static bool mergeMaps(MemoryMapT *mm, const MemoryMapT *from,
                           PointsToSetT *overwritten) {
         bool changed = false;
-        for (auto& it : *from) {
+        for (const auto& it : *from) {
             PSNode *fromTarget = it.first;
-            std::unique_ptr<MemoryObject>& toMo = (*mm)[fromTarget];
-            if (toMo == nullptr)
-                toMo.reset(new MemoryObject(fromTarget));
+            const MemoryObject *fromMo = it.second.get();
+            const MemoryObject *toMo = mm->get(fromTarget);
+            // the same (shared) object, nothing to merge
+            if (toMo == fromMo)
+                continue;
 
-            changed |= mergeObjects(fromTarget, toMo.get(),
-                                    it.second.get(), overwritten);
+            if (!toMo &&
+                (!overwritten || !overwritten->pointsToTarget(fromTarget))) {
+                // we do not have this object yet and nothing
+                // in it is overwritten, so just share it
+                mm->share(fromTarget, it.second);
+                changed |= hasPointers(fromMo);
+                continue;
+            }
+
+            if (toMo && !addsPointers(fromTarget, toMo, fromMo, overwritten))
+                continue;
+
+            changed |= mergeObjects(fromTarget, getOrCreateMO(mm, fromTarget),
+                                    fromMo, overwritten);
         }
 
         return changed;
@@ -188,27 +242,6 @@ protected:
         return mm;
     }
 
-    bool isOnLoop(const PSNode *n) const {
-        unsigned idx = n->getSCCId();
-        const auto& scc = getSCCs()[idx];
-
-        // if the scc's size > 1, the node is in loop
-        return scc.size() > 1;
-    }
-
-    bool pointsToAllocationInLoop(PSNode *n) const {
-        for (const auto& ptr : n->pointsTo) {
-            // skip invalidated, null and unknown memory
-            if (!ptr.isValid() || ptr.isInvalidated())
-                continue;
-
-            if (isOnLoop(ptr.target))
-                return true;
-        }
-        return false;
-
-    }
-
 private:
     static bool needsMerge(PSNode *n) {
         return n->predecessorsNum() > 1 || canChangeMM(n);
@@ -23,20 +23,9 @@ class PointerAnalysisFSInv : public PointerAnalysisFS
         return n->predecessorsNum() > 1 || canChangeMM(n);
     }
 
-    static MemoryObject *getOrCreateMO(MemoryMapT *mm, PSNode *target) {
-        std::unique_ptr<MemoryObject>& moptr = (*mm)[target];
-        if (!moptr)
-            moptr.reset(new MemoryObject(target));
-
-        assert(mm->find(target) != mm->end());
-        return moptr.get();
-    }
-
 public:
     using MemoryMapT = PointerAnalysisFS::MemoryMapT;
 
-    // this is an easy but not very efficient implementation,
-    // works for testing
     PointerAnalysisFSInv(PointerSubgraph *ps,
                            PointerAnalysisOptions opts)
     : PointerAnalysisFS(ps, opts.setInvalidateNodes(true)) {}
@@ -92,7 +81,7 @@ public:
                 alloc->getParent() == where->getParent();
     }
 
-    bool containsRemovableLocals(PSNode *where, PointsToSetT& S) {
+    bool containsRemovableLocals(PSNode *where, const PointsToSetT& S) const {
         for (const auto& ptr : S) {
             if (ptr.isNull() || ptr.isUnknown() || ptr.isInvalidated())
                 continue;
@@ -106,6 +95,33 @@ public:
         return false;
     }
 
+    bool containsRemovableLocals(PSNode *where, const MemoryObject *mo) const {
+        for (const auto& it : *mo) {
+            if (containsRemovableLocals(where, it.second))
+                return true;
+        }
+        return false;
+    }
+
+    // if the object from the predecessor needs no change, share it
+    // instead of copying it (or skip it if we share it already).
+    // Return true if the object was handled.
+    static bool shareUnchanged(MemoryMapT *mm,
+                               const MemoryMapT::Map::value_type& predEntry,
+                               bool& changed) {
+        const MemoryObject *mo = mm->get(predEntry.first);
+        if (mo == predEntry.second.get())
+            return true;
+
+        if (mo == nullptr) {
+            mm->share(predEntry.first, predEntry.second);
+            changed |= hasPointers(predEntry.second.get());
+            return true;
+        }
+
+        return false;
+    }
+
     // not very efficient
     void replaceLocalsWithInv(PSNode *where, PointsToSetT& S1) {
         PointsToSetT S;
@@ -157,10 +173,13 @@ public:
             if (isInvalidTarget(I.first))
                 continue;
 
-            // get or create a memory object for this target
+            const MemoryObject *pmo = I.second.get();
+            if (!containsRemovableLocals(node, pmo) &&
+                shareUnchanged(mm, I, changed))
+                continue;
 
+            // get or create a memory object for this target
             MemoryObject *mo = getOrCreateMO(mm, I.first);
-            MemoryObject *pmo = I.second.get();
 
             for (auto& it : *mo) {
                 // remove pointers to locals from the points-to set
@@ -171,12 +190,12 @@ public:
                 }
             }
 
-            for (auto& it : *pmo) {
-                PointsToSetT& predS = it.second;
+            for (const auto& it : *pmo) {
+                const PointsToSetT& predS = it.second;
                 if (predS.empty())
                     continue;
 
-                PointsToSetT& S = mo->pointsTo[it.first];
+                PointsToSetT& S = mo->getPointsTo(it.first);
 
                 // merge pointers from the previous states
                 // but do not include the pointers
@@ -284,17 +303,35 @@ public:
         // we can set it to invalidated
         auto mo = getOrCreateMO(mm, target);
         if (mo->pointsTo.size() == 1) {
-            auto& S = mo->pointsTo[0];
+            auto& S = mo->getPointsTo(0);
             if (S.size() == 1 && (*S.begin()).target == INVALIDATED) {
                 return false; // no update
             }
         }
 
         mo->pointsTo.clear();
-        mo->pointsTo[0].add(INVALIDATED, 0);
+        mo->getPointsTo(0).add(INVALIDATED, 0);
         return true;
     }
 
+    // can invalidating the memory pointed by the operand
+    // change the object?
+    static bool mayBeInvalidated(const MemoryObject *mo, PSNode *operand) {
+        if (operand->pointsTo.empty())
+            return false;
+        if (operand->pointsTo.hasUnknown())
+            return true;
+
+        for (const auto& it : *mo) {
+            for (const auto& ptr : it.second) {
+                if (operand->pointsTo.pointsToTarget(ptr.target))
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
     bool invalidateMemory(PSNode *node, PSNode *pred,
                           bool is_free = false)
     {
@@ -331,9 +368,13 @@ public:
             if (strong_update == I.first)
                 continue;
 
+            const MemoryObject *pmo = I.second.get();
+            if (!mayBeInvalidated(pmo, operand) &&
+                shareUnchanged(mm, I, changed))
+                continue;
+
             // get or create a memory object for this target
             MemoryObject *mo = getOrCreateMO(mm, I.first);
-            MemoryObject *pmo = I.second.get();
 
             // Remove references to invalidated memory from mo
             // if the invalidated object is just one.
@@ -368,12 +409,12 @@ public:
 
             // merge pointers from pmo to mo, but skip
             // the pointers that may point to the freed memory
-            for (auto& it : *pmo) {
-                PointsToSetT& predS = it.second;
+            for (const auto& it : *pmo) {
+                const PointsToSetT& predS = it.second;
                 if (predS.empty()) // keep the map clean
                     continue;
 
-                PointsToSetT& S = mo->pointsTo[it.first];
+                PointsToSetT& S = mo->getPointsTo(it.first);
 
                 // merge pointers from the previous states
                 // but do not include the pointers
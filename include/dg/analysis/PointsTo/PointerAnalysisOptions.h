@@ -1,7 +1,10 @@
 #ifndef _DG_POINTER_ANALYSIS_OPTIONS_H_
 #define _DG_POINTER_ANALYSIS_OPTIONS_H_
 
+#include <cstdint>
+
 #include "dg/analysis/AnalysisOptions.h"
+#include "dg/analysis/PointsTo/PointsToSet.h"
 
 namespace dg {
 namespace analysis {
@@ -19,8 +22,55 @@ struct PointerAnalysisOptions : AnalysisOptions {
     // INVALIDATED object.
     bool invalidateNodes{false};
 
+    // Use difference propagation in the flow-insensitive analysis:
+    // nodes are processed in the order of a worklist (prioritized
+    // by the topological order of SCCs) and propagate to their users
+    // only the pointers that they gained since the last processing.
+    bool diffPropagation{false};
+
+    // Detect cycles of copy nodes (casts, phis, ...) during difference
+    // propagation and collapse them into a single node (all the nodes
+    // on such a cycle have the same points-to set).
+    // Has an effect only with diffPropagation.
+    bool collapseCycles{false};
+
+    // Merge the nodes that compute the same value (hash-based value
+    // numbering, see PSEquivalentNodesMerger::runHVN()) before running
+    // the analysis. The merged nodes have the same points-to sets
+    // only in flow-insensitive analysis, so it is used only there.
+    bool valueNumbering{false};
+
+    // The number of threads used by the flow-insensitive analysis.
+    // With more than one thread, the nodes are processed in the
+    // topological order of the SCCs of the graph and the nodes
+    // from the SCCs of the same level (that is, SCCs that are not
+    // reachable from each other) are processed in parallel.
+    // Takes precedence over diffPropagation.
+    unsigned solverThreads{1};
+
+    // Representation of points-to sets. The sets are created
+    // already when building the PointerSubgraph, so the builder
+    // of the graph must pass this to the graph
+    // (PointerSubgraph::setPointsToSetRepresentation())
+    pta::PointsToSet::Representation ptSetRepresentation{
+        pta::PointsToSet::Representation::BITVECTOR};
+
+    // The maximal number of steps of one query of the demand-driven
+    // analysis (DemandPointerAnalysis). If the query does not finish
+    // in the budget, the queried node points to unknown memory.
+    // Zero means no limit.
+    uint64_t queryBudget{100000};
+
     PointerAnalysisOptions& setInvalidateNodes(bool b) { invalidateNodes = b; return *this;}
     PointerAnalysisOptions& setPreprocessGeps(bool b)  { preprocessGeps = b; return *this;}
+    PointerAnalysisOptions& setDiffPropagation(bool b) { diffPropagation = b; return *this;}
+    PointerAnalysisOptions& setCollapseCycles(bool b) { collapseCycles = b; return *this;}
+    PointerAnalysisOptions& setValueNumbering(bool b) { valueNumbering = b; return *this;}
+    PointerAnalysisOptions& setSolverThreads(unsigned n) { solverThreads = n; return *this;}
+    PointerAnalysisOptions& setQueryBudget(uint64_t b) { queryBudget = b; return *this;}
+    PointerAnalysisOptions& setPTSetRepresentation(pta::PointsToSet::Representation r) {
+        ptSetRepresentation = r; return *this;
+    }
 };
 
 } // namespace analysis
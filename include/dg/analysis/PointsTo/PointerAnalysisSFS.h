@@ -0,0 +1,577 @@
+#ifndef _DG_ANALYSIS_POINTS_TO_SPARSE_FLOW_SENSITIVE_H_
+#define _DG_ANALYSIS_POINTS_TO_SPARSE_FLOW_SENSITIVE_H_
+
+#include <cassert>
+#include <map>
+#include <set>
+#include <memory>
+#include <tuple>
+#include <vector>
+#include <algorithm>
+
+#include "dg/ADT/Queue.h"
+#include "PointerAnalysisFI.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+///
+// Staged sparse flow-sensitive pointer analysis.
+//
+// The analysis first runs the flow-insensitive analysis.
+// From its results we know which memory objects may be written
+// by STORE and MEMCPY nodes and read by LOAD and MEMCPY nodes.
+// For every memory object we connect each node that may write
+// the object with the nodes that may access the object and
+// that are reachable without going through another write
+// of the object (def-use chains over memory). The chains are
+// taken from memory SSA that is built for all the objects at once.
+// Then we compute
+// the points-to sets again, now flow-sensitively, but the memory
+// is propagated only along these sparse edges instead of keeping
+// a memory map in every node of the graph (as PointerAnalysisFS does).
+//
+// The results are the same as the results of PointerAnalysisFS
+// up to the order in which strong updates are performed and with
+// the exception of calls via function pointers and threads that are
+// resolved by the flow-insensitive pre-analysis.
+// The analysis does not support invalidate nodes.
+class PointerAnalysisSFS : public PointerAnalysisFI
+{
+    using MemoryMapT = std::map<PSNode *, std::unique_ptr<MemoryObject>>;
+
+    struct SparseState {
+        // memory objects accessed by this node. For loads this
+        // is the memory merged from the writes that reach the load,
+        // writes keep here also the memory that they wrote
+        MemoryMapT memory;
+        // (object, write) pairs -- the memory of these writes
+        // flows into this node
+        std::vector<std::pair<PSNode *, PSNode *>> incoming;
+        // nodes that use the memory written by this node
+        std::vector<PSNode *> memoryUsers;
+    };
+
+    // indexed by the IDs of nodes
+    std::vector<std::unique_ptr<SparseState>> states;
+    std::vector<bool> queued;
+    ADT::QueueFIFO<PSNode *> queue;
+
+    // are we in the flow-sensitive phase?
+    bool sparse{false};
+    size_t memory_edges_num{0};
+
+    static bool isWrite(const PSNode *n) {
+        return n->getType() == PSNodeType::STORE ||
+               n->getType() == PSNodeType::MEMCPY;
+    }
+
+    static bool accessesMemory(const PSNode *n) {
+        return isWrite(n) || n->getType() == PSNodeType::LOAD;
+    }
+
+    // the nodes whose points-to sets are computed only
+    // from the operands (and the memory). Other nodes keep
+    // the points-to sets computed by the pre-analysis
+    // (allocations, constants, calls via pointers, ...)
+    static bool isRecomputed(const PSNode *n) {
+        switch (n->getType()) {
+            case PSNodeType::LOAD:
+            case PSNodeType::GEP:
+            case PSNodeType::CAST:
+            case PSNodeType::PHI:
+            case PSNodeType::RETURN:
+                return true;
+            case PSNodeType::CALL_RETURN:
+                // calls to undefined functions via pointers
+                // put unknown pointer to the return node
+                return !n->getPairedNode() ||
+                        n->getPairedNode()->getType() != PSNodeType::CALL_FUNCPTR;
+            default:
+                return false;
+        }
+    }
+
+    static bool canBeDereferenced(const Pointer& ptr) {
+        return ptr.isValid() && !ptr.isInvalidated() &&
+               ptr.target->getType() != PSNodeType::FUNCTION;
+    }
+
+    // the objects read and written by the node
+    // according to the results of the pre-analysis
+    static void getAccessedObjects(PSNode *n,
+                                   std::vector<PSNode *>& read,
+                                   std::vector<PSNode *>& written) {
+        auto add = [](const PointsToSetT& S, std::vector<PSNode *>& to) {
+            for (const auto& ptr : S) {
+                if (canBeDereferenced(ptr))
+                    to.push_back(ptr.target);
+            }
+        };
+
+        switch (n->getType()) {
+            case PSNodeType::LOAD:
+                add(n->getOperand(0)->pointsTo, read);
+                break;
+            case PSNodeType::STORE:
+                add(n->getOperand(1)->pointsTo, written);
+                break;
+            case PSNodeType::MEMCPY:
+                add(PSNodeMemcpy::get(n)->getSource()->pointsTo, read);
+                add(PSNodeMemcpy::get(n)->getDestination()->pointsTo, written);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // a phi node of memory SSA, it merges the definitions
+    // of an object (writes and other phi nodes) at a join point
+    struct MemoryPhi {
+        std::vector<PSNode *> writes;
+        std::vector<size_t> phis;
+        // the phi nodes that use this phi node
+        std::vector<size_t> users;
+        // the writes that reach this phi node through the operands
+        std::set<PSNode *> reaching;
+    };
+
+    // the definition of an object: a write or a phi node (if write is null)
+    struct MemoryDef {
+        PSNode *write;
+        size_t phi;
+    };
+
+    // Get the nodes reachable from the root in reverse postorder
+    // and compute their immediate dominators (K. D. Cooper, T. J. Harvey,
+    // K. Kennedy: A Simple, Fast Dominance Algorithm).
+    // 'order' maps the IDs of nodes to the positions in the returned
+    // vector (-1 for unreachable nodes), 'idom' maps the positions
+    // to the positions of immediate dominators.
+    std::vector<PSNode *> computeDominators(PSNode *root,
+                                            std::vector<int>& order,
+                                            std::vector<size_t>& idom) {
+        std::vector<PSNode *> rpo;
+        std::vector<bool> visited(order.size(), false);
+        std::vector<std::pair<PSNode *, size_t>> stack;
+
+        visited[root->getID()] = true;
+        stack.emplace_back(root, 0);
+        while (!stack.empty()) {
+            PSNode *cur = stack.back().first;
+            size_t idx = stack.back().second;
+            if (idx < cur->getSuccessors().size()) {
+                ++stack.back().second;
+                PSNode *succ = cur->getSuccessors()[idx];
+                if (!visited[succ->getID()]) {
+                    visited[succ->getID()] = true;
+                    stack.emplace_back(succ, 0);
+                }
+            } else {
+                rpo.push_back(cur);
+                stack.pop_back();
+            }
+        }
+
+        std::reverse(rpo.begin(), rpo.end());
+        for (size_t i = 0; i < rpo.size(); ++i)
+            order[rpo[i]->getID()] = static_cast<int>(i);
+
+        const size_t undefined = rpo.size();
+        idom.assign(rpo.size(), undefined);
+        idom[0] = 0;
+
+        auto intersect = [&idom](size_t a, size_t b) {
+            while (a != b) {
+                while (a > b)
+                    a = idom[a];
+                while (b > a)
+                    b = idom[b];
+            }
+            return a;
+        };
+
+        bool changed;
+        do {
+            changed = false;
+            for (size_t i = 1; i < rpo.size(); ++i) {
+                size_t newIdom = undefined;
+                for (PSNode *pred : rpo[i]->getPredecessors()) {
+                    int p = order[pred->getID()];
+                    if (p < 0 || idom[p] == undefined)
+                        continue;
+                    newIdom = newIdom == undefined ?
+                                static_cast<size_t>(p) : intersect(p, newIdom);
+                }
+
+                if (idom[i] != newIdom) {
+                    idom[i] = newIdom;
+                    changed = true;
+                }
+            }
+        } while (changed);
+
+        return rpo;
+    }
+
+    // Build memory SSA for all the objects at once (phi nodes are placed
+    // at the iterated dominance frontiers of the writes and the definitions
+    // are renamed in one walk over the dominator tree) and connect every
+    // access with the writes that reach it, possibly through phi nodes.
+    void buildMemoryEdges(PSNode *root) {
+        std::vector<int> order(states.size(), -1);
+        std::vector<size_t> idom;
+        std::vector<PSNode *> rpo = computeDominators(root, order, idom);
+
+        // the objects written and accessed by the nodes (by positions)
+        std::map<PSNode *, size_t> objectIdx;
+        std::vector<PSNode *> objects;
+        std::vector<std::vector<size_t>> objectWrites;
+        std::vector<std::vector<size_t>> written(rpo.size());
+        std::vector<std::vector<size_t>> accessed(rpo.size());
+        std::vector<PSNode *> read, wr;
+
+        auto getIdx = [&](PSNode *o) {
+            auto it = objectIdx.emplace(o, objects.size());
+            if (it.second) {
+                objects.push_back(o);
+                objectWrites.emplace_back();
+            }
+            return it.first->second;
+        };
+
+        for (size_t i = 0; i < rpo.size(); ++i) {
+            PSNode *n = rpo[i];
+            if (!accessesMemory(n))
+                continue;
+
+            states[n->getID()].reset(new SparseState());
+
+            read.clear();
+            wr.clear();
+            getAccessedObjects(n, read, wr);
+            for (PSNode *o : wr) {
+                size_t idx = getIdx(o);
+                written[i].push_back(idx);
+                objectWrites[idx].push_back(i);
+                // the write is weak in general,
+                // so it uses the previous memory too
+                accessed[i].push_back(idx);
+            }
+            for (PSNode *o : read)
+                accessed[i].push_back(getIdx(o));
+
+            // a node may access the object via more pointers
+            makeUnique(written[i]);
+            makeUnique(accessed[i]);
+        }
+
+        // dominance frontiers
+        std::vector<std::vector<size_t>> frontier(rpo.size());
+        for (size_t i = 1; i < rpo.size(); ++i) {
+            if (rpo[i]->getPredecessors().size() < 2)
+                continue;
+
+            for (PSNode *pred : rpo[i]->getPredecessors()) {
+                int runner = order[pred->getID()];
+                if (runner < 0)
+                    continue;
+                while (static_cast<size_t>(runner) != idom[i]) {
+                    frontier[runner].push_back(i);
+                    runner = static_cast<int>(idom[runner]);
+                }
+            }
+        }
+
+        // place the phi nodes, phisAt keeps (object, phi) pairs
+        std::vector<MemoryPhi> phis;
+        std::vector<std::vector<std::pair<size_t, size_t>>> phisAt(rpo.size());
+        std::vector<size_t> hasPhi(rpo.size(), 0);
+        std::vector<size_t> worklist;
+        for (size_t o = 0; o < objects.size(); ++o) {
+            worklist = objectWrites[o];
+            while (!worklist.empty()) {
+                size_t x = worklist.back();
+                worklist.pop_back();
+                for (size_t y : frontier[x]) {
+                    if (hasPhi[y] == o + 1)
+                        continue;
+                    hasPhi[y] = o + 1;
+                    phisAt[y].emplace_back(o, phis.size());
+                    phis.emplace_back();
+                    worklist.push_back(y);
+                }
+            }
+        }
+
+        // rename the definitions, uses keep (definition, access, object)
+        std::vector<std::vector<size_t>> children(rpo.size());
+        for (size_t i = 1; i < rpo.size(); ++i)
+            children[idom[i]].push_back(i);
+
+        std::vector<std::tuple<MemoryDef, PSNode *, size_t>> uses;
+        std::vector<std::vector<MemoryDef>> defs(objects.size());
+        std::vector<std::pair<size_t, size_t>> walk;
+        walk.emplace_back(0, 0);
+        while (!walk.empty()) {
+            size_t i = walk.back().first;
+            size_t child = walk.back().second++;
+            if (child == 0) {
+                for (const auto& it : phisAt[i])
+                    defs[it.first].push_back(MemoryDef{nullptr, it.second});
+                for (size_t o : accessed[i]) {
+                    if (!defs[o].empty())
+                        uses.emplace_back(defs[o].back(), rpo[i], o);
+                }
+                for (size_t o : written[i])
+                    defs[o].push_back(MemoryDef{rpo[i], 0});
+
+                for (PSNode *succ : rpo[i]->getSuccessors()) {
+                    for (const auto& it : phisAt[order[succ->getID()]]) {
+                        if (defs[it.first].empty())
+                            continue;
+                        const MemoryDef& def = defs[it.first].back();
+                        MemoryPhi& phi = phis[it.second];
+                        if (def.write) {
+                            phi.writes.push_back(def.write);
+                        } else {
+                            phi.phis.push_back(def.phi);
+                            phis[def.phi].users.push_back(it.second);
+                        }
+                    }
+                }
+            }
+
+            if (child < children[i].size()) {
+                walk.emplace_back(children[i][child], 0);
+                continue;
+            }
+
+            for (size_t o : written[i])
+                defs[o].pop_back();
+            for (const auto& it : phisAt[i])
+                defs[it.first].pop_back();
+            walk.pop_back();
+        }
+
+        // the writes that reach the phi nodes
+        worklist.clear();
+        for (size_t p = 0; p < phis.size(); ++p) {
+            phis[p].reaching.insert(phis[p].writes.begin(), phis[p].writes.end());
+            worklist.push_back(p);
+        }
+        while (!worklist.empty()) {
+            size_t p = worklist.back();
+            worklist.pop_back();
+            for (size_t u : phis[p].users) {
+                size_t size = phis[u].reaching.size();
+                phis[u].reaching.insert(phis[p].reaching.begin(),
+                                        phis[p].reaching.end());
+                if (phis[u].reaching.size() != size)
+                    worklist.push_back(u);
+            }
+        }
+
+        auto connect = [this](PSNode *object, PSNode *w, PSNode *access) {
+            states[access->getID()]->incoming.emplace_back(object, w);
+            states[w->getID()]->memoryUsers.push_back(access);
+            ++memory_edges_num;
+        };
+
+        for (const auto& use : uses) {
+            const MemoryDef& def = std::get<0>(use);
+            PSNode *object = objects[std::get<2>(use)];
+            if (def.write) {
+                connect(object, def.write, std::get<1>(use));
+            } else {
+                for (PSNode *w : phis[def.phi].reaching)
+                    connect(object, w, std::get<1>(use));
+            }
+        }
+
+        for (auto& st : states) {
+            if (st)
+                makeUnique(st->memoryUsers);
+        }
+    }
+
+    template <typename T>
+    static void makeUnique(std::vector<T>& vec) {
+        std::sort(vec.begin(), vec.end());
+        vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
+    }
+
+    static bool mergeObjects(PSNode *target, MemoryObject *to,
+                             const MemoryObject *from,
+                             const PointsToSetT *overwritten) {
+        if (!overwritten || !overwritten->pointsToTarget(target))
+            return to->merge(*from);
+
+        bool changed = false;
+        for (const auto& it : from->pointsTo) {
+            if (it.second.empty() ||
+                overwritten->count(Pointer(target, it.first)))
+                continue;
+
+            changed |= to->getPointsTo(it.first).add(it.second);
+        }
+
+        return changed;
+    }
+
+    // merge the memory from the writes that reach the node,
+    // return true if the memory of the node changed
+    bool mergeIncoming(PSNode *n, SparseState *st) {
+        // every store that stores to a memory allocated
+        // not in a loop is a strong update (the same as in
+        // PointerAnalysisFS)
+        const PointsToSetT *overwritten = nullptr;
+        if (n->getType() == PSNodeType::STORE &&
+            !pointsToAllocationInLoop(n->getOperand(1)))
+            overwritten = &n->getOperand(1)->pointsTo;
+
+        bool changed = false;
+        for (const auto& inc : st->incoming) {
+            const MemoryMapT& from = states[inc.second->getID()]->memory;
+            auto it = from.find(inc.first);
+            if (it == from.end())
+                continue;
+
+            std::unique_ptr<MemoryObject>& mo = st->memory[inc.first];
+            if (!mo)
+                mo.reset(new MemoryObject(inc.first));
+
+            changed |= mergeObjects(inc.first, mo.get(),
+                                    it->second.get(), overwritten);
+        }
+
+        return changed;
+    }
+
+    void enqueueSparse(PSNode *n) {
+        if (changesGraph(n) || queued[n->getID()])
+            return;
+
+        queued[n->getID()] = true;
+        queue.push(n);
+    }
+
+    // these nodes would change the graph, but that has
+    // already been done by the pre-analysis (the pre-analysis
+    // is sound, so the sparse phase cannot find new callees).
+    // The states are sized for the graph that we have now.
+    static bool changesGraph(const PSNode *n) {
+        return n->getType() == PSNodeType::CALL_FUNCPTR ||
+               n->getType() == PSNodeType::FORK ||
+               n->getType() == PSNodeType::JOIN;
+    }
+
+    void processSparse(PSNode *n) {
+        SparseState *st = states[n->getID()].get();
+
+        bool memoryChanged = false;
+        if (st)
+            memoryChanged |= mergeIncoming(n, st);
+
+        bool changed = processNode(n);
+        if (isWrite(n)) {
+            // writes change only the memory
+            memoryChanged |= changed;
+        } else if (changed) {
+            for (PSNode *user : n->getUsers())
+                enqueueSparse(user);
+        }
+
+        if (memoryChanged && isWrite(n)) {
+            for (PSNode *user : st->memoryUsers)
+                enqueueSparse(user);
+        }
+    }
+
+    void runSparse() {
+        PointerSubgraph *PS = getPS();
+        auto nodes = PS->getNodes(PS->getRoot());
+
+        states.clear();
+        states.resize(PS->size());
+        queued.assign(PS->size(), false);
+
+        buildMemoryEdges(PS->getRoot());
+
+        sparse = true;
+
+        // compute the points-to sets again
+        for (PSNode *n : nodes) {
+            if (isRecomputed(n))
+                n->pointsTo.clear();
+        }
+
+        for (PSNode *n : nodes)
+            enqueueSparse(n);
+
+        while (!queue.empty()) {
+            PSNode *n = queue.pop();
+            queued[n->getID()] = false;
+            processSparse(n);
+        }
+
+        assert(states.size() == PS->size() && "The graph changed in the sparse phase");
+    }
+
+public:
+    PointerAnalysisSFS(PointerSubgraph *ps,
+                       PointerAnalysisOptions opts)
+    : PointerAnalysisFI(ps, opts.setPreprocessGeps(false))
+    {
+        assert(!opts.invalidateNodes &&
+               "Sparse flow-sensitive analysis does not support invalidate nodes");
+    }
+
+    // default options
+    PointerAnalysisSFS(PointerSubgraph *ps) : PointerAnalysisSFS(ps, {}) {}
+
+    void run() override {
+        // the flow-insensitive pre-analysis
+        sparse = false;
+        PointerAnalysisFI::run();
+
+        runSparse();
+        sanityCheck();
+    }
+
+    // the number of the (object, write, access) edges
+    size_t getMemoryEdgesNum() const { return memory_edges_num; }
+
+    void getMemoryObjects(PSNode *where, const Pointer& pointer,
+                          std::vector<MemoryObject *>& objects) override
+    {
+        if (!sparse) {
+            PointerAnalysisFI::getMemoryObjects(where, pointer, objects);
+            return;
+        }
+
+        SparseState *st = states[where->getID()].get();
+        assert(st && "Node accessing memory has no state");
+
+        auto it = st->memory.find(pointer.target);
+        if (it != st->memory.end()) {
+            objects.push_back(it->second.get());
+            return;
+        }
+
+        // writes need something to write to
+        // (the same as in PointerAnalysisFS)
+        if (isWrite(where)) {
+            MemoryObject *mo = new MemoryObject(pointer.target);
+            st->memory.emplace(pointer.target, std::unique_ptr<MemoryObject>(mo));
+            objects.push_back(mo);
+        }
+    }
+};
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_ANALYSIS_POINTS_TO_SPARSE_FLOW_SENSITIVE_H_
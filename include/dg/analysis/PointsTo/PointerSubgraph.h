@@ -1,6 +1,7 @@
 #ifndef _DG_POINTER_SUBGRAPH_H_
 #define _DG_POINTER_SUBGRAPH_H_
 
+#include "dg/ADT/Arena.h"
 #include "dg/ADT/Queue.h"
 #include "dg/analysis/SubgraphNode.h"
 #include "dg/analysis/CallGraph.h"
@@ -18,12 +19,20 @@ namespace pta {
 
 class PointerSubgraph
 {
+public:
+    // the nodes are allocated in the arena of the graph,
+    // the pointers only call the destructors
+    using NodesT = std::vector<ADT::ArenaPtr<PSNode>>;
+
+private:
     unsigned int dfsnum;
 
     // root of the pointer state subgraph
     PSNode *root;
 
-    using NodesT = std::vector<std::unique_ptr<PSNode>>;
+    // must be declared before the nodes,
+    // so that it is destroyed after them
+    ADT::Arena arena;
     NodesT nodes;
 
     // Take care of assigning ids to new nodes
@@ -32,8 +41,20 @@ class PointerSubgraph
         return ++last_node_id;
     }
 
+    // the constructors of nodes are accessible only to us,
+    // so we can not use arena.create()
+    template <typename T, typename... Args>
+    T *_create(Args&&... args) {
+        return new (arena.allocate(sizeof(T), alignof(T)))
+                    T(std::forward<Args>(args)...);
+    }
+
     GenericCallGraph<PSNode *> callGraph;
 
+    // the representation of the points-to sets of the nodes
+    PointsToSet::Representation ptSetRepresentation{
+        PointsToSet::getDefaultRepresentation()};
+
 public:
     PointerSubgraph() : dfsnum(0), root(nullptr) {
         // nodes[0] represents invalid node (the node with id 0)
@@ -46,11 +67,32 @@ public:
 
     const GenericCallGraph<PSNode *>& getCallGraph() const { return callGraph; }
 
+    // set the representation of the points-to sets of the nodes
+    // that are created from now on
+    void setPointsToSetRepresentation(PointsToSet::Representation r) {
+        ptSetRepresentation = r;
+    }
+
+    PointsToSet::Representation getPointsToSetRepresentation() const {
+        return ptSetRepresentation;
+    }
+
     const NodesT& getNodes() const { return nodes; }
     size_t size() const { return nodes.size(); }
 
     PointerSubgraph(PointerSubgraph&&) = default;
-    PointerSubgraph& operator=(PointerSubgraph&&) = default;
+    PointerSubgraph& operator=(PointerSubgraph&& rhs) {
+        // destroy our nodes while we still have the memory
+        nodes.clear();
+        dfsnum = rhs.dfsnum;
+        root = rhs.root;
+        arena = std::move(rhs.arena);
+        nodes = std::move(rhs.nodes);
+        last_node_id = rhs.last_node_id;
+        callGraph = std::move(rhs.callGraph);
+        ptSetRepresentation = rhs.ptSetRepresentation;
+        return *this;
+    }
     PointerSubgraph(const PointerSubgraph&) = delete;
     PointerSubgraph operator=(const PointerSubgraph&) = delete;
 
@@ -95,43 +137,50 @@ public:
         switch (t) {
             case PSNodeType::ALLOC:
             case PSNodeType::DYN_ALLOC:
-                node = new PSNodeAlloc(getNewNodeId(), t);
+                node = _create<PSNodeAlloc>(getNewNodeId(), t);
                 break;
-            case PSNodeType::GEP:
-                node = new PSNodeGep(getNewNodeId(),
-                                     va_arg(args, PSNode *),
-                                     va_arg(args, Offset::type));
+            // NOTE: the order of evaluation of arguments is unspecified,
+            // so we must read the variadic arguments before the call
+            case PSNodeType::GEP: {
+                PSNode *src = va_arg(args, PSNode *);
+                Offset::type off = va_arg(args, Offset::type);
+                node = _create<PSNodeGep>(getNewNodeId(), src, off);
                 break;
-            case PSNodeType::MEMCPY:
-                node = new PSNodeMemcpy(getNewNodeId(),
-                                        va_arg(args, PSNode *),
-                                        va_arg(args, PSNode *),
-                                        va_arg(args, Offset::type));
+            }
+            case PSNodeType::MEMCPY: {
+                PSNode *src = va_arg(args, PSNode *);
+                PSNode *dest = va_arg(args, PSNode *);
+                Offset::type len = va_arg(args, Offset::type);
+                node = _create<PSNodeMemcpy>(getNewNodeId(), src, dest, len);
                 break;
-            case PSNodeType::CONSTANT:
-                node = new PSNode(getNewNodeId(), PSNodeType::CONSTANT,
-                                  va_arg(args, PSNode *),
-                                  va_arg(args, Offset::type));
+            }
+            case PSNodeType::CONSTANT: {
+                PSNode *target = va_arg(args, PSNode *);
+                Offset::type off = va_arg(args, Offset::type);
+                node = _create<PSNode>(getNewNodeId(), PSNodeType::CONSTANT,
+                                  target, off);
                 break;
+            }
             case PSNodeType::ENTRY:
-                node = new PSNodeEntry(getNewNodeId());
+                node = _create<PSNodeEntry>(getNewNodeId());
                 break;
             case PSNodeType::CALL:
-                node = new PSNodeCall(getNewNodeId());
+                node = _create<PSNodeCall>(getNewNodeId());
                 break;
             case PSNodeType::FORK:
-                node = new PSNodeFork(getNewNodeId());
+                node = _create<PSNodeFork>(getNewNodeId());
                 break;
             case PSNodeType::JOIN:
-                node = new PSNodeJoin(getNewNodeId());
+                node = _create<PSNodeJoin>(getNewNodeId());
                 break;
             default:
-                node = new PSNode(getNewNodeId(), t, args);
+                node = _create<PSNode>(getNewNodeId(), t, args);
                 break;
         }
         va_end(args);
 
         assert(node && "Didn't created node");
+        node->pointsTo.setRepresentation(ptSetRepresentation);
         nodes.emplace_back(node);
         return node;
     }
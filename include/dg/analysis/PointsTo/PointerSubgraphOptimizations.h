@@ -1,6 +1,11 @@
 #ifndef _DG_POINTER_SUBGRAPH_OPTIMIZATIONS_H_
 #define _DG_POINTER_SUBGRAPH_OPTIMIZATIONS_H_
 
+#include <map>
+#include <set>
+#include <vector>
+#include <tuple>
+
 #include "PointsToMapping.h"
 
 namespace dg {
@@ -150,7 +155,150 @@ public:
         return merged_nodes_num;
     }
 
+    ///
+    // Merge also the nodes that get the same value number
+    // by hash-based value numbering. The value numbers are
+    // computed such that nodes with the same number have the same
+    // points-to set in flow-insensitive analysis (e.g. two loads
+    // from the same pointer), so use this only with flow-insensitive
+    // analysis. Also, the graph must not change during the analysis
+    // (the builder must not add operands to the merged nodes).
+    unsigned runHVN() {
+        mergeCasts();
+        mergeByValueNumbers();
+        return merged_nodes_num;
+    }
+
 private:
+    // (type, operands' value numbers, offset, target of constant).
+    // The constants are identified by the target node, not by its ID,
+    // because null, unknown and invalidated memory have no IDs
+    using ValueKeyT = std::tuple<PSNodeType, std::vector<unsigned>,
+                                 Offset::type, PSNode *>;
+
+    // the value numbers of nodes indexed by the ID of nodes
+    std::vector<unsigned> value_numbers;
+    // nodes reachable from the root, the analysis does not
+    // process the others, so we must not merge into them
+    std::vector<bool> reachable;
+    unsigned last_value_number{0};
+
+    unsigned getValueNumber(PSNode *nd,
+                            std::map<ValueKeyT, unsigned>& numbers) {
+        auto& vn = value_numbers[nd->getID()];
+        assert(vn == 0 && "Already numbered");
+
+        std::vector<unsigned> ops;
+        ops.reserve(nd->getOperandsNum());
+        // the operand of a constant is its target,
+        // the constants are numbered by the target below
+        if (nd->getType() != PSNodeType::CONSTANT) {
+            for (PSNode *op : nd->getOperands()) {
+                // the operand is on a cycle with this node
+                // or it is outside of the graph (e.g. unknown memory)
+                if (op->getID() == 0 || value_numbers[op->getID()] == 0)
+                    return vn = ++last_value_number;
+                ops.push_back(value_numbers[op->getID()]);
+            }
+        }
+
+        if (!reachable[nd->getID()])
+            return vn = ++last_value_number;
+
+        Offset::type off = 0;
+        PSNode *target = nullptr;
+        switch (nd->getType()) {
+            case PSNodeType::CAST:
+                return vn = ops[0];
+            case PSNodeType::PHI:
+                if (ops.empty())
+                    // the operands may be added later
+                    return vn = ++last_value_number;
+                // phi is a set of operands
+                std::sort(ops.begin(), ops.end());
+                ops.erase(std::unique(ops.begin(), ops.end()), ops.end());
+                if (ops.size() == 1)
+                    return vn = ops[0];
+                break;
+            case PSNodeType::GEP:
+                off = *PSNodeGep::get(nd)->getOffset();
+                break;
+            case PSNodeType::CONSTANT:
+                // constants are identified by the pointer
+                assert(nd->pointsTo.size() == 1);
+                target = (*nd->pointsTo.begin()).target;
+                off = *(*nd->pointsTo.begin()).offset;
+                break;
+            case PSNodeType::LOAD:
+                break;
+            default:
+                // other nodes have unique value
+                return vn = ++last_value_number;
+        }
+
+        auto it = numbers.emplace(ValueKeyT(nd->getType(), std::move(ops),
+                                            off, target), 0).first;
+        if (it->second == 0)
+            it->second = ++last_value_number;
+        return vn = it->second;
+    }
+
+    // Hash-based value numbering. Go over the graph in the order
+    // of operands (an operand is numbered before its users) and
+    // give the same number to nodes that compute the same value
+    // from the same (numbered) operands. Nodes on cycles get
+    // unique numbers.
+    void mergeByValueNumbers() {
+        if (!PS->getRoot())
+            return;
+
+        reachable.assign(PS->size(), false);
+        for (PSNode *nd : PS->getNodes(PS->getRoot()))
+            reachable[nd->getID()] = true;
+
+        value_numbers.assign(PS->size(), 0);
+        std::map<ValueKeyT, unsigned> numbers;
+        // the representative for every value number
+        std::map<unsigned, PSNode *> representatives;
+        std::vector<PSNode *> order;
+        order.reserve(PS->size());
+
+        // post-order over operands (iterative, the chains may be long)
+        std::vector<bool> visited(PS->size(), false);
+        std::vector<std::pair<PSNode *, size_t>> stack;
+        for (const auto& nodeptr : PS->getNodes()) {
+            if (!nodeptr || visited[nodeptr->getID()])
+                continue;
+
+            visited[nodeptr->getID()] = true;
+            stack.emplace_back(nodeptr.get(), 0);
+            while (!stack.empty()) {
+                PSNode *cur = stack.back().first;
+                size_t& idx = stack.back().second;
+                if (idx < cur->getOperandsNum()) {
+                    PSNode *op = cur->getOperand(idx++);
+                    if (op->getID() != 0 && !visited[op->getID()]) {
+                        visited[op->getID()] = true;
+                        stack.emplace_back(op, 0);
+                    }
+                    continue;
+                }
+
+                stack.pop_back();
+                getValueNumber(cur, numbers);
+                order.push_back(cur);
+            }
+        }
+
+        for (PSNode *node : order) {
+            auto& repr = representatives[value_numbers[node->getID()]];
+            if (!repr)
+                repr = node;
+            else
+                merge(node, repr);
+        }
+    }
+
     // get rid of all casts
     void mergeCasts() {
         for (const auto& nodeptr : PS->getNodes()) {
@@ -180,6 +328,7 @@ private:
         // remove node1
         node1->replaceAllUsesWith(node2);
         node1->isolate();
+        node1->removeAllOperands();
         PS->remove(node1);
 
         // update the mapping
@@ -226,6 +375,15 @@ public:
         }
     }
 
+    // see PSEquivalentNodesMerger::runHVN()
+    void removeEquivalentValues() {
+        PSEquivalentNodesMerger merger(PS);
+        if (auto r = merger.runHVN()) {
+                mapping.merge(std::move(merger.getMapping()));
+                removed += r;
+        }
+    }
+
     unsigned run() {
         removeNoops();
         removeEquivalentNodes();
@@ -58,10 +58,11 @@ public:
 
     // compose this mapping with some other mapping:
     // (PSNode * -> PSNode *) o (ValT -> PSNode *)
-    // leads to (ValT -> PSNode *).
+    // leads to (ValT -> PSNode *). The node may have been merged
+    // into a node that was merged later too, so follow the chain.
     void compose(PointsToMapping<PSNode *>&& rhs) {
         for (auto& it : mapping) {
-            if (PSNode *rhs_node = rhs.get(it.second)) {
+            while (PSNode *rhs_node = rhs.get(it.second)) {
                 it.second = rhs_node;
             }
         }
@@ -2,10 +2,12 @@
 #define _DG_POINTS_TO_SET_H_
 
 #include "dg/analysis/PointsTo/Pointer.h"
+#include "dg/analysis/PointsTo/FlatPointsToSet.h"
 #include "dg/ADT/Bitvector.h"
 
 #include <map>
 #include <set>
+#include <new>
 #include <cassert>
 
 namespace dg {
@@ -15,7 +17,9 @@ namespace pta {
 // declare PSNode
 class PSNode;
 
-class PointsToSet {
+///
+// Points-to set that maps targets to bitvectors of offsets
+class BitvectorPointsToSet {
     // each pointer is a pair (PSNode *, {offsets}),
     // so we represent them coinciesly this way
     using ContainerT = std::map<PSNode *, ADT::SparseBitvector>;
@@ -39,8 +43,8 @@ class PointsToSet {
     }
 
 public:
-    PointsToSet() = default;
-    PointsToSet(std::initializer_list<Pointer> elems) { add(elems); }
+    BitvectorPointsToSet() = default;
+    BitvectorPointsToSet(std::initializer_list<Pointer> elems) { add(elems); }
 
     bool add(PSNode *target, Offset off) {
         if (off.isUnknown())
@@ -67,7 +71,7 @@ public:
     }
 
     // union (unite S into this set)
-    bool add(const PointsToSet& S) {
+    bool add(const BitvectorPointsToSet& S) {
         bool changed = false;
         for (auto& it : S.pointers) {
             changed |= pointers[it.first].set(it.second);
@@ -170,7 +174,7 @@ public:
         return num;
     }
 
-    void swap(PointsToSet& rhs) { pointers.swap(rhs.pointers); }
+    void swap(BitvectorPointsToSet& rhs) { pointers.swap(rhs.pointers); }
 
     class const_iterator {
         typename ContainerT::const_iterator container_it;
@@ -214,7 +218,7 @@ public:
             return !operator==(rhs);
         }
 
-        friend class PointsToSet;
+        friend class BitvectorPointsToSet;
     };
 
     const_iterator begin() const { return const_iterator(pointers); }
@@ -361,7 +365,316 @@ public:
     const_iterator end() const { return pointers.end(); }
 };
 
+///
+// The points-to set used by the analyses. It is a thin wrapper
+// that dispatches to one of the implementations above,
+// so that the representation can be chosen at runtime
+// (e.g., from the command line of the tools). The representation
+// can be given to the constructor, otherwise the default representation
+// is used (the analyses do not change the default, the PointerSubgraph
+// creates the sets of its nodes with the representation it was given).
+// Sets with different representations can be mixed together,
+// but such operations fall back to element-wise processing.
+class PointsToSet {
+public:
+    enum class Representation {
+        // map from targets to bitvectors of offsets
+        BITVECTOR,
+        // sorted array of pointers
+        FLAT
+    };
+
+private:
+    Representation repr;
+
+    // NOTE: the members have non-trivial ctors/dtors,
+    // they are managed manually by _init() and _destroy()
+    union ImplT {
+        BitvectorPointsToSet bv;
+        FlatPointsToSet flat;
+
+        ImplT() {}
+        ~ImplT() {}
+    } _impl;
+
+    static Representation& _defaultRepresentation() {
+        static Representation defaultRepr = Representation::BITVECTOR;
+        return defaultRepr;
+    }
+
+    bool isFlat() const { return repr == Representation::FLAT; }
+
+    void _init(Representation r) {
+        repr = r;
+        if (isFlat())
+            new (&_impl.flat) FlatPointsToSet();
+        else
+            new (&_impl.bv) BitvectorPointsToSet();
+    }
+
+    void _initCopy(const PointsToSet& rhs) {
+        repr = rhs.repr;
+        if (isFlat())
+            new (&_impl.flat) FlatPointsToSet(rhs._impl.flat);
+        else
+            new (&_impl.bv) BitvectorPointsToSet(rhs._impl.bv);
+    }
+
+    void _initMove(PointsToSet&& rhs) {
+        repr = rhs.repr;
+        if (isFlat())
+            new (&_impl.flat) FlatPointsToSet(std::move(rhs._impl.flat));
+        else
+            new (&_impl.bv) BitvectorPointsToSet(std::move(rhs._impl.bv));
+    }
+
+    void _destroy() {
+        if (isFlat())
+            _impl.flat.~FlatPointsToSet();
+        else
+            _impl.bv.~BitvectorPointsToSet();
+    }
+
+public:
+    static void setDefaultRepresentation(Representation r) {
+        _defaultRepresentation() = r;
+    }
+
+    static Representation getDefaultRepresentation() {
+        return _defaultRepresentation();
+    }
+
+    PointsToSet() { _init(getDefaultRepresentation()); }
+    PointsToSet(Representation r) { _init(r); }
+    PointsToSet(std::initializer_list<Pointer> elems) : PointsToSet() {
+        add(elems);
+    }
+
+    PointsToSet(const PointsToSet& rhs) { _initCopy(rhs); }
+    PointsToSet(PointsToSet&& rhs) { _initMove(std::move(rhs)); }
+
+    PointsToSet& operator=(const PointsToSet& rhs) {
+        if (this == &rhs)
+            return *this;
+
+        if (repr == rhs.repr) {
+            if (isFlat())
+                _impl.flat = rhs._impl.flat;
+            else
+                _impl.bv = rhs._impl.bv;
+        } else {
+            _destroy();
+            _initCopy(rhs);
+        }
+        return *this;
+    }
+
+    PointsToSet& operator=(PointsToSet&& rhs) {
+        if (this == &rhs)
+            return *this;
+
+        _destroy();
+        _initMove(std::move(rhs));
+        return *this;
+    }
+
+    ~PointsToSet() { _destroy(); }
+
+    Representation getRepresentation() const { return repr; }
+
+    // change the representation of the set, the elements are kept
+    void setRepresentation(Representation r) {
+        if (repr == r)
+            return;
+
+        PointsToSet tmp(r);
+        tmp.add(*this);
+        _destroy();
+        _initMove(std::move(tmp));
+    }
+
+    bool add(PSNode *target, Offset off) {
+        return isFlat() ? _impl.flat.add(target, off)
+                        : _impl.bv.add(target, off);
+    }
+
+    bool add(const Pointer& ptr) {
+        return add(ptr.target, ptr.offset);
+    }
+
+    // union (unite S into this set)
+    bool add(const PointsToSet& S) {
+        if (repr == S.repr) {
+            return isFlat() ? _impl.flat.add(S._impl.flat)
+                            : _impl.bv.add(S._impl.bv);
+        }
+
+        // different representations, this happens only
+        // for the sets that are not created with the representation
+        // of the graph (e.g. the sets of the special nodes),
+        // so it should be rare
+        bool changed = false;
+        for (const Pointer& ptr : S)
+            changed |= add(ptr);
+        return changed;
+    }
+
+    bool add(std::initializer_list<Pointer> elems) {
+        bool changed = false;
+        for (const auto& e : elems) {
+            changed |= add(e);
+        }
+        return changed;
+    }
+
+    bool remove(const Pointer& ptr) {
+        return remove(ptr.target, ptr.offset);
+    }
+
+    ///
+    // Remove pointer to this target with this offset.
+    // This is method really removes the pair
+    // (target, off) even when the off is unknown
+    bool remove(PSNode *target, Offset offset) {
+        return isFlat() ? _impl.flat.remove(target, offset)
+                        : _impl.bv.remove(target, offset);
+    }
+
+    ///
+    // Remove pointers pointing to this target
+    bool removeAny(PSNode *target) {
+        return isFlat() ? _impl.flat.removeAny(target)
+                        : _impl.bv.removeAny(target);
+    }
+
+    void clear() {
+        if (isFlat())
+            _impl.flat.clear();
+        else
+            _impl.bv.clear();
+    }
+
+    bool pointsTo(const Pointer& ptr) const {
+        return isFlat() ? _impl.flat.pointsTo(ptr) : _impl.bv.pointsTo(ptr);
+    }
+
+    // points to the pointer or the the same target
+    // with unknown offset? Note: we do not count
+    // unknown memory here...
+    bool mayPointTo(const Pointer& ptr) const {
+        return pointsTo(ptr) ||
+                pointsTo(Pointer(ptr.target, Offset::UNKNOWN));
+    }
+
+    bool mustPointTo(const Pointer& ptr) const {
+        assert(!ptr.offset.isUnknown() && "Makes no sense");
+        return pointsTo(ptr) && isSingleton();
+    }
+
+    bool pointsToTarget(PSNode *target) const {
+        return isFlat() ? _impl.flat.pointsToTarget(target)
+                        : _impl.bv.pointsToTarget(target);
+    }
+
+    bool isSingleton() const {
+        return isFlat() ? _impl.flat.isSingleton() : _impl.bv.isSingleton();
+    }
+
+    bool empty() const {
+        return isFlat() ? _impl.flat.empty() : _impl.bv.empty();
+    }
+
+    size_t count(const Pointer& ptr) const {
+        return isFlat() ? _impl.flat.count(ptr) : _impl.bv.count(ptr);
+    }
+
+    bool has(const Pointer& ptr) const {
+        return count(ptr) > 0;
+    }
+
+    bool hasUnknown() const { return pointsToTarget(UNKNOWN_MEMORY); }
+    bool hasNull() const { return pointsToTarget(NULLPTR); }
+    bool hasInvalidated() const { return pointsToTarget(INVALIDATED); }
+
+    size_t size() const {
+        return isFlat() ? _impl.flat.size() : _impl.bv.size();
+    }
+
+    void swap(PointsToSet& rhs) {
+        if (repr == rhs.repr) {
+            if (isFlat())
+                _impl.flat.swap(rhs._impl.flat);
+            else
+                _impl.bv.swap(rhs._impl.bv);
+        } else {
+            PointsToSet tmp(std::move(rhs));
+            rhs = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+
+    class const_iterator {
+        bool is_flat;
+
+        union ItT {
+            BitvectorPointsToSet::const_iterator bv_it;
+            FlatPointsToSet::const_iterator flat_it;
+            ItT() {}
+            ~ItT() {}
+        } _it;
+
+    public:
+        const_iterator(const PointsToSet& S, bool end = false)
+        : is_flat(S.isFlat()) {
+            if (is_flat)
+                new (&_it.flat_it) FlatPointsToSet::const_iterator(
+                        end ? S._impl.flat.end() : S._impl.flat.begin());
+            else
+                new (&_it.bv_it) BitvectorPointsToSet::const_iterator(
+                        end ? S._impl.bv.end() : S._impl.bv.begin());
+        }
+
+        // both iterators are trivially destructible,
+        // so we do not need to care about the destructors
+        const_iterator(const const_iterator&) = default;
+        const_iterator& operator=(const const_iterator&) = default;
+
+        const_iterator& operator++() {
+            if (is_flat)
+                ++_it.flat_it;
+            else
+                ++_it.bv_it;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        Pointer operator*() const {
+            return is_flat ? *_it.flat_it : *_it.bv_it;
+        }
+
+        bool operator==(const const_iterator& rhs) const {
+            if (is_flat != rhs.is_flat)
+                return false;
+
+            return is_flat ? _it.flat_it == rhs._it.flat_it
+                           : _it.bv_it == rhs._it.bv_it;
+        }
+
+        bool operator!=(const const_iterator& rhs) const {
+            return !operator==(rhs);
+        }
+    };
+
+    const_iterator begin() const { return const_iterator(*this); }
+    const_iterator end() const { return const_iterator(*this, true /* end */); }
 
+    friend class const_iterator;
+};
 
 using PointsToSetT = PointsToSet;
 using PointsToMapT = std::map<Offset, PointsToSetT>;
@@ -0,0 +1,60 @@
+#ifndef _DG_DEF_SITE_UNIVERSE_H_
+#define _DG_DEF_SITE_UNIVERSE_H_
+
+#include <cassert>
+#include <map>
+#include <vector>
+
+#include "dg/analysis/ReachingDefinitions/RDMap.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+///
+// Interning table of def-sites. Every distinct (target, offset, len)
+// gets a dense ID (in the order in which the def-sites are added),
+// so that sets of def-sites (or of anything indexed by def-sites)
+// can be kept in bitvectors instead of sets of DefSite objects.
+class DefSiteUniverse
+{
+    std::map<DefSite, unsigned> ids;
+    std::vector<DefSite> sites;
+
+public:
+    // get the ID of the def-site, create a new one if the def-site
+    // has not been seen yet
+    unsigned add(const DefSite& ds) {
+        auto it = ids.emplace(ds, sites.size());
+        if (it.second)
+            sites.push_back(ds);
+        return it.first->second;
+    }
+
+    // get the ID of the def-site or NONE if the def-site is not there
+    unsigned find(const DefSite& ds) const {
+        auto it = ids.find(ds);
+        return it == ids.end() ? NONE : it->second;
+    }
+
+    const DefSite& get(unsigned id) const {
+        assert(id < sites.size());
+        return sites[id];
+    }
+
+    const DefSite& operator[](unsigned id) const { return get(id); }
+
+    size_t size() const { return sites.size(); }
+    bool empty() const { return sites.empty(); }
+
+    std::vector<DefSite>::const_iterator begin() const { return sites.begin(); }
+    std::vector<DefSite>::const_iterator end() const { return sites.end(); }
+
+    enum : unsigned { NONE = ~0U };
+};
+
+} // namespace rd
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_DEF_SITE_UNIVERSE_H_
@@ -3,6 +3,7 @@
 
 #include "dg/analysis/Offset.h"
 #include <cassert>
+#include <iterator>
 #include <map>
 #include <set>
 
@@ -162,11 +163,11 @@ public:
     // that overlaps the interval I or end() if there is
     // no such interval
     iterator le(const IntervalT& I) {
-        return _shift_le(_find_ge(I), I);
+        return _shift_le(_mapping, _find_ge(I), I);
     }
 
     const_iterator le(const IntervalT& I) const {
-        return _shift_le(_find_ge(I), I);
+        return _shift_le(_mapping, _find_ge(I), I);
     }
 
     iterator le(const IntervalValueT start, const IntervalValueT end) {
@@ -199,25 +200,31 @@ private:
     // shift the iterator such that it will point to the
     // first element that overlaps with I, or to end
     // if there is no such interval
-    template <typename IteratorT>
-    IteratorT _shift_le(const IteratorT& startge, const IntervalT& I) const {
+    // (the mapping is a parameter so that this works both
+    // for iterators and const iterators)
+    template <typename MapT, typename IteratorT>
+    static IteratorT _shift_le(MapT& mapping, const IteratorT& startge,
+                               const IntervalT& I) {
         // find the element that starts at the same value
         // as I or later (i.e. I.start >= it.start)
-        if (startge == end()) {
-            auto last = _get_last();
+        if (startge == mapping.end()) {
+            if (mapping.empty())
+                return mapping.end();
+
+            auto last = std::prev(mapping.end());
             if (last->first.end >= I.start) {
                 assert(last->first.overlaps(I));
                 return last;
             }
 
-            return end();
+            return mapping.end();
         }
 
         assert(startge->first.start >= I.start);
 
         // check whether there's
         // an previous interval with an overlap
-        if (startge != begin()) {
+        if (startge != mapping.begin()) {
             auto tmp = startge;
             --tmp;
             if (tmp->first.end >= I.start) {
@@ -231,7 +238,7 @@ private:
         // previous interval does not overlap.
         // Just check whether this interval overlaps
         if (startge->first.start > I.end)
-            return end();
+            return mapping.end();
 
         assert(startge->first.overlaps(I));
         return startge;
@@ -0,0 +1,119 @@
+#ifndef _DG_RD_FUNCTION_SUMMARIES_H_
+#define _DG_RD_FUNCTION_SUMMARIES_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+///
+// Summaries of functions for the dense reaching definitions analysis.
+//
+// Instead of connecting a call-site to the root and the return node
+// of the called function (so that the definitions from all the contexts
+// in which the function is called flow to all call-sites),
+// the call-site gets a summary node that carries the summary of the function:
+// the definitions that reach the return node of the function when
+// nothing is defined at its entry (gen) and the def-sites that are
+// overwritten on every path through the function (kill).
+// Summaries are computed bottom-up over the SCCs of the call graph.
+// Inside recursive SCCs the summaries are iterated to a fixpoint
+// and have no kill sets.
+//
+// Once the summaries are computed, the call-sites are connected
+// to the roots of the called functions, so that the definitions
+// from the callers reach the nodes inside of the functions.
+// Nothing flows from the return nodes of the functions back to callers.
+class RDFunctionSummaries
+{
+public:
+    struct Summary {
+        RDMap gen;
+        DefSiteSetT kill;
+    };
+
+    class Function;
+
+    struct CallSite {
+        // the node that precedes the call (it is connected to the root
+        // of the called function when the summaries are computed)
+        RDNode *call;
+        // the node that carries the summary
+        RDNode *summaryNode;
+        Function *callee;
+    };
+
+    class Function {
+        RDNode *root;
+        RDNode *ret;
+        std::vector<CallSite> calls;
+        std::vector<Function *> callees;
+        // nodes of the function (without the called functions)
+        std::vector<RDNode *> nodes;
+        Summary summary;
+
+        friend class RDFunctionSummaries;
+
+    public:
+        // for computing SCCs
+        unsigned int dfs_id{0};
+        unsigned int lowpt{0};
+        unsigned int scc_id{0};
+        bool on_stack{false};
+
+        Function(RDNode *r, RDNode *rt) : root(r), ret(rt) {}
+
+        RDNode *getRoot() const { return root; }
+        RDNode *getRet() const { return ret; }
+        const Summary& getSummary() const { return summary; }
+        const std::vector<Function *>& getSuccessors() const { return callees; }
+    };
+
+    RDFunctionSummaries(const ReachingDefinitionsAnalysisOptions& opts)
+    : options(opts) {}
+
+    // register a function whose graph is between 'root' and 'ret'
+    Function *addFunction(RDNode *root, RDNode *ret) {
+        functions.emplace_back(new Function(root, ret));
+        return functions.back().get();
+    }
+
+    // register a call of 'callee' from 'caller'. The 'summaryNode'
+    // must be a successor of 'call' in the graph of the caller
+    void addCall(Function *caller, RDNode *call,
+                 RDNode *summaryNode, Function *callee) {
+        caller->calls.push_back(CallSite{call, summaryNode, callee});
+        caller->callees.push_back(callee);
+    }
+
+    // compute the summaries and connect the call-sites
+    // to the called functions
+    void compute();
+
+    size_t size() const { return functions.size(); }
+    // the number of runs of the analysis on a single function
+    size_t getAnalyzedFunctionsNum() const { return analyzed_num; }
+
+private:
+    const ReachingDefinitionsAnalysisOptions options;
+    std::vector<std::unique_ptr<Function>> functions;
+    size_t analyzed_num{0};
+
+    void _analyze(ReachingDefinitionsAnalysis& RDA, Function *F);
+    void _computeRecursive(ReachingDefinitionsAnalysis& RDA,
+                           const std::vector<Function *>& component);
+    void _computeNonRecursive(ReachingDefinitionsAnalysis& RDA, Function *F);
+    static void _apply(const CallSite& cs);
+    static void _resetNode(RDNode *n);
+};
+
+} // namespace rd
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_RD_FUNCTION_SUMMARIES_H_
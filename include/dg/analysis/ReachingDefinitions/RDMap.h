@@ -3,9 +3,12 @@
 
 #include <set>
 #include <map>
+#include <memory>
+#include <utility>
 #include <cassert>
 
 #include "dg/analysis/Offset.h"
+#include "dg/analysis/ReachingDefinitions/DisjunctiveIntervalMap.h"
 
 namespace dg {
 namespace analysis {
@@ -157,6 +160,10 @@ public:
         return nodes;
     };
 
+    const ContainerTy& getNodes() const {
+        return nodes;
+    };
+
 };
 
 using DefSiteSetT = std::set<DefSite>;
@@ -170,6 +177,9 @@ public:
     BasicRDMap(const BasicRDMap& o) {
         merge(&o);
     }
+    BasicRDMap(BasicRDMap&&) = default;
+    BasicRDMap& operator=(const BasicRDMap&) = default;
+    BasicRDMap& operator=(BasicRDMap&&) = default;
 
     bool merge(const BasicRDMap *o,
                DefSiteSetT *without = nullptr,
@@ -228,7 +238,271 @@ private:
     MapT _defs;
 };
 
-using RDMap = BasicRDMap;
+///
+// Reaching definitions map that keeps for every target a mapping
+// of disjunctive byte intervals to the definitions of these bytes
+// (DisjunctiveIntervalMap) and the set of definitions of the target
+// at unknown offset. Definitions are merged and strong updates
+// are performed per bytes, so the map does not need to compare
+// every pair of overlapping def-sites like BasicRDMap does.
+class IntervalRDMap
+{
+public:
+    using IntervalsT = DisjunctiveIntervalMap<RDNode *, uint64_t>;
+    using IntervalT = IntervalsT::IntervalT;
+    using ValuesT = IntervalsT::ValuesT;
+
+    // the last byte of definitions with unknown length
+    static const uint64_t MAX_END = ~static_cast<uint64_t>(0) - 1;
+
+    struct ObjectDefs {
+        IntervalsT intervals;
+        // definitions of the object at unknown offset
+        RDNodesSet unknown;
+
+        bool empty() const { return intervals.empty() && unknown.size() == 0; }
+    };
+
+    using MapT = std::map<RDNode *, ObjectDefs>;
+
+    bool merge(const IntervalRDMap *o,
+               DefSiteSetT *without = nullptr,
+               bool strong_update_unknown = true,
+               Offset::type max_set_size  = Offset::UNKNOWN,
+               bool merge_unknown     = false);
+
+    bool add(const DefSite&, RDNode *n);
+    bool update(const DefSite&, RDNode *n);
+    bool empty() const { return _defs.empty(); }
+
+    // gather reaching definitions of memory [n + off, n + off + len]
+    // and store them to the @ret
+    size_t get(RDNode *n, const Offset& off,
+               const Offset& len, std::set<RDNode *>& ret) const;
+    size_t get(const DefSite& ds, std::set<RDNode *>& ret) const;
+
+    // iterates over (def-site, definitions) pairs, the def-sites
+    // are created from the intervals on the fly
+    class const_iterator {
+        MapT::const_iterator obj, obj_end;
+        IntervalsT::const_iterator interval;
+        // are we at the definitions with unknown offset?
+        bool at_unknown{false};
+
+        void _skipEmpty() {
+            while (obj != obj_end) {
+                if (!at_unknown) {
+                    if (interval != obj->second.intervals.end())
+                        return;
+                    at_unknown = true;
+                }
+
+                if (obj->second.unknown.size() > 0)
+                    return;
+
+                _nextObject();
+            }
+        }
+
+        void _nextObject() {
+            ++obj;
+            at_unknown = false;
+            if (obj != obj_end)
+                interval = obj->second.intervals.begin();
+        }
+
+    public:
+        const_iterator() = default;
+        const_iterator(MapT::const_iterator b, MapT::const_iterator e)
+        : obj(b), obj_end(e) {
+            if (obj != obj_end)
+                interval = obj->second.intervals.begin();
+            _skipEmpty();
+        }
+
+        std::pair<DefSite, const ValuesT&> operator*() const {
+            if (at_unknown)
+                return {DefSite(obj->first), obj->second.unknown.getNodes()};
+
+            const IntervalT& I = interval->first;
+            Offset len = I.end == MAX_END ? Offset::UNKNOWN : I.end - I.start + 1;
+            return {DefSite(obj->first, I.start, len), interval->second};
+        }
+
+        const_iterator& operator++() {
+            if (at_unknown)
+                _nextObject();
+            else
+                ++interval;
+            _skipEmpty();
+            return *this;
+        }
+
+        const_iterator operator++(int) { auto tmp = *this; operator++(); return tmp; }
+
+        bool operator==(const const_iterator& oth) const {
+            if (obj != oth.obj)
+                return false;
+            if (obj == obj_end)
+                return true;
+            return at_unknown == oth.at_unknown &&
+                   (at_unknown || interval == oth.interval);
+        }
+
+        bool operator!=(const const_iterator& oth) const { return !operator==(oth); }
+    };
+
+    const_iterator begin() const { return const_iterator(_defs.begin(), _defs.end()); }
+    const_iterator end() const { return const_iterator(_defs.end(), _defs.end()); }
+
+    static IntervalT getInterval(const Offset& off, const Offset& len);
+
+private:
+    // add the values to the bytes of the interval I,
+    // return true if some byte got a new definition
+    static bool _addValues(RDNode *target, ObjectDefs& defs,
+                           const IntervalT& I, const ValuesT& vals,
+                           Offset::type max_set_size);
+
+    MapT _defs;
+};
+
+///
+// The map of reaching definitions that nodes keep. The definitions
+// are stored in BasicRDMap unless useIntervals() is called, then
+// they are moved to IntervalRDMap (see
+// ReachingDefinitionsAnalysisOptions::intervalMaps).
+class RDMap
+{
+    BasicRDMap _basic;
+    std::unique_ptr<IntervalRDMap> _intervals;
+
+    static void _fill(IntervalRDMap& to, const BasicRDMap& from) {
+        for (const auto& it : from) {
+            for (RDNode *n : it.second)
+                to.add(it.first, n);
+        }
+    }
+
+public:
+    RDMap() = default;
+    RDMap(const RDMap& o)
+    : _basic(o._basic),
+      _intervals(o._intervals ? new IntervalRDMap(*o._intervals) : nullptr) {}
+    RDMap(RDMap&&) = default;
+
+    RDMap& operator=(const RDMap& o) {
+        if (this != &o) {
+            _basic = o._basic;
+            _intervals.reset(o._intervals ? new IntervalRDMap(*o._intervals) : nullptr);
+        }
+        return *this;
+    }
+
+    RDMap& operator=(RDMap&&) = default;
+
+    // move the definitions to an interval map
+    void useIntervals() {
+        if (_intervals)
+            return;
+
+        _intervals.reset(new IntervalRDMap());
+        _fill(*_intervals, _basic);
+        _basic = BasicRDMap();
+    }
+
+    bool usesIntervals() const { return _intervals != nullptr; }
+
+    bool merge(const RDMap *o,
+               DefSiteSetT *without = nullptr,
+               bool strong_update_unknown = true,
+               Offset::type max_set_size  = Offset::UNKNOWN,
+               bool merge_unknown     = false) {
+        if (o->_intervals && !_intervals)
+            useIntervals();
+
+        if (!_intervals)
+            return _basic.merge(&o->_basic, without, strong_update_unknown,
+                                max_set_size, merge_unknown);
+
+        if (o->_intervals)
+            return _intervals->merge(o->_intervals.get(), without,
+                                     strong_update_unknown,
+                                     max_set_size, merge_unknown);
+
+        IntervalRDMap tmp;
+        _fill(tmp, o->_basic);
+        return _intervals->merge(&tmp, without, strong_update_unknown,
+                                 max_set_size, merge_unknown);
+    }
+
+    bool add(const DefSite& ds, RDNode *n) {
+        return _intervals ? _intervals->add(ds, n) : _basic.add(ds, n);
+    }
+
+    bool update(const DefSite& ds, RDNode *n) {
+        return _intervals ? _intervals->update(ds, n) : _basic.update(ds, n);
+    }
+
+    bool empty() const {
+        return _intervals ? _intervals->empty() : _basic.empty();
+    }
+
+    size_t get(RDNode *n, const Offset& off,
+               const Offset& len, std::set<RDNode *>& ret) {
+        return _intervals ? _intervals->get(n, off, len, ret)
+                          : _basic.get(n, off, len, ret);
+    }
+
+    size_t get(DefSite& ds, std::set<RDNode *>& ret) {
+        return _intervals ? _intervals->get(ds, ret) : _basic.get(ds, ret);
+    }
+
+    // iterates over (def-site, set of definitions) pairs
+    // of either of the maps
+    class const_iterator {
+        BasicRDMap::const_map_iterator basic;
+        IntervalRDMap::const_iterator intervals;
+        bool is_intervals;
+
+    public:
+        const_iterator(BasicRDMap::const_map_iterator b,
+                       IntervalRDMap::const_iterator i, bool isi)
+        : basic(b), intervals(i), is_intervals(isi) {}
+
+        std::pair<DefSite, const std::set<RDNode *>&> operator*() const {
+            if (is_intervals)
+                return *intervals;
+
+            const auto& it = *basic;
+            return {it.first, it.second.getNodes()};
+        }
+
+        const_iterator& operator++() {
+            if (is_intervals)
+                ++intervals;
+            else
+                ++basic;
+            return *this;
+        }
+
+        bool operator==(const const_iterator& oth) const {
+            return is_intervals ? intervals == oth.intervals : basic == oth.basic;
+        }
+
+        bool operator!=(const const_iterator& oth) const { return !operator==(oth); }
+    };
+
+    const_iterator begin() const {
+        return _intervals ? const_iterator(_basic.end(), _intervals->begin(), true)
+                          : const_iterator(_basic.begin(), {}, false);
+    }
+
+    const_iterator end() const {
+        return _intervals ? const_iterator(_basic.end(), _intervals->end(), true)
+                          : const_iterator(_basic.end(), {}, false);
+    }
+};
 
 } // rd
 } // analysis
@@ -1,6 +1,7 @@
 #ifndef _DG_REACHING_DEFINITIONS_ANALYSIS_H_
 #define _DG_REACHING_DEFINITIONS_ANALYSIS_H_
 
+#include <algorithm>
 #include <vector>
 #include <set>
 #include <cassert>
@@ -32,6 +33,7 @@ namespace srg {
 
 class RDNode;
 class ReachingDefinitionsAnalysis;
+class RDFunctionSummaries;
 
 // here the types are for type-checking (optional - user can do it
 // when building the graph) and for later optimizations
@@ -69,10 +71,13 @@ class RDNode : public SubgraphNode<RDNode> {
     BBlock<RDNode> *bblock = nullptr;
     // marks for DFS/BFS
     unsigned int dfsid;
+    // the position of the node in the reverse postorder
+    // (the priority of the node in the worklist of the analysis)
+    unsigned int rpoid;
 public:
 
     RDNode(RDNodeType t = RDNodeType::NONE)
-    : SubgraphNode<RDNode>(0), type(t), dfsid(0) {}
+    : SubgraphNode<RDNode>(0), type(t), dfsid(0), rpoid(0) {}
 
 #ifndef NDEBUG
     virtual ~RDNode() = default;
@@ -245,6 +250,7 @@ public:
     }
 
     friend class ReachingDefinitionsAnalysis;
+    friend class RDFunctionSummaries;
     friend class dg::analysis::rd::srg::AssignmentFinder;
 };
 
@@ -269,6 +275,14 @@ protected:
 
     const ReachingDefinitionsAnalysisOptions options;
 
+    // statistics
+    size_t processed_num{0};
+    size_t merges_num{0};
+
+    // solve the analysis on the nodes (in RPO) using bitvectors
+    // of definitions (see BitvectorRD.cpp)
+    void solveBitvectors(const std::vector<RDNode *>& nodes);
+
 public:
     ReachingDefinitionsAnalysis(ReachingDefinitionsGraph&& graph,
                                 const ReachingDefinitionsAnalysisOptions& opts)
@@ -315,10 +329,49 @@ public:
         return cont;
     }
 
+    // get nodes reachable from the node in reverse postorder
+    // (predecessors go before successors except for back edges)
+    std::vector<RDNode *> getNodesRPO(RDNode *start)
+    {
+        ++dfsnum;
+
+        std::vector<RDNode *> cont;
+        // (node, index of the next successor to visit)
+        std::vector<std::pair<RDNode *, size_t>> stack;
+
+        start->dfsid = dfsnum;
+        stack.emplace_back(start, 0);
+        while (!stack.empty()) {
+            auto& top = stack.back();
+            RDNode *cur = top.first;
+            if (top.second < cur->getSuccessors().size()) {
+                RDNode *succ = cur->getSuccessors()[top.second++];
+                if (succ->dfsid != dfsnum) {
+                    succ->dfsid = dfsnum;
+                    // invalidates 'top'
+                    stack.emplace_back(succ, 0);
+                }
+            } else {
+                cont.push_back(cur);
+                stack.pop_back();
+            }
+        }
+
+        std::reverse(cont.begin(), cont.end());
+        return cont;
+    }
+
     RDNode *getRoot() const { return graph.getRoot(); }
 
     bool processNode(RDNode *n);
     virtual void run();
+    // compute the fixpoint only on the nodes reachable from 'start'
+    void solve(RDNode *start);
+
+    // the number of nodes taken from the worklist
+    size_t getProcessedNodesNum() const { return processed_num; }
+    // the number of merges of the maps of predecessors
+    size_t getMergesNum() const { return merges_num; }
 };
 
 } // namespace rd
@@ -73,6 +73,8 @@ struct FunctionModel {
         return it == _defines.end() ? nullptr : &it->second;
     }
 
+    const std::map<unsigned, Defines>& getDefines() const { return _defines; }
+
 private:
     std::map<unsigned, Defines> _defines;
 };
@@ -96,6 +98,16 @@ struct ReachingDefinitionsAnalysisOptions : AnalysisOptions {
     // or just objects?
     bool fieldInsensitive{false};
 
+    // Keep the definitions in maps of byte intervals (IntervalRDMap)
+    // instead of maps of def-sites (BasicRDMap)?
+    bool intervalMaps{false};
+
+    // Solve the dense analysis with bitvectors of definitions
+    // (def-site, node) instead of merging the maps. Strong updates
+    // are performed per def-site as with BasicRDMap and the sets
+    // are not cropped to maxSetSize. The bitvectors replace the maps,
+    // so intervalMaps has no effect if this option is set.
+    bool bitvectors{false};
 
     ReachingDefinitionsAnalysisOptions& setStrongUpdateUnknown(bool b) {
         strongUpdateUnknown = b; return *this;
@@ -117,6 +129,14 @@ struct ReachingDefinitionsAnalysisOptions : AnalysisOptions {
         fieldInsensitive = b; return *this;
     }
 
+    ReachingDefinitionsAnalysisOptions& setIntervalMaps(bool b) {
+        intervalMaps = b; return *this;
+    }
+
+    ReachingDefinitionsAnalysisOptions& setBitvectors(bool b) {
+        bitvectors = b; return *this;
+    }
+
     std::map<const std::string, FunctionModel> functionModels;
 
     const FunctionModel *getFunctionModel(const std::string& name) const {
@@ -1,13 +1,17 @@
 #ifndef _DG_SLICING_H_
 #define _DG_SLICING_H_
 
+#include <algorithm>
+#include <functional>
 #include <set>
+#include <vector>
 
 #include "dg/analysis/legacy/Analysis.h"
 #include "dg/analysis/legacy/NodesWalk.h"
 #include "dg/analysis/legacy/BFS.h"
 #include "dg/ADT/Queue.h"
 #include "dg/DependenceGraph.h"
+#include "dg/FrozenDependenceGraph.h"
 
 #ifdef ENABLE_CFG
 #include "dg/BBlock.h"
@@ -54,11 +58,17 @@ public:
     // returns marked blocks, but only for forward slicing atm
     const std::set<BBlock<NodeT> *>& getMarkedBlocks() { return markedBlocks; }
 
+    using GraphReachedFunT = std::function<void(DependenceGraph<NodeT> *)>;
 
+    // 'fun' is called with the graph of every marked node
+    // before the edges of the node are walked, so that the edges
+    // can be computed on demand
+    void setGraphReached(GraphReachedFunT fun) { graph_reached = std::move(fun); }
 
 private:
     bool forward_slice{false};
     std::set<BBlock<NodeT> *> markedBlocks;
+    GraphReachedFunT graph_reached{};
 
 
     struct WalkData
@@ -96,6 +106,9 @@ private:
         // the same with dependence graph, if we keep a node from
         // a dependence graph, we need to keep the dependence graph
         if (DependenceGraph<NodeT> *dg = n->getDG()) {
+            if (data->analysis->graph_reached)
+                data->analysis->graph_reached(dg);
+
             dg->setSlice(slice_id);
             if (!data->analysis->isForward()) {
                 // and keep also all call-sites of this func (they are
@@ -110,6 +123,241 @@ private:
     }
 };
 
+///
+// Backward slicing on a frozen dependence graph. Marks the same nodes,
+// blocks and graphs as WalkAndMark does in the backward direction,
+// but it walks the compressed edges and keeps the visited nodes
+// in a bitset. The walker can be used for many slicing criteria,
+// the bitsets are reused.
+template <typename NodeT>
+class FrozenWalkAndMark
+{
+    using GraphT = FrozenDependenceGraph<NodeT>;
+    using IndexT = typename GraphT::IndexT;
+
+    const GraphT& graph;
+    std::vector<uint64_t> visited;
+    std::vector<uint64_t> visited_graphs;
+    std::vector<IndexT> stack;
+
+    static bool _testAndSet(std::vector<uint64_t>& bits, IndexT i) {
+        uint64_t mask = uint64_t(1) << (i % 64);
+        uint64_t& word = bits[i / 64];
+        if (word & mask)
+            return false;
+        word |= mask;
+        return true;
+    }
+
+    void _push(IndexT i) {
+        if (_testAndSet(visited, i))
+            stack.push_back(i);
+    }
+
+    void _markNode(IndexT i, uint32_t slice_id) {
+        NodeT *n = graph.getNode(i);
+        n->setSlice(slice_id);
+
+#ifdef ENABLE_CFG
+        if (BBlock<NodeT> *B = n->getBBlock())
+            B->setSlice(slice_id);
+#endif
+
+        // keep the graph of the node and its entry node
+        // (call-sites are control dependent on the entry node)
+        IndexT g = graph.getGraphIndex(i);
+        if (g == GraphT::NO_INDEX || !_testAndSet(visited_graphs, g))
+            return;
+
+        graph.getGraph(g)->setSlice(slice_id);
+        IndexT entry = graph.getGraphEntry(g);
+        assert(entry != GraphT::NO_INDEX && "No entry node in dg");
+        _push(entry);
+    }
+
+public:
+    FrozenWalkAndMark(const GraphT& g) : graph(g) {}
+
+    ///
+    // Mark the nodes that the nodes 'start' depend on with 'slice_id'.
+    // Returns the number of marked nodes.
+    size_t mark(const std::set<NodeT *>& start, uint32_t slice_id) {
+        visited.assign((graph.size() + 63) / 64, 0);
+        visited_graphs.assign((graph.graphsNum() + 63) / 64, 0);
+
+        for (NodeT *n : start) {
+            IndexT i = graph.getIndex(n);
+            assert(i != GraphT::NO_INDEX && "Node is not in the frozen graph");
+            _push(i);
+        }
+
+        size_t marked = 0;
+        while (!stack.empty()) {
+            IndexT i = stack.back();
+            stack.pop_back();
+
+            _markNode(i, slice_id);
+            ++marked;
+
+            for (auto I = graph.edges_begin(i), E = graph.edges_end(i); I != E; ++I)
+                _push(*I);
+        }
+
+        return marked;
+    }
+
+    size_t mark(NodeT *start, uint32_t slice_id) {
+        return mark(std::set<NodeT *>{start}, slice_id);
+    }
+};
+
+///
+// Backward slicing of many slicing criteria at once on a frozen
+// dependence graph. Every node gets a bitmask with a bit for every
+// criterion and the bits are propagated along the edges together,
+// so the graph is walked once instead of once per criterion.
+// The node 'n' is in the slice of the criterion 'c' iff the bit 'c'
+// of its mask is set. The slices are the same as the ones computed
+// by FrozenWalkAndMark for each criterion separately.
+template <typename NodeT>
+class FrozenBatchWalkAndMark
+{
+    using GraphT = FrozenDependenceGraph<NodeT>;
+    using IndexT = typename GraphT::IndexT;
+
+    const GraphT& graph;
+    // the number of words of the mask of one node
+    size_t words{0};
+    size_t criteria_num{0};
+    // masks of the nodes and the bits that were not propagated yet
+    std::vector<uint64_t> masks;
+    std::vector<uint64_t> pending;
+    std::vector<IndexT> stack;
+    std::vector<bool> queued;
+
+    uint64_t *_mask(std::vector<uint64_t>& v, IndexT i) {
+        return v.data() + i * words;
+    }
+
+    // add the bits 'bits' to the node 'i', returns true if
+    // some of the bits were not set yet
+    bool _add(IndexT i, const uint64_t *bits) {
+        uint64_t *M = _mask(masks, i);
+        uint64_t *P = _mask(pending, i);
+        bool changed = false;
+        for (size_t w = 0; w < words; ++w) {
+            uint64_t n = bits[w] & ~M[w];
+            if (n) {
+                M[w] |= n;
+                P[w] |= n;
+                changed = true;
+            }
+        }
+
+        if (changed && !queued[i]) {
+            queued[i] = true;
+            stack.push_back(i);
+        }
+
+        return changed;
+    }
+
+public:
+    FrozenBatchWalkAndMark(const GraphT& g) : graph(g) {}
+
+    ///
+    // Compute the slices of all criteria, the criterion
+    // 'criteria[c]' gets the bit 'c'.
+    void mark(const std::vector<std::set<NodeT *>>& criteria) {
+        criteria_num = criteria.size();
+        words = (criteria_num + 63) / 64;
+        masks.assign(graph.size() * words, 0);
+        pending.assign(graph.size() * words, 0);
+        queued.assign(graph.size(), false);
+
+        std::vector<uint64_t> bit(words);
+        for (size_t c = 0; c < criteria.size(); ++c) {
+            std::fill(bit.begin(), bit.end(), 0);
+            bit[c / 64] = uint64_t(1) << (c % 64);
+            for (NodeT *n : criteria[c]) {
+                IndexT i = graph.getIndex(n);
+                assert(i != GraphT::NO_INDEX && "Node is not in the frozen graph");
+                _add(i, bit.data());
+            }
+        }
+
+        std::vector<uint64_t> bits(words);
+        while (!stack.empty()) {
+            IndexT i = stack.back();
+            stack.pop_back();
+            queued[i] = false;
+
+            uint64_t *P = _mask(pending, i);
+            std::copy(P, P + words, bits.begin());
+            std::fill(P, P + words, 0);
+
+            for (auto I = graph.edges_begin(i), E = graph.edges_end(i); I != E; ++I)
+                _add(*I, bits.data());
+
+            // keep the entry of the graph of the node
+            // (call-sites are control dependent on the entry node)
+            IndexT g = graph.getGraphIndex(i);
+            if (g != GraphT::NO_INDEX) {
+                IndexT entry = graph.getGraphEntry(g);
+                assert(entry != GraphT::NO_INDEX && "No entry node in dg");
+                _add(entry, bits.data());
+            }
+        }
+    }
+
+    size_t criteriaNum() const { return criteria_num; }
+
+    bool inSlice(IndexT i, size_t c) const {
+        assert(c < criteria_num);
+        return masks[i * words + c / 64] & (uint64_t(1) << (c % 64));
+    }
+
+    bool inSlice(const NodeT *n, size_t c) const {
+        IndexT i = graph.getIndex(n);
+        return i != GraphT::NO_INDEX && inSlice(i, c);
+    }
+
+    // get the nodes in the slice of the criterion 'c'
+    std::vector<NodeT *> getSlice(size_t c) const {
+        std::vector<NodeT *> nodes;
+        for (IndexT i = 0; i < graph.size(); ++i) {
+            if (inSlice(i, c))
+                nodes.push_back(graph.getNode(i));
+        }
+        return nodes;
+    }
+
+    ///
+    // Mark the nodes (and their blocks and graphs) from the slice
+    // of the criterion 'c' with 'slice_id', so that the graph can be
+    // sliced w.r.t this criterion. Returns the number of marked nodes.
+    size_t apply(size_t c, uint32_t slice_id) const {
+        size_t marked = 0;
+        for (IndexT i = 0; i < graph.size(); ++i) {
+            if (!inSlice(i, c))
+                continue;
+
+            NodeT *n = graph.getNode(i);
+            n->setSlice(slice_id);
+#ifdef ENABLE_CFG
+            if (BBlock<NodeT> *B = n->getBBlock())
+                B->setSlice(slice_id);
+#endif
+            IndexT g = graph.getGraphIndex(i);
+            if (g != GraphT::NO_INDEX)
+                graph.getGraph(g)->setSlice(slice_id);
+            ++marked;
+        }
+
+        return marked;
+    }
+};
+
 struct SlicerStatistics
 {
     SlicerStatistics()
@@ -132,6 +380,8 @@ class Slicer : legacy::Analysis<NodeT>
 
     std::set<DependenceGraph<NodeT> *> sliced_graphs;
 
+    typename WalkAndMark<NodeT>::GraphReachedFunT graph_reached{};
+
     // slice nodes from the graph; do it recursively for call-nodes
     void sliceNodes(DependenceGraph<NodeT> *dg, uint32_t slice_id)
     {
@@ -182,6 +432,11 @@ public:
     SlicerStatistics& getStatistics() { return statistics; }
     const SlicerStatistics& getStatistics() const { return statistics; }
 
+    // see WalkAndMark::setGraphReached()
+    void setGraphReached(typename WalkAndMark<NodeT>::GraphReachedFunT fun) {
+        graph_reached = std::move(fun);
+    }
+
     ///
     // Mark nodes dependent on 'start' with 'sl_id'.
     // If 'forward_slice' is true, mark the nodes depending on 'start' instead.
@@ -191,6 +446,7 @@ public:
             sl_id = ++slice_id;
 
         WalkAndMark<NodeT> wm(forward_slice);
+        wm.setGraphReached(graph_reached);
 
         uint32_t opt = legacy::NODES_WALK_REV_CD |
                        legacy::NODES_WALK_REV_DD |
@@ -220,6 +476,7 @@ public:
 
             if (!branchings.empty()) {
                 WalkAndMark<NodeT> wm2;
+                wm2.setGraphReached(graph_reached);
                 wm2.mark(branchings, sl_id);
             }
         }
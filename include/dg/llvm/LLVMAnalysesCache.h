@@ -0,0 +1,85 @@
+#ifndef _DG_LLVM_ANALYSES_CACHE_H_
+#define _DG_LLVM_ANALYSES_CACHE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "dg/llvm/analysis/PointsTo/LLVMPointerAnalysisOptions.h"
+#include "dg/llvm/analysis/ReachingDefinitions/LLVMReachingDefinitionsAnalysisOptions.h"
+
+namespace llvm {
+    class Module;
+}
+
+namespace dg {
+
+class LLVMPointerAnalysis;
+
+namespace analysis {
+namespace rd {
+    class LLVMReachingDefinitions;
+}}
+
+namespace llvmdg {
+
+/// ------------------------------------------------------------------
+// - LLVMAnalysesCache
+//
+//   On-disk cache of the results of pointer analysis and reaching
+//   definitions. The files are keyed by the hash of the module
+//   and of the options of the analyses, so a file is used only
+//   for a byte-identical module analyzed with the same options.
+//
+//   The graphs of the analyses are always built (that is cheap),
+//   only the solving is replaced by filling in the points-to sets
+//   and the maps of reaching definitions. The nodes of pointer analysis
+//   are identified by their IDs, these are stable for the same module.
+//   The nodes of reaching definitions are identified by the index of
+//   the value that they were created for in the module (and the order
+//   among the nodes of the value), so that they do not depend on
+//   the order in which the graph was built (e.g., in parallel).
+//   The types of the nodes are stored to check that.
+//   The calls via function pointers that the pointer analysis inserted
+//   into the graph are stored too and inserted again before filling
+//   in the points-to sets.
+//
+//   Only the dense reaching definitions and the analyses without
+//   threads are cached.
+/// ------------------------------------------------------------------
+class LLVMAnalysesCache {
+    const llvm::Module *_module;
+    std::string _ptaFile;
+    std::string _rdFile;
+    uint64_t _moduleHash{0};
+    uint64_t _ptaOptionsHash{0};
+    uint64_t _rdOptionsHash{0};
+    bool _intervalMaps{false};
+
+public:
+    // bump this when the format of the files changes
+    static const uint32_t VERSION = 2;
+
+    LLVMAnalysesCache(const std::string& dir, const llvm::Module *M,
+                      const analysis::LLVMPointerAnalysisOptions& ptaOpts,
+                      const analysis::LLVMReachingDefinitionsAnalysisOptions& rdOpts);
+
+    // Build the graph of pointer analysis and fill in the points-to sets
+    // from the cache. Returns false if the results are not in the cache
+    // (the graph is not built in that case).
+    bool loadPTA(LLVMPointerAnalysis& PTA, bool invalidateNodes) const;
+    bool storePTA(const LLVMPointerAnalysis& PTA) const;
+
+    // Fill in the maps of reaching definitions from the cache.
+    // The graph must be built by LLVMReachingDefinitions::initialize()
+    // and is not changed if the results are not in the cache.
+    bool loadRD(analysis::rd::LLVMReachingDefinitions& RD) const;
+    bool storeRD(analysis::rd::LLVMReachingDefinitions& RD) const;
+
+    const std::string& getPTAFile() const { return _ptaFile; }
+    const std::string& getRDFile() const { return _rdFile; }
+};
+
+} // namespace llvmdg
+} // namespace dg
+
+#endif // _DG_LLVM_ANALYSES_CACHE_H_
@@ -9,6 +9,7 @@
 #error "Need CFG enabled"
 #endif
 
+#include <cstdint>
 #include <map>
 #include <unordered_map>
 
@@ -50,6 +51,19 @@ using analysis::rd::LLVMReachingDefinitions;
 
 using LLVMBBlock = dg::BBlock<LLVMNode>;
 
+struct InterferenceStatistics
+{
+    // number of pairs (load, store) from regions
+    // that may happen in parallel
+    uint64_t pairsTotal{0};
+    // number of pairs whose points-to sets were compared,
+    // i.e., the store may write to some object that the load reads
+    uint64_t pairsChecked{0};
+    // number of pairs skipped because the load and the store
+    // access disjoint memory objects
+    uint64_t pairsPruned{0};
+};
+
 /// ------------------------------------------------------------------
 //  -- LLVMDependenceGraph
 /// ------------------------------------------------------------------
@@ -132,15 +146,19 @@ public:
     void addNoreturnDependencies(LLVMNode *noret, LLVMBBlock *from);
     void addNoreturnDependencies();
 
-    void computeControlDependencies(CD_ALG alg_type, bool terminSensitive = true)
+    void computeControlDependencies(CD_ALG alg_type, bool terminSensitive = true);
+
+    // compute control dependencies only in this graph
+    // (not in the graphs of the called functions)
+    void computeFunctionControlDependencies(CD_ALG alg_type, bool terminSensitive = true)
     {
         if (alg_type == CD_ALG::CLASSIC) {
-            computePostDominators(true);
+            computeFunctionPostDominators(true);
             //makeSelfLoopsControlDependent();
             if (terminSensitive)
-                addNoreturnDependencies();
+                addFunctionNoreturnDependencies();
         } else if (alg_type == CD_ALG::CONTROL_EXPRESSION) {
-            computeControlExpression(true);
+            computeFunctionControlExpression(true);
         } else
             abort();
     }
@@ -166,14 +184,21 @@ public:
 
     LLVMNode *findNode(llvm::Value *value) const;
     void computeInterferenceDependentEdges(ControlFlowGraph * controlFlowGraph);
+    const InterferenceStatistics& getInterferenceStatistics() const {
+        return interferenceStatistics;
+    }
     void computeForkJoinDependencies(ControlFlowGraph * controlFlowGraph);
     void computeCriticalSections(ControlFlowGraph * controlFlowGraph);
 private:
     void computePostDominators(bool addPostDomFrontiers = false);
     void computeControlExpression(bool addCDs = false);
+    // the same as above, but only for this graph
+    void computeFunctionPostDominators(bool addPostDomFrontiers = false);
+    void computeFunctionControlExpression(bool addCDs = false);
+    void addFunctionNoreturnDependencies();
 
-    void computeInterferenceDependentEdges(const std::set<const llvm::Instruction *> &loads,
-                                           const std::set<const llvm::Instruction *> &stores);
+    void addInterferenceDependence(const llvm::Instruction *load,
+                                   const llvm::Instruction *store);
 
     std::set<const llvm::Instruction *> getLoadInstructions(const std::set<const llvm::Instruction *> &llvmInstructions) const;
     std::set<const llvm::Instruction *> getStoreInstructions(const std::set<const llvm::Instruction *> &llvmInstructions) const;
@@ -219,6 +244,8 @@ private:
     // control expression for this graph
     ControlExpression CE;
 
+    InterferenceStatistics interferenceStatistics;
+
     // verifier needs access to private elements
     friend class LLVMDGVerifier;
 };
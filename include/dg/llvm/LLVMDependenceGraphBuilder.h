@@ -1,6 +1,7 @@
 #ifndef _DG_LLVM_DEPENDENCE_GRAPH_BUILDER_H_
 #define _DG_LLVM_DEPENDENCE_GRAPH_BUILDER_H_
 
+#include <set>
 #include <string>
 
 // ignore unused parameters in LLVM libraries
@@ -21,6 +22,7 @@
 #endif
 
 #include "dg/llvm/LLVMDependenceGraph.h"
+#include "dg/llvm/LLVMAnalysesCache.h"
 #include "dg/llvm/analysis/DefUse/LLVMDefUseAnalysisOptions.h"
 #include "dg/llvm/analysis/PointsTo/LLVMPointerAnalysisOptions.h"
 #include "dg/llvm/analysis/ReachingDefinitions/LLVMReachingDefinitionsAnalysisOptions.h"
@@ -33,6 +35,7 @@
 #include "dg/analysis/PointsTo/PointerAnalysisFI.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFS.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFSInv.h"
+#include "dg/analysis/PointsTo/PointerAnalysisSFS.h"
 #include "dg/analysis/PointsTo/Pointer.h"
 #include "dg/analysis/Offset.h"
 
@@ -64,6 +67,15 @@ struct LLVMDependenceGraphOptions {
 
     std::string entryFunction{"main"};
 
+    // the directory with the cached results of pointer analysis
+    // and reaching definitions (no caching if empty), see LLVMAnalysesCache
+    std::string cacheDir{};
+
+    // compute the def-use edges and control dependencies of a function
+    // only when its graph is materialized (see
+    // LLVMDependenceGraphBuilder::materialize()), not used with threads
+    bool lazyDependencies{false};
+
     void addAllocationFunction(const std::string& name,
                                analysis::AllocationFunction F) {
         PTAOptions.addAllocationFunction(name, F);
@@ -80,16 +92,37 @@ class LLVMDependenceGraphBuilder {
     std::unique_ptr<LLVMDependenceGraph> _dg{};
     std::unique_ptr<ControlFlowGraph> _controlFlowGraph{};
     llvm::Function *_entryFunction{nullptr};
+    std::unique_ptr<LLVMAnalysesCache> _cache{};
+    // def-use analysis and the graphs with computed
+    // dependencies when the dependencies are lazy
+    std::unique_ptr<LLVMDefUseAnalysis> _DUA{};
+    std::set<LLVMDependenceGraph *> _materialized{};
+
+    template <typename PTType>
+    void _runPointerAnalysis() {
+        if (!_cache) {
+            _PTA->run<PTType>();
+            return;
+        }
+
+        if (_cache->loadPTA(*_PTA, _options.PTAOptions.isFSInv()))
+            return;
+
+        _PTA->run<PTType>();
+        _cache->storePTA(*_PTA);
+    }
 
     void _runPointerAnalysis() {
         assert(_PTA && "BUG: No PTA");
 
         if (_options.PTAOptions.isFS())
-            _PTA->run<analysis::pta::PointerAnalysisFS>();
+            _runPointerAnalysis<analysis::pta::PointerAnalysisFS>();
         else if (_options.PTAOptions.isFI())
-            _PTA->run<analysis::pta::PointerAnalysisFI>();
+            _runPointerAnalysis<analysis::pta::PointerAnalysisFI>();
         else if (_options.PTAOptions.isFSInv())
-            _PTA->run<analysis::pta::PointerAnalysisFSInv>();
+            _runPointerAnalysis<analysis::pta::PointerAnalysisFSInv>();
+        else if (_options.PTAOptions.isSFS())
+            _runPointerAnalysis<analysis::pta::PointerAnalysisSFS>();
         else {
             assert(0 && "Wrong pointer analysis");
             abort();
@@ -100,7 +133,15 @@ class LLVMDependenceGraphBuilder {
         assert(_RD && "BUG: No RD");
 
         if (_options.RDAOptions.isDense()) {
-            _RD->run<dg::analysis::rd::ReachingDefinitionsAnalysis>();
+            if (_cache) {
+                _RD->initialize<dg::analysis::rd::ReachingDefinitionsAnalysis>();
+                if (!_cache->loadRD(*_RD)) {
+                    _RD->solve();
+                    _cache->storeRD(*_RD);
+                }
+            } else {
+                _RD->run<dg::analysis::rd::ReachingDefinitionsAnalysis>();
+            }
         } else if (_options.RDAOptions.isSparse()) {
             _RD->run<dg::analysis::rd::SemisparseRda>();
         } else {
@@ -122,6 +163,23 @@ class LLVMDependenceGraphBuilder {
                                         _options.terminationSensitive);
     }
 
+    void _runDependenceAnalyses() {
+        if (isLazy()) {
+            // the edges are added in materialize()
+            _DUA.reset(new LLVMDefUseAnalysis(_dg.get(),
+                                              _RD.get(),
+                                              _PTA.get(),
+                                              _options.DUOptions));
+            return;
+        }
+
+        // insert the data dependencies edges
+        _runDefUseAnalysis();
+
+        // compute and fill-in control dependencies
+        _runControlDependenceAnalysis();
+    }
+
     void _runInterferenceDependenceAnalysis() {
         _dg->computeInterferenceDependentEdges(_controlFlowGraph.get());
     }
@@ -152,6 +210,14 @@ public:
       _controlFlowGraph(new ControlFlowGraph(_PTA.get())),
       _entryFunction(M->getFunction(_options.entryFunction)) {
         assert(_entryFunction && "The entry function not found");
+
+        // the forks and joins found by pointer analysis are not cached
+        if (!_options.cacheDir.empty() &&
+            !_options.threads && !_options.PTAOptions.threads) {
+            _cache.reset(new LLVMAnalysesCache(_options.cacheDir, M,
+                                               _options.PTAOptions,
+                                               _options.RDAOptions));
+        }
     }
 
     LLVMPointerAnalysis *getPTA() { return _PTA.get(); }
@@ -170,11 +236,8 @@ public:
         // build the graph itself
         _dg->build(_M, _PTA.get(), _RD.get(), _entryFunction);
 
-        // insert the data dependencies edges
-        _runDefUseAnalysis();
-
-        // compute and fill-in control dependencies
-        _runControlDependenceAnalysis();
+        // insert the data and control dependencies edges
+        _runDependenceAnalyses();
 
         if (_options.threads) {
             _controlFlowGraph->buildFunction(_entryFunction);
@@ -232,12 +295,9 @@ public:
         // get the ownership
         _dg = std::move(dg);
 
-        // data-dependence edges
+        // data-dependence and control dependence edges
         _runReachingDefinitionsAnalysis();
-        _runDefUseAnalysis();
-
-        // fill-in control dependencies
-        _runControlDependenceAnalysis();
+        _runDependenceAnalyses();
 
         if (_options.threads) {
             _runInterferenceDependenceAnalysis();
@@ -248,6 +308,36 @@ public:
         return std::move(_dg);
     }
 
+    bool isLazy() const {
+        return _options.lazyDependencies && !_options.threads;
+    }
+
+    // Compute the def-use edges and control dependencies of the nodes
+    // of the given graph (of one function) if they are computed lazily
+    // and were not computed yet. The edges that lead to the nodes
+    // of the graph are added, so after materializing a graph,
+    // backward slicing can walk from any of its nodes.
+    // Returns true if the edges were computed now.
+    bool materialize(LLVMDependenceGraph *graph) {
+        assert(_DUA && "The dependencies are not computed lazily");
+
+        if (!_materialized.insert(graph).second)
+            return false;
+
+        _DUA->runOnGraph(graph);
+        graph->computeFunctionControlDependencies(_options.cdAlgorithm,
+                                                  _options.terminationSensitive);
+        return true;
+    }
+
+    // materialize the graphs of all functions
+    void materializeAll() {
+        for (auto& F : getConstructedFunctions())
+            materialize(F.second);
+    }
+
+    // the number of graphs whose dependencies were computed by materialize()
+    size_t getMaterializedFunctionsNum() const { return _materialized.size(); }
 };
 
 } // namespace llvmdg
@@ -56,6 +56,10 @@ public:
 
     /* virtual */
     bool runOnNode(LLVMNode *node, LLVMNode *prev);
+
+    // add def-use edges only to the nodes of the given graph
+    // (run() adds them to the nodes of all the graphs)
+    void runOnGraph(LLVMDependenceGraph *graph);
 private:
     void addDataDependence(LLVMNode *node,
                            analysis::pta::PSNode *pts,
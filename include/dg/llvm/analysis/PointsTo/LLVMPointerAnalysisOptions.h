@@ -9,12 +9,13 @@ namespace analysis {
 
 struct LLVMPointerAnalysisOptions : public LLVMAnalysisOptions, PointerAnalysisOptions
 {
-    enum class AnalysisType { fi, fs, inv } analysisType{AnalysisType::fi};
+    enum class AnalysisType { fi, fs, inv, sfs } analysisType{AnalysisType::fi};
 
-    bool threads;
+    bool threads{false};
     bool isFS() const { return analysisType == AnalysisType::fs; }
     bool isFSInv() const { return analysisType == AnalysisType::inv; }
     bool isFI() const { return analysisType == AnalysisType::fi; }
+    bool isSFS() const { return analysisType == AnalysisType::sfs; }
 };
 
 } // namespace analysis
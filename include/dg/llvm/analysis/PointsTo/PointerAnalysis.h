@@ -24,6 +24,7 @@
 #include "dg/analysis/PointsTo/PointerAnalysis.h"
 #include "dg/analysis/PointsTo/PointerSubgraphOptimizations.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFSInv.h"
+#include "dg/analysis/PointsTo/DemandPointerAnalysis.h"
 #include "dg/analysis/PointsTo/Pointer.h"
 
 #include "dg/llvm/analysis/PointsTo/LLVMPointerAnalysisOptions.h"
@@ -41,58 +42,79 @@ using analysis::pta::PSNodesSeq;
 using analysis::pta::Pointer;
 using analysis::Offset;
 
+///
+// Build the subgraph of the function called via pointer
+// and insert the call into the graph. Returns true if the graph changed.
+// The inserted calls are stored into 'insertedCalls' (if not null)
+// as pairs (ID of the call-site, ID of the called function).
+inline bool
+insertFunctionPointerCall(LLVMPointerSubgraphBuilder *builder,
+                          PSNode *callsite, PSNode *called,
+                          std::vector<std::pair<unsigned, unsigned>> *insertedCalls)
+{
+    using namespace analysis::pta;
+    const llvm::Function *F
+        = llvm::dyn_cast<llvm::Function>(called->getUserData<llvm::Value>());
+    // with vararg it may happen that we get pointer that
+    // is not to function, so just bail out here in that case
+    if (!F)
+        return false;
+
+    if (F->isDeclaration()) {
+        if (builder->threads()) {
+            if (F->getName() == "pthread_create") {
+                builder->insertPthreadCreateByPtrCall(callsite);
+                return true;
+            } else if (F->getName() == "pthread_join") {
+                builder->insertPthreadJoinByPtrCall(callsite);
+                return true;
+            }
+        }
+        return callsite->getPairedNode()->addPointsTo(analysis::pta::UnknownPointer);
+    }
+
+    if (!LLVMPointerSubgraphBuilder::callIsCompatible(callsite, called)) {
+        return false;
+    } else {
+        builder->insertFunctionCall(callsite, called);
+        if (insertedCalls)
+            insertedCalls->emplace_back(callsite->getID(), called->getID());
+    }
+
+
+#ifndef NDEBUG
+    // check the graph after rebuilding, but do not check for connectivity,
+    // because we can call a function that will disconnect the graph
+    if (!builder->validateSubgraph(true)) {
+        llvm::errs() << "Pointer Subgraph is broken!\n";
+        llvm::errs() << "This happend after building this function called via pointer: "
+                     <<  F->getName() << "\n";
+        abort();
+    }
+#endif // NDEBUG
+
+    return true; // we changed the graph
+}
+
 template <typename PTType>
 class LLVMPointerAnalysisImpl : public PTType
 {
     LLVMPointerSubgraphBuilder *builder;
+    // the calls via function pointers inserted into the graph
+    // as pairs (ID of the call-site, ID of the called function)
+    std::vector<std::pair<unsigned, unsigned>> *insertedCalls;
 
 public:
-    LLVMPointerAnalysisImpl(PointerSubgraph *PS, LLVMPointerSubgraphBuilder *b)
-    : PTType(PS), builder(b) {}
+    LLVMPointerAnalysisImpl(PointerSubgraph *PS,
+                            LLVMPointerSubgraphBuilder *b,
+                            const LLVMPointerAnalysisOptions& opts,
+                            std::vector<std::pair<unsigned, unsigned>> *calls = nullptr)
+    : PTType(PS, opts), builder(b), insertedCalls(calls) {}
 
     // build new subgraphs on calls via pointer
     bool functionPointerCall(PSNode *callsite, PSNode *called) override
     {
-        using namespace analysis::pta;
-        const llvm::Function *F
-            = llvm::dyn_cast<llvm::Function>(called->getUserData<llvm::Value>());
-        // with vararg it may happen that we get pointer that
-        // is not to function, so just bail out here in that case
-        if (!F)
-            return false;
-
-        if (F->isDeclaration()) {
-            if (builder->threads()) {
-                if (F->getName() == "pthread_create") {
-                    builder->insertPthreadCreateByPtrCall(callsite);
-                    return true;
-                } else if (F->getName() == "pthread_join") {
-                    builder->insertPthreadJoinByPtrCall(callsite);
-                    return true;
-                }
-            }
-            return callsite->getPairedNode()->addPointsTo(analysis::pta::UnknownPointer);
-        }
-
-        if (!LLVMPointerSubgraphBuilder::callIsCompatible(callsite, called)) {
-            return false;
-        } else {
-            builder->insertFunctionCall(callsite, called);
-        }
-
-
-#ifndef NDEBUG
-        // check the graph after rebuilding, but do not check for connectivity,
-        // because we can call a function that will disconnect the graph
-        if (!builder->validateSubgraph(true)) {
-            llvm::errs() << "Pointer Subgraph is broken!\n";
-            llvm::errs() << "This happend after building this function called via pointer: "
-                         <<  F->getName() << "\n";
-            abort();
-        }
-#endif // NDEBUG
-
-        return true; // we changed the graph
+        return insertFunctionPointerCall(builder, callsite, called, insertedCalls);
     }
 
     bool handleFork(PSNode *forkNode) override
@@ -118,10 +140,48 @@ public:
     }
 };
 
+///
+// Demand-driven pointer analysis on the LLVM pointer subgraph.
+// The computed points-to sets are filled into the nodes of the graph
+// when resolving the nodes, so that the nodes can be used the same way
+// as after running the whole analysis.
+class LLVMDemandPointerAnalysis : public analysis::pta::DemandPointerAnalysis
+{
+    LLVMPointerSubgraphBuilder *builder;
+    std::vector<std::pair<unsigned, unsigned>> *insertedCalls;
+    std::unordered_set<PSNode *> filled;
+
+public:
+    LLVMDemandPointerAnalysis(PointerSubgraph *PS,
+                              LLVMPointerSubgraphBuilder *b,
+                              const LLVMPointerAnalysisOptions& opts,
+                              std::vector<std::pair<unsigned, unsigned>> *calls = nullptr)
+    : DemandPointerAnalysis(PS, opts), builder(b), insertedCalls(calls) {}
+
+    bool functionPointerCall(PSNode *callsite, PSNode *called) override
+    {
+        return insertFunctionPointerCall(builder, callsite, called, insertedCalls);
+    }
+
+    // compute the points-to set of the node and fill it into the node
+    PSNode *resolve(PSNode *node) {
+        if (filled.insert(node).second)
+            node->pointsTo = query(node);
+        return node;
+    }
+};
+
 class LLVMPointerAnalysis
 {
+    const llvm::Module *_module;
     PointerSubgraph *PS = nullptr;
     std::unique_ptr<LLVMPointerSubgraphBuilder> _builder;
+    const LLVMPointerAnalysisOptions _options;
+    // calls via function pointers that were inserted into the graph
+    // during the analysis, see getFunctionPointerCalls()
+    std::vector<std::pair<unsigned, unsigned>> _functionPointerCalls;
+    // answers the queries if the graph is solved on demand, see runOnDemand()
+    std::unique_ptr<LLVMDemandPointerAnalysis> _demand;
 
     LLVMPointerAnalysisOptions createOptions(const char *entry_func,
                                              uint64_t field_sensitivity,
@@ -149,13 +209,17 @@ public:
         : LLVMPointerAnalysis(m, createOptions(entry_func, field_sensitivity, threads)) {}
 
     LLVMPointerAnalysis(const llvm::Module *m, const LLVMPointerAnalysisOptions opts)
-        : _builder(new LLVMPointerSubgraphBuilder(m, opts)) {}
+        : _module(m), _builder(new LLVMPointerSubgraphBuilder(m, opts)), _options(opts) {}
 
     ///
     // Get the node from pointer analysis that holds the points-to set.
+    // If the analysis runs on demand, the points-to set is computed now.
     // See: getLLVMPointsTo()
     PSNode *getPointsTo(const llvm::Value *val) const {
-        return _builder->getPointsTo(val);
+        PSNode *node = _builder->getPointsTo(val);
+        if (node && _demand)
+            return _demand->resolve(node);
+        return node;
     }
 
     ///
@@ -189,6 +253,8 @@ public:
     getPointsToFunctions(const llvm::Value *calledValue) const
     {
         std::vector<const llvm::Function *> functions;
+        // fill in the points-to set if the analysis runs on demand
+        getPointsTo(calledValue);
         for (auto node : _builder->getPointsToFunctions(calledValue)) {
             functions.push_back(node->getUserData<llvm::Function>());
         }
@@ -211,7 +277,7 @@ public:
         return _builder->getNodesMap();
     }
 
-    const std::vector<std::unique_ptr<PSNode>>& getNodes()
+    const PointerSubgraph::NodesT& getNodes()
     {
         return PS->getNodes();
     }
@@ -234,6 +300,14 @@ public:
             abort();
         }
 
+        if (_options.valueNumbering && _options.isFI()) {
+            analysis::pta::PointerSubgraphOptimizer optimizer(PS);
+            optimizer.removeEquivalentValues();
+
+            if (optimizer.getNumOfRemovedNodes() > 0)
+                _builder->composeMapping(std::move(optimizer.getMapping()));
+        }
+
 /*
         analysis::pta::PointerSubgraphOptimizer optimizer(PS);
         optimizer.run();
@@ -257,12 +331,90 @@ public:
 
     }
 
+    ///
+    // Build the graph and insert the given calls via function pointers
+    // (in the given order) without running the analysis. The graph is then
+    // the same as the graph after running the analysis that inserted
+    // these calls, so the points-to sets from that run can be filled in.
+    // Returns false if some of the calls does not match the graph.
+    bool rebuildSubgraph(const std::vector<std::pair<unsigned, unsigned>>& calls,
+                         bool invalidateNodes = false)
+    {
+        assert(_builder && "Incorrectly constructed PTA, missing builder");
+        _builder->setInvalidateNodesFlag(invalidateNodes);
+        buildSubgraph();
+
+        for (const auto& call : calls) {
+            const auto& nodes = PS->getNodes();
+            if (call.first >= nodes.size() || call.second >= nodes.size() ||
+                !nodes[call.first] || !nodes[call.second])
+                return false;
+
+            PSNode *callsite = nodes[call.first].get();
+            PSNode *called = nodes[call.second].get();
+            if (!LLVMPointerSubgraphBuilder::callIsCompatible(callsite, called))
+                return false;
+
+            _builder->insertFunctionCall(callsite, called);
+            _functionPointerCalls.push_back(call);
+        }
+
+        return true;
+    }
+
+    ///
+    // Throw away the graph (e.g., the graph from rebuildSubgraph()
+    // whose points-to sets could not be filled in), so that the next
+    // run() starts with a fresh graph without the inserted calls
+    void resetSubgraph()
+    {
+        assert(!_demand && "The graph is used by the analysis on demand");
+        _builder.reset(new LLVMPointerSubgraphBuilder(_module, _options));
+        PS = nullptr;
+        _functionPointerCalls.clear();
+    }
+
+    ///
+    // The calls via function pointers that were inserted into the graph
+    // during the analysis as pairs (ID of the call-site, ID of the function)
+    const std::vector<std::pair<unsigned, unsigned>>& getFunctionPointerCalls() const {
+        return _functionPointerCalls;
+    }
+
     template <typename PTType>
     void run()
     {
         buildSubgraph();
+        solve<PTType>();
+    }
 
-        LLVMPointerAnalysisImpl<PTType> PTA(PS, _builder.get());
+    ///
+    // Build the graph, but do not run the analysis. The points-to sets
+    // are computed only for the values given to getPointsTo() (and to the
+    // methods that use it), see DemandPointerAnalysis. The points-to
+    // sets of the other nodes of the graph are not computed.
+    // Threads are not supported.
+    void runOnDemand()
+    {
+        assert(!_options.threads && "Threads are not supported on demand");
+        buildSubgraph();
+        _demand.reset(new LLVMDemandPointerAnalysis(PS, _builder.get(), _options,
+                                                    &_functionPointerCalls));
+    }
+
+    bool isOnDemand() const { return _demand != nullptr; }
+
+    const analysis::pta::DemandPointerAnalysisStatistics *getDemandStatistics() const {
+        return _demand ? &_demand->getStatistics() : nullptr;
+    }
+
+    // run the analysis on the already built graph
+    template <typename PTType>
+    void solve()
+    {
+        assert(PS && "The graph is not built");
+        LLVMPointerAnalysisImpl<PTType> PTA(PS, _builder.get(), _options,
+                                            &_functionPointerCalls);
         PTA.run();
     }
 
@@ -274,7 +426,7 @@ public:
     analysis::pta::PointerAnalysis *createPTA()
     {
         buildSubgraph();
-        return new LLVMPointerAnalysisImpl<PTType>(PS, _builder.get());
+        return new LLVMPointerAnalysisImpl<PTType>(PS, _builder.get(), _options);
     }
 };
 
@@ -285,9 +437,7 @@ inline void LLVMPointerAnalysis::run<analysis::pta::PointerAnalysisFSInv>()
     assert(_builder && "Incorrectly constructed PTA, missing builder");
     _builder->setInvalidateNodesFlag(true);
     buildSubgraph();
-
-    LLVMPointerAnalysisImpl<analysis::pta::PointerAnalysisFSInv> PTA(PS, _builder.get());
-    PTA.run();
+    solve<analysis::pta::PointerAnalysisFSInv>();
 }
 
 template <>
@@ -298,7 +448,7 @@ inline analysis::pta::PointerAnalysis *LLVMPointerAnalysis::createPTA<analysis::
     _builder->setInvalidateNodesFlag(true);
     buildSubgraph();
 
-    return new LLVMPointerAnalysisImpl<analysis::pta::PointerAnalysisFSInv>(PS, _builder.get());
+    return new LLVMPointerAnalysisImpl<analysis::pta::PointerAnalysisFSInv>(PS, _builder.get(), _options);
 }
 
 } // namespace dg
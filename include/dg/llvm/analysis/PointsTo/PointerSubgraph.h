@@ -122,7 +122,9 @@ public:
     inline bool threads() { return threads_; }
 
     LLVMPointerSubgraphBuilder(const llvm::Module *m, const LLVMPointerAnalysisOptions& opts)
-        : M(m), DL(new llvm::DataLayout(m)), _options(opts), threads_(opts.threads) {}
+        : M(m), DL(new llvm::DataLayout(m)), _options(opts), threads_(opts.threads) {
+        PS.setPointsToSetRepresentation(opts.ptSetRepresentation);
+    }
 
     ~LLVMPointerSubgraphBuilder();
 
@@ -188,7 +190,27 @@ public:
         this->invalidate_nodes = value;
     }
 
+    // some nodes of the graph were merged into other nodes
+    // (see PointerSubgraphOptimizer), use the remaining nodes
+    // also when building new parts of the graph
     void composeMapping(PointsToMapping<PSNode *>&& rhs) {
+        auto get = [&rhs](PSNode *n) {
+            while (PSNode *r = rhs.get(n))
+                n = r;
+            return n;
+        };
+
+        for (auto& it : nodes_map) {
+            it.second.first = get(it.second.first);
+            it.second.second = get(it.second.second);
+        }
+        for (auto& it : built_blocks) {
+            it.second.first = get(it.second.first);
+            it.second.second = get(it.second.second);
+        }
+        for (auto& it : subgraphs_map)
+            it.second.vararg = get(it.second.vararg);
+
         mapping.compose(std::move(rhs));
     }
 
@@ -14,6 +14,13 @@ struct LLVMReachingDefinitionsAnalysisOptions :
     enum class AnalysisType { dense, ss } analysisType{AnalysisType::dense};
 
     bool threads;
+    // compute summaries of functions and apply them at call-sites
+    // instead of returning from functions to all the call-sites
+    // (dense analysis without threads only, see RDFunctionSummaries)
+    bool functionSummaries{false};
+    // the number of threads that build the graphs of functions
+    // (dense analysis without threads only, 1 = build sequentially)
+    unsigned buildThreads{1};
     bool isDense() const { return analysisType == AnalysisType::dense; }
     bool isSparse() const { return analysisType == AnalysisType::ss; }
 };
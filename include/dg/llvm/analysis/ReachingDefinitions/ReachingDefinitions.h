@@ -1,9 +1,12 @@
 #ifndef _LLVM_DG_RD_H_
 #define _LLVM_DG_RD_H_
 
+#include <chrono>
+#include <string>
 #include <unordered_map>
 #include <memory>
 #include <type_traits>
+#include <vector>
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -38,11 +41,18 @@ class LLVMRDBuilder;
 
 class LLVMReachingDefinitions
 {
+public:
+    // times of the phases of the analysis (building the graph and solving)
+    using PhaseTimesT = std::vector<std::pair<std::string,
+                                              std::chrono::steady_clock::duration>>;
+
+private:
     LLVMRDBuilder *builder{nullptr};
     std::unique_ptr<ReachingDefinitionsAnalysis> RDA;
     const llvm::Module *m;
     dg::LLVMPointerAnalysis *pta;
     const LLVMReachingDefinitionsAnalysisOptions _options;
+    PhaseTimesT phase_times;
 
     void initializeSparseRDA();
     void initializeDenseRDA();
@@ -62,6 +72,14 @@ public:
      */
     template <typename RdaType>
     void run()
+    {
+        initialize<RdaType>();
+        solve();
+    }
+
+    // build the graph of the analysis, but do not run the analysis
+    template <typename RdaType>
+    void initialize()
     {
         // this helps while guessing causes of template substitution errors
         static_assert(std::is_base_of<ReachingDefinitionsAnalysis, RdaType>::value,
@@ -76,11 +94,22 @@ public:
         assert(builder);
         assert(RDA);
         assert(getRoot());
+    }
+
+    // run the analysis on the graph built by initialize()
+    void solve()
+    {
+        assert(RDA && "The graph is not built");
 
+        auto start = std::chrono::steady_clock::now();
         RDA->run();
+        phase_times.emplace_back("solve", std::chrono::steady_clock::now() - start);
     }
 
+    const PhaseTimesT& getPhaseTimes() const { return phase_times; }
+
     RDNode *getRoot() { return RDA->getRoot(); }
+    const ReachingDefinitionsAnalysis *getRDA() const { return RDA.get(); }
     RDNode *getNode(const llvm::Value *val);
 
     // let the user get the nodes map, so that we can
@@ -91,6 +120,11 @@ public:
     RDNode *getMapping(const llvm::Value *val);
     const RDNode *getMapping(const llvm::Value *val) const;
 
+    // the values that the nodes were created for (a value may have
+    // more nodes, these are in the order of creation), only the dense
+    // analysis keeps these
+    const std::vector<std::pair<const llvm::Value *, RDNode *>>& getNodeValues() const;
+
     std::vector<RDNode *> getNodes() {
         assert(RDA);
         // FIXME: this is insane, we should have this method defined here
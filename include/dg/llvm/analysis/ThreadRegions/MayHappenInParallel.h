@@ -1,18 +1,66 @@
 #ifndef MAYHAPPENINPARALLEL_H
 #define MAYHAPPENINPARALLEL_H
 
+#include <cstdint>
+#include <map>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "ThreadRegion.h"
 
+/**
+ * @brief The may-happen-in-parallel relation of thread regions.
+ *
+ * The regions get dense indices (in the order of their ids) and the relation
+ * is precomputed into a regions x regions bitmatrix, so that queries
+ * do not walk the regions and sets of regions can be intersected with the rows.
+ */
 class MayHappenInParallel
 {
+public:
+    // a set of regions (bits indexed by the indices of the regions)
+    using RowT = std::vector<uint64_t>;
+
+    static const unsigned NONE = ~0U;
+
 private:
-    std::set<ThreadRegion *> threadRegions_;
+    std::vector<ThreadRegion *> regions_;
+    std::map<const ThreadRegion *, unsigned> indices_;
+    // indices of the regions that contain the instruction
+    std::unordered_map<const llvm::Instruction *, std::vector<unsigned>> instructionRegions_;
+
+    // the relation stored by rows of rowWords_ words
+    size_t rowWords_{0};
+    RowT matrix_;
+
+    void setParallel(unsigned i, unsigned j);
+
 public:
     MayHappenInParallel(std::set<ThreadRegion *> threadRegions);
 
+    size_t regionsNum() const;
+    size_t rowWords() const;
+
+    ThreadRegion * region(unsigned index) const;
+    unsigned regionIndex(const ThreadRegion * threadRegion) const;
+    const std::vector<unsigned> & regionIndices(const llvm::Instruction * instruction) const;
+
+    bool mayHappenInParallel(unsigned i, unsigned j) const;
+    bool mayHappenInParallel(const llvm::Instruction * a, const llvm::Instruction * b) const;
+
+    /**
+     * @brief returns an empty set of regions that can be passed to parallelRegions()
+     */
+    RowT emptyRow() const;
+    void addToRow(RowT & row, unsigned index) const;
+
     std::set<ThreadRegion *> parallelRegions(ThreadRegion * threadRegion);
+    /**
+     * @brief returns indices of the regions from the set 'regions'
+     * that may happen in parallel with the region with the given index
+     */
+    std::vector<unsigned> parallelRegions(unsigned index, const RowT & regions) const;
 };
 
 #endif // MAYHAPPENINPARALLEL_H
@@ -1,7 +1,9 @@
 #ifndef _DG_LLVM_EQUALITY_MAP_H_
 #define _DG_LLVM_EQUALITY_MAP_H_
 
+#include <map>
 #include <memory>
+#include <set>
 #include <cassert>
 
 #ifndef NDEBUG
@@ -25,7 +27,31 @@ class EqualityMap {
 
     using SetT = std::set<T, _Cmp>;
     using ClassT = std::shared_ptr<SetT>;
-    std::map<T, ClassT, _Cmp> _map;
+    using MapT = std::map<T, ClassT, _Cmp>;
+
+    // The map is shared by the copies of EqualityMap until one of them
+    // is modified (copy-on-write), so that the locations on straight-line
+    // code do not keep their own copies of the same equalities.
+    std::shared_ptr<MapT> _map{std::make_shared<MapT>()};
+
+    // get the map for modification (make a private copy if it is shared)
+    MapT& _mutableMap() {
+        if (_map.use_count() > 1) {
+            // the classes are shared between the values in the map,
+            // so we must copy every class only once
+            auto copy = std::make_shared<MapT>();
+            std::map<const SetT *, ClassT> classes;
+            for (const auto& it : *_map) {
+                auto& cls = classes[it.second.get()];
+                if (!cls)
+                    cls = ClassT(new SetT(*it.second));
+                copy->emplace_hint(copy->end(), it.first, cls);
+            }
+            _map = std::move(copy);
+        }
+
+        return *_map;
+    }
 
     // FIXME: use variadic templates
     ClassT newClass(const T& a, const T& b) {
@@ -43,30 +69,36 @@ class EqualityMap {
 
 public:
     bool add(const T& a, const T& b) {
-        auto itA = _map.find(a);
-        auto itB = _map.find(b);
-        if (itA == _map.end()) {
-            if (itB == _map.end()) {
+        // do not copy the shared map if we already have the equality
+        auto cls = get(a);
+        if (cls && cls == get(b))
+            return false;
+
+        auto& map = _mutableMap();
+        auto itA = map.find(a);
+        auto itB = map.find(b);
+        if (itA == map.end()) {
+            if (itB == map.end()) {
                 if (a == b) {
                     auto newcls = newClass(a);
-                    _map[a] = newcls;
+                    map[a] = newcls;
                     assert(newcls.use_count() == 2);
                 } else {
                     auto newcls = newClass(a, b);
-                    _map[b] = newcls;
-                    _map[a] = newcls;
+                    map[b] = newcls;
+                    map[a] = newcls;
                     assert(newcls.use_count() == 3);
                 }
             } else {
                 auto B = itB->second;
                 B->insert(a);
-                _map[a] = B;
+                map[a] = B;
             }
         } else {
             auto A = itA->second;
-            if (itB == _map.end()) {
+            if (itB == map.end()) {
                 A->insert(b);
-                _map[b] = A;
+                map[b] = A;
             } else {
                 // merge of classes
                 auto B = itB->second;
@@ -75,15 +107,15 @@ public:
 
                 for (auto& val : *B.get()) {
                     A->insert(val);
-                    _map[val] = A;
+                    map[val] = A;
                 }
                 assert(B.use_count() == 1);
                 A->insert(b);
-                assert(_map[b] == A);
+                assert(map[b] == A);
             }
         }
 
-        assert(!_map.empty());
+        assert(!map.empty());
         assert(get(a) != nullptr);
         assert(get(a) == get(b));
         assert(get(a)->count(a) > 0);
@@ -92,9 +124,19 @@ public:
     }
 
     bool add(const EqualityMap& rhs) {
+        if (_map == rhs._map)
+            return false;
+        // just share the map of rhs if we have nothing
+        if (_map->empty()) {
+            if (rhs._map->empty())
+                return false;
+            _map = rhs._map;
+            return true;
+        }
+
         bool changed = false;
         // FIXME: not very efficient
-        for (auto& it : rhs._map) {
+        for (auto& it : *rhs._map) {
             for (auto& eq : *it.second.get()) {
                 changed |= add(it.first, eq);
             }
@@ -112,17 +154,11 @@ public:
         return changed;
     }
 
-    SetT *get(const T& a) {
-        auto it = _map.find(a);
-        if (it == _map.end()) {
-            return nullptr;
-        }
-        return it->second.get();
-    }
-
+    // NOTE: the returned set may be shared with other maps,
+    // it must not be modified
     SetT *get(const T& a) const {
-        auto it = _map.find(a);
-        if (it == _map.end()) {
+        auto it = _map->find(a);
+        if (it == _map->end()) {
             return nullptr;
         }
         return it->second.get();
@@ -144,15 +180,13 @@ public:
         _map.swap(tmp._map);
     }
 
-    auto begin() -> decltype(_map.begin()) { return _map.begin(); }
-    auto end() -> decltype(_map.end()) { return _map.end(); }
-    auto begin() const -> decltype(_map.begin()) { return _map.begin(); }
-    auto end() const -> decltype(_map.end()) { return _map.end(); }
+    typename MapT::const_iterator begin() const { return _map->begin(); }
+    typename MapT::const_iterator end() const { return _map->end(); }
 
 #ifndef NDEBUG
     void dump() const {
         std::set<SetT*> classes;
-        for (const auto& it : _map) {
+        for (const auto& it : *_map) {
             classes.insert(it.second.get());
         }
 
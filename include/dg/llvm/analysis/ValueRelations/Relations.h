@@ -1,8 +1,14 @@
 #ifndef _DG_LLVM_RELATIONS_H_
 #define _DG_LLVM_RELATIONS_H_
 
+#include <map>
 #include <memory>
+#include <set>
+#include <vector>
 #include <cassert>
+#include <cstdlib>
+
+#include "dg/ADT/Bitvector.h"
 
 #ifndef NDEBUG
 #include "getValName.h"
@@ -134,305 +140,255 @@ public:
 	friend VRRelation Not(const VRRelation& r);
 	friend VRRelation reverse(const VRRelation&);
 	friend VRRelation sameOp(const VRRelation&, const llvm::Value *, const llvm::Value *);
-    friend class Relations;
+    friend class RelationsMap;
 };
 
-/// Set of relations for one value
-class Relations {
-    // this value is in relation with values in rhs
-    const llvm::Value *value;
-    // one set for each type of relation
-    std::set<const llvm::Value *> rhs[7]{{}};
-
-public:
-    Relations(const llvm::Value *v) : value(v) {}
-
-    bool add(const VRRelation& rel) {
-        assert(rel.getRelation() != VRRelationType::NONE);
-        assert(rel.getLHS() == value);
-        return rhs[rel.getRelation()].insert(rel.getRHS()).second;
-    }
+///
+// Map of relations between values. The values that are equal are kept
+// in union-find classes and the relations <, <= and != are kept as bitvectors
+// of IDs of the values, one bitvector per class. A relation holds
+// for two values if it holds for some members of their classes, so an equality
+// merges just the classes and the transitive closure is computed
+// with unions of the bitvectors.
+class RelationsMap {
+    // with each relation, add also all relations that follow from transitivity.
+    // NOTE: this may cause big overhead
+    bool _keep_transitively_closed{false};
 
-    bool add(const Relations& oth) {
-        bool changed = false;
-        for (int i = 0; i < 7; ++i) {
-            for (auto& it : oth.rhs[i])
-                changed |= rhs[i].insert(it).second;
+    enum : unsigned { NO_ID = ~0U };
+
+    struct Data {
+        std::map<const llvm::Value *, unsigned> ids;
+        std::vector<const llvm::Value *> values;
+        // union-find of the classes of equal values
+        std::vector<unsigned> parent;
+        std::vector<unsigned> size;
+        // the members of the class (valid only for the representatives)
+        std::vector<ADT::SparseBitvector> members;
+        // the values that are greater than (or equal, not equal) to
+        // the members of the class (valid only for the representatives)
+        std::vector<ADT::SparseBitvector> lt, le, neq;
+        // is the map transitively closed?
+        bool closed{true};
+
+        unsigned getId(const llvm::Value *v) const {
+            auto it = ids.find(v);
+            return it == ids.end() ? NO_ID : it->second;
         }
 
-        return changed;
-    }
-
-    bool has(VRRelationType t, const llvm::Value *x) const {
-        assert(t > 0 && t < 7);
-        return rhs[t].count(x) > 0;
-    }
-
-    bool has(const VRRelation& rel) const {
-        assert(rel.getLHS() == value);
-        return has(rel.getRelation(), rel.getRHS());
-    }
-
-    struct const_iterator {
-        unsigned idx;
-        const Relations& relations;
-        std::set<const llvm::Value *>::const_iterator it;
-
-        const_iterator(const Relations& r, unsigned idx)
-        : idx(idx), relations(r) {
-            if (idx < 7) {
-                it = relations.rhs[idx].begin();
-                _get_next();
+        unsigned getOrCreateId(const llvm::Value *v) {
+            auto it = ids.emplace(v, values.size());
+            if (it.second) {
+                unsigned id = values.size();
+                values.push_back(v);
+                parent.push_back(id);
+                size.push_back(1);
+                members.emplace_back(id);
+                lt.emplace_back();
+                le.emplace_back();
+                neq.emplace_back();
             }
+            return it.first->second;
         }
 
-        VRRelation operator*() const {
-            return VRRelation(static_cast<VRRelationType>(idx),
-                              relations.value, *it);
-        }
-
-        const_iterator& operator++() {
-            ++it;
-            _get_next();
-            return *this;
+        unsigned find(unsigned id) const {
+            while (parent[id] != id)
+                id = parent[id];
+            return id;
         }
 
-        bool operator==(const const_iterator& rhs) const {
-            if (idx < 7) {
-                return idx == rhs.idx ? it == rhs.it : false;
+        unsigned find(unsigned id) {
+            while (parent[id] != id) {
+                parent[id] = parent[parent[id]];
+                id = parent[id];
             }
-
-            return idx == rhs.idx;
+            return id;
         }
 
-        bool operator!=(const const_iterator& rhs) const { return !operator==(rhs); }
-    private:
-        void _get_next() {
-            while (idx < 7) {
-                if (it == relations.rhs[idx].end())
-                    ++idx;
-                else
-                    break;
-                if (idx >= 7)
-                    break;
-                it = relations.rhs[idx].begin();
-            }
+        // merge the classes of the representatives A and B
+        void unite(unsigned A, unsigned B) {
+            assert(A != B);
+            if (size[A] < size[B])
+                std::swap(A, B);
+
+            parent[B] = A;
+            size[A] += size[B];
+            members[A].set(members[B]);
+            lt[A].set(lt[B]);
+            le[A].set(le[B]);
+            neq[A].set(neq[B]);
+            members[B].reset();
+            lt[B].reset();
+            le[B].reset();
+            neq[B].reset();
         }
-    };
-
-    const_iterator begin() const { return const_iterator(*this, 1); }
-    const_iterator end() const { return const_iterator(*this, 7); }
-
 
-#ifndef NDEBUG
-    void dump() const {
-        for (int i = 1; i < 7; ++i) {
-            for (const auto& r : rhs[i]) {
-                VRRelation(static_cast<VRRelationType>(i),
-                           value, r).dump();
-                std::cout << "\n";
-            }
+        // is some member of the class B in the relation
+        // with the members of the class A?
+        static bool has(const std::vector<ADT::SparseBitvector>& rel,
+                        unsigned A, const ADT::SparseBitvector& B) {
+            return rel[A].intersects(B);
         }
-    }
-#endif // NDEBUG
 
-};
-
-class RelationsMap {
-    // with each relation, add also all relations that follow from transitivity.
-    // NOTE: this may cause big overhead
-    bool _keep_transitively_closed{false};
-    std::map<const llvm::Value *, Relations> relations;
-
-    bool addTransitiveEq(const VRRelation& rel) {
-        bool changed = false;
-        if (auto B = get(rel.getRHS())) {
-            auto tmp = *B; // we would modify iterator when iterating over *B
-            for (const auto& it : tmp) {
-                assert(it.getLHS() == rel.getRHS());
-                changed |= add(VRRelation::sameOp(it, rel.getLHS(), it.getRHS()));
+        bool has(VRRelationType t, unsigned A, unsigned B) const {
+            switch (t) {
+            case VRRelationType::EQ:  return A == B;
+            case VRRelationType::NEQ: return has(neq, A, members[B]) ||
+                                             has(lt, A, members[B]) ||
+                                             has(lt, B, members[A]);
+            case VRRelationType::LT:  return has(lt, A, members[B]);
+            case VRRelationType::LE:  return A == B || has(le, A, members[B]) ||
+                                             has(lt, A, members[B]);
+            case VRRelationType::GT:  return has(lt, B, members[A]);
+            case VRRelationType::GE:  return A == B || has(le, B, members[A]) ||
+                                             has(lt, B, members[A]);
+            default: abort();
             }
         }
-        if (auto A = get(rel.getLHS())) {
-            auto tmp = *A; // we would modify iterator when iterating over *B
-            for (const auto& it : tmp) {
-                assert(it.getLHS() == rel.getLHS());
-                changed |= add(VRRelation::sameOp(it, rel.getRHS(), it.getRHS()));
-            }
-        }
-        return changed;
-    }
 
-    bool addTransitiveLt(const VRRelation& rel) {
-        bool changed = false;
-        if (auto B = get(rel.getRHS())) {
-            auto tmp = *B; // we would modify iterator when iterating over *B
-            for (const auto& it : tmp) {
-                assert(it.getLHS() == rel.getRHS());
-                if (it.isEq() || it.isLt() || it.isLe())
-                    changed |= add(VRRelation::sameOp(rel, rel.getLHS(), it.getRHS()));
-            }
-        }
-        if (auto A = get(rel.getLHS())) {
-            auto tmp = *A; // we would modify iterator when iterating over *B
-            for (const auto& it : tmp) {
-                assert(it.getLHS() == rel.getLHS());
-                if (it.isEq() || it.isGt() || it.isGe())
-                    changed |= add(VRRelation::sameOp(rel, it.getRHS(), rel.getRHS()));
+        void close() {
+            std::vector<unsigned> reps;
+            for (unsigned i = 0; i < parent.size(); ++i) {
+                if (parent[i] == i)
+                    reps.push_back(i);
             }
-        }
-        return changed;
-    }
 
-    bool addTransitiveLe(const VRRelation& rel) {
-        bool changed = false;
-        if (auto B = get(rel.getRHS())) {
-            auto tmp = *B; // we would modify iterator when iterating over *B
-            for (const auto& it : tmp) {
-                assert(it.getLHS() == rel.getRHS());
-                if (it.isEq() || it.isLe())
-                    changed |= add(VRRelation::sameOp(rel, rel.getLHS(), it.getRHS()));
-                else if (it.isLt())
-                    changed |= add(VRRelation::sameOp(it, rel.getLHS(), it.getRHS()));
-            }
-        }
-        if (auto A = get(rel.getLHS())) {
-            auto tmp = *A; // we would modify iterator when iterating over *B
-            for (const auto& it : tmp) {
-                assert(it.getLHS() == rel.getLHS());
-                if (it.isEq() || it.isGe())
-                    changed |= add(VRRelation::sameOp(rel, it.getRHS(), rel.getRHS()));
-                else if (it.isGt())
-                    changed |= add(VRRelation::sameOp(it, it.getRHS(), rel.getRHS()));
+            // le contains also the strictly greater values
+            for (unsigned r : reps)
+                le[r].set(lt[r]);
+
+            // i <= k and k <= j  -> i <= j
+            // i < k and k <= j or i <= k and k < j  -> i < j
+            for (unsigned k : reps) {
+                for (unsigned i : reps) {
+                    if (i == k)
+                        continue;
+                    bool isLt = lt[i].intersects(members[k]);
+                    if (!isLt && !le[i].intersects(members[k]))
+                        continue;
+
+                    le[i].set(le[k]);
+                    lt[i].set(lt[k]);
+                    if (isLt)
+                        lt[i].set(le[k]);
+                }
             }
-        }
-        return changed;
-    }
 
-    bool _addTransitive1(const VRRelation& rel) {
-        bool changed = false;
-        if (rel.isEq()) {
-            changed |= addTransitiveEq(rel);
-        } else if (rel.isLt()) {
-            changed |= addTransitiveLt(rel);
-        } else if (rel.isLe()) {
-            changed |= addTransitiveLe(rel);
-        } else if (rel.isGt()) {
-            changed |= addTransitiveLt(VRRelation::reverse(rel));
-        } else if (rel.isGe()) {
-            changed |= addTransitiveLe(VRRelation::reverse(rel));
+            closed = true;
         }
+    };
 
-        return changed;
-    }
-
-    bool _addTransitive(const VRRelation& rel) {
-        bool changed, changed_any = false;
-        do {
-            changed = false;
-            changed |= _addTransitive1(rel);
-            if (!rel.isEq() && !rel.isNeq()) // these are symmetric, all work has been done
-                changed |= _addTransitive1(VRRelation::reverse(rel));
-            changed_any |= changed;
-        } while(changed);
-
-        return changed_any;
-    }
+    // shared by the copies of the map until one of them is modified
+    // (copy-on-write, see also EqualityMap)
+    std::shared_ptr<Data> _data;
 
-    bool _add(const VRRelation& rel) {
-        auto it = relations.find(rel.getLHS());
-        if (it == relations.end()) {
-            auto n = relations.emplace(std::piecewise_construct,
-                                       std::forward_as_tuple(rel.getLHS()),
-                                       std::forward_as_tuple(rel.getLHS()));
-            return n.first->second.add(rel);
-        } else {
-            return it->second.add(rel);
-        }
+    Data& _mutableData() {
+        if (_data.use_count() > 1)
+            _data = std::make_shared<Data>(*_data);
+        return *_data;
     }
 
 public:
-    RelationsMap(bool keep_trans = false) : _keep_transitively_closed(keep_trans), relations{} {}
+    RelationsMap(bool keep_trans = false)
+    : _keep_transitively_closed(keep_trans), _data(std::make_shared<Data>()) {}
     RelationsMap(const RelationsMap&) = default;
+    RelationsMap& operator=(const RelationsMap&) = default;
+
+    bool empty() const { return _data->values.empty(); }
 
     bool add(const VRRelation& rel) {
-        bool ret = _add(rel);
-        if (_keep_transitively_closed) // we want also the reverse mapping here
-            ret |= _add(VRRelation::reverse(rel));
+        assert(rel.getRelation() != VRRelationType::NONE);
+        if (has(rel))
+            return false;
+
+        auto& D = _mutableData();
+        unsigned a = D.getOrCreateId(rel.getLHS());
+        unsigned b = D.getOrCreateId(rel.getRHS());
+        unsigned A = D.find(a);
+        unsigned B = D.find(b);
+
+        switch (rel.getRelation()) {
+        case VRRelationType::EQ:  D.unite(A, B); break;
+        case VRRelationType::NEQ: D.neq[A].set(b); D.neq[B].set(a); break;
+        case VRRelationType::LT:  D.lt[A].set(b); break;
+        case VRRelationType::LE:  D.le[A].set(b); break;
+        case VRRelationType::GT:  D.lt[B].set(a); break;
+        case VRRelationType::GE:  D.le[B].set(a); break;
+        default: abort();
+        }
 
-        if (ret && _keep_transitively_closed)
-            _addTransitive(rel);
+        D.closed = false;
+        if (_keep_transitively_closed)
+            D.close();
 
-        return ret;
+        return true;
     }
 
     bool add(const RelationsMap& rhs) {
-        bool changed = false;
-
-        for (const auto& it : rhs) {
-            for (const auto& rel : it.second) {
-                changed |= add(rel);
-            }
+        if (_data == rhs._data)
+            return false;
+        // just share the map of rhs if we have nothing
+        if (empty() &&
+            _keep_transitively_closed == rhs._keep_transitively_closed) {
+            if (rhs.empty())
+                return false;
+            _data = rhs._data;
+            return true;
         }
+
+        bool changed = false;
+        rhs.forEachRelation([&](const VRRelation& rel) {
+            changed |= add(rel);
+        });
         return changed;
     }
 
     bool has(const VRRelation& rel) const {
-        auto it = relations.find(rel.getLHS());
-        if (it == relations.end())
+        if (rel.isEq() && rel.getLHS() == rel.getRHS())
+            return true;
+
+        unsigned a = _data->getId(rel.getLHS());
+        unsigned b = _data->getId(rel.getRHS());
+        if (a == NO_ID || b == NO_ID)
             return false;
-        return it->second.has(rel);
-    }
 
-    Relations *get(const llvm::Value *v) {
-        auto it = relations.find(v);
-        if (it == relations.end()) {
-            return nullptr;
-        }
-        return &it->second;
+        return _data->has(rel.getRelation(), _data->find(a), _data->find(b));
     }
 
     void transitivelyClose() {
-        auto tmp = relations;
-        for (auto& it : tmp) {
-            for (const auto& r : it.second) {
-                // add mapping also for right-hand sides of relations
-                add(VRRelation::reverse(r));
-            }
-        }
-        bool changed;
-        do {
-            changed = false;
-            auto tmp = relations;
-            for (auto& it : tmp) {
-                for (const auto& r : it.second) {
-                    changed |= _addTransitive(r);
-                }
-            }
-        } while (changed);
+        if (!_data->closed)
+            _mutableData().close();
     }
 
-    /*
-	void intersect(const RelationsMap& rhs) {
-		decltype(relations) tmp;
-		for (const auto& r : rhs) {
-			if (relations.count(r) > 0)
-				tmp.insert(r);
-		}
-		relations.swap(tmp);
-	}
-    */
+    // call f on the relations that were added into the map
+    // (or derived by the transitive closure)
+    template <typename F>
+    void forEachRelation(F f) const {
+        const Data& D = *_data;
+        for (unsigned i = 0; i < D.parent.size(); ++i) {
+            if (D.parent[i] != i) {
+                f(VRRelation::Eq(D.values[i], D.values[D.parent[i]]));
+                continue;
+            }
 
-    auto begin() -> decltype(relations.begin()) { return relations.begin(); }
-    auto end() -> decltype(relations.end()) { return relations.end(); }
-    auto begin() const -> decltype(relations.begin()) { return relations.begin(); }
-    auto end() const -> decltype(relations.end()) { return relations.end(); }
+            for (auto t : D.lt[i])
+                f(VRRelation::Lt(D.values[i], D.values[t]));
+            ADT::SparseBitvector le = D.le[i];
+            le.unset(D.lt[i]);
+            for (auto t : le)
+                f(VRRelation::Le(D.values[i], D.values[t]));
+            for (auto t : D.neq[i])
+                f(VRRelation::Neq(D.values[i], D.values[t]));
+        }
+    }
 
 #ifndef NDEBUG
     void dump() const {
         std::cout << "{";
-        for (auto& it : relations)
-            it.second.dump();
+        forEachRelation([](const VRRelation& rel) {
+            rel.dump();
+            std::cout << "\n";
+        });
         std::cout << "}";
     }
 #endif // NDEBUG
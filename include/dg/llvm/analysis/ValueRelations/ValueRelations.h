@@ -294,10 +294,11 @@ public:
     bool isLt(const llvm::Value *where, const llvm::Value *a, const llvm::Value *b) {
         auto A = getMapping(where);
         assert(A);
-        // FIXME: this is really not efficient
+        if (a == b)
+            return false;
+        // the closure is computed only if the relations changed
         A->transitivelyClose();
-        auto aRel = A->relations.get(a);
-        return aRel ? aRel->has(VRRelationType::LT, b) : false;
+        return A->relations.has(VRRelation::Lt(a, b));
     }
 
     auto getEquals(const llvm::Value *where, const llvm::Value *v)
@@ -1,7 +1,9 @@
 #ifndef _DG_LLVM_VALUE_RELATION_ANALYSIS_H_
 #define _DG_LLVM_VALUE_RELATION_ANALYSIS_H_
 
+#include <functional>
 #include <list>
+#include <vector>
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -30,6 +32,7 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include "dg/ADT/Queue.h"
 #include "dg/analysis/ValueRelations/ValueRelations.h"
 
 #include "Graph.h"
@@ -495,6 +498,13 @@ class LLVMValueRelationsAnalysis {
         bool overwritesAll = false;
         bool changed = false;
 
+        ///
+        // -- merge
+        // (merge first, so that the maps of straight-line locations
+        // are shared with the predecessor if nothing is generated)
+        changed |= loc->equalities.add(source->equalities);
+        changed |= loc->relations.add(source->relations);
+
         ///
         // -- gen
         if (edge->op->isAssume()) {
@@ -509,10 +519,7 @@ class LLVMValueRelationsAnalysis {
         }
 
         ///
-        // -- merge && kill
-        changed |= loc->equalities.add(source->equalities);
-        changed |= loc->relations.add(source->relations);
-
+        // -- kill
         if (overwritesAll) { // no merge
             return changed;
         }
@@ -530,7 +537,9 @@ class LLVMValueRelationsAnalysis {
         return collect(loc, loc->equalities, loc->relations, loc->reads, edge);
     }
 
-    // merge information from predecessors
+public:
+    // merge information from predecessors,
+    // returns true if the state of the location changed
     bool collect(VRLocation *loc) {
         if (loc->predecessors.size() > 1) {
             return mergePredecessors(loc);
@@ -540,6 +549,8 @@ class LLVMValueRelationsAnalysis {
         return false;
     }
 
+private:
+
     // the only values that might not be changed after join are
     // loads from fixed memory and constants and fixed-memory allocation
     // addresses
@@ -685,35 +696,43 @@ public:
         return changed;
     }
 
+    // Compute the fixpoint. A location is processed again only when
+    // the state of some of its predecessors changed. The locations are
+    // taken in the order of their IDs (the order in which they were built).
+    // The maximal number of iterations bounds the number of processed
+    // locations to max_iterations times the number of locations.
+    // Returns true if the fixpoint was not reached.
     template <typename Blocks>
     bool run(Blocks& blocks) {
-        // FIXME: only nodes reachable from changed nodes
-        bool changed;
-        unsigned n = 0;
-        do {
-            ++n;
-
-#ifndef NDEBUG
-            if (n % 1000 == 0) {
-                llvm::errs() << "Iterations: " << n << "\n";
+        std::vector<VRLocation *> locations;
+        ADT::PrioritySet<unsigned, std::less<unsigned>> worklist;
+        for (const auto& B : blocks) {
+            for (const auto& loc : B.second->locations) {
+                if (locations.size() <= loc->id)
+                    locations.resize(loc->id + 1);
+                locations[loc->id] = loc.get();
+                worklist.push(loc->id);
             }
-#endif
+        }
 
-            if (_max_iterations && (n > _max_iterations))
+        const size_t budget = _max_iterations * worklist.size();
+        size_t n = 0;
+        while (!worklist.empty()) {
+            if (_max_iterations && (n >= budget))
                 break;
+            ++n;
 
-            changed = false;
-            for (const auto& B : blocks) {
-                for (const auto& loc : B.second->locations) {
-                    changed |= collect(loc.get());
-                }
+            VRLocation *loc = locations[worklist.pop()];
+            if (collect(loc)) {
+                for (const auto& succ : loc->successors)
+                    worklist.push(succ->target->id);
             }
-        } while (changed);
+        }
 
 #ifndef NDEBUG
-        llvm::errs() << "Number of iterations: " << n << "\n";
+        llvm::errs() << "Number of processed locations: " << n << "\n";
 #endif
-        return changed;
+        return !worklist.empty();
     }
 
     LLVMValueRelationsAnalysis(const llvm::Module *M,
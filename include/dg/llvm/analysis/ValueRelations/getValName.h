@@ -5,6 +5,7 @@
 #include <sstream>
 #include <fstream>
 #include <string>
+#include <llvm/IR/Value.h>
 #include <llvm/Support/raw_os_ostream.h>
 
 namespace dg{
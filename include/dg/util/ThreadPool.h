@@ -0,0 +1,112 @@
+#ifndef _DG_UTIL_THREAD_POOL_H_
+#define _DG_UTIL_THREAD_POOL_H_
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dg {
+
+///
+// A fixed set of threads that run jobs in lock-step.
+// The calling thread takes part in every job as the thread 0,
+// so a pool of 1 thread runs everything sequentially
+// and creates no other thread.
+class ThreadPool {
+    using JobT = std::function<void(unsigned)>;
+
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+
+    const JobT *job{nullptr};
+    unsigned generation{0};
+    unsigned running{0};
+    bool stop{false};
+
+    void work(unsigned idx) {
+        unsigned seen = 0;
+        while (true) {
+            const JobT *cur;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                start_cv.wait(lock, [&] { return stop || generation != seen; });
+                if (stop)
+                    return;
+                seen = generation;
+                cur = job;
+            }
+
+            (*cur)(idx);
+
+            std::lock_guard<std::mutex> lock(mtx);
+            if (--running == 0)
+                done_cv.notify_one();
+        }
+    }
+
+public:
+    ThreadPool(unsigned threadsNum) {
+        for (unsigned i = 1; i < threadsNum; ++i)
+            workers.emplace_back(&ThreadPool::work, this, i);
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stop = true;
+        }
+        start_cv.notify_all();
+        for (auto& t : workers)
+            t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return workers.size() + 1; }
+
+    // run f(thread index) on every thread and wait until all finish
+    void runOnAll(const JobT& f) {
+        if (workers.empty()) {
+            f(0);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            assert(running == 0 && "Nested job");
+            job = &f;
+            running = workers.size();
+            ++generation;
+        }
+        start_cv.notify_all();
+
+        f(0);
+
+        std::unique_lock<std::mutex> lock(mtx);
+        done_cv.wait(lock, [&] { return running == 0; });
+        job = nullptr;
+    }
+
+    // run f(i, thread index) for every i in [0, num),
+    // the indices are distributed among the threads dynamically
+    template <typename F>
+    void parallelFor(size_t num, F f) {
+        std::atomic<size_t> next{0};
+        runOnAll([&](unsigned tid) {
+            size_t i;
+            while ((i = next.fetch_add(1, std::memory_order_relaxed)) < num)
+                f(i, tid);
+        });
+    }
+};
+
+} // namespace dg
+
+#endif // _DG_UTIL_THREAD_POOL_H_
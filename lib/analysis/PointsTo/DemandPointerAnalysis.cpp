@@ -0,0 +1,356 @@
+#include <cassert>
+#include <unordered_set>
+
+#include "dg/analysis/PointsTo/DemandPointerAnalysis.h"
+#include "dg/analysis/PointsTo/PointerAnalysis.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+static inline bool canBeDereferenced(const Pointer& ptr)
+{
+    if (!ptr.isValid() || ptr.isInvalidated() || ptr.isUnknown())
+        return false;
+
+    // if the pointer points to a function, we can not dereference it
+    return ptr.target->getType() != PSNodeType::FUNCTION;
+}
+
+void DemandPointerAnalysis::gatherNodes()
+{
+    reachable.clear();
+    initialPointers.clear();
+    loads.clear();
+    writersOf.clear();
+    loadedWriters.clear();
+    loadedWritersFound = false;
+
+    for (PSNode *nd : PS->getNodes(PS->getRoot())) {
+        reachable.insert(nd);
+        if (nd->getType() == PSNodeType::LOAD)
+            loads.push_back(nd);
+
+        // allocations point to themselves, constants to their operand,
+        // but the builder may have given pointers to any node
+        for (const Pointer& ptr : nd->pointsTo) {
+            if (ptr.target != nd)
+                initialPointers[ptr.target].push_back(nd);
+        }
+    }
+}
+
+// Walk the users of the nodes that copy the pointers of the nodes
+// and gather the stores and memcpy reachable from the root whose
+// address may be one of these pointers. Return true if some of
+// the pointers may be stored to memory.
+bool DemandPointerAnalysis::findWriters(std::vector<PSNode *> nodes,
+                                        std::vector<PSNode *>& out)
+{
+    std::unordered_set<PSNode *> derived(nodes.begin(), nodes.end());
+    std::unordered_set<PSNode *> found;
+    bool stored = false;
+
+    while (!nodes.empty()) {
+        PSNode *nd = nodes.back();
+        nodes.pop_back();
+        ++statistics.steps;
+
+        for (PSNode *user : nd->getUsers()) {
+            switch (user->getType()) {
+                case PSNodeType::GEP:
+                case PSNodeType::CAST:
+                case PSNodeType::CONSTANT:
+                case PSNodeType::CALL_RETURN:
+                case PSNodeType::RETURN:
+                case PSNodeType::PHI:
+                    if (derived.insert(user).second)
+                        nodes.push_back(user);
+                    break;
+                case PSNodeType::STORE:
+                    if (user->getOperand(0) == nd)
+                        stored = true;
+                    if (user->getOperand(1) == nd && reachable.count(user) > 0
+                        && found.insert(user).second)
+                        out.push_back(user);
+                    break;
+                case PSNodeType::MEMCPY:
+                    // the source is not a writer, memcpy copies
+                    // the pointers stored in it, not the pointer itself
+                    if (PSNodeMemcpy::get(user)->getDestination() == nd &&
+                        reachable.count(user) > 0 && found.insert(user).second)
+                        out.push_back(user);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    return stored;
+}
+
+const std::vector<PSNode *>& DemandPointerAnalysis::getWriters(PSNode *target)
+{
+    auto it = writersOf.find(target);
+    if (it != writersOf.end())
+        return it->second;
+
+    std::vector<PSNode *> nodes{target};
+    auto iit = initialPointers.find(target);
+    if (iit != initialPointers.end())
+        nodes.insert(nodes.end(), iit->second.begin(), iit->second.end());
+
+    std::vector<PSNode *> writers;
+    if (findWriters(std::move(nodes), writers)) {
+        // the pointer to the target may be read back from memory
+        // by any load (we do not know which memory holds it yet)
+        if (!loadedWritersFound) {
+            findWriters(loads, loadedWriters);
+            loadedWritersFound = true;
+        }
+
+        std::unordered_set<PSNode *> found(writers.begin(), writers.end());
+        for (PSNode *writer : loadedWriters) {
+            if (found.insert(writer).second)
+                writers.push_back(writer);
+        }
+    }
+
+    return writersOf.emplace(target, std::move(writers)).first->second;
+}
+
+void DemandPointerAnalysis::prepare()
+{
+    if (prepared)
+        return;
+
+    // the inserted calls change the graph, so we must forget
+    // what we computed and do it again until no call is inserted
+    std::set<std::pair<PSNode *, PSNode *>> calls;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        resolved.clear();
+        gatherNodes();
+
+        std::vector<PSNode *> funcptrCalls;
+        for (PSNode *nd : PS->getNodes(PS->getRoot())) {
+            if (nd->getType() == PSNodeType::CALL_FUNCPTR)
+                funcptrCalls.push_back(nd);
+        }
+
+        for (PSNode *callsite : funcptrCalls) {
+            // copy the set, inserting the call may change the graph
+            PointsToSetT called = solve(callsite->getOperand(0), 0 /* no budget */);
+            for (const Pointer& ptr : called) {
+                if (ptr.target->getType() != PSNodeType::FUNCTION)
+                    continue;
+
+                if (calls.emplace(callsite, ptr.target).second)
+                    changed |= functionPointerCall(callsite, ptr.target);
+            }
+        }
+    }
+
+    prepared = true;
+}
+
+const PointsToSetT& DemandPointerAnalysis::query(PSNode *node)
+{
+    assert(node && "No node given");
+    prepare();
+
+    return solve(node, options.queryBudget);
+}
+
+const PointsToSetT& DemandPointerAnalysis::get(PSNode *node, PSNode *user, Query& q)
+{
+    auto it = resolved.find(node);
+    if (it != resolved.end())
+        return it->second;
+
+    auto qit = q.pointsTo.find(node);
+    if (qit == q.pointsTo.end()) {
+        // start with the pointers that the node got
+        // when building the graph (e.g., allocations, constants)
+        qit = q.pointsTo.emplace(node, node->pointsTo).first;
+        q.enqueue(node);
+    }
+
+    // the user may be the node itself (e.g. a load that
+    // reads the memory copied from its own pointers)
+    if (user)
+        q.users[node].insert(user);
+
+    return qit->second;
+}
+
+const PointsToSetT& DemandPointerAnalysis::solve(PSNode *node, uint64_t budget)
+{
+    auto it = resolved.find(node);
+    if (it != resolved.end())
+        return it->second;
+
+    ++statistics.queries;
+
+    Query q;
+    get(node, nullptr, q);
+
+    while (!q.worklist.empty()) {
+        PSNode *cur = q.worklist.pop();
+        q.queued.erase(cur);
+
+        ++q.steps;
+        if (budget > 0 && q.steps > budget)
+            break;
+
+        PointsToSetT out;
+        transfer(cur, q, out);
+
+        if (q.pointsTo[cur].add(out)) {
+            for (PSNode *user : q.users[cur])
+                q.enqueue(user);
+        }
+    }
+
+    statistics.steps += q.steps;
+
+    if (budget > 0 && q.steps > budget) {
+        // do not keep the unknown pointer, the node may be the address
+        // of a store in the following queries and the store through
+        // an unknown pointer would be dropped
+        ++statistics.exceeded;
+        return unknown;
+    }
+
+    // we reached the fixpoint, all the explored nodes have
+    // their points-to sets computed
+    for (auto& it : q.pointsTo)
+        resolved.emplace(it.first, std::move(it.second));
+
+    statistics.resolvedNodes = resolved.size();
+    return resolved[node];
+}
+
+Offset DemandPointerAnalysis::gepOffset(PSNode *gep, const Pointer& ptr) const
+{
+    // the same as PointerAnalysis::gepOffset()
+    Offset off = PSNodeGep::get(gep)->getOffset();
+    Offset::type new_offset;
+    if (ptr.offset.isUnknown() || off.isUnknown())
+        new_offset = Offset::UNKNOWN;
+    else
+        new_offset = *ptr.offset + *off;
+
+    if ((new_offset == 0 || new_offset < ptr.target->getSize())
+        && new_offset < *options.fieldSensitivity)
+        return new_offset;
+
+    return Offset::UNKNOWN;
+}
+
+// Add the pointers that may be stored in 'target' at 'offset' to 'out'.
+// 'visited' are the sources of memcpy that we already read.
+void DemandPointerAnalysis::loadFrom(PSNode *node, PSNode *target, Offset offset,
+                                     Query& q, PointsToSetT& out,
+                                     std::set<PSNode *>& visited)
+{
+    for (PSNode *writer : getWriters(target)) {
+        ++q.steps;
+
+        if (writer->getType() == PSNodeType::STORE) {
+            for (const Pointer& ptr : get(writer->getOperand(1), node, q)) {
+                if (ptr.target != target || !canBeDereferenced(ptr))
+                    continue;
+
+                if (offset.isUnknown() || ptr.offset.isUnknown() ||
+                    ptr.offset == offset) {
+                    out.add(get(writer->getOperand(0), node, q));
+                    break;
+                }
+            }
+            continue;
+        }
+
+        // memcpy - we do not track the offsets of the copied pointers,
+        // all pointers from the source memory may be anywhere in the destination
+        PSNodeMemcpy *memcpy = PSNodeMemcpy::get(writer);
+        for (const Pointer& dptr : get(memcpy->getDestination(), node, q)) {
+            if (dptr.target != target || !canBeDereferenced(dptr))
+                continue;
+
+            for (const Pointer& sptr : get(memcpy->getSource(), node, q)) {
+                if (!canBeDereferenced(sptr))
+                    continue;
+
+                PSNodeAlloc *source = PSNodeAlloc::get(sptr.target);
+                if (source && source->isZeroInitialized())
+                    out.add(NullPointer);
+
+                // the source may be the target itself
+                // (e.g. memmove in an array), so it is not
+                // in 'visited' until we read it here
+                if (visited.insert(sptr.target).second)
+                    loadFrom(node, sptr.target, Offset::UNKNOWN, q, out, visited);
+            }
+
+            break;
+        }
+    }
+}
+
+void DemandPointerAnalysis::transfer(PSNode *node, Query& q, PointsToSetT& out)
+{
+    switch (node->getType()) {
+        case PSNodeType::LOAD:
+            for (const Pointer& ptr : get(node->getOperand(0), node, q)) {
+                if (ptr.isUnknown()) {
+                    // load from unknown pointer yields unknown pointer
+                    out.add(UnknownPointer);
+                    continue;
+                }
+
+                if (!canBeDereferenced(ptr))
+                    continue;
+
+                std::set<PSNode *> visited;
+                loadFrom(node, ptr.target, ptr.offset, q, out, visited);
+
+                // we ignore the order of the nodes, so the load
+                // may read the memory before any store to it
+                PSNodeAlloc *target = PSNodeAlloc::get(ptr.target);
+                if (target && target->isZeroInitialized())
+                    out.add(NullPointer);
+            }
+            break;
+        case PSNodeType::GEP:
+            for (const Pointer& ptr : get(node->getOperand(0), node, q))
+                out.add(ptr.target, gepOffset(node, ptr));
+            break;
+        case PSNodeType::CAST:
+        case PSNodeType::CALL_RETURN:
+        case PSNodeType::RETURN:
+        case PSNodeType::PHI:
+            for (size_t i = 0; i < node->getOperandsNum(); ++i)
+                out.add(get(node->getOperand(i), node, q));
+            break;
+        case PSNodeType::CALL_FUNCPTR:
+            // the calls were inserted in prepare(),
+            // here we just gather the called functions
+            for (const Pointer& ptr : get(node->getOperand(0), node, q)) {
+                if (ptr.target->getType() == PSNodeType::FUNCTION)
+                    out.add(ptr);
+            }
+            break;
+        default:
+            // allocations, constants and the nodes that do not
+            // have points-to sets keep what they got when
+            // building the graph
+            break;
+    }
+}
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
@@ -36,16 +36,24 @@ static inline bool canBeDereferenced(const Pointer& ptr)
 
 bool PointerAnalysis::processLoad(PSNode *node)
 {
-    bool changed = false;
     PSNode *operand = node->getOperand(0);
 
     if (operand->pointsTo.empty())
         return error(operand, "Load's operand has no points-to set");
 
-    for (const Pointer& ptr : operand->pointsTo) {
+    return processLoad(node, operand->pointsTo, node->pointsTo);
+}
+
+bool PointerAnalysis::processLoad(PSNode *node,
+                                  const PointsToSetT& addresses,
+                                  PointsToSetT& out)
+{
+    bool changed = false;
+
+    for (const Pointer& ptr : addresses) {
         if (ptr.isUnknown()) {
             // load from unknown pointer yields unknown pointer
-            changed |= node->addPointsTo(UnknownPointer);
+            changed |= out.add(UnknownPointer);
             continue;
         }
 
@@ -66,7 +74,7 @@ bool PointerAnalysis::processLoad(PSNode *node)
             if (target->isZeroInitialized())
                 // if the memory is zero initialized, then everything
                 // is fine, we add nullptr
-                changed |= node->addPointsTo(NullPointer);
+                changed |= out.add(NullPointer);
             else
                 changed |= errorEmptyPointsTo(node, target);
 
@@ -83,7 +91,7 @@ bool PointerAnalysis::processLoad(PSNode *node)
                 // FIXME: don't duplicate the code
                 if (o->pointsTo.empty()) {
                     if (target->isZeroInitialized())
-                        changed |= node->addPointsTo(NullPointer);
+                        changed |= out.add(NullPointer);
                     else if (objects.size() == 1)
                         changed |= errorEmptyPointsTo(node, target);
                 }
@@ -91,7 +99,7 @@ bool PointerAnalysis::processLoad(PSNode *node)
                 // we have some pointers - copy them all,
                 // since the offset is unknown
                 for (auto& it : o->pointsTo) {
-                    changed |= node->addPointsTo(it.second);
+                    changed |= out.add(it.second);
                 }
 
                 // this is all that we can do here...
@@ -105,7 +113,7 @@ bool PointerAnalysis::processLoad(PSNode *node)
                 // if the memory is zero initialized, then everything
                 // is fine, we add nullptr
                 if (target->isZeroInitialized())
-                    changed |= node->addPointsTo(NullPointer);
+                    changed |= out.add(NullPointer);
                 // if we don't have a definition even with unknown offset
                 // it is an error
                 // FIXME: don't triplicate the code!
@@ -114,14 +122,14 @@ bool PointerAnalysis::processLoad(PSNode *node)
             } else {
                 // we have pointers on that memory, so we can
                 // do the work
-                changed |= node->addPointsTo(it->second);
+                changed |= out.add(it->second);
             }
 
             // plus always add the pointers at unknown offset,
             // since these can be what we need too
             it = o->pointsTo.find(Offset::UNKNOWN);
             if (it != o->pointsTo.end()) {
-                changed |= node->addPointsTo(it->second);
+                changed |= out.add(it->second);
             }
         }
     }
@@ -267,22 +275,48 @@ bool PointerAnalysis::processGep(PSNode *node) {
     PSNodeGep *gep = PSNodeGep::get(node);
     assert(gep && "Non-GEP given");
 
-    for (const Pointer& ptr : gep->getSource()->pointsTo) {
-        Offset::type new_offset;
-        if (ptr.offset.isUnknown() || gep->getOffset().isUnknown())
-            // set it like this to avoid overflow when adding
-            new_offset = Offset::UNKNOWN;
-        else
-            new_offset = *ptr.offset + *gep->getOffset();
-
-        // in the case PSNodeType::the memory has size 0, then every pointer
-        // will have unknown offset with the exception that it points
-        // to the begining of the memory - therefore make 0 exception
-        if ((new_offset == 0 || new_offset < ptr.target->getSize())
-            && new_offset < *options.fieldSensitivity)
-            changed |= node->addPointsTo(ptr.target, new_offset);
-        else
-            changed |= node->addPointsTo(ptr.target, Offset::UNKNOWN);
+    for (const Pointer& ptr : gep->getSource()->pointsTo)
+        changed |= node->addPointsTo(ptr.target, gepOffset(gep, ptr));
+
+    return changed;
+}
+
+Offset PointerAnalysis::gepOffset(PSNodeGep *gep, const Pointer& ptr) const {
+    Offset::type new_offset;
+    if (ptr.offset.isUnknown() || gep->getOffset().isUnknown())
+        // set it like this to avoid overflow when adding
+        new_offset = Offset::UNKNOWN;
+    else
+        new_offset = *ptr.offset + *gep->getOffset();
+
+    // in the case PSNodeType::the memory has size 0, then every pointer
+    // will have unknown offset with the exception that it points
+    // to the begining of the memory - therefore make 0 exception
+    if ((new_offset == 0 || new_offset < ptr.target->getSize())
+        && new_offset < *options.fieldSensitivity)
+        return new_offset;
+
+    return Offset::UNKNOWN;
+}
+
+bool PointerAnalysis::processStore(PSNode *node,
+                                   const PointsToSetT& addresses,
+                                   const PointsToSetT& values)
+{
+    bool changed = false;
+    std::vector<MemoryObject *> objects;
+
+    for (const Pointer& ptr : addresses) {
+        assert(ptr.target && "Got nullptr as target");
+
+        if (!canBeDereferenced(ptr))
+            continue;
+
+        objects.clear();
+        getMemoryObjects(node, ptr, objects);
+        for (MemoryObject *o : objects) {
+            changed |= o->addPointsTo(ptr.offset, values);
+        }
     }
 
     return changed;
@@ -291,7 +325,6 @@ bool PointerAnalysis::processGep(PSNode *node) {
 bool PointerAnalysis::processNode(PSNode *node)
 {
     bool changed = false;
-    std::vector<MemoryObject *> objects;
 
 #ifdef DEBUG_ENABLED
     size_t prev_size = node->pointsTo.size();
@@ -302,19 +335,8 @@ bool PointerAnalysis::processNode(PSNode *node)
             changed |= processLoad(node);
             break;
         case PSNodeType::STORE:
-            for (const Pointer& ptr : node->getOperand(1)->pointsTo) {
-                assert(ptr.target && "Got nullptr as target");
-
-                if (!canBeDereferenced(ptr))
-                    continue;
-
-                objects.clear();
-                getMemoryObjects(node, ptr, objects);
-                for (MemoryObject *o : objects) {
-                    changed |= o->addPointsTo(ptr.offset,
-                                              node->getOperand(0)->pointsTo);
-                }
-            }
+            changed |= processStore(node, node->getOperand(1)->pointsTo,
+                                    node->getOperand(0)->pointsTo);
             break;
         case PSNodeType::INVALIDATE_OBJECT:
         case PSNodeType::FREE:
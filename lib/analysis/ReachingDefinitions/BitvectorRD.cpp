@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "dg/ADT/Bitvector.h"
+#include "dg/ADT/Queue.h"
+#include "dg/analysis/ReachingDefinitions/DefSiteUniverse.h"
+#include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+namespace {
+
+///
+// The universe of definitions, i.e., the pairs (def-site, node)
+// that may occur in the maps of reaching definitions.
+// Every definition gets a dense ID that is used in the bitvectors.
+class Definitions {
+    DefSiteUniverse sites;
+    std::map<std::pair<unsigned, RDNode *>, unsigned> ids;
+    std::vector<std::pair<unsigned, RDNode *>> defs;
+    // definitions of memory objects (for computing the kill sets)
+    std::unordered_map<RDNode *, std::vector<unsigned>> of_target;
+
+public:
+    unsigned add(const DefSite& ds, RDNode *n) {
+        unsigned site = sites.add(ds);
+        auto it = ids.emplace(std::make_pair(site, n), defs.size());
+        if (it.second) {
+            defs.emplace_back(site, n);
+            of_target[ds.target].push_back(it.first->second);
+        }
+
+        return it.first->second;
+    }
+
+    void add(const RDMap& map, ADT::SparseBitvector& to) {
+        for (const auto& it : map) {
+            for (RDNode *n : it.second)
+                to.set(add(it.first, n));
+        }
+    }
+
+    const DefSite& getDefSite(unsigned id) const { return sites[defs[id].first]; }
+    RDNode *getNode(unsigned id) const { return defs[id].second; }
+
+    const std::vector<unsigned> *getDefinitionsOf(RDNode *target) const {
+        auto it = of_target.find(target);
+        return it == of_target.end() ? nullptr : &it->second;
+    }
+};
+
+} // anonymous namespace
+
+static bool comp_ds(const DefSite& a, const DefSite& b)
+{
+    return a.target < b.target;
+}
+
+///
+// Is the definition of 'ds' overwritten by some of the def-sites
+// from [I, E) (these are def-sites of the same target that are
+// strongly updated by a node)? This must be the same as the strong
+// update in BasicRDMap::merge().
+template <typename IT>
+static bool isOverwritten(const DefSite& ds, IT I, IT E,
+                          bool strong_update_unknown)
+{
+    if (strong_update_unknown &&
+        ds.offset.isUnknown() && ds.target->getSize() > 0) {
+        for (; I != E; ++I) {
+            if (*I->offset == 0 && *I->len >= ds.target->getSize())
+                return true;
+        }
+
+        return false;
+    }
+
+    if (ds.target->getType() == RDNodeType::DYN_ALLOC)
+        return false;
+
+    for (; I != E; ++I) {
+        const DefSite& ds2 = *I;
+        // writes to unknown offset keep all the definitions
+        if (ds2.offset.isUnknown())
+            return false;
+
+        if ((*ds.offset >= *ds2.offset)
+            && (*ds.offset + *ds.len <= *ds2.offset + *ds2.len))
+            return true;
+    }
+
+    return false;
+}
+
+///
+// Solve the dense reaching definitions as the classical bit-vector
+// problem: out(n) = gen(n) | (in(n) & ~kill(n)) where in(n) is the union
+// of out() of the predecessors. The gen set of a node are the definitions
+// that it has in its map before the analysis starts and the kill set
+// are the definitions overwritten by the node. The results are written
+// back to the maps of the nodes once the fixpoint is reached.
+void ReachingDefinitionsAnalysis::solveBitvectors(const std::vector<RDNode *>& nodes)
+{
+    Definitions D;
+    std::vector<ADT::SparseBitvector> out(nodes.size());
+    std::vector<ADT::SparseBitvector> kill(nodes.size());
+
+    // the nodes are marked with dfsnum by getNodesRPO()
+    auto reachable = [this](RDNode *n) { return n->dfsid == dfsnum; };
+
+    for (unsigned i = 0; i < nodes.size(); ++i)
+        D.add(nodes[i]->def_map, out[i]);
+
+    // predecessors that are not reachable from the start do not change
+    // during the analysis, they just contribute with their maps
+    std::unordered_map<RDNode *, ADT::SparseBitvector> external;
+    for (RDNode *n : nodes) {
+        for (RDNode *pred : n->predecessors) {
+            if (!reachable(pred) && external.count(pred) == 0)
+                D.add(pred->def_map, external[pred]);
+        }
+    }
+
+    const std::vector<ADT::SparseBitvector> gen(out);
+
+    // the kill sets. All definitions are known at this moment,
+    // since the analysis does not create any new definitions
+    for (unsigned i = 0; i < nodes.size(); ++i) {
+        const DefSiteSetT& overwrites = nodes[i]->overwrites;
+        for (auto I = overwrites.begin(); I != overwrites.end();) {
+            auto E = std::upper_bound(I, overwrites.end(), *I, comp_ds);
+            if (auto *defs = D.getDefinitionsOf(I->target)) {
+                for (unsigned id : *defs) {
+                    if (isOverwritten(D.getDefSite(id), I, E,
+                                      options.strongUpdateUnknown))
+                        kill[i].set(id);
+                }
+            }
+            I = E;
+        }
+    }
+
+    ADT::PrioritySet<unsigned, std::less<unsigned>> worklist;
+    for (unsigned i = 0; i < nodes.size(); ++i)
+        worklist.push(i);
+
+    ADT::SparseBitvector in;
+    while (!worklist.empty()) {
+        unsigned i = worklist.pop();
+        RDNode *cur = nodes[i];
+
+        ++processed_num;
+        merges_num += cur->predecessors.size();
+
+        in.reset();
+        for (RDNode *pred : cur->predecessors) {
+            if (reachable(pred))
+                in.set(out[pred->rpoid]);
+            else
+                in.set(external[pred]);
+        }
+
+        in.unset(kill[i]);
+        in.set(gen[i]);
+
+        // the sets only grow
+        assert(out[i].isSubsetOf(in));
+        if (in != out[i]) {
+            out[i].swap(in);
+            for (RDNode *succ : cur->getSuccessors())
+                worklist.push(succ->rpoid);
+        }
+    }
+
+    for (unsigned i = 0; i < nodes.size(); ++i) {
+        RDMap& map = nodes[i]->def_map;
+        map = RDMap();
+        for (auto id : out[i])
+            map.add(D.getDefSite(id), D.getNode(id));
+    }
+}
+
+} // namespace rd
+} // namespace analysis
+} // namespace dg
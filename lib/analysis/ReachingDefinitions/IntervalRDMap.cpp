@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "dg/analysis/ReachingDefinitions/RDMap.h"
+#include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+const uint64_t IntervalRDMap::MAX_END;
+
+static bool comp_ds(const DefSite& a, const DefSite& b)
+{
+    return a.target < b.target;
+}
+
+IntervalRDMap::IntervalT
+IntervalRDMap::getInterval(const Offset& off, const Offset& len)
+{
+    assert(!off.isUnknown() && "The offset must be concrete");
+
+    if (len.isUnknown() || *len > MAX_END - *off)
+        return IntervalT(*off, MAX_END);
+
+    // definitions of zero bytes are taken as definitions of one byte
+    return IntervalT(*off, *off + (len.isZero() ? 0 : *len - 1));
+}
+
+static bool covers(const IntervalRDMap::IntervalsT& intervals,
+                   const IntervalRDMap::IntervalT& I,
+                   const IntervalRDMap::ValuesT& vals)
+{
+    if (!intervals.overlapsFull(I))
+        return false;
+
+    for (auto it = intervals.le(I);
+         it != intervals.end() && it->first.start <= I.end; ++it) {
+        const auto& S = it->second;
+        // unknown memory stands for all definitions
+        if (S.count(UNKNOWN_MEMORY) > 0)
+            continue;
+
+        if (!std::includes(S.begin(), S.end(), vals.begin(), vals.end()))
+            return false;
+    }
+
+    return true;
+}
+
+bool IntervalRDMap::_addValues(RDNode *target, ObjectDefs& defs,
+                               const IntervalT& I, const ValuesT& vals,
+                               Offset::type max_set_size)
+{
+    // do not split the intervals if nothing changes,
+    // the result of the merge would not be precise then
+    if (covers(defs.intervals, I, vals))
+        return false;
+
+    for (RDNode *n : vals)
+        defs.intervals.add(I, n);
+
+    // crop the sets to UNKNOWN_MEMORY the same way as RDNodesSet does
+    for (auto it = defs.intervals.le(I);
+         it != defs.intervals.end() && it->first.start <= I.end; ++it) {
+        auto& S = it->second;
+        if (S.size() > 1 &&
+            (S.count(UNKNOWN_MEMORY) > 0 ||
+             (!target->isUnknown() && S.size() > max_set_size))) {
+            S.clear();
+            S.insert(UNKNOWN_MEMORY);
+        }
+    }
+
+    return true;
+}
+
+///
+// merge @oth map to this map. The semantics is the same as in
+// BasicRDMap::merge(), but strong updates are performed per bytes:
+// we do not merge the bytes of concrete definitions from @oth that are
+// overwritten by any concrete definition from @no_update. Definitions
+// with Offset::UNKNOWN are overwritten only when @strong_update_unknown
+// is set and some definition from @no_update overwrites the whole memory.
+// If @merge_unknown is set, all definitions of an object that has
+// some definition with Offset::UNKNOWN are merged to the unknown offset.
+bool IntervalRDMap::merge(const IntervalRDMap *oth,
+                          DefSiteSetT *no_update,
+                          bool strong_update_unknown,
+                          Offset::type max_set_size,
+                          bool merge_unknown)
+{
+    if (this == oth)
+        return false;
+
+    bool changed = false;
+    std::vector<IntervalT> overwritten;
+    for (const auto& it : oth->_defs) {
+        RDNode *target = it.first;
+        const ObjectDefs& from = it.second;
+
+        // STRONG UPDATE
+        // --------------------
+        bool unknown_overwritten = false;
+        bool whole_overwritten = false;
+        overwritten.clear();
+        if (no_update) {
+            auto range = std::equal_range(no_update->begin(),
+                                          no_update->end(),
+                                          DefSite(target), comp_ds);
+            for (auto I = range.first; I != range.second; ++I) {
+                const DefSite& ds2 = *I;
+                if (ds2.offset.isUnknown()) {
+                    unknown_overwritten = true;
+                    continue;
+                }
+
+                if (*ds2.offset == 0 && *ds2.len >= target->getSize())
+                    whole_overwritten = true;
+
+                overwritten.push_back(getInterval(ds2.offset, ds2.len));
+            }
+        }
+
+        // the same as in BasicRDMap, we do not do strong
+        // updates of heap allocated objects and if the object
+        // is overwritten at unknown offset, we keep everything
+        bool filter = !overwritten.empty() && !unknown_overwritten &&
+                      target->getType() != RDNodeType::DYN_ALLOC;
+        if (filter)
+            std::sort(overwritten.begin(), overwritten.end());
+
+        ObjectDefs& to = _defs[target];
+
+        // DEFINITIONS AT UNKNOWN OFFSET
+        // ------------------------------
+        if (from.unknown.size() > 0 &&
+            !(strong_update_unknown && target->getSize() > 0 && whole_overwritten)) {
+            for (RDNode *n : from.unknown)
+                changed |= to.unknown.insert(n);
+
+            if (!target->isUnknown() && to.unknown.size() > max_set_size)
+                to.unknown.makeUnknown();
+        }
+
+        // MERGE CONCRETE OFFSETS (if desired)
+        // ------------------------------------
+        if (merge_unknown && to.unknown.size() > 0) {
+            for (const auto& I : to.intervals) {
+                for (RDNode *n : I.second)
+                    changed |= to.unknown.insert(n);
+            }
+            for (const auto& I : from.intervals) {
+                for (RDNode *n : I.second)
+                    changed |= to.unknown.insert(n);
+            }
+
+            to.intervals = IntervalsT();
+            if (!target->isUnknown() && to.unknown.size() > max_set_size)
+                to.unknown.makeUnknown();
+            continue;
+        }
+
+        // DEFINITIONS AT CONCRETE OFFSETS
+        // ------------------------------------
+        for (const auto& I : from.intervals) {
+            if (!filter) {
+                changed |= _addValues(target, to, I.first, I.second, max_set_size);
+                continue;
+            }
+
+            // add the parts of the interval that are not overwritten
+            uint64_t start = I.first.start;
+            bool done = false;
+            for (const IntervalT& O : overwritten) {
+                if (O.end < start)
+                    continue;
+                if (O.start > I.first.end)
+                    break;
+
+                if (O.start > start)
+                    changed |= _addValues(target, to, IntervalT(start, O.start - 1),
+                                          I.second, max_set_size);
+
+                if (O.end >= I.first.end) {
+                    done = true;
+                    break;
+                }
+
+                start = O.end + 1;
+            }
+
+            if (!done)
+                changed |= _addValues(target, to, IntervalT(start, I.first.end),
+                                      I.second, max_set_size);
+        }
+
+        if (to.empty())
+            _defs.erase(target);
+    }
+
+    return changed;
+}
+
+bool IntervalRDMap::add(const DefSite& ds, RDNode *n)
+{
+    ObjectDefs& defs = _defs[ds.target];
+    if (ds.offset.isUnknown())
+        return defs.unknown.insert(n);
+
+    return _addValues(ds.target, defs, getInterval(ds.offset, ds.len),
+                      ValuesT{n}, Offset::UNKNOWN);
+}
+
+bool IntervalRDMap::update(const DefSite& ds, RDNode *n)
+{
+    ObjectDefs& defs = _defs[ds.target];
+    if (ds.offset.isUnknown()) {
+        bool ret = defs.unknown.count(n) == 0 || defs.unknown.size() > 1;
+        defs.unknown.clear();
+        defs.unknown.insert(n);
+        return ret;
+    }
+
+    return defs.intervals.update(getInterval(ds.offset, ds.len), n);
+}
+
+size_t IntervalRDMap::get(RDNode *n, const Offset& off,
+                          const Offset& len, std::set<RDNode *>& ret) const
+{
+    return get(DefSite(n, off, len), ret);
+}
+
+size_t IntervalRDMap::get(const DefSite& ds, std::set<RDNode *>& ret) const
+{
+    auto it = _defs.find(ds.target);
+    if (it == _defs.end())
+        return ret.size();
+
+    const ObjectDefs& defs = it->second;
+    // definitions with unknown offset may define any byte
+    ret.insert(defs.unknown.begin(), defs.unknown.end());
+
+    if (ds.offset.isUnknown()) {
+        for (const auto& I : defs.intervals)
+            ret.insert(I.second.begin(), I.second.end());
+    } else if (!defs.intervals.empty()) {
+        IntervalT I = getInterval(ds.offset, ds.len);
+        for (auto J = defs.intervals.le(I);
+             J != defs.intervals.end() && J->first.start <= I.end; ++J)
+            ret.insert(J->second.begin(), J->second.end());
+    }
+
+    return ret.size();
+}
+
+} // rd
+} // analysis
+} // dg
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cassert>
+#include <set>
+
+#include "dg/analysis/SCC.h"
+#include "dg/analysis/ReachingDefinitions/RDFunctionSummaries.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+void RDFunctionSummaries::_apply(const CallSite& cs)
+{
+    const Summary& S = cs.callee->summary;
+    for (const auto& it : S.gen) {
+        for (RDNode *n : it.second)
+            cs.summaryNode->def_map.add(it.first, n);
+    }
+
+    cs.summaryNode->overwrites.insert(S.kill.begin(), S.kill.end());
+}
+
+void RDFunctionSummaries::_resetNode(RDNode *n)
+{
+    n->dfsid = 0;
+    n->rpoid = 0;
+    // the same as RDNode::addDef() does
+    n->def_map = RDMap();
+    for (const DefSite& ds : n->defs)
+        n->def_map.update(ds, n);
+}
+
+void RDFunctionSummaries::_analyze(ReachingDefinitionsAnalysis& RDA,
+                                   Function *F)
+{
+    ++analyzed_num;
+    RDA.solve(F->root);
+}
+
+void RDFunctionSummaries::_computeNonRecursive(ReachingDefinitionsAnalysis& RDA,
+                                               Function *F)
+{
+    for (const CallSite& cs : F->calls)
+        _apply(cs);
+
+    // the root of the function "defines" everything that may be
+    // overwritten in the function. The def-sites whose definitions
+    // from the root do not reach the return node are overwritten
+    // on every path through the function
+    DefSiteSetT candidates;
+    for (RDNode *n : F->nodes) {
+        for (const DefSite& ds : n->overwrites) {
+            if (ds.offset.isUnknown() || ds.len.isUnknown() ||
+                ds.target->isUnknown() ||
+                ds.target->getType() == RDNodeType::DYN_ALLOC)
+                continue;
+
+            candidates.insert(ds);
+        }
+    }
+
+    for (const DefSite& ds : candidates)
+        F->root->def_map.add(ds, F->root);
+
+    _analyze(RDA, F);
+
+    RDMap& exit = F->ret->def_map;
+    for (const auto& it : exit) {
+        for (RDNode *n : it.second) {
+            if (n != F->root)
+                F->summary.gen.add(it.first, n);
+        }
+    }
+
+    for (const DefSite& ds : candidates) {
+        std::set<RDNode *> defs;
+        exit.get(ds.target, ds.offset, ds.len, defs);
+        if (defs.count(F->root) == 0 && defs.count(UNKNOWN_MEMORY) == 0)
+            F->summary.kill.insert(ds);
+    }
+}
+
+void RDFunctionSummaries::_computeRecursive(ReachingDefinitionsAnalysis& RDA,
+                                            const std::vector<Function *>& component)
+{
+    bool changed;
+    do {
+        changed = false;
+
+        for (Function *F : component) {
+            for (const CallSite& cs : F->calls)
+                _apply(cs);
+        }
+
+        for (Function *F : component)
+            _analyze(RDA, F);
+
+        for (Function *F : component)
+            changed |= F->summary.gen.merge(&F->ret->def_map);
+    } while (changed);
+}
+
+void RDFunctionSummaries::compute()
+{
+    if (functions.empty())
+        return;
+
+    // we use the analysis only to compute the fixpoint
+    // on the graphs of single functions
+    ReachingDefinitionsAnalysis RDA(functions[0]->root, options);
+
+    // the call-sites are not connected to the called
+    // functions yet, so these are only the nodes of the function
+    for (auto& F : functions)
+        F->nodes = RDA.getNodes(F->root);
+
+    SCC<Function> scc;
+    for (auto& F : functions) {
+        if (F->dfs_id == 0)
+            scc.compute(F.get());
+    }
+
+    // the components are in reverse topological order,
+    // so the called functions go first
+    for (const auto& component : scc.getSCC()) {
+        assert(!component.empty());
+
+        Function *F = component[0];
+        bool recursive = component.size() > 1 ||
+                         std::find(F->callees.begin(), F->callees.end(), F)
+                            != F->callees.end();
+        if (recursive)
+            _computeRecursive(RDA, component);
+        else
+            _computeNonRecursive(RDA, F);
+    }
+
+    // the nodes now keep the results for the empty context
+    // (and the definitions from the roots), so start from scratch.
+    // Only the summary nodes keep the summaries
+    for (auto& F : functions) {
+        for (RDNode *n : F->nodes)
+            _resetNode(n);
+    }
+
+    for (auto& F : functions) {
+        for (const CallSite& cs : F->calls) {
+            _apply(cs);
+            cs.call->addSuccessor(cs.callee->root);
+        }
+    }
+}
+
+} // namespace rd
+} // namespace analysis
+} // namespace dg
@@ -1,5 +1,7 @@
+#include <functional>
 #include <set>
 
+#include "dg/ADT/Queue.h"
 #include "dg/analysis/ReachingDefinitions/RDMap.h"
 #include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
 
@@ -14,6 +16,9 @@ bool ReachingDefinitionsAnalysis::processNode(RDNode *node)
 {
     bool changed = false;
 
+    ++processed_num;
+    merges_num += node->predecessors.size();
+
     // merge maps from predecessors
     for (RDNode *n : node->predecessors)
         changed |= node->def_map.merge(&n->def_map,
@@ -29,30 +34,41 @@ bool ReachingDefinitionsAnalysis::processNode(RDNode *node)
 void ReachingDefinitionsAnalysis::run()
 {
     assert(getRoot() && "Do not have root");
+    solve(getRoot());
+}
 
-    std::vector<RDNode *> to_process = getNodes(getRoot());
-    std::vector<RDNode *> changed;
+void ReachingDefinitionsAnalysis::solve(RDNode *start)
+{
+    std::vector<RDNode *> nodes = getNodesRPO(start);
+    for (unsigned i = 0; i < nodes.size(); ++i)
+        nodes[i]->rpoid = i;
 
-    // do fixpoint
-    do {
-        unsigned last_processed_num = to_process.size();
-        changed.clear();
+    if (options.bitvectors) {
+        solveBitvectors(nodes);
+        return;
+    }
 
-        for (RDNode *cur : to_process) {
-            if (processNode(cur))
-                changed.push_back(cur);
-        }
+    if (options.intervalMaps) {
+        for (RDNode *n : nodes)
+            n->def_map.useIntervals();
+    }
 
-        if (!changed.empty()) {
-            to_process.clear();
-            to_process = getNodes(changed /* starting set */,
-                                  last_processed_num /* expected num */);
+    // the worklist contains the positions of nodes in RPO,
+    // so we always take the first node in RPO that needs to be processed
+    // and changes are propagated through the loop bodies before
+    // we get to the nodes after the loops
+    ADT::PrioritySet<unsigned, std::less<unsigned>> worklist;
+    for (unsigned i = 0; i < nodes.size(); ++i)
+        worklist.push(i);
 
-            // since changed was not empty,
-            // the to_process must not be empty too
-            assert(!to_process.empty());
+    // do fixpoint
+    while (!worklist.empty()) {
+        RDNode *cur = nodes[worklist.pop()];
+        if (processNode(cur)) {
+            for (RDNode *succ : cur->getSuccessors())
+                worklist.push(succ->rpoid);
         }
-    } while (!changed.empty());
+    }
 }
 
 } // namespace rd
@@ -141,7 +141,11 @@ public:
 template <typename V, bool ReverseLookup=true>
 class IntervalMap {
 
-    std::vector<std::pair<Interval, V>> buckets;
+public:
+    using Bucket = std::pair<Interval, V>;
+
+private:
+    std::vector<Bucket> buckets;
 
     /**
      * Returns true if @interval is subset of union of intervals in @intervals
@@ -234,28 +238,32 @@ public:
      * Searching stops as soon as satisfying set is found
      *
      * Return Tuple:
-     *      0 - values associated with key intervals
+     *      0 - values with their key intervals
      *      1 - key intervals that (partially) cover specified interval
      *      2 - true if @interval is fully covered by returned key interval set, false otherwise
      */
-    std::tuple<std::vector<V>, std::vector<Interval>, bool>
+    std::tuple<std::vector<Bucket>, std::vector<Interval>, bool>
         collect(const Interval& interval, const std::vector<detail::Interval>& covered) const {
 
-        std::vector<V> result;
+        std::vector<Bucket> result;
         DisjointIntervalSet intervals = covered;
         bool is_covered = false;
 
         static_assert(ReverseLookup, "forward lookup in IntervalMap is not yet supported");
         for (auto it = buckets.rbegin(); it != buckets.rend(); ++it) {
             if (interval.isUnknown() || it->first.isUnknown() || (it->first.overlaps(interval))) {
+                // the value is overwritten by the values found before
+                if (!it->first.isUnknown() && isCovered(it->first, intervals))
+                    continue;
                 intervals.insert(it->first);
-                result.push_back(it->second);
-                is_covered = isCovered(interval, intervals);
+                result.push_back(*it);
+                if (!interval.isUnknown() && isCovered(interval, intervals))
+                    break;
             }
         }
         is_covered = isCovered(interval, intervals);
 
-        return std::tuple<std::vector<V>, std::vector<Interval>, bool>(std::move(result), std::move(intervals.moveVector()), is_covered);
+        return std::tuple<std::vector<Bucket>, std::vector<Interval>, bool>(std::move(result), std::move(intervals.moveVector()), is_covered);
     }
 
     /**
@@ -274,6 +282,26 @@ public:
         return result;
     }
 
+    /**
+     * Returns all values (with their intervals) such, that @interval
+     * intersects with interval associated with each of values and
+     * the associated interval is not a subset of union of intervals in @covered
+     */
+    std::vector<Bucket> collectAll(const Interval& interval, const std::vector<Interval>& covered) const {
+        std::vector<Bucket> result;
+        DisjointIntervalSet intervals = covered;
+
+        static_assert(ReverseLookup, "forward lookup in IntervalMap is not yet supported");
+        for (auto it = buckets.rbegin(); it != buckets.rend(); ++it) {
+            if (interval.isUnknown() || it->first.isUnknown() || it->first.overlaps(interval)) {
+                if (!it->first.isUnknown() && isCovered(it->first, intervals))
+                    continue;
+                result.push_back(*it);
+            }
+        }
+        return result;
+    }
+
     auto begin() -> decltype(buckets.begin()) {
         return buckets.begin();
     }
@@ -288,6 +316,37 @@ public:
 
 };
 
+/**
+ * Returns the parts of @interval that are not covered by @covered.
+ * Unknown interval is returned as it is.
+ */
+inline std::vector<Interval> uncoveredParts(const Interval& interval, const std::vector<Interval>& covered) {
+    if (interval.isUnknown() || interval.getLength().isUnknown()) {
+        return {interval};
+    }
+
+    DisjointIntervalSet set = covered;
+    std::vector<Interval> sorted = set.toVector();
+    std::sort(sorted.begin(), sorted.end(), [](const Interval& a, const Interval& b) {
+        return a.getStart() < b.getStart();
+    });
+
+    std::vector<Interval> result;
+    Offset start = interval.getStart();
+    const Offset end = interval.getStart() + interval.getLength();
+    for (const Interval& cov : sorted) {
+        if (cov.isUnknown() || cov.getLength().isUnknown() || !cov.overlaps(interval))
+            continue;
+        if (start < cov.getStart())
+            result.emplace_back(start, cov.getStart() - start);
+        start = std::max(start, cov.getStart() + cov.getLength());
+    }
+    if (start < end)
+        result.emplace_back(start, end - start);
+
+    return result;
+}
+
 }
 }
 }
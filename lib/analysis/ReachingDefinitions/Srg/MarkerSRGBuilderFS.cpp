@@ -17,39 +17,62 @@ void MarkerSRGBuilderFS::writeVariableWeak(const DefSite& var, NodeT *assignment
     current_weak_def[var.target][block].add(concretize(detail::Interval{var.offset, var.len}, var.target->getSize()), assignment);
 }
 
-std::vector<MarkerSRGBuilderFS::NodeT *> MarkerSRGBuilderFS::readVariable(const DefSite& var, BlockT *read, BlockT *start, const Intervals& covered) {
+std::vector<MarkerSRGBuilderFS::SRGEdge> MarkerSRGBuilderFS::readVariable(const DefSite& var, BlockT *read, BlockT *start, const Intervals& covered) {
     assert( read );
     // use specialized method for unknown memory
     if (var.target == UNKNOWN_MEMORY) {
         std::unordered_map<NodeT *, detail::DisjointIntervalSet> found;
-        return std::vector<NodeT *> { readUnknown(read, found) };
+        return std::vector<SRGEdge> { SRGEdge(var, readUnknown(read, found)) };
     }
 
     auto& block_defs = current_def[var.target];
     auto it = block_defs.find(read);
-    std::vector<NodeT *> result;
+    std::vector<SRGEdge> result;
+    std::vector<detail::IntervalMap<NodeT *>::Bucket> defs;
     const auto interval = concretize(detail::Interval{var.offset, var.len}, var.target->getSize());
 
     // find weak defs
-    auto block_weak_defs = current_weak_def[var.target][read].collectAll(interval);
+    auto block_weak_defs = current_weak_def[var.target][read].collectAll(interval, covered);
     auto unknown_defs = current_weak_def[UNKNOWN_MEMORY][read].collectAll(interval);
 
     // find the last definition
     if (it != block_defs.end()) {
         Intervals cov;
         bool is_covered = false;
-        std::tie(result, cov, is_covered) = it->second.collect(interval, covered);
+        std::tie(defs, cov, is_covered) = it->second.collect(interval, covered);
         if (!is_covered && (!interval.isUnknown() || read != start)) {
-            NodeT *phi = readVariableRecursive(var, read, start, cov);
-            result.push_back(phi);
+            result = readUncovered(var, read, start, cov);
         }
     } else {
-        result.push_back(readVariableRecursive(var, read, start, covered));
+        result = readUncovered(var, read, start, covered);
+    }
+
+    // add the last definitions, weak defs & unknown weak defs
+    for (auto& def : defs) {
+        for (auto& part : partsOf(var, def.first, covered))
+            result.emplace_back(part, def.second);
     }
+    for (auto& def : block_weak_defs) {
+        for (auto& part : partsOf(var, def.first, covered))
+            result.emplace_back(part, def.second);
+    }
+    for (NodeT *def : unknown_defs)
+        result.emplace_back(var, def);
 
-    // add weak defs & unknown weak defs
-    std::move(block_weak_defs.begin(), block_weak_defs.end(), std::back_inserter(result));
-    std::move(unknown_defs.begin(), unknown_defs.end(), std::back_inserter(result));
+    return result;
+}
+
+std::vector<MarkerSRGBuilderFS::SRGEdge> MarkerSRGBuilderFS::readUncovered(const DefSite& var, BlockT *block, BlockT *start, const Intervals& covered) {
+    const auto interval = concretize(detail::Interval{var.offset, var.len}, var.target->getSize());
+    if (covered.empty() || interval.isUnknown() || interval.getLength().isUnknown()) {
+        return std::vector<SRGEdge> { SRGEdge(var, readVariableRecursive(var, block, start, covered)) };
+    }
+
+    std::vector<SRGEdge> result;
+    for (const auto& part : detail::uncoveredParts(interval, covered)) {
+        DefSite part_var(var.target, part.getStart(), part.getLength());
+        result.emplace_back(part_var, readVariableRecursive(part_var, block, start, Intervals()));
+    }
 
     return result;
 }
@@ -62,22 +85,24 @@ MarkerSRGBuilderFS::NodeT *MarkerSRGBuilderFS::addPhiOperands(const DefSite& var
     phi->addUse(var);
 
     for (BlockT *pred : block->predecessors()) {
-        std::vector<NodeT *> assignments;
+        std::vector<detail::IntervalMap<NodeT *>::Bucket> assignments;
         Intervals cov;
         bool is_covered = false;
 
         std::tie(assignments, cov, is_covered) = last_def[var.target][pred].collect(interval, covered);
         // add weak updates
-        auto weak_defs = last_weak_def[var.target][pred].collectAll(interval);
+        auto weak_defs = last_weak_def[var.target][pred].collectAll(interval, covered);
         std::move(weak_defs.begin(), weak_defs.end(), std::back_inserter(assignments));
 
-        if (!is_covered || (interval.isUnknown() && block != start)) {
-            std::vector<NodeT *> assignments2 = readVariable(var, pred, start, cov);
-            std::move(assignments2.begin(), assignments2.end(), std::back_inserter(assignments));
+        for (auto& assignment : assignments) {
+            for (auto& part : partsOf(var, assignment.first, covered))
+                insertSrgEdge(assignment.second, phi, part);
         }
 
-        for (auto& assignment : assignments)
-            insertSrgEdge(assignment, phi, var);
+        if (!is_covered || (interval.isUnknown() && block != start)) {
+            for (auto& edge : readVariable(var, pred, start, cov))
+                insertSrgEdge(edge.second, phi, edge.first);
+        }
     }
 
     return tryRemoveTrivialPhi(phi);
@@ -107,17 +132,17 @@ MarkerSRGBuilderFS::NodeT* MarkerSRGBuilderFS::tryRemoveTrivialPhi(NodeT *phi) {
         return phi;
     }
 
-    replacePhi(phi, same);
-
+    // remember the users before they are rerouted to @same
+    std::vector<NodeT *> users;
     auto users_it = reverse_srg.find(phi);
-    if (users_it == reverse_srg.end()) {
-        // no users...
-        return phi;
+    if (users_it != reverse_srg.end()) {
+        for (auto& edge : users_it->second)
+            users.push_back(edge.second);
     }
 
-    auto users = users_it->second;
-    for (auto& edge : users) {
-        NodeT* user = edge.second;
+    replacePhi(phi, same);
+
+    for (NodeT *user : users) {
         if (user != phi && user->getType() == RDNodeType::PHI) {
             tryRemoveTrivialPhi(user);
         }
@@ -135,23 +160,16 @@ void MarkerSRGBuilderFS::replacePhi(NodeT *phi, NodeT *replacement) {
         return;
     }
 
-    auto defs_it = srg.find(phi);
-    if (defs_it != srg.end()) {
-        auto& defs = defs_it->second;
-        for (auto& def_edge : defs) {
-            DefSite& var = def_edge.first;
-            NodeT *dest = def_edge.second;
-            removeSrgEdge(phi, dest, var);
-        }
-    }
+    // the operands of @phi are kept, @phi may still be the current
+    // definition in some block, so it must lead to the replacement
 
     auto uses = uses_it->second;
 
     for (auto& use_edge : uses) {
         DefSite var = use_edge.first;
-        NodeT *dest = use_edge.second;
-        removeSrgEdge(dest, phi, var);
-        insertSrgEdge(dest, replacement, var);
+        NodeT *user = use_edge.second;
+        removeSrgEdge(phi, user, var);
+        insertSrgEdge(replacement, user, var);
     }
 }
 
@@ -163,9 +181,11 @@ MarkerSRGBuilderFS::NodeT *MarkerSRGBuilderFS::readVariableRecursive(const DefSi
 
     phi->setBasicBlock(block);
     // writeVariableStrong kills current weak definitions, which are needed in the phi node, so we need to lookup them first.
-    auto weak_defs = current_weak_def[var.target][block].collectAll(interval);
-    for (auto& assignment : weak_defs)
-        insertSrgEdge(assignment, phi.get(), var);
+    auto weak_defs = current_weak_def[var.target][block].collectAll(interval, covered);
+    for (auto& assignment : weak_defs) {
+        for (auto& part : partsOf(var, assignment.first, covered))
+            insertSrgEdge(assignment.second, phi.get(), part);
+    }
 
     writeVariableStrong(var, phi.get(), block);
     NodeT *val = addPhiOperands(var, phi.get(), block, start, covered);
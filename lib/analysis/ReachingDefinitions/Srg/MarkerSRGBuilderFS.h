@@ -65,6 +65,13 @@ class MarkerSRGBuilderFS : public SparseRDGraphBuilder
      */
     NodeT *readVariableRecursive(const DefSite& var, BlockT *block, BlockT *start, const Intervals& covered);
 
+    /**
+     * Looks up definitions of the parts of @var that are not in @covered.
+     * Every part gets its own phi node, so the phi nodes join
+     * the definitions of exactly the memory they are created for.
+     */
+    std::vector<SRGEdge> readUncovered(const DefSite& var, BlockT *block, BlockT *start, const Intervals& covered);
+
     /*
      * If the interval has unknown offset or length, it is changed to contain everything.
      * Optional parameter @size makes it possible to concretize to variable size, in case the size is known.
@@ -79,15 +86,37 @@ class MarkerSRGBuilderFS : public SparseRDGraphBuilder
         return interval;
     }
 
-    std::vector<NodeT *> readVariable(const DefSite& var, BlockT *read, BlockT *start) {
+    /*
+     * The parts of @var that are in @interval (the interval of a definition)
+     * and are not in @covered.
+     */
+    std::vector<DefSite> partsOf(const DefSite& var, const detail::Interval& interval, const Intervals& covered) const {
+        if (var.offset.isUnknown() || interval.isUnknown() || interval.getLength().isUnknown()) {
+            return std::vector<DefSite> { var };
+        }
+        Offset start = std::max(var.offset, interval.getStart());
+        Offset end = std::min(var.offset + var.len, interval.getStart() + interval.getLength());
+        if (!(start < end)) {
+            return std::vector<DefSite> { var };
+        }
+
+        std::vector<DefSite> result;
+        for (const auto& part : detail::uncoveredParts(detail::Interval{start, end - start}, covered)) {
+            result.emplace_back(var.target, part.getStart(), part.getLength());
+        }
+        return result;
+    }
+
+    std::vector<SRGEdge> readVariable(const DefSite& var, BlockT *read, BlockT *start) {
         Intervals empty_vector;
         return readVariable(var, read, start, empty_vector);
     }
 
     /**
      * Lookup all definitions of @var in @read starting from @start.
+     * Returns the definitions with the part of @var they were found for.
      */
-    std::vector<NodeT *> readVariable(const DefSite& var, BlockT *read, BlockT *start, const Intervals& covered);
+    std::vector<SRGEdge> readVariable(const DefSite& var, BlockT *read, BlockT *start, const Intervals& covered);
     NodeT *readUnknown(BlockT *read, std::unordered_map<NodeT *, detail::DisjointIntervalSet>& found);
 
     NodeT *addPhiOperands(const DefSite& var, NodeT *phi, BlockT *block, BlockT *start, const Intervals& covered);
@@ -142,10 +171,10 @@ class MarkerSRGBuilderFS : public SparseRDGraphBuilder
         for (NodeT *node : block->getNodes()) {
             for (const DefSite& use : node->getUses()) {
                 // remember uses of unknown memory
-               std::vector<NodeT *> assignments = readVariable(use, block, block);
+               std::vector<SRGEdge> assignments = readVariable(use, block, block);
                 // add edge from last definition to here
-                for (NodeT *assignment : assignments) {
-                    insertSrgEdge(assignment, node, use);
+                for (auto& assignment : assignments) {
+                    insertSrgEdge(assignment.second, node, assignment.first);
                 }
             }
 
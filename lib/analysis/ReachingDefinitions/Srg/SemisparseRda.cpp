@@ -1,9 +1,13 @@
 #include "dg/analysis/ReachingDefinitions/SemisparseRda.h"
+#include "dg/ADT/Queue.h"
 
 #include "analysis/ReachingDefinitions/Srg/MarkerSRGBuilderFS.h"
 #include "analysis/ReachingDefinitions/Srg/SparseRDGraphBuilder.h"
 
-#include <unordered_set>
+#include <algorithm>
+#include <cassert>
+#include <set>
+#include <unordered_map>
 
 namespace dg {
 namespace analysis {
@@ -12,47 +16,295 @@ namespace rd {
 using SrgBuilder = dg::analysis::rd::srg::MarkerSRGBuilderFS;
 using SparseRDGraph = dg::analysis::rd::srg::SparseRDGraph;
 
-template< typename T >
-static void bfs(RDNode *from, SparseRDGraph& srg, T&& visitor) {
-    std::unordered_set<RDNode *> visited;
-    std::queue<RDNode *> q;
-    q.push(from);
-    visited.insert(from);
-
-    while (!q.empty()) {
-        RDNode *n = q.front();
-        q.pop();
-        auto edges_it = srg.find(n);
-        if (edges_it != srg.end()) {
-            auto& edges = edges_it->second;
-            for (auto& edge : edges) {
-                RDNode *src = edge.second;
-                if (visited.insert(src).second) {
-                    visitor(edge.first, edge.second);
-                    q.push(src);
+namespace {
+
+///
+// Strongly connected components of the PHI nodes of the sparse graph
+// (edges go from uses to definitions, we follow only the edges between
+// PHI nodes). The components are numbered in reverse topological
+// order, i.e., a component gets its number after all components
+// that are reachable from it.
+class SrgComponents {
+    const SparseRDGraph& srg;
+
+    std::unordered_map<RDNode *, unsigned> index;
+    std::vector<RDNode *> nodes;
+
+    enum : unsigned { NONE = ~0U };
+
+public:
+    std::vector<unsigned> component;
+    std::vector<std::vector<unsigned>> components;
+
+    SrgComponents(const SparseRDGraph& g) : srg(g) {
+        for (const auto& it : srg) {
+            if (it.first->getType() == RDNodeType::PHI)
+                addNode(it.first);
+        }
+
+        compute();
+    }
+
+    unsigned size() const { return nodes.size(); }
+
+    bool has(RDNode *n) const { return index.count(n) > 0; }
+
+    unsigned getIndex(RDNode *n) const {
+        assert(index.count(n) > 0 && "Not a PHI node of the graph");
+        return index.find(n)->second;
+    }
+
+    const std::vector<srg::SparseRDGraphBuilder::SRGEdge> *
+    getEdges(unsigned i) const {
+        auto it = srg.find(nodes[i]);
+        return it == srg.end() ? nullptr : &it->second;
+    }
+
+private:
+    void addNode(RDNode *n) {
+        if (index.emplace(n, nodes.size()).second)
+            nodes.push_back(n);
+    }
+
+    // iterative Tarjan's algorithm, the sparse graphs
+    // are too deep for the recursive one
+    void compute() {
+        std::vector<unsigned> dfsid(nodes.size(), NONE);
+        std::vector<unsigned> lowpt(nodes.size(), 0);
+        std::vector<bool> on_stack(nodes.size(), false);
+        std::vector<unsigned> stack;
+        // (node, index of the next edge)
+        std::vector<std::pair<unsigned, size_t>> dfs;
+        unsigned dfsnum = 0;
+
+        component.assign(nodes.size(), NONE);
+
+        for (unsigned start = 0; start < nodes.size(); ++start) {
+            if (dfsid[start] != NONE)
+                continue;
+
+            dfs.emplace_back(start, 0);
+            dfsid[start] = lowpt[start] = dfsnum++;
+            stack.push_back(start);
+            on_stack[start] = true;
+
+            while (!dfs.empty()) {
+                unsigned cur = dfs.back().first;
+                const auto *edges = getEdges(cur);
+                if (edges && dfs.back().second < edges->size()) {
+                    RDNode *succnode = (*edges)[dfs.back().second++].second;
+                    auto it = index.find(succnode);
+                    // not a PHI node (or a PHI node without operands)
+                    if (it == index.end())
+                        continue;
+
+                    unsigned succ = it->second;
+                    if (dfsid[succ] == NONE) {
+                        dfsid[succ] = lowpt[succ] = dfsnum++;
+                        stack.push_back(succ);
+                        on_stack[succ] = true;
+                        dfs.emplace_back(succ, 0);
+                    } else if (on_stack[succ]) {
+                        lowpt[cur] = std::min(lowpt[cur], dfsid[succ]);
+                    }
+                    continue;
+                }
+
+                dfs.pop_back();
+                if (!dfs.empty()) {
+                    unsigned parent = dfs.back().first;
+                    lowpt[parent] = std::min(lowpt[parent], lowpt[cur]);
+                }
+
+                if (lowpt[cur] == dfsid[cur]) {
+                    components.emplace_back();
+                    unsigned w;
+                    do {
+                        w = stack.back();
+                        stack.pop_back();
+                        on_stack[w] = false;
+                        component[w] = components.size() - 1;
+                        components.back().push_back(w);
+                    } while (w != cur);
                 }
             }
         }
-        visited.insert(n);
     }
+};
+
+// the definition @second reaches the memory @first
+using ReachingDef = std::pair<DefSite, RDNode *>;
+
+// get the memory that is in both @a and @b, return false if there is none
+static bool intersect(const DefSite& a, const DefSite& b, DefSite& out) {
+    if (a.target == UNKNOWN_MEMORY) {
+        out = b;
+        return true;
+    }
+    if (b.target == UNKNOWN_MEMORY) {
+        out = a;
+        return true;
+    }
+    if (a.target != b.target)
+        return false;
+    if (a.offset.isUnknown()) {
+        out = b;
+        return true;
+    }
+    if (b.offset.isUnknown()) {
+        out = a;
+        return true;
+    }
+
+    // unknown end is bigger than any other (and stays unknown in end - start)
+    Offset start = std::max(a.offset, b.offset);
+    Offset end = std::min(a.offset + a.len, b.offset + b.len);
+    if (!(start < end))
+        return false;
+
+    out = DefSite(a.target, start, end - start);
+    return true;
+}
+
+// add the definitions from @from that reach some of @ds to @to
+// (only for the memory of @ds), return true if @to changed
+static bool addReaching(std::set<ReachingDef>& to,
+                        const std::set<ReachingDef>& from,
+                        const DefSite& ds) {
+    bool changed = false;
+    DefSite mem(ds);
+    for (const auto& rd : from) {
+        if (intersect(rd.first, ds, mem))
+            changed |= to.emplace(mem, rd.second).second;
+    }
+
+    return changed;
 }
 
+// add the memory of @ds defined by @def to @to
+static void addDefinition(std::set<ReachingDef>& to, RDNode *def,
+                          const DefSite& ds) {
+    DefSite mem(ds);
+    for (const DefSite& d : def->getDefines()) {
+        if (intersect(d, ds, mem))
+            to.emplace(mem, def);
+    }
+}
+
+} // anonymous namespace
+
 void SemisparseRda::run()
 {
     SrgBuilder srg_builder;
     SparseRDGraph srg;
 
-    std::unordered_set<RDNode *> to_process;
     std::tie(srg, phi_nodes) = srg_builder.build(getRoot());
 
-    for (auto& pair : srg) {
-        RDNode *dest = pair.first;
-        if (dest->getUses().size() > 0 && dest->getType() != RDNodeType::PHI) {
-            bfs(dest, srg, [&](DefSite& ds, RDNode *n){
-                if (n->getType() != RDNodeType::PHI) {
-                    merge_maps(n, dest, ds);
+    // The definitions that reach a use are the definitions that are
+    // reachable from the use in the sparse graph via PHI nodes only.
+    // The builder does not go past the definitions that overwrite
+    // the memory, but a PHI node may be created for a bigger part
+    // of the memory than the nodes that read it (it is reused by
+    // the following reads in the block), so we remember for which
+    // memory a definition reaches a PHI node and every edge passes
+    // only the part of the memory on the edge.
+    // First we compute the definitions reaching the PHI nodes.
+    // The PHI nodes of a variable only point to the PHI nodes of
+    // the same variable, so the definitions of every variable are
+    // propagated separately, along the components of its PHI nodes
+    // in reverse topological order. The components without cycles
+    // are computed at once, the others with a worklist.
+    SrgComponents C(srg);
+    std::vector<std::set<ReachingDef>> reaching(C.size());
+
+    // the PHI nodes that use a PHI node from the same component
+    // (with the label of the edge)
+    std::vector<std::vector<std::pair<unsigned, DefSite>>> users(C.size());
+    for (unsigned i = 0; i < C.size(); ++i) {
+        for (const auto& edge : *C.getEdges(i)) {
+            if (C.has(edge.second)) {
+                unsigned j = C.getIndex(edge.second);
+                if (j != i && C.component[j] == C.component[i])
+                    users[j].emplace_back(i, edge.first);
+            }
+        }
+    }
+
+    // the definitions that were not propagated to the users yet
+    std::vector<std::set<ReachingDef>> changes(C.size());
+    for (const auto& component : C.components) {
+        for (unsigned m : component) {
+            auto& defs = reaching[m];
+            for (const auto& edge : *C.getEdges(m)) {
+                RDNode *def = edge.second;
+                if (def->getType() != RDNodeType::PHI) {
+                    addDefinition(defs, def, edge.first);
+                } else if (C.has(def)) {
+                    // PHI nodes without operands reach nothing
+                    unsigned j = C.getIndex(def);
+                    if (C.component[j] != C.component[m])
+                        addReaching(defs, reaching[j], edge.first);
                 }
-            });
+            }
+        }
+
+        if (component.size() == 1)
+            continue;
+
+        // propagate only the new definitions, so every definition
+        // goes over every edge of the component at most once
+        ADT::QueueFIFO<unsigned> worklist;
+        for (unsigned m : component) {
+            changes[m] = reaching[m];
+            worklist.push(m);
+        }
+
+        while (!worklist.empty()) {
+            unsigned m = worklist.pop();
+            std::set<ReachingDef> delta;
+            delta.swap(changes[m]);
+
+            DefSite mem(UNKNOWN_MEMORY);
+            for (const auto& user : users[m]) {
+                auto& udefs = reaching[user.first];
+                auto& uchanges = changes[user.first];
+                bool queued = !uchanges.empty();
+                for (const auto& rd : delta) {
+                    if (intersect(rd.first, user.second, mem) &&
+                        udefs.emplace(mem, rd.second).second)
+                        uchanges.emplace(mem, rd.second);
+                }
+
+                if (!queued && !uchanges.empty())
+                    worklist.push(user.first);
+            }
+        }
+    }
+
+    // now fill the maps of the uses
+    for (const auto& it : srg) {
+        RDNode *use = it.first;
+        if (use->getUses().empty() || use->getType() == RDNodeType::PHI)
+            continue;
+
+        // the edges are labeled with the memory that is read
+        // via the edge, so that is the memory the definitions reach
+        DefSite mem(UNKNOWN_MEMORY);
+        for (const auto& edge : it.second) {
+            RDNode *def = edge.second;
+            if (def->getType() != RDNodeType::PHI) {
+                for (const DefSite& ds : def->getDefines()) {
+                    if (intersect(ds, edge.first, mem)) {
+                        use->def_map.add(edge.first, def);
+                        break;
+                    }
+                }
+            } else if (C.has(def)) {
+                for (const auto& rd : reaching[C.getIndex(def)]) {
+                    if (intersect(rd.first, edge.first, mem))
+                        use->def_map.add(edge.first, rd.second);
+                }
+            }
         }
     }
 }
@@ -60,5 +312,3 @@ void SemisparseRda::run()
 } // namespace rd
 } // namespace analysis
 } // namespace dg
-
-
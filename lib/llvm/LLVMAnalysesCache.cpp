@@ -0,0 +1,688 @@
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "dg/llvm/LLVMAnalysesCache.h"
+#include "dg/llvm/analysis/PointsTo/PointerAnalysis.h"
+#include "dg/llvm/analysis/ReachingDefinitions/ReachingDefinitions.h"
+
+namespace dg {
+namespace llvmdg {
+
+using analysis::pta::PointerSubgraph;
+using analysis::rd::RDNode;
+using analysis::rd::RDMap;
+using analysis::rd::DefSite;
+
+namespace {
+
+// FNV-1a
+class Hasher {
+    uint64_t hash{14695981039346656037ULL};
+
+public:
+    void add(const void *data, size_t len) {
+        auto bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < len; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    void add(const std::string& str) {
+        add(str.data(), str.size());
+        // separate the strings
+        add("", 1);
+    }
+
+    void add(uint64_t val) { add(&val, sizeof(val)); }
+
+    uint64_t get() const { return hash; }
+};
+
+class Writer {
+    std::string buffer;
+
+public:
+    template <typename T>
+    void put(T val) {
+        buffer.append(reinterpret_cast<const char *>(&val), sizeof(T));
+    }
+
+    // write the data into a temporary file and rename it,
+    // so that readers never see a partially written file
+    bool save(const std::string& path) const {
+        std::string tmp = path + ".tmp." + std::to_string(getpid());
+        FILE *f = fopen(tmp.c_str(), "wb");
+        if (!f)
+            return false;
+
+        bool ok = fwrite(buffer.data(), 1, buffer.size(), f) == buffer.size();
+        ok &= fclose(f) == 0;
+        if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+            unlink(tmp.c_str());
+            return false;
+        }
+
+        return true;
+    }
+};
+
+// read-only mapping of a file into memory
+class MappedFile {
+    const char *data{nullptr};
+    size_t size{0};
+
+public:
+    MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *mem = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mem != MAP_FAILED) {
+                data = static_cast<const char *>(mem);
+                size = st.st_size;
+            }
+        }
+
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (data)
+            munmap(const_cast<char *>(data), size);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return data != nullptr; }
+    const char *begin() const { return data; }
+    const char *end() const { return data + size; }
+};
+
+// reads the values from the mapped file, after reading
+// past the end of the data, ok() returns false
+class Reader {
+    const char *pos;
+    const char *end;
+    bool _ok{true};
+
+public:
+    Reader(const char *b, const char *e) : pos(b), end(e) {}
+
+    template <typename T>
+    T get() {
+        T val{};
+        if (static_cast<size_t>(end - pos) < sizeof(T)) {
+            _ok = false;
+            pos = end;
+            return val;
+        }
+
+        memcpy(&val, pos, sizeof(T));
+        pos += sizeof(T);
+        return val;
+    }
+
+    const char *position() const { return pos; }
+    size_t remaining() const { return static_cast<size_t>(end - pos); }
+    bool ok() const { return _ok; }
+    bool atEnd() const { return pos == end; }
+};
+
+const char MAGIC[4] = {'D', 'G', 'A', 'C'};
+
+enum ResultsKind : uint32_t {
+    PTA_RESULTS = 1,
+    RD_RESULTS  = 2,
+};
+
+// the IDs of the special nodes (that are not in the graphs)
+enum : uint32_t {
+    NO_NODE      = ~0U,
+    UNKNOWN_NODE = ~0U - 1,
+    NULL_NODE    = ~0U - 2,
+    INVALIDATED_NODE = ~0U - 3,
+};
+
+// the type of a node that was removed from the graph
+const uint8_t REMOVED_NODE = 0xff;
+
+void writeHeader(Writer& W, uint32_t kind, uint64_t moduleHash, uint64_t optionsHash)
+{
+    for (char c : MAGIC)
+        W.put(c);
+    W.put<uint32_t>(LLVMAnalysesCache::VERSION);
+    W.put<uint32_t>(kind);
+    W.put<uint64_t>(moduleHash);
+    W.put<uint64_t>(optionsHash);
+}
+
+bool checkHeader(Reader& R, uint32_t kind, uint64_t moduleHash, uint64_t optionsHash)
+{
+    for (char c : MAGIC) {
+        if (R.get<char>() != c)
+            return false;
+    }
+
+    return R.get<uint32_t>() == LLVMAnalysesCache::VERSION &&
+           R.get<uint32_t>() == kind &&
+           R.get<uint64_t>() == moduleHash &&
+           R.get<uint64_t>() == optionsHash &&
+           R.ok();
+}
+
+uint64_t hashModule(const llvm::Module *M)
+{
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    M->print(os, nullptr);
+    os.flush();
+
+    Hasher H;
+    H.add(str);
+    return H.get();
+}
+
+void hashAnalysisOptions(Hasher& H, const analysis::AnalysisOptions& opts)
+{
+    H.add(*opts.fieldSensitivity);
+    for (const auto& it : opts.allocationFunctions) {
+        H.add(it.first);
+        H.add(static_cast<uint64_t>(it.second));
+    }
+}
+
+uint64_t hashOptions(const analysis::LLVMPointerAnalysisOptions& opts)
+{
+    Hasher H;
+    hashAnalysisOptions(H, opts);
+    H.add(opts.entryFunction);
+    H.add(static_cast<uint64_t>(opts.analysisType));
+    H.add(opts.threads);
+    H.add(opts.preprocessGeps);
+    H.add(opts.invalidateNodes);
+    H.add(opts.diffPropagation);
+    H.add(opts.collapseCycles);
+    H.add(opts.valueNumbering);
+    H.add(static_cast<uint64_t>(opts.ptSetRepresentation));
+    return H.get();
+}
+
+uint64_t hashOptions(const analysis::LLVMReachingDefinitionsAnalysisOptions& opts,
+                     uint64_t ptaOptionsHash)
+{
+    Hasher H;
+    // the results depend on the results of pointer analysis
+    H.add(ptaOptionsHash);
+    hashAnalysisOptions(H, opts);
+    H.add(opts.entryFunction);
+    H.add(static_cast<uint64_t>(opts.analysisType));
+    H.add(opts.strongUpdateUnknown);
+    H.add(opts.undefinedArePure);
+    H.add(*opts.maxSetSize);
+    H.add(opts.sparse);
+    H.add(opts.fieldInsensitive);
+    H.add(opts.intervalMaps);
+    H.add(opts.bitvectors);
+    H.add(opts.functionSummaries);
+    for (const auto& it : opts.functionModels) {
+        H.add(it.first);
+        for (const auto& def : it.second.getDefines()) {
+            H.add(def.first);
+            for (const auto *val : {&def.second.from, &def.second.to}) {
+                H.add(val->isOffset());
+                H.add(val->isOffset() ? *val->getOffset() : val->getOperand());
+            }
+        }
+    }
+    return H.get();
+}
+
+std::string toHex(uint64_t val)
+{
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(val));
+    return buf;
+}
+
+} // anonymous namespace
+
+LLVMAnalysesCache::LLVMAnalysesCache(const std::string& dir, const llvm::Module *M,
+                                     const analysis::LLVMPointerAnalysisOptions& ptaOpts,
+                                     const analysis::LLVMReachingDefinitionsAnalysisOptions& rdOpts)
+: _module(M),
+  _moduleHash(hashModule(M)),
+  _ptaOptionsHash(hashOptions(ptaOpts)),
+  _rdOptionsHash(hashOptions(rdOpts, _ptaOptionsHash)),
+  _intervalMaps(rdOpts.intervalMaps)
+{
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+        llvm::errs() << "WARNING: cannot create the cache directory "
+                     << dir << ": " << strerror(errno) << "\n";
+
+    _ptaFile = dir + "/" + toHex(_moduleHash) + "-" + toHex(_ptaOptionsHash) + ".pta";
+    _rdFile = dir + "/" + toHex(_moduleHash) + "-" + toHex(_rdOptionsHash) + ".rd";
+}
+
+/// ------------------------------------------------------------------
+// Pointer analysis
+//
+// calls:  u32 number, (u32 call-site ID, u32 function ID) * number
+// nodes:  u32 number, for every ID: u8 type, u32 size of the points-to set,
+//         (u32 target ID, u64 offset) * size
+/// ------------------------------------------------------------------
+
+static uint32_t ptaTargetID(const PointerSubgraph *PS, PSNode *target)
+{
+    using namespace analysis::pta;
+
+    if (target == UNKNOWN_MEMORY)
+        return UNKNOWN_NODE;
+    if (target == NULLPTR)
+        return NULL_NODE;
+    if (target == INVALIDATED)
+        return INVALIDATED_NODE;
+
+    unsigned id = target->getID();
+    if (id >= PS->size() || PS->getNodes()[id].get() != target)
+        return NO_NODE;
+    return id;
+}
+
+static PSNode *ptaTarget(const PointerSubgraph *PS, uint32_t id)
+{
+    using namespace analysis::pta;
+
+    switch (id) {
+    case UNKNOWN_NODE: return UNKNOWN_MEMORY;
+    case NULL_NODE: return NULLPTR;
+    case INVALIDATED_NODE: return INVALIDATED;
+    default:
+        return id < PS->size() ? PS->getNodes()[id].get() : nullptr;
+    }
+}
+
+bool LLVMAnalysesCache::storePTA(const LLVMPointerAnalysis& PTA) const
+{
+    const PointerSubgraph *PS = PTA.getPS();
+    if (!PS)
+        return false;
+
+    Writer W;
+    writeHeader(W, PTA_RESULTS, _moduleHash, _ptaOptionsHash);
+
+    const auto& calls = PTA.getFunctionPointerCalls();
+    W.put<uint32_t>(calls.size());
+    for (const auto& call : calls) {
+        W.put<uint32_t>(call.first);
+        W.put<uint32_t>(call.second);
+    }
+
+    const auto& nodes = PS->getNodes();
+    W.put<uint32_t>(nodes.size());
+    for (const auto& nd : nodes) {
+        if (!nd) {
+            W.put<uint8_t>(REMOVED_NODE);
+            W.put<uint32_t>(0);
+            continue;
+        }
+
+        W.put<uint8_t>(static_cast<uint8_t>(nd->getType()));
+        W.put<uint32_t>(nd->pointsTo.size());
+        for (const auto& ptr : nd->pointsTo) {
+            auto id = ptaTargetID(PS, ptr.target);
+            // the target is not in the graph, we would not find it again
+            if (id == NO_NODE)
+                return false;
+            W.put<uint32_t>(id);
+            W.put<uint64_t>(*ptr.offset);
+        }
+    }
+
+    return W.save(_ptaFile);
+}
+
+// check the points-to sets of the nodes against the graph (fill == false)
+// or fill them in (fill == true)
+static bool readPointsTo(Reader R, const PointerSubgraph *PS, bool fill)
+{
+    const auto& nodes = PS->getNodes();
+    if (R.get<uint32_t>() != nodes.size())
+        return false;
+
+    for (const auto& nd : nodes) {
+        auto type = R.get<uint8_t>();
+        auto size = R.get<uint32_t>();
+        if (!R.ok())
+            return false;
+
+        if (!nd) {
+            if (type != REMOVED_NODE || size != 0)
+                return false;
+            continue;
+        }
+
+        if (type != static_cast<uint8_t>(nd->getType()))
+            return false;
+
+        for (uint32_t i = 0; i < size; ++i) {
+            PSNode *target = ptaTarget(PS, R.get<uint32_t>());
+            auto offset = R.get<uint64_t>();
+            if (!target || !R.ok())
+                return false;
+            if (fill)
+                nd->addPointsTo(target, offset);
+        }
+    }
+
+    return R.atEnd();
+}
+
+bool LLVMAnalysesCache::loadPTA(LLVMPointerAnalysis& PTA, bool invalidateNodes) const
+{
+    MappedFile F(_ptaFile);
+    if (!F.isOpen())
+        return false;
+
+    Reader R(F.begin(), F.end());
+    if (!checkHeader(R, PTA_RESULTS, _moduleHash, _ptaOptionsHash))
+        return false;
+
+    // do not trust the number before we know that the file
+    // is big enough (the file may be corrupted)
+    auto num = R.get<uint32_t>();
+    if (!R.ok() || R.remaining() / (2 * sizeof(uint32_t)) < num)
+        return false;
+
+    std::vector<std::pair<unsigned, unsigned>> calls(num);
+    for (auto& call : calls) {
+        call.first = R.get<uint32_t>();
+        call.second = R.get<uint32_t>();
+    }
+
+    if (!R.ok())
+        return false;
+
+    // check the whole file before we change the points-to sets,
+    // the calls can be checked only when inserting them
+    if (!PTA.rebuildSubgraph(calls, invalidateNodes) ||
+        !readPointsTo(R, PTA.getPS(), false)) {
+        // the graph may contain some of the calls now, but the analysis
+        // would insert them again, so it must start with a fresh graph
+        PTA.resetSubgraph();
+        return false;
+    }
+
+    return readPointsTo(R, PTA.getPS(), true);
+}
+
+/// ------------------------------------------------------------------
+// Reaching definitions
+//
+// keys:   u32 number, for every node (in the order of getNodes()):
+//         u32 index of the value that the node was created for,
+//         u32 the number of nodes created for the value before this node,
+//         u8 type
+// maps:   for every node (in the same order): u32 number of def-sites,
+//         for every def-site: u32 target, u64 offset, u64 length,
+//         u32 number of definitions, u32 definition * number
+//         (the nodes are referred to by their position in the keys)
+//
+// The values are numbered in the order of the module: globals, then
+// for every function the function, its blocks and their instructions.
+// The order of getNodes() depends on the order of edges, which is not
+// the same when the graph is built in parallel, the keys are.
+/// ------------------------------------------------------------------
+
+using NodeKey = std::pair<uint32_t, uint32_t>;
+
+struct NodeKeyHash {
+    size_t operator()(const NodeKey& key) const {
+        return std::hash<uint64_t>()((static_cast<uint64_t>(key.first) << 32) | key.second);
+    }
+};
+
+// get the keys of the nodes of the graph, returns false
+// if some node does not have a key
+static bool getNodeKeys(const llvm::Module *M,
+                        const analysis::rd::LLVMReachingDefinitions& RD,
+                        std::unordered_map<const RDNode *, NodeKey>& keys)
+{
+    std::unordered_map<const llvm::Value *, uint32_t> indices;
+    auto number = [&indices](const llvm::Value *val) {
+        indices.emplace(val, indices.size());
+    };
+
+    for (const llvm::GlobalVariable& G : M->globals())
+        number(&G);
+    for (const llvm::Function& F : *M) {
+        number(&F);
+        for (const llvm::BasicBlock& B : F) {
+            number(&B);
+            for (const llvm::Instruction& I : B)
+                number(&I);
+        }
+    }
+
+    // the number of nodes created for the value so far
+    std::unordered_map<const llvm::Value *, uint32_t> created;
+    for (const auto& it : RD.getNodeValues()) {
+        auto idx = indices.find(it.first);
+        if (idx == indices.end())
+            return false;
+        keys.emplace(it.second, NodeKey(idx->second, created[it.first]++));
+    }
+
+    return true;
+}
+
+bool LLVMAnalysesCache::storeRD(analysis::rd::LLVMReachingDefinitions& RD) const
+{
+    std::unordered_map<const RDNode *, NodeKey> keys;
+    if (!getNodeKeys(_module, RD, keys))
+        return false;
+
+    const auto nodes = RD.getNodes();
+    std::unordered_map<const RDNode *, uint32_t> ids;
+    ids.reserve(nodes.size());
+    for (uint32_t i = 0; i < nodes.size(); ++i)
+        ids.emplace(nodes[i], i);
+
+    auto getID = [&ids](const RDNode *n) -> uint32_t {
+        if (n == analysis::rd::UNKNOWN_MEMORY)
+            return UNKNOWN_NODE;
+        auto it = ids.find(n);
+        return it == ids.end() ? NO_NODE : it->second;
+    };
+
+    Writer W;
+    writeHeader(W, RD_RESULTS, _moduleHash, _rdOptionsHash);
+
+    W.put<uint32_t>(nodes.size());
+    for (RDNode *n : nodes) {
+        auto it = keys.find(n);
+        // we would not find the node again
+        if (it == keys.end())
+            return false;
+
+        W.put<uint32_t>(it->second.first);
+        W.put<uint32_t>(it->second.second);
+        W.put<uint8_t>(static_cast<uint8_t>(n->getType()));
+    }
+
+    for (RDNode *n : nodes) {
+        const RDMap& map = RD.getReachingDefinitions(n);
+        uint32_t num = 0;
+        for (auto it = map.begin(), et = map.end(); it != et; ++it)
+            ++num;
+
+        W.put<uint32_t>(num);
+        for (auto it = map.begin(), et = map.end(); it != et; ++it) {
+            const auto& entry = *it;
+            auto target = getID(entry.first.target);
+            if (target == NO_NODE)
+                return false;
+
+            W.put<uint32_t>(target);
+            W.put<uint64_t>(*entry.first.offset);
+            W.put<uint64_t>(*entry.first.len);
+            W.put<uint32_t>(entry.second.size());
+            for (RDNode *def : entry.second) {
+                auto id = getID(def);
+                if (id == NO_NODE)
+                    return false;
+                W.put<uint32_t>(id);
+            }
+        }
+    }
+
+    return W.save(_rdFile);
+}
+
+// find the nodes of the graph in the order of the file,
+// returns false if the file does not match the graph
+static bool readNodes(Reader& R, const llvm::Module *M,
+                      analysis::rd::LLVMReachingDefinitions& RD,
+                      std::vector<RDNode *>& nodes)
+{
+    std::unordered_map<const RDNode *, NodeKey> keys;
+    if (!getNodeKeys(M, RD, keys))
+        return false;
+
+    const auto graphNodes = RD.getNodes();
+    std::unordered_map<NodeKey, RDNode *, NodeKeyHash> byKey;
+    byKey.reserve(graphNodes.size());
+    for (RDNode *n : graphNodes) {
+        auto it = keys.find(n);
+        if (it == keys.end())
+            return false;
+        byKey.emplace(it->second, n);
+    }
+
+    auto num = R.get<uint32_t>();
+    if (!R.ok() || num != graphNodes.size())
+        return false;
+
+    nodes.reserve(num);
+    for (uint32_t i = 0; i < num; ++i) {
+        NodeKey key;
+        key.first = R.get<uint32_t>();
+        key.second = R.get<uint32_t>();
+        auto type = R.get<uint8_t>();
+        if (!R.ok())
+            return false;
+
+        auto it = byKey.find(key);
+        if (it == byKey.end() || type != static_cast<uint8_t>(it->second->getType()))
+            return false;
+
+        nodes.push_back(it->second);
+        // every node of the graph must be in the file once
+        byKey.erase(it);
+    }
+
+    return true;
+}
+
+// check the maps of the nodes against the graph (fill == false)
+// or fill them in (fill == true)
+static bool readDefinitions(Reader R, const std::vector<RDNode *>& nodes,
+                            bool intervalMaps, bool fill,
+                            analysis::rd::LLVMReachingDefinitions& RD)
+{
+    auto getNode = [&nodes](uint32_t id) -> RDNode * {
+        if (id == UNKNOWN_NODE)
+            return analysis::rd::UNKNOWN_MEMORY;
+        return id < nodes.size() ? nodes[id] : nullptr;
+    };
+
+    for (RDNode *n : nodes) {
+        auto num = R.get<uint32_t>();
+        if (!R.ok())
+            return false;
+
+        RDMap map;
+        if (intervalMaps)
+            map.useIntervals();
+
+        for (uint32_t i = 0; i < num; ++i) {
+            RDNode *target = getNode(R.get<uint32_t>());
+            auto offset = R.get<uint64_t>();
+            auto len = R.get<uint64_t>();
+            auto defs = R.get<uint32_t>();
+            if (!target || !R.ok())
+                return false;
+
+            DefSite ds(target, offset, len);
+            for (uint32_t j = 0; j < defs; ++j) {
+                RDNode *def = getNode(R.get<uint32_t>());
+                if (!def || !R.ok())
+                    return false;
+                if (fill)
+                    map.add(ds, def);
+            }
+        }
+
+        if (fill)
+            RD.getReachingDefinitions(n) = std::move(map);
+    }
+
+    return R.atEnd();
+}
+
+bool LLVMAnalysesCache::loadRD(analysis::rd::LLVMReachingDefinitions& RD) const
+{
+    MappedFile F(_rdFile);
+    if (!F.isOpen())
+        return false;
+
+    Reader R(F.begin(), F.end());
+    if (!checkHeader(R, RD_RESULTS, _moduleHash, _rdOptionsHash))
+        return false;
+
+    std::vector<RDNode *> nodes;
+    if (!readNodes(R, _module, RD, nodes))
+        return false;
+
+    // check the whole file before we change anything
+    if (!readDefinitions(R, nodes, _intervalMaps, false, RD))
+        return false;
+
+    return readDefinitions(R, nodes, _intervalMaps, true, RD);
+}
+
+} // namespace llvmdg
+} // namespace dg
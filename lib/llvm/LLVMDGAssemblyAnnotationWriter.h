@@ -148,8 +148,8 @@ private:
                 os << "  ; RD: no mapping\n";
             } else {
                 auto& defs = rd->getReachingDefinitions();
-                for (auto& it : defs) {
-                    for (auto& nd : it.second) {
+                for (const auto& it : defs) {
+                    for (auto nd : it.second) {
                         printDefSite(it.first, os, "RD: ");
                         os << " @ ";
                         if (nd->isUnknown())
@@ -1014,60 +1014,163 @@ bool LLVMDependenceGraph::getCallSites(const std::vector<std::string>& names,
     return callsites->size() != 0;
 }
 
+void LLVMDependenceGraph::computeControlDependencies(CD_ALG alg_type,
+                                                     bool terminSensitive)
+{
+    for (auto& F : getConstructedFunctions())
+        F.second->computeFunctionControlDependencies(alg_type, terminSensitive);
+}
+
 void LLVMDependenceGraph::computeControlExpression(bool addCDs)
+{
+    for (auto& F : getConstructedFunctions())
+        F.second->computeFunctionControlExpression(addCDs);
+}
+
+void LLVMDependenceGraph::computeFunctionControlExpression(bool addCDs)
 {
     LLVMCFABuilder builder;
 
-    for (auto& F : getConstructedFunctions()) {
-        llvm::Function *func = llvm::cast<llvm::Function>(F.first);
-        LLVMCFA cfa = builder.build(*func);
-
-        CE = cfa.compute();
-
-        if (addCDs) {
-            // compute the control scope
-            CE.computeSets();
-            auto& our_blocks = F.second->getBlocks();
-
-            for (llvm::BasicBlock& B : *func) {
-                LLVMBBlock *B1 = our_blocks[&B];
-
-                // if this block is a predicate block,
-                // we compute the control deps for it
-                // XXX: for now we compute the control
-                // scope, which is enough for slicing,
-                // but may add some extra (transitive)
-                // edges
-                if (B.getTerminator()->getNumSuccessors() > 1) {
-                    auto CS = CE.getControlScope(&B);
-                    for (auto cs : CS) {
-                        assert(cs->isa(CENodeType::LABEL));
-                        auto lab = static_cast<CELabel<llvm::BasicBlock *> *>(cs);
-                        LLVMBBlock *B2 = our_blocks[lab->getLabel()];
-                        B1->addControlDependence(B2);
-                    }
+    llvm::Function *func = llvm::cast<llvm::Function>(getEntry()->getKey());
+    LLVMCFA cfa = builder.build(*func);
+
+    CE = cfa.compute();
+
+    if (addCDs) {
+        // compute the control scope
+        CE.computeSets();
+        auto& our_blocks = getBlocks();
+
+        for (llvm::BasicBlock& B : *func) {
+            LLVMBBlock *B1 = our_blocks[&B];
+
+            // if this block is a predicate block,
+            // we compute the control deps for it
+            // XXX: for now we compute the control
+            // scope, which is enough for slicing,
+            // but may add some extra (transitive)
+            // edges
+            if (B.getTerminator()->getNumSuccessors() > 1) {
+                auto CS = CE.getControlScope(&B);
+                for (auto cs : CS) {
+                    assert(cs->isa(CENodeType::LABEL));
+                    auto lab = static_cast<CELabel<llvm::BasicBlock *> *>(cs);
+                    LLVMBBlock *B2 = our_blocks[lab->getLabel()];
+                    B1->addControlDependence(B2);
                 }
             }
         }
     }
 }
 
+namespace {
+
+using dg::analysis::pta::PSNode;
+
+///
+// Stores of one thread region bucketed by the memory objects
+// that they may write to, so that a load is compared only
+// with the stores that write to some object that the load reads.
+class StoresIndex {
+    struct Write {
+        const llvm::Instruction *store;
+        dg::analysis::Offset offset;
+
+        Write(const llvm::Instruction *s, dg::analysis::Offset o)
+        : store(s), offset(o) {}
+    };
+
+    std::unordered_map<PSNode *, std::vector<Write>> buckets;
+    size_t storesNum{0};
+
+public:
+    void add(dg::LLVMPointerAnalysis *PTA, const llvm::Instruction *store) {
+        ++storesNum;
+        // if the pointer has no points-to set, we do not know
+        // where the store writes and it interferes with nothing
+        // (the same as when comparing the pairs one by one)
+        auto storeOperand = PTA->getPointsTo(store->getOperand(1));
+        if (!storeOperand)
+            return;
+
+        for (const auto& pointer : storeOperand->pointsTo)
+            buckets[pointer.target].emplace_back(store, pointer.offset);
+    }
+
+    size_t size() const { return storesNum; }
+    bool empty() const { return storesNum == 0; }
+
+    // gather the stores that may write to some object pointed by 'loadOperand'
+    // to 'candidates' and the stores that may write the same bytes to 'matching'
+    void find(const PSNode *loadOperand,
+              std::set<const llvm::Instruction *>& candidates,
+              std::set<const llvm::Instruction *>& matching) const {
+        for (const auto& pointer : loadOperand->pointsTo) {
+            auto it = buckets.find(pointer.target);
+            if (it == buckets.end())
+                continue;
+
+            for (const auto& write : it->second) {
+                candidates.insert(write.store);
+                if (pointer.offset.isUnknown() ||
+                    write.offset.isUnknown() ||
+                    pointer.offset == write.offset)
+                    matching.insert(write.store);
+            }
+        }
+    }
+};
+
+} // anonymous namespace
+
 void LLVMDependenceGraph::computeInterferenceDependentEdges(ControlFlowGraph * controlFlowGraph)
 {
     auto regions = controlFlowGraph->threadRegions();
     MayHappenInParallel mayHappenInParallel(regions);
 
-    for (const auto &currentRegion : regions) {
-        auto llvmValuesForCurrentRegion     = currentRegion->llvmInstructions();
-        auto currentRegionLoads             = getLoadInstructions(llvmValuesForCurrentRegion);
-        auto currentRegionStores            = getStoreInstructions(llvmValuesForCurrentRegion);
-        auto parallelRegions                = mayHappenInParallel.parallelRegions(currentRegion);
-        for (const auto &parallelRegion : parallelRegions) {
-            auto llvmInstructionsForParallelRegion      = parallelRegion->llvmInstructions();
-            auto parallelRegionLoads                    = getLoadInstructions(llvmInstructionsForParallelRegion);
-            auto parallelRegionStores                   = getStoreInstructions(llvmInstructionsForParallelRegion);
-                computeInterferenceDependentEdges(currentRegionLoads, parallelRegionStores);
-                computeInterferenceDependentEdges(parallelRegionLoads, currentRegionStores);
+    // gather the loads and index the stores of every region only once
+    // (indexed by the indices of the regions in MHP)
+    const auto regionsNum = mayHappenInParallel.regionsNum();
+    std::vector<std::set<const llvm::Instruction *>> loads(regionsNum);
+    std::vector<StoresIndex> stores(regionsNum);
+    auto regionsWithStores = mayHappenInParallel.emptyRow();
+    for (unsigned i = 0; i < regionsNum; ++i) {
+        auto llvmInstructions = mayHappenInParallel.region(i)->llvmInstructions();
+        loads[i] = getLoadInstructions(llvmInstructions);
+        for (auto store : getStoreInstructions(llvmInstructions))
+            stores[i].add(PTA, store);
+        if (!stores[i].empty())
+            mayHappenInParallel.addToRow(regionsWithStores, i);
+    }
+
+    // MHP is symmetric, so pairing the loads of every region with the stores
+    // of the regions that may run in parallel with it covers both directions
+    std::set<const llvm::Instruction *> candidates;
+    std::set<const llvm::Instruction *> matching;
+    for (unsigned i = 0; i < regionsNum; ++i) {
+        if (loads[i].empty())
+            continue;
+
+        auto parallel = mayHappenInParallel.parallelRegions(i, regionsWithStores);
+        for (const auto &load : loads[i]) {
+            auto loadOperand = PTA->getPointsTo(load->getOperand(0));
+            for (auto j : parallel) {
+                interferenceStatistics.pairsTotal += stores[j].size();
+                if (!loadOperand) {
+                    interferenceStatistics.pairsPruned += stores[j].size();
+                    continue;
+                }
+
+                candidates.clear();
+                matching.clear();
+                stores[j].find(loadOperand, candidates, matching);
+
+                interferenceStatistics.pairsChecked += candidates.size();
+                interferenceStatistics.pairsPruned += stores[j].size() - candidates.size();
+
+                for (const auto &store : matching)
+                    addInterferenceDependence(load, store);
+            }
         }
     }
 }
@@ -1113,36 +1216,19 @@ void LLVMDependenceGraph::computeCriticalSections(ControlFlowGraph *controlFlowG
     }
 }
 
-void LLVMDependenceGraph::computeInterferenceDependentEdges(const std::set<const llvm::Instruction *> &loads,
-                                                            const std::set<const llvm::Instruction *> &stores) {
-    for (const auto &load :loads) {
-        for (const auto &store : stores) {
-            auto loadOperand = PTA->getPointsTo(load->getOperand(0));
-            auto storeOperand = PTA->getPointsTo(store->getOperand(1));
-            if (loadOperand && storeOperand) { // if storeOperand does not have pointsTo, expect it can write anywhere??
-                for (const auto pointerLoad : loadOperand->pointsTo) {
-                    for (const auto pointerStore : storeOperand->pointsTo) {
-                        if (pointerLoad.target == pointerStore.target &&
-                            (pointerLoad.offset.isUnknown()  ||
-                             pointerStore.offset.isUnknown() ||
-                             pointerLoad.offset == pointerStore.offset)) {
-                            llvm::Instruction *loadInst = const_cast<llvm::Instruction *>(load);
-                            llvm::Instruction *storeInst = const_cast<llvm::Instruction *>(store);
-                            //auto loadFunction = constructedFunctions.find(const_cast<llvm::Function *>(load->getFunction()));
-                            auto loadFunction = constructedFunctions.find(const_cast<llvm::Function *>(load->getParent()->getParent()));
-                            //auto storeFunction = constructedFunctions.find(const_cast<llvm::Function *>(store->getFunction()));
-                            auto storeFunction = constructedFunctions.find(const_cast<llvm::Function *>(store->getParent()->getParent()));
-                            if (loadFunction != constructedFunctions.end() && storeFunction != constructedFunctions.end()) {
-                                auto loadNode = loadFunction->second->findNode(loadInst);
-                                auto storeNode = storeFunction->second->findNode(storeInst);
-                                if (loadNode && storeNode) {
-                                    storeNode->addInterferenceDependence(loadNode);
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+void LLVMDependenceGraph::addInterferenceDependence(const llvm::Instruction *load,
+                                                    const llvm::Instruction *store) {
+    llvm::Instruction *loadInst = const_cast<llvm::Instruction *>(load);
+    llvm::Instruction *storeInst = const_cast<llvm::Instruction *>(store);
+    //auto loadFunction = constructedFunctions.find(const_cast<llvm::Function *>(load->getFunction()));
+    auto loadFunction = constructedFunctions.find(const_cast<llvm::Function *>(load->getParent()->getParent()));
+    //auto storeFunction = constructedFunctions.find(const_cast<llvm::Function *>(store->getFunction()));
+    auto storeFunction = constructedFunctions.find(const_cast<llvm::Function *>(store->getParent()->getParent()));
+    if (loadFunction != constructedFunctions.end() && storeFunction != constructedFunctions.end()) {
+        auto loadNode = loadFunction->second->findNode(loadInst);
+        auto storeNode = storeFunction->second->findNode(storeInst);
+        if (loadNode && storeNode) {
+            storeNode->addInterferenceDependence(loadNode);
         }
     }
 }
@@ -1221,26 +1307,28 @@ void LLVMDependenceGraph::addNoreturnDependencies(LLVMNode *noret, LLVMBBlock *f
 
 void LLVMDependenceGraph::addNoreturnDependencies()
 {
-    for (auto& F : getConstructedFunctions()) {
-        auto& blocks = F.second->getBlocks();
+    for (auto& F : getConstructedFunctions())
+        F.second->addFunctionNoreturnDependencies();
+}
 
-        for (auto& it : blocks) {
-            LLVMBBlock *B = it.second;
-            std::set<LLVMNode *> noreturns;
-            for (auto node : B->getNodes()) {
-                // add dependencies for the found no returns
-                for (auto nrt : noreturns) {
-                    nrt->addControlDependence(node);
-                }
+void LLVMDependenceGraph::addFunctionNoreturnDependencies()
+{
+    for (auto& it : getBlocks()) {
+        LLVMBBlock *B = it.second;
+        std::set<LLVMNode *> noreturns;
+        for (auto node : B->getNodes()) {
+            // add dependencies for the found no returns
+            for (auto nrt : noreturns) {
+                nrt->addControlDependence(node);
+            }
 
-                if (auto params = node->getParameters()) {
-                    if (auto noret = params->getNoReturn()) {
-                        // process the rest of the block
-                        noreturns.insert(noret);
+            if (auto params = node->getParameters()) {
+                if (auto noret = params->getNoReturn()) {
+                    // process the rest of the block
+                    noreturns.insert(noret);
 
-                        // process reachable nodes
-                        addNoreturnDependencies(noret, B);
-                    }
+                    // process reachable nodes
+                    addNoreturnDependencies(noret, B);
                 }
             }
         }
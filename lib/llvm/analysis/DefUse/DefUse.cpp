@@ -453,4 +453,10 @@ bool LLVMDefUseAnalysis::runOnNode(LLVMNode *node, LLVMNode *)
     return false;
 }
 
+void LLVMDefUseAnalysis::runOnGraph(LLVMDependenceGraph *graph)
+{
+    for (auto& it : graph->getBlocks())
+        runOnBlock(it.second);
+}
+
 } // namespace dg
@@ -1,8 +1,11 @@
 #ifndef _LLVM_DG_RD_BUILDER_H
 #define _LLVM_DG_RD_BUILDER_H
 
+#include <chrono>
+#include <string>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -23,6 +26,7 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include "dg/ADT/Arena.h"
 #include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
 #include "dg/llvm/analysis/ReachingDefinitions/LLVMReachingDefinitionsAnalysisOptions.h"
 #include "dg/llvm/analysis/PointsTo/PointerAnalysis.h"
@@ -33,6 +37,11 @@ namespace rd {
 
 class LLVMRDBuilder
 {
+public:
+    // times of the phases of building the graph
+    using PhaseTimesT = std::vector<std::pair<std::string,
+                                              std::chrono::steady_clock::duration>>;
+
 protected:
     const llvm::Module *M;
     const llvm::DataLayout *DL;
@@ -50,6 +59,9 @@ protected:
     // points-to information
     dg::LLVMPointerAnalysis *PTA;
 
+    // all the nodes that we created
+    ADT::ArenaOwner<RDNode> nodes_storage;
+
     // map of all nodes we created - use to look up operands
     std::unordered_map<const llvm::Value *, RDNode *> nodes_map;
 
@@ -64,9 +76,25 @@ protected:
 
     // map of all built subgraphs - the value type is a pair (root, return)
     std::unordered_map<const llvm::Value *, Subgraph> subgraphs_map;
-    // list of dummy nodes (used just to keep the track of memory,
-    // so that we can delete it later)
+    // list of dummy nodes
     std::vector<RDNode *> dummy_nodes;
+    // the values that the nodes were created for (also the dummy nodes),
+    // a value may have more nodes (e.g., a call and the return from
+    // the call), those are in the order in which they were created
+    std::vector<std::pair<const llvm::Value *, RDNode *>> node_values;
+
+    PhaseTimesT phase_times;
+
+    RDNode *newNode(RDNodeType t) {
+        return nodes_storage.create(t);
+    }
+
+    template <typename FuncT>
+    void measurePhase(const char *name, FuncT&& f) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        phase_times.emplace_back(name, std::chrono::steady_clock::now() - start);
+    }
 
 public:
     LLVMRDBuilder(const llvm::Module *m,
@@ -77,24 +105,7 @@ public:
     virtual ~LLVMRDBuilder() {
         // delete data layout
         delete DL;
-
-        // delete artificial nodes from subgraphs
-        for (auto& it : subgraphs_map) {
-            assert((it.second.root && it.second.ret) ||
-                   (!it.second.root && !it.second.ret));
-            delete it.second.root;
-            delete it.second.ret;
-        }
-
-        // delete nodes
-        for (auto& it : nodes_map) {
-            assert(it.first && "Have a nullptr node mapping");
-            delete it.second;
-        }
-
-        // delete dummy nodes
-        for (RDNode *nd : dummy_nodes)
-            delete nd;
+        // the nodes are deleted with nodes_storage
     }
 
     virtual ReachingDefinitionsGraph build() = 0;
@@ -106,6 +117,11 @@ public:
     const std::unordered_map<const llvm::Value *, RDNode *>&
                                 getMapping() const { return mapping; }
 
+    const PhaseTimesT& getPhaseTimes() const { return phase_times; }
+
+    const std::vector<std::pair<const llvm::Value *, RDNode *>>&
+                                getNodeValues() const { return node_values; }
+
     RDNode *getMapping(const llvm::Value *val)
     {
         auto it = mapping.find(val);
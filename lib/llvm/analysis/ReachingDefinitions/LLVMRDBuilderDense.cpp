@@ -1,5 +1,7 @@
+#include <atomic>
 #include <set>
 #include <cassert>
+#include <mutex>
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -35,6 +37,7 @@
 
 
 #include "dg/llvm/analysis/PointsTo/PointerSubgraph.h"
+#include "dg/util/ThreadPool.h"
 
 #include "llvm/analysis/ReachingDefinitions/LLVMRDBuilderDense.h"
 #include "llvm/llvm-utils.h"
@@ -53,21 +56,128 @@ static inline void makeEdge(RDNode *src, RDNode *dst)
     src->addSuccessor(dst);
 }
 
+///
+// Building of the graphs of functions in parallel. Every function is built
+// by a single thread that keeps the nodes it creates in its own arena
+// and the mapping of values to nodes in the context of the function.
+// The nodes of memory objects and the subgraphs of all functions
+// are created beforehand, so the threads only read the shared maps.
+// Edges between different functions are added once all functions are built.
+struct LLVMRDBuilderDense::ThreadContext {
+    ADT::ArenaOwner<RDNode> nodes_storage;
+    // DataLayout caches the layouts of structures, so it must not be shared
+    llvm::DataLayout DL;
+
+    ThreadContext(const llvm::Module *M) : DL(M) {}
+};
+
+struct LLVMRDBuilderDense::FunctionContext {
+    const llvm::Function *F;
+    ThreadContext *thread{nullptr};
+
+    std::unordered_map<const llvm::Value *, RDNode *> nodes_map;
+    std::unordered_map<const llvm::Value *, RDNode *> mapping;
+    std::vector<RDNode *> dummy_nodes;
+    std::vector<std::pair<const llvm::Value *, RDNode *>> node_values;
+    // edges that may lead to other functions
+    std::vector<std::pair<RDNode *, RDNode *>> call_edges;
+
+    FunctionContext(const llvm::Function *F) : F(F) {}
+};
+
+thread_local LLVMRDBuilderDense::FunctionContext *LLVMRDBuilderDense::_ctx = nullptr;
+
+LLVMRDBuilderDense::LLVMRDBuilderDense(const llvm::Module *m,
+                                       dg::LLVMPointerAnalysis *p,
+                                       const LLVMReachingDefinitionsAnalysisOptions& opts,
+                                       bool buildUses)
+    : LLVMRDBuilder(m, p, opts), buildUses(buildUses) {
+    if (opts.functionSummaries && !opts.threads)
+        summaries.reset(new RDFunctionSummaries(opts));
+}
+
+LLVMRDBuilderDense::~LLVMRDBuilderDense() = default;
+
+RDNode *LLVMRDBuilderDense::newNode(RDNodeType t)
+{
+    if (_ctx)
+        return _ctx->thread->nodes_storage.create(t);
+    return nodes_storage.create(t);
+}
+
+RDNode *LLVMRDBuilderDense::getNode(const llvm::Value *val)
+{
+    if (_ctx) {
+        auto it = _ctx->nodes_map.find(val);
+        if (it != _ctx->nodes_map.end())
+            return it->second;
+    }
+
+    return LLVMRDBuilder::getNode(val);
+}
+
+void LLVMRDBuilderDense::addNode(const llvm::Value *val, RDNode *node)
+{
+    auto& map = _ctx ? _ctx->nodes_map : nodes_map;
+    auto it = map.find(val);
+    assert(it == map.end() && "Adding a node that we already have");
+    assert((!_ctx || nodes_map.count(val) == 0) && "Adding a node that we already have");
+
+    map.emplace_hint(it, val, node);
+    node->setUserData(const_cast<llvm::Value *>(val));
+    (_ctx ? _ctx->node_values : node_values).emplace_back(val, node);
+}
+
+void LLVMRDBuilderDense::addDummyNode(const llvm::Value *val, RDNode *node)
+{
+    (_ctx ? _ctx->dummy_nodes : dummy_nodes).push_back(node);
+    (_ctx ? _ctx->node_values : node_values).emplace_back(val, node);
+}
+
+void LLVMRDBuilderDense::addArtificialNode(const llvm::Value *val, RDNode *node)
+{
+    node->setUserData(const_cast<llvm::Value *>(val));
+    addDummyNode(val, node);
+}
+
+void LLVMRDBuilderDense::addMapping(const llvm::Value *val, RDNode *node)
+{
+    auto& map = _ctx ? _ctx->mapping : mapping;
+    auto it = map.find(val);
+    assert(it == map.end() && "Adding mapping that we already have");
+
+    map.emplace_hint(it, val, node);
+}
+
+void LLVMRDBuilderDense::makeCallEdge(RDNode *src, RDNode *dst)
+{
+    // the nodes of other functions may be being built by other threads
+    if (_ctx)
+        _ctx->call_edges.emplace_back(src, dst);
+    else
+        makeEdge(src, dst);
+}
+
+const llvm::DataLayout *LLVMRDBuilderDense::getDataLayout() const
+{
+    return _ctx ? &_ctx->thread->DL : DL;
+}
+
 RDNode *LLVMRDBuilderDense::createAlloc(const llvm::Instruction *Inst)
 {
-    RDNode *node = new RDNode(RDNodeType::ALLOC);
-    auto iterator = nodes_map.find(Inst);
-    if (iterator == nodes_map.end()) {
+    RDNode *node = newNode(RDNodeType::ALLOC);
+    RDNode *existing = getNode(Inst);
+    if (!existing) {
         addNode(Inst, node);
     } else {
-        assert(iterator->second->getType() == RDNodeType::CALL && "Adding node we already have");
+        assert(existing->getType() == RDNodeType::CALL && "Adding node we already have");
         addArtificialNode(Inst, node);
-        makeEdge(iterator->second, node);
+        makeEdge(existing, node);
     }
 
     if (const llvm::AllocaInst *AI
             = llvm::dyn_cast<llvm::AllocaInst>(Inst))
-        node->setSize(getAllocatedSize(AI, DL));
+        node->setSize(getAllocatedSize(AI, getDataLayout()));
 
     return node;
 }
@@ -76,12 +186,12 @@ RDNode *LLVMRDBuilderDense::createDynAlloc(const llvm::Instruction *Inst, Alloca
 {
     using namespace llvm;
 
-    RDNode *node = new RDNode(RDNodeType::DYN_ALLOC);
-    auto iterator = nodes_map.find(Inst);
-    if (iterator == nodes_map.end()) {
+    RDNode *node = newNode(RDNodeType::DYN_ALLOC);
+    RDNode *existing = getNode(Inst);
+    if (!existing) {
         addNode(Inst, node);
     } else {
-        assert(iterator->second->getType() == RDNodeType::CALL && "Adding node we already have");
+        assert(existing->getType() == RDNodeType::CALL && "Adding node we already have");
         addArtificialNode(Inst, node);
     }
 
@@ -120,12 +230,12 @@ RDNode *LLVMRDBuilderDense::createDynAlloc(const llvm::Instruction *Inst, Alloca
 
 RDNode *LLVMRDBuilderDense::createRealloc(const llvm::Instruction *Inst)
 {
-    RDNode *node = new RDNode(RDNodeType::DYN_ALLOC);
-    auto iterator = nodes_map.find(Inst);
-    if (iterator == nodes_map.end()) {
+    RDNode *node = newNode(RDNodeType::DYN_ALLOC);
+    RDNode *existing = getNode(Inst);
+    if (!existing) {
         addNode(Inst, node);
     } else {
-        assert(iterator->second->getType() == RDNodeType::CALL && "Adding node we already have");
+        assert(existing->getType() == RDNodeType::CALL && "Adding node we already have");
         addArtificialNode(Inst, node);
     }
 
@@ -179,7 +289,7 @@ static void getLocalVariables(const llvm::Function *F,
 
 RDNode *LLVMRDBuilderDense::createReturn(const llvm::Instruction *Inst)
 {
-    RDNode *node = new RDNode(RDNodeType::RETURN);
+    RDNode *node = newNode(RDNodeType::RETURN);
     addNode(Inst, node);
 
     // FIXME: don't do that for every return instruction,
@@ -238,10 +348,10 @@ RDNode *LLVMRDBuilderDense::createNode(const llvm::Instruction &Inst)
 
 RDNode *LLVMRDBuilderDense::createStore(const llvm::Instruction *Inst)
 {
-    RDNode *node = new RDNode(RDNodeType::STORE);
+    RDNode *node = newNode(RDNodeType::STORE);
     addNode(Inst, node);
 
-    uint64_t size = getAllocatedSize(Inst->getOperand(0)->getType(), DL);
+    uint64_t size = getAllocatedSize(Inst->getOperand(0)->getType(), getDataLayout());
     if (size == 0)
         size = Offset::UNKNOWN;
 
@@ -280,10 +390,10 @@ RDNode *LLVMRDBuilderDense::createStore(const llvm::Instruction *Inst)
 
 RDNode *LLVMRDBuilderDense::createLoad(const llvm::Instruction *Inst)
 {
-    RDNode *node = new RDNode(RDNodeType::LOAD);
+    RDNode *node = newNode(RDNodeType::LOAD);
     addNode(Inst, node);
 
-    uint64_t size = getAllocatedSize(Inst->getType(), DL);
+    uint64_t size = getAllocatedSize(Inst->getType(), getDataLayout());
     if (size == 0)
         size = Offset::UNKNOWN;
 
@@ -352,10 +462,10 @@ LLVMRDBuilderDense::buildBlock(const llvm::BasicBlock& block)
 
     // the first node is dummy and serves as a phi from previous
     // blocks so that we can have proper mapping
-    RDNode *node = new RDNode(RDNodeType::PHI);
+    RDNode *node = newNode(RDNodeType::PHI);
     RDNode *last_node = node;
 
-    addNode(node);
+    addDummyNode(&block, node);
     std::pair<RDNode *, RDNode *> ret(node, nullptr);
 
     for (const Instruction& Inst : block) {
@@ -456,14 +566,14 @@ LLVMRDBuilderDense::createCallToFunction(const llvm::Function *F,
     RDNode *callNode = nullptr;
     RDNode *returnNode = nullptr;
 
-    auto iterator = nodes_map.find(CInst);
-    if (iterator == nodes_map.end()) {
-        callNode = new RDNode(RDNodeType::CALL);
-        returnNode = new RDNode(RDNodeType::RETURN);
+    RDNode *existing = getNode(CInst);
+    if (!existing) {
+        callNode = newNode(RDNodeType::CALL);
+        returnNode = newNode(RDNodeType::RETURN);
         addNode(CInst, callNode);
-        addNode(returnNode);
+        addDummyNode(CInst, returnNode);
     } else {
-        assert(iterator->second->getType() == RDNodeType::CALL && "Adding node we already have");
+        assert(existing->getType() == RDNodeType::CALL && "Adding node we already have");
     }
 
     // FIXME: if this is an inline assembly call
@@ -477,6 +587,9 @@ LLVMRDBuilderDense::createCallToFunction(const llvm::Function *F,
     RDNode *root, *ret;
     auto it = subgraphs_map.find(F);
     if (it == subgraphs_map.end()) {
+        // when building in parallel, the subgraphs
+        // of all called functions have been created
+        assert(!_ctx && "Do not have the subgraph of a called function");
         // create a new subgraph
         std::tie(root, ret) = buildFunction(*F);
     } else {
@@ -486,30 +599,76 @@ LLVMRDBuilderDense::createCallToFunction(const llvm::Function *F,
 
     assert(root && ret && "Incomplete subgraph");
 
+    if (summaries) {
+        // the call-site is connected to the function once
+        // the summaries are computed and the definitions from
+        // the function get to the call-site only via the summary.
+        // For calls via pointers, the call node is created by the caller
+        RDNode *call = callNode ? callNode : existing;
+        RDNode *summaryNode = returnNode;
+        if (!summaryNode) {
+            summaryNode = newNode(RDNodeType::RETURN);
+            addDummyNode(CInst, summaryNode);
+        }
+
+        const llvm::Function *caller = CInst->getParent()->getParent();
+        assert(summary_functions.count(caller) > 0);
+        assert(summary_functions.count(F) > 0);
+        // the call is registered only in the function of the caller,
+        // so this is safe also when building the functions in parallel
+        summaries->addCall(summary_functions.at(caller), call,
+                           summaryNode, summary_functions.at(F));
+
+        if (callNode) {
+            makeEdge(callNode, returnNode);
+            return {callNode, returnNode};
+        }
+
+        return {summaryNode, summaryNode};
+    }
+
     if (callNode) {
-        makeEdge(callNode, root);
-        makeEdge(ret, returnNode);
+        makeCallEdge(callNode, root);
+        makeCallEdge(ret, returnNode);
         return {callNode, returnNode};
     }
 
     return {root, ret};
 }
 
-std::pair<RDNode *, RDNode *>
-LLVMRDBuilderDense::buildFunction(const llvm::Function& F)
+LLVMRDBuilder::Subgraph
+LLVMRDBuilderDense::createSubgraph(const llvm::Function& F)
 {
-    // here we'll keep first and last nodes of every built block and
-    // connected together according to successors
-    std::map<const llvm::BasicBlock *, std::pair<RDNode *, RDNode *>> built_blocks;
-
     // create root and (unified) return nodes of this subgraph. These are
     // just for our convenience when building the graph, they can be
     // optimized away later since they are noops
-    RDNode *root = new RDNode(RDNodeType::NOOP);
-    RDNode *ret = new RDNode(RDNodeType::NOOP);
+    RDNode *root = newNode(RDNodeType::NOOP);
+    RDNode *ret = newNode(RDNodeType::NOOP);
+    addDummyNode(&F, root);
+    addDummyNode(&F, ret);
 
     // emplace new subgraph to avoid looping with recursive functions
     subgraphs_map.emplace(&F, Subgraph(root, ret));
+    if (summaries)
+        summary_functions.emplace(&F, summaries->addFunction(root, ret));
+
+    return Subgraph(root, ret);
+}
+
+std::pair<RDNode *, RDNode *>
+LLVMRDBuilderDense::buildFunction(const llvm::Function& F)
+{
+    Subgraph subg = createSubgraph(F);
+    buildFunctionBody(F, subg);
+    return {subg.root, subg.ret};
+}
+
+void LLVMRDBuilderDense::buildFunctionBody(const llvm::Function& F,
+                                           const Subgraph& subg)
+{
+    // here we'll keep first and last nodes of every built block and
+    // connected together according to successors
+    std::map<const llvm::BasicBlock *, std::pair<RDNode *, RDNode *>> built_blocks;
 
     RDNode *first = nullptr;
     for (const llvm::BasicBlock& block : F) {
@@ -522,7 +681,7 @@ LLVMRDBuilderDense::buildFunction(const llvm::Function& F)
     }
 
     assert(first);
-    makeEdge(root, first);
+    makeEdge(subg.root, first);
 
     std::vector<RDNode *> rets;
     for (const llvm::BasicBlock& block : F) {
@@ -547,21 +706,19 @@ LLVMRDBuilderDense::buildFunction(const llvm::Function& F)
 
     // add successors edges from every real return to our artificial ret node
     for (RDNode *r : rets)
-        makeEdge(r, ret);
-
-    return {root, ret};
+        makeEdge(r, subg.ret);
 }
 
 RDNode *LLVMRDBuilderDense::createUndefinedCall(const llvm::CallInst *CInst)
 {
     using namespace llvm;
 
-    RDNode *node = new RDNode(RDNodeType::CALL);
-    auto iterator = nodes_map.find((CInst));
-    if (iterator == nodes_map.end()) {
+    RDNode *node = newNode(RDNodeType::CALL);
+    RDNode *existing = getNode(CInst);
+    if (!existing) {
         addNode(CInst, node);
     } else {
-        assert(iterator->second->getType() == RDNodeType::CALL && "Adding node we already have");
+        assert(existing->getType() == RDNodeType::CALL && "Adding node we already have");
         addArtificialNode(CInst, node);
     }
 
@@ -662,7 +819,7 @@ RDNode *LLVMRDBuilderDense::createIntrinsicCall(const llvm::CallInst *CInst)
             // we create this node because this nodes works
             // as ALLOC in points-to, so we can have
             // reaching definitions to that
-            ret = new RDNode(RDNodeType::CALL);
+            ret = newNode(RDNodeType::CALL);
             ret->addDef(ret, 0, Offset::UNKNOWN);
             addNode(CInst, ret);
             return ret;
@@ -670,7 +827,7 @@ RDNode *LLVMRDBuilderDense::createIntrinsicCall(const llvm::CallInst *CInst)
             return createUndefinedCall(CInst);
     }
 
-    ret = new RDNode(RDNodeType::CALL);
+    ret = newNode(RDNodeType::CALL);
     addNode(CInst, ret);
 
     auto pts = PTA->getLLVMPointsToChecked(dest);
@@ -717,7 +874,7 @@ RDNode *LLVMRDBuilderDense::createIntrinsicCall(const llvm::CallInst *CInst)
 }
 
 RDNode *LLVMRDBuilderDense::funcFromModel(const FunctionModel *model, const llvm::CallInst *CInst) {
-    RDNode *node = new RDNode(RDNodeType::CALL);
+    RDNode *node = newNode(RDNodeType::CALL);
     for (unsigned int i = 0; i < CInst->getNumArgOperands(); ++i) {
         auto defines = model->defines(i);
         if (!defines)
@@ -760,12 +917,11 @@ LLVMRDBuilderDense::createCall(const llvm::Instruction *Inst)
     using namespace llvm;
     const CallInst *CInst = cast<CallInst>(Inst);
     const Value *calledVal = CInst->getCalledValue()->stripPointerCasts();
-    static bool warned_inline_assembly = false;
+    static std::atomic<bool> warned_inline_assembly{false};
 
     if (CInst->isInlineAsm()) {
-        if (!warned_inline_assembly) {
+        if (!warned_inline_assembly.exchange(true)) {
             llvm::errs() << "WARNING: RD: Inline assembler found\n";
-            warned_inline_assembly = true;
         }
         RDNode *node = createUndefinedCall(CInst);
         return {node, node};
@@ -816,17 +972,17 @@ LLVMRDBuilderDense::createCallToFunctions(const std::vector<const llvm::Function
 {
     using namespace std;
 
-    RDNode *callNode = new RDNode(RDNodeType::CALL);
-    RDNode *returnNode = new RDNode(RDNodeType::RETURN);
+    RDNode *callNode = newNode(RDNodeType::CALL);
+    RDNode *returnNode = newNode(RDNodeType::RETURN);
     addNode(CInst, callNode);
-    addNode(returnNode);
+    addDummyNode(CInst, returnNode);
 
     bool hasFunction = false;
     for(const llvm::Function *function : functions) {
         auto func = createCallToFunction(function, CInst);
         if (func.first && func.second) {
-            makeEdge(callNode, func.first);
-            makeEdge(func.second, returnNode);
+            makeCallEdge(callNode, func.first);
+            makeCallEdge(func.second, returnNode);
             hasFunction |= true;
         }
     }
@@ -848,12 +1004,12 @@ LLVMRDBuilderDense::createPthreadCreateCalls(const llvm::CallInst *CInst)
 {
     using namespace llvm;
 
-    RDNode *rootNode = new RDNode(RDNodeType::FORK);
-    auto iterator = nodes_map.find(CInst);
-    if (iterator == nodes_map.end()) {
+    RDNode *rootNode = newNode(RDNodeType::FORK);
+    RDNode *existing = getNode(CInst);
+    if (!existing) {
         addNode(CInst, rootNode);
     } else {
-        assert(iterator->second->getType() == RDNodeType::CALL && "Adding node we already have");
+        assert(existing->getType() == RDNodeType::CALL && "Adding node we already have");
         addArtificialNode(CInst, rootNode);
     }
     threadCreateCalls.emplace(CInst, rootNode);
@@ -905,11 +1061,21 @@ ReachingDefinitionsGraph LLVMRDBuilderDense::build()
     }
 
     // first we must build globals, because nodes can use them as operands
-    std::pair<RDNode *, RDNode *> glob = buildGlobals();
+    std::pair<RDNode *, RDNode *> glob;
+    measurePhase("globals", [&] { glob = buildGlobals(); });
 
     // now we can build rest of the graph
     RDNode *root, *ret;
-    std::tie(root, ret) = buildFunction(*F);
+    if (_options.buildThreads > 1 && !_options.threads) {
+        buildFunctionsParallel(*F);
+        const auto& subg = subgraphs_map[F];
+        root = subg.root;
+        ret = subg.ret;
+    } else {
+        measurePhase("functions", [&] {
+            std::tie(root, ret) = buildFunction(*F);
+        });
+    }
     assert(root && "Do not have a root node of a function");
     assert(ret && "Do not have a ret node of a function");
 
@@ -929,12 +1095,165 @@ ReachingDefinitionsGraph LLVMRDBuilderDense::build()
         matchForksAndJoins();
     }
 
+    if (summaries) {
+        measurePhase("summaries", [&] { summaries->compute(); });
+    }
+
     ReachingDefinitionsGraph graph;
     graph.setRoot(root);
 
     return graph;
 }
 
+///
+// Get the defined functions whose subgraphs are used by the call
+// (this must follow what createCall() does)
+std::vector<const llvm::Function *>
+LLVMRDBuilderDense::getCalledFunctions(const llvm::CallInst *CInst)
+{
+    using namespace llvm;
+
+    std::vector<const Function *> ret;
+    if (CInst->isInlineAsm())
+        return ret;
+
+    const Value *calledVal = CInst->getCalledValue()->stripPointerCasts();
+    std::vector<const Function *> functions;
+    if (const Function *F = dyn_cast<Function>(calledVal))
+        functions.push_back(F);
+    else
+        functions = PTA->getPointsToFunctions(calledVal);
+
+    for (const Function *F : functions) {
+        if (F->size() > 0 && !_options.getFunctionModel(F->getName()) &&
+            llvmutils::callIsCompatible(F, CInst))
+            ret.push_back(F);
+    }
+
+    return ret;
+}
+
+///
+// Do everything that the threads building the functions
+// would have to do on shared data: find the functions reachable
+// from the entry, create their subgraphs, create the nodes of memory
+// objects and make the pointer analysis create the nodes for constants
+// (it does so lazily when queried). Returns the reachable functions.
+std::vector<const llvm::Function *>
+LLVMRDBuilderDense::prepareFunctions(const llvm::Function& entry)
+{
+    using namespace llvm;
+
+    std::vector<const Function *> functions{&entry};
+    std::set<const Function *> seen{&entry};
+
+    auto queryPTA = [this](const Value *val) {
+        if (isa<Constant>(val))
+            PTA->getPointsTo(val);
+    };
+
+    for (size_t i = 0; i < functions.size(); ++i) {
+        const Function *F = functions[i];
+        createSubgraph(*F);
+
+        for (const BasicBlock& block : *F) {
+            for (const Instruction& Inst : block) {
+                if (isa<AllocaInst>(&Inst)) {
+                    getOperand(&Inst);
+                } else if (const StoreInst *SI = dyn_cast<StoreInst>(&Inst)) {
+                    queryPTA(SI->getPointerOperand());
+                } else if (const LoadInst *LI = dyn_cast<LoadInst>(&Inst)) {
+                    if (buildUses)
+                        queryPTA(LI->getPointerOperand());
+                } else if (const CallInst *CInst = dyn_cast<CallInst>(&Inst)) {
+                    if (!isRelevantCall(CInst, _options))
+                        continue;
+
+                    const Value *calledVal
+                        = CInst->getCalledValue()->stripPointerCasts();
+                    if (!isa<Function>(calledVal))
+                        queryPTA(calledVal);
+                    for (unsigned n = 0; n < CInst->getNumArgOperands(); ++n)
+                        queryPTA(CInst->getArgOperand(n));
+
+                    // memory allocated by the call
+                    const Function *callee = dyn_cast<Function>(calledVal);
+                    if (callee && callee->size() == 0 &&
+                        !_options.getFunctionModel(callee->getName()) &&
+                        (_options.isAllocationFunction(callee->getName()) ||
+                         callee->getIntrinsicID() == Intrinsic::vastart))
+                        getOperand(CInst);
+
+                    for (const Function *called : getCalledFunctions(CInst)) {
+                        if (seen.insert(called).second)
+                            functions.push_back(called);
+                    }
+                }
+            }
+        }
+    }
+
+    // pointers may point also to the memory allocated in the functions
+    // that we do not build (e.g., the functions that are called only
+    // via pointers that we did not resolve). The threads would create
+    // the nodes of such memory each in their own map, so create all
+    // memory objects that the pointer analysis knows about here
+    for (const auto& nd : PTA->getNodes()) {
+        if (!nd || (nd->getType() != pta::PSNodeType::ALLOC &&
+                    nd->getType() != pta::PSNodeType::DYN_ALLOC))
+            continue;
+
+        const Value *val = nd->getUserData<Value>();
+        if (val && isa<Instruction>(val) && !getNode(val))
+            getOperand(val);
+    }
+
+    return functions;
+}
+
+void LLVMRDBuilderDense::buildFunctionsParallel(const llvm::Function& entry)
+{
+    std::vector<const llvm::Function *> functions;
+    measurePhase("prepare", [&] { functions = prepareFunctions(entry); });
+
+    ThreadPool pool(_options.buildThreads);
+    for (unsigned i = 0; i < pool.size(); ++i)
+        thread_contexts.emplace_back(new ThreadContext(M));
+
+    std::vector<FunctionContext> contexts(functions.begin(), functions.end());
+    measurePhase("functions", [&] {
+        pool.parallelFor(contexts.size(), [&](size_t i, unsigned tid) {
+            FunctionContext& ctx = contexts[i];
+            ctx.thread = thread_contexts[tid].get();
+
+            _ctx = &ctx;
+            buildFunctionBody(*ctx.F, subgraphs_map.at(ctx.F));
+            _ctx = nullptr;
+        });
+    });
+
+    // stitch the functions together (in the order of the functions,
+    // so that the result does not depend on the scheduling)
+    measurePhase("stitch", [&] {
+        for (FunctionContext& ctx : contexts) {
+            for (auto& it : ctx.nodes_map) {
+                assert(nodes_map.count(it.first) == 0);
+                nodes_map.emplace(it.first, it.second);
+            }
+            for (auto& it : ctx.mapping) {
+                assert(mapping.count(it.first) == 0);
+                mapping.emplace(it.first, it.second);
+            }
+            dummy_nodes.insert(dummy_nodes.end(),
+                               ctx.dummy_nodes.begin(), ctx.dummy_nodes.end());
+            node_values.insert(node_values.end(),
+                               ctx.node_values.begin(), ctx.node_values.end());
+            for (auto& edge : ctx.call_edges)
+                makeEdge(edge.first, edge.second);
+        }
+    });
+}
+
 std::pair<RDNode *, RDNode *> LLVMRDBuilderDense::buildGlobals()
 {
     RDNode *cur = nullptr, *prev, *first = nullptr;
@@ -942,7 +1261,7 @@ std::pair<RDNode *, RDNode *> LLVMRDBuilderDense::buildGlobals()
         prev = cur;
 
         // every global node is like memory allocation
-        cur = new RDNode(RDNodeType::ALLOC);
+        cur = newNode(RDNodeType::ALLOC);
         addNode(&*I, cur);
 
         if (prev)
@@ -1009,6 +1328,8 @@ std::vector<DefSite> LLVMRDBuilderDense::mapPointers(const llvm::Value *where,
             // keeping such set is faster then printing it all to terminal
             // ... and we don't flood the terminal that way
             static std::set<const llvm::Value *> warned;
+            static std::mutex warned_mtx;
+            std::lock_guard<std::mutex> lock(warned_mtx);
             if (warned.insert(ptr.value).second) {
                 llvm::errs() << "[RD] error for " << *val << "\n";
                 llvm::errs() << "[RD] error: Haven't created the node for the pointer to:\n";
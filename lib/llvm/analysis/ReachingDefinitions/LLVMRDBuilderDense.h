@@ -1,6 +1,7 @@
 #ifndef _LLVM_DG_RD_DENSE_H_
 #define _LLVM_DG_RD_DENSE_H_
 
+#include <memory>
 #include <vector>
 #include <unordered_map>
 
@@ -24,6 +25,7 @@
 #endif
 
 #include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
+#include "dg/analysis/ReachingDefinitions/RDFunctionSummaries.h"
 #include "llvm/analysis/ReachingDefinitions/LLVMRDBuilder.h"
 
 namespace dg {
@@ -35,12 +37,12 @@ public:
     LLVMRDBuilderDense(const llvm::Module *m,
                        dg::LLVMPointerAnalysis *p,
                        const LLVMReachingDefinitionsAnalysisOptions& opts,
-                       bool buildUses = false)
-        : LLVMRDBuilder(m, p, opts), buildUses(buildUses) {}
-    virtual ~LLVMRDBuilderDense() = default;
+                       bool buildUses = false);
+    virtual ~LLVMRDBuilderDense();
 
     ReachingDefinitionsGraph build() override;
 
+    RDNode *getNode(const llvm::Value *val);
     RDNode *getOperand(const llvm::Value *val);
     RDNode *createNode(const llvm::Instruction& Inst);
 
@@ -49,35 +51,16 @@ private:
                                      const llvm::Value *val,
                                      Offset size);
 
-    void addNode(const llvm::Value *val, RDNode *node)
-    {
-        auto it = nodes_map.find(val);
-        assert(it == nodes_map.end() && "Adding a node that we already have");
-
-        nodes_map.emplace_hint(it, val, node);
-        node->setUserData(const_cast<llvm::Value *>(val));
-    }
-
-    ///
-    // Add a dummy node for which there's no real LLVM node
-    void addNode(RDNode *node)
-    {
-        dummy_nodes.push_back(node);
-    }
-
-    void addArtificialNode(const llvm::Value *val, RDNode *node)
-    {
-        node->setUserData(const_cast<llvm::Value *>(val));
-        dummy_nodes.push_back(node);
-    }
-
-    void addMapping(const llvm::Value *val, RDNode *node)
-    {
-        auto it = mapping.find(val);
-        assert(it == mapping.end() && "Adding mapping that we already have");
-
-        mapping.emplace_hint(it, val, node);
-    }
+    RDNode *newNode(RDNodeType t);
+    void addNode(const llvm::Value *val, RDNode *node);
+    // Add a dummy node for which there's no real LLVM node,
+    // @val is the value that the node was created for
+    void addDummyNode(const llvm::Value *val, RDNode *node);
+    void addArtificialNode(const llvm::Value *val, RDNode *node);
+    void addMapping(const llvm::Value *val, RDNode *node);
+    // add an edge that may lead to a node of another function
+    void makeCallEdge(RDNode *src, RDNode *dst);
+    const llvm::DataLayout *getDataLayout() const;
 
     RDNode *createStore(const llvm::Instruction *Inst);
     RDNode *createLoad(const llvm::Instruction *Inst);
@@ -90,6 +73,8 @@ private:
     RDNode *funcFromModel(const FunctionModel *model, const llvm::CallInst *);
     std::pair<RDNode *, RDNode *> buildBlock(const llvm::BasicBlock& block);
     std::pair<RDNode *, RDNode *> buildFunction(const llvm::Function& F);
+    Subgraph createSubgraph(const llvm::Function& F);
+    void buildFunctionBody(const llvm::Function& F, const Subgraph& subg);
 
     std::pair<RDNode *, RDNode *> buildGlobals();
 
@@ -113,8 +98,26 @@ private:
 
     bool buildUses{false};
 
+    // summaries of functions (if we use them)
+    std::unique_ptr<RDFunctionSummaries> summaries;
+    std::unordered_map<const llvm::Function *,
+                       RDFunctionSummaries::Function *> summary_functions;
+
     bool isInlineAsm(const llvm::Instruction *instruction);
 
+    // building the graphs of functions in parallel
+    // (see LLVMReachingDefinitionsAnalysisOptions::buildThreads)
+    struct ThreadContext;
+    struct FunctionContext;
+    // the function that is being built by this thread
+    static thread_local FunctionContext *_ctx;
+    // the nodes created by the threads
+    std::vector<std::unique_ptr<ThreadContext>> thread_contexts;
+
+    std::vector<const llvm::Function *> getCalledFunctions(const llvm::CallInst *CInst);
+    std::vector<const llvm::Function *> prepareFunctions(const llvm::Function& entry);
+    void buildFunctionsParallel(const llvm::Function& entry);
+
     void matchForksAndJoins();
 };
 
@@ -46,7 +46,7 @@ namespace rd {
 
 RDNode *LLVMRDBuilderSemisparse::createAlloc(const llvm::Instruction *Inst, RDBlock *rb)
 {
-    RDNode *node = new RDNode(RDNodeType::ALLOC);
+    RDNode *node = newNode(RDNodeType::ALLOC);
     addNode(Inst, node);
     rb->append(node);
 
@@ -62,7 +62,7 @@ RDNode *LLVMRDBuilderSemisparse::createDynAlloc(const llvm::Instruction *Inst,
 {
     using namespace llvm;
 
-    RDNode *node = new RDNode(RDNodeType::DYN_ALLOC);
+    RDNode *node = newNode(RDNodeType::DYN_ALLOC);
     addNode(Inst, node);
     rb->append(node);
 
@@ -101,7 +101,7 @@ RDNode *LLVMRDBuilderSemisparse::createDynAlloc(const llvm::Instruction *Inst,
 
 RDNode *LLVMRDBuilderSemisparse::createRealloc(const llvm::Instruction *Inst, RDBlock *rb)
 {
-    RDNode *node = new RDNode(RDNodeType::DYN_ALLOC);
+    RDNode *node = newNode(RDNodeType::DYN_ALLOC);
     addNode(Inst, node);
     rb->append(node);
 
@@ -157,7 +157,7 @@ static void getLocalVariables(const llvm::Function *F,
 
 RDNode *LLVMRDBuilderSemisparse::createReturn(const llvm::Instruction *Inst, RDBlock *rb)
 {
-    RDNode *node = new RDNode(RDNodeType::RETURN);
+    RDNode *node = newNode(RDNodeType::RETURN);
     addNode(Inst, node);
     rb->append(node);
 
@@ -350,7 +350,7 @@ std::vector<DefSite> LLVMRDBuilderSemisparse::getPointsTo(const llvm::Value *val
 RDNode *LLVMRDBuilderSemisparse::createLoad(const llvm::Instruction *Inst, RDBlock *rb)
 {
     const llvm::LoadInst *LI = static_cast<const llvm::LoadInst *>(Inst);
-    RDNode *node = new RDNode(RDNodeType::LOAD);
+    RDNode *node = newNode(RDNodeType::LOAD);
     addNode(Inst, node);
     rb->append(node);
 
@@ -369,7 +369,7 @@ RDNode *LLVMRDBuilderSemisparse::createLoad(const llvm::Instruction *Inst, RDBlo
 
 RDNode *LLVMRDBuilderSemisparse::createStore(const llvm::Instruction *Inst, RDBlock *rb)
 {
-    RDNode *node = new RDNode(RDNodeType::STORE);
+    RDNode *node = newNode(RDNodeType::STORE);
     addNode(Inst, node);
     rb->append(node);
 
@@ -462,7 +462,7 @@ LLVMRDBuilderSemisparse::buildBlock(const llvm::BasicBlock& block)
 
     // the first node is dummy and serves as a phi from previous
     // blocks so that we can have proper mapping
-    RDNode *node = new RDNode(RDNodeType::PHI);
+    RDNode *node = newNode(RDNodeType::PHI);
     RDNode *last_node = node;
 
     addNode(node);
@@ -602,8 +602,8 @@ LLVMRDBuilderSemisparse::createCallToFunction(const llvm::Function *F, RDBlock *
     RDNode *callNode, *returnNode;
 
     // dummy nodes for easy generation
-    callNode = new RDNode(RDNodeType::CALL);
-    returnNode = new RDNode(RDNodeType::CALL_RETURN);
+    callNode = newNode(RDNodeType::CALL);
+    returnNode = newNode(RDNodeType::CALL_RETURN);
 
     // do not leak the memory of returnNode (the callNode
     // will be added to nodes_map)
@@ -654,8 +654,8 @@ LLVMRDBuilderSemisparse::buildFunction(const llvm::Function& F)
     // create root and (unified) return nodes of this subgraph. These are
     // just for our convenience when building the graph, they can be
     // optimized away later since they are noops
-    RDNode *root = new RDNode(RDNodeType::NOOP);
-    RDNode *ret = new RDNode(RDNodeType::NOOP);
+    RDNode *root = newNode(RDNodeType::NOOP);
+    RDNode *ret = newNode(RDNodeType::NOOP);
 
     // emplace new subgraph to avoid looping with recursive functions
     subgraphs_map.emplace(&F, Subgraph(root, ret));
@@ -732,7 +732,7 @@ RDNode *LLVMRDBuilderSemisparse::createUndefinedCall(const llvm::CallInst *CInst
 {
     using namespace llvm;
 
-    RDNode *node = new RDNode(RDNodeType::CALL);
+    RDNode *node = newNode(RDNodeType::CALL);
     addNode(CInst, node);
     rb->append(node);
 
@@ -816,7 +816,7 @@ RDNode *LLVMRDBuilderSemisparse::createIntrinsicCall(const llvm::CallInst *CInst
             // we create this node because this nodes works
             // as ALLOC in points-to, so we can have
             // reaching definitions to that
-            ret = new RDNode(RDNodeType::CALL);
+            ret = newNode(RDNodeType::CALL);
             ret->addDef(ret, 0, Offset::UNKNOWN);
             pts2 = PTA->getPointsTo(I->getOperand(0));
             assert(pts2 && "No points-to information");
@@ -857,7 +857,7 @@ RDNode *LLVMRDBuilderSemisparse::createIntrinsicCall(const llvm::CallInst *CInst
             return createUndefinedCall(CInst, rb);
     }
 
-    ret = new RDNode(RDNodeType::CALL);
+    ret = newNode(RDNodeType::CALL);
     rb->append(ret);
     addNode(CInst, ret);
 
@@ -1026,8 +1026,8 @@ LLVMRDBuilderSemisparse::createCall(const llvm::Instruction *Inst, RDBlock *rb)
                     assert(!ret_call);
 
                     // create the new nodes lazily
-                    call_funcptr = new RDNode(RDNodeType::CALL);
-                    ret_call = new RDNode(RDNodeType::CALL_RETURN);
+                    call_funcptr = newNode(RDNodeType::CALL);
+                    ret_call = newNode(RDNodeType::CALL_RETURN);
                     addNode(CInst, call_funcptr);
                     addNode(ret_call);
                 }
@@ -1128,7 +1128,7 @@ RDBlock *LLVMRDBuilderSemisparse::buildGlobals()
         prev = cur;
 
         // every global node is like memory allocation
-        cur = new RDNode(RDNodeType::ALLOC);
+        cur = newNode(RDNodeType::ALLOC);
         cur->setSize(getGlobalVariableSize(&*I, DL));
         // some global variables are initialized on creation
         if (I->hasInitializer())
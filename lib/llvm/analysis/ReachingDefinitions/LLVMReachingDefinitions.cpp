@@ -32,8 +32,10 @@ LLVMReachingDefinitions::~LLVMReachingDefinitions() {
 
 void LLVMReachingDefinitions::initializeSparseRDA() {
     builder = new LLVMRDBuilderSemisparse(m, pta, _options);
+    auto start = std::chrono::steady_clock::now();
     // let the compiler do copy-ellision
     auto graph = builder->build();
+    phase_times.emplace_back("build", std::chrono::steady_clock::now() - start);
 
     RDA = std::unique_ptr<ReachingDefinitionsAnalysis>(
                     new SemisparseRda(std::move(graph)));
@@ -42,9 +44,10 @@ void LLVMReachingDefinitions::initializeSparseRDA() {
 void LLVMReachingDefinitions::initializeDenseRDA() {
     builder = new LLVMRDBuilderDense(m, pta, _options);
     auto graph = builder->build();
+    phase_times = builder->getPhaseTimes();
 
     RDA = std::unique_ptr<ReachingDefinitionsAnalysis>(
-                    new ReachingDefinitionsAnalysis(std::move(graph)));
+                    new ReachingDefinitionsAnalysis(std::move(graph), _options));
 }
 
 RDNode *LLVMReachingDefinitions::getNode(const llvm::Value *val) {
@@ -71,6 +74,11 @@ const RDNode *LLVMReachingDefinitions::getMapping(const llvm::Value *val) const
     return builder->getMapping(val);
 }
 
+const std::vector<std::pair<const llvm::Value *, RDNode *>>&
+LLVMReachingDefinitions::getNodeValues() const {
+    return builder->getNodeValues();
+}
+
 
 std::set<llvm::Value *>
 LLVMReachingDefinitions::getLLVMReachingDefinitions(llvm::Value *where, llvm::Value *what,
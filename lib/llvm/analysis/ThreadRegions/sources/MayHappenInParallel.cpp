@@ -1,9 +1,124 @@
+#include <algorithm>
+#include <cassert>
+
+#include "dg/ADT/WordOps.h"
 #include "dg/llvm/analysis/ThreadRegions/MayHappenInParallel.h"
 
 using namespace std;
 
-MayHappenInParallel::MayHappenInParallel(set<ThreadRegion *> threadRegions):threadRegions_(move(threadRegions)) {}
+const unsigned MayHappenInParallel::NONE;
+
+MayHappenInParallel::MayHappenInParallel(set<ThreadRegion *> threadRegions)
+    :regions_(threadRegions.begin(), threadRegions.end()) {
+    // the ids of the regions are unique, order by them
+    // so that the indices do not depend on the addresses
+    sort(regions_.begin(), regions_.end(),
+         [](const ThreadRegion *a, const ThreadRegion *b) { return a->id() < b->id(); });
+
+    for (unsigned i = 0; i < regions_.size(); ++i) {
+        indices_.emplace(regions_[i], i);
+        for (const auto &instruction : regions_[i]->llvmInstructions()) {
+            instructionRegions_[instruction].push_back(i);
+        }
+    }
+
+    rowWords_ = (regions_.size() + 63) / 64;
+    matrix_.resize(rowWords_ * regions_.size(), 0);
+
+    // FIXME: we do not have any information about the order
+    // of the regions yet, so every region may happen in parallel
+    // with every region (including itself, the thread may run
+    // multiple times in parallel)
+    for (unsigned i = 0; i < regions_.size(); ++i) {
+        for (unsigned j = i; j < regions_.size(); ++j) {
+            setParallel(i, j);
+        }
+    }
+}
+
+void MayHappenInParallel::setParallel(unsigned i, unsigned j) {
+    // the relation is symmetric
+    matrix_[i * rowWords_ + j / 64] |= uint64_t(1) << (j % 64);
+    matrix_[j * rowWords_ + i / 64] |= uint64_t(1) << (i % 64);
+}
+
+size_t MayHappenInParallel::regionsNum() const {
+    return regions_.size();
+}
+
+size_t MayHappenInParallel::rowWords() const {
+    return rowWords_;
+}
+
+ThreadRegion *MayHappenInParallel::region(unsigned index) const {
+    assert(index < regions_.size());
+    return regions_[index];
+}
+
+unsigned MayHappenInParallel::regionIndex(const ThreadRegion *threadRegion) const {
+    auto iterator = indices_.find(threadRegion);
+    return iterator == indices_.end() ? NONE : iterator->second;
+}
+
+const vector<unsigned> &MayHappenInParallel::regionIndices(const llvm::Instruction *instruction) const {
+    static const vector<unsigned> noRegions;
+    auto iterator = instructionRegions_.find(instruction);
+    return iterator == instructionRegions_.end() ? noRegions : iterator->second;
+}
+
+bool MayHappenInParallel::mayHappenInParallel(unsigned i, unsigned j) const {
+    assert(i < regions_.size() && j < regions_.size());
+    return matrix_[i * rowWords_ + j / 64] & (uint64_t(1) << (j % 64));
+}
+
+bool MayHappenInParallel::mayHappenInParallel(const llvm::Instruction *a,
+                                              const llvm::Instruction *b) const {
+    for (auto i : regionIndices(a)) {
+        for (auto j : regionIndices(b)) {
+            if (mayHappenInParallel(i, j)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+MayHappenInParallel::RowT MayHappenInParallel::emptyRow() const {
+    return RowT(rowWords_, 0);
+}
+
+void MayHappenInParallel::addToRow(RowT &row, unsigned index) const {
+    assert(row.size() == rowWords_ && index < regions_.size());
+    row[index / 64] |= uint64_t(1) << (index % 64);
+}
+
+set<ThreadRegion *> MayHappenInParallel::parallelRegions(ThreadRegion *threadRegion) {
+    set<ThreadRegion *> result;
+    auto index = regionIndex(threadRegion);
+    if (index == NONE) {
+        return result;
+    }
+
+    RowT all = emptyRow();
+    for (unsigned i = 0; i < regions_.size(); ++i) {
+        addToRow(all, i);
+    }
+    for (auto i : parallelRegions(index, all)) {
+        result.insert(regions_[i]);
+    }
+    return result;
+}
 
-set<ThreadRegion *> MayHappenInParallel::parallelRegions(ThreadRegion *) {
-    return threadRegions_;
+vector<unsigned> MayHappenInParallel::parallelRegions(unsigned index, const RowT &regions) const {
+    assert(index < regions_.size() && regions.size() == rowWords_);
+    vector<unsigned> result;
+    const uint64_t *row = &matrix_[index * rowWords_];
+    for (size_t w = 0; w < rowWords_; ++w) {
+        uint64_t bits = row[w] & regions[w];
+        while (bits != 0) {
+            result.push_back(w * 64 + dg::ADT::words::ctz(bits));
+            bits &= bits - 1;
+        }
+    }
+    return result;
 }
@@ -1,9 +1,12 @@
 #include <assert.h>
 #include <cstdarg>
 #include <cstdio>
+#include <cstdint>
+#include <array>
 
 #include "test-runner.h"
 
+#include "dg/ADT/Arena.h"
 #include "dg/ADT/Queue.h"
 #include "dg/ADT/Bitvector.h"
 #include "dg/analysis/ReachingDefinitions/RDMap.h"
@@ -150,6 +153,67 @@ public:
     }
 };
 
+class TestArena : public Test
+{
+    struct Counted {
+        int *counter;
+        double value;
+        Counted(int *c, double v) : counter(c), value(v) { ++*counter; }
+        ~Counted() { --*counter; }
+    };
+
+public:
+    TestArena() : Test("arena test")
+    {}
+
+    void test()
+    {
+        Arena arena(256);
+        char *c = arena.create<char>('a');
+        double *d = arena.create<double>(1.5);
+        check(*c == 'a' && *d == 1.5, "Wrong values");
+        check(reinterpret_cast<uintptr_t>(d) % alignof(double) == 0,
+              "Misaligned object");
+        check(arena.getSlabsNum() == 1, "Wrong number of slabs");
+
+        // 16 + 4 * 60 bytes fill the slab exactly
+        for (int i = 0; i < 4; ++i)
+            arena.create<std::array<char, 60>>();
+        check(arena.getSlabsNum() == 1, "Wrong number of slabs");
+        // does not fit into the rest of the slab
+        arena.create<std::array<char, 60>>();
+        check(arena.getSlabsNum() == 2, "Wrong number of slabs");
+        // big objects get their own slab
+        arena.create<std::array<char, 100>>();
+        check(arena.getSlabsNum() == 3, "Wrong number of slabs");
+
+        int counter = 0;
+        {
+            ArenaOwner<Counted> owner(128);
+            for (int i = 0; i < 100; ++i)
+                check(owner.create(&counter, i)->value == i, "Wrong value");
+            check(counter == 100, "Wrong number of objects");
+
+            ArenaOwner<Counted> owner2(std::move(owner));
+            check(counter == 100, "Moving destroyed objects");
+            check(owner2.size() == 100 && owner.size() == 0,
+                  "Wrong number of objects after moving");
+
+            // trivially destructible objects are not tracked
+            ArenaOwner<int> ints(128);
+            for (int i = 0; i < 100; ++i)
+                check(*ints.create(i) == i, "Wrong value");
+            check(ints.size() == 100, "Wrong number of objects");
+
+            ArenaPtr<Counted> ptr(arena.create<Counted>(&counter, 0.0));
+            check(counter == 101, "Wrong number of objects");
+            ptr.reset();
+            check(counter == 100, "Object not destroyed");
+        }
+        check(counter == 0, "Objects not destroyed");
+    }
+};
+
 }; // namespace tests
 }; // namespace dg
 
@@ -162,6 +226,7 @@ int main()
     Runner.add(new TestFIFO());
     Runner.add(new TestPrioritySet());
     Runner.add(new TestIntervalsHandling());
+    Runner.add(new TestArena());
 
     return Runner();
 }
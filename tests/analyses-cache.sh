@@ -0,0 +1,74 @@
+#!/bin/bash
+
+TESTS_DIR=`dirname $0`
+source "$TESTS_DIR/test-runner.sh"
+
+set_environment
+
+CODE="$TESTS_DIR/sources/funcptr1.c"
+NAME="$TESTS_DIR/analyses-cache"
+BCFILE="$NAME.bc"
+CACHEDIR="$NAME.cache"
+
+# slice $BCFILE into $NAME.$1.sliced using the cache, the rest of
+# the arguments are passed to the slicer
+slice_cached()
+{
+	OUT="$NAME.$1.sliced"
+	shift
+
+	llvm-slicer -analyses-cache "$CACHEDIR" $@ -c test_assert \
+		-o "$OUT" "$BCFILE" || errmsg "Slicing failed"
+}
+
+# check that the slice is the same as the slice without the cache
+check_slice()
+{
+	llvm-dis "$NAME.$1.sliced" -o - | tail -n +2 > "$NAME.$1.ll"
+	diff "$NAME.nocache.ll" "$NAME.$1.ll" \
+		|| errmsg "The slice differs when using the cache ($1)"
+}
+
+rm -rf "$CACHEDIR" $NAME.*.sliced $NAME.*.ll
+mkdir -p "$CACHEDIR"
+
+compile "$CODE" "$BCFILE"
+
+llvm-slicer -c test_assert -o "$NAME.nocache.sliced" "$BCFILE" \
+	|| errmsg "Slicing failed"
+llvm-dis "$NAME.nocache.sliced" -o - | tail -n +2 > "$NAME.nocache.ll"
+
+# the first run fills the cache, the second one uses it
+slice_cached store
+check_slice store
+[ "`ls $CACHEDIR | wc -l`" -eq 2 ] || errmsg "The results were not cached"
+
+slice_cached load
+check_slice load
+
+# the results of reaching definitions do not depend
+# on the number of threads that build the graph
+slice_cached threads -rd-build-threads 4
+check_slice threads
+
+# truncated files must be ignored and rewritten
+for F in $CACHEDIR/*; do
+	head -c 20 "$F" > "$F.tmp" && mv "$F.tmp" "$F"
+done
+slice_cached truncated
+check_slice truncated
+slice_cached reloaded
+check_slice reloaded
+
+# and so must be the files with garbage in them
+for F in $CACHEDIR/*; do
+	SIZE=`stat -c %s "$F"`
+	head -c 32 "$F" > "$F.tmp"
+	head -c $(($SIZE - 32)) /dev/urandom >> "$F.tmp"
+	mv "$F.tmp" "$F"
+done
+slice_cached corrupted
+check_slice corrupted
+
+link_with_assert "$NAME.corrupted.sliced" "$NAME.sliced.linked"
+get_result "$NAME.sliced.linked"
@@ -2,6 +2,9 @@
 #include "catch.hpp"
 
 #include <random>
+#include <set>
+#include <algorithm>
+#include <iterator>
 
 #include "dg/ADT/Bitvector.h"
 
@@ -205,3 +208,111 @@ TEST_CASE("Merge random bitvectors (union)", "SparseBitvector") {
 //    B2.merge(B1);
 //    REQUIRE(B1 == B2);
 }
+
+TEST_CASE("Unset returns previous value", "SparseBitvector") {
+    SparseBitvector B;
+    B.set(1);
+    REQUIRE(B.unset(2) == false);
+    REQUIRE(B.unset(1) == true);
+    REQUIRE(B.unset(1) == false);
+    REQUIRE(B.empty());
+}
+
+TEST_CASE("Size", "SparseBitvector") {
+    SparseBitvector B;
+    REQUIRE(B.size() == 0);
+
+    for (uint64_t i = 0; i < 1000; i += 3)
+        B.set(i);
+    B.set(~static_cast<uint64_t>(0));
+    REQUIRE(B.size() == 335);
+}
+
+using WideBitvector = dg::ADT::SparseBitvectorImpl<uint64_t, uint64_t, 8>;
+
+template <typename BV>
+static std::set<uint64_t> toSet(const BV& B) {
+    std::set<uint64_t> S;
+    for (auto x : B)
+        S.insert(x);
+    return S;
+}
+
+template <typename BV>
+static void checkSetOperations() {
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution(0, 5000);
+
+    for (int round = 0; round < 20; ++round) {
+        BV B1, B2;
+        std::set<uint64_t> S1, S2;
+        for (int i = 0; i < 300; ++i) {
+            auto x = distribution(generator);
+            auto y = distribution(generator);
+            B1.set(x);
+            S1.insert(x);
+            B2.set(y);
+            S2.insert(y);
+        }
+
+        REQUIRE(B1.size() == S1.size());
+        REQUIRE(B2.size() == S2.size());
+
+        std::set<uint64_t> I;
+        std::set_intersection(S1.begin(), S1.end(), S2.begin(), S2.end(),
+                              std::inserter(I, I.end()));
+        REQUIRE(B1.intersects(B2) == !I.empty());
+
+        auto U = B1;
+        REQUIRE(U.set(B2) == !std::includes(S1.begin(), S1.end(),
+                                            S2.begin(), S2.end()));
+        REQUIRE(B1.isSubsetOf(U));
+        REQUIRE(B2.isSubsetOf(U));
+        REQUIRE(U.set(B2) == false);
+
+        std::set<uint64_t> US(S1);
+        US.insert(S2.begin(), S2.end());
+        REQUIRE(U.size() == US.size());
+        REQUIRE(toSet(U) == US);
+
+        auto In = B1;
+        In.intersect(B2);
+        REQUIRE(In.size() == I.size());
+        REQUIRE(toSet(In) == I);
+        REQUIRE(In.isSubsetOf(B1));
+        REQUIRE(In.isSubsetOf(B2));
+        REQUIRE(In.intersect(B1) == false);
+
+        std::set<uint64_t> D;
+        std::set_difference(S1.begin(), S1.end(), S2.begin(), S2.end(),
+                            std::inserter(D, D.end()));
+        auto Diff = B1;
+        REQUIRE(Diff.unset(B2) == !I.empty());
+        REQUIRE(toSet(Diff) == D);
+        REQUIRE(Diff.size() == D.size());
+        REQUIRE(!Diff.intersects(B2));
+        REQUIRE(Diff.unset(B2) == false);
+
+        U.intersect(B1);
+        REQUIRE(U == B1);
+    }
+}
+
+TEST_CASE("Union, intersection, difference and subset", "SparseBitvector") {
+    checkSetOperations<SparseBitvector>();
+}
+
+TEST_CASE("Union, intersection, difference and subset (wide elements)", "SparseBitvector") {
+    checkSetOperations<WideBitvector>();
+}
+
+TEST_CASE("Iterate wide elements", "SparseBitvector") {
+    WideBitvector B;
+    std::set<uint64_t> S{0, 63, 64, 511, 512, 1000, 100000,
+                         ~static_cast<uint64_t>(0)};
+    for (auto x : S)
+        REQUIRE(B.set(x) == false);
+
+    REQUIRE(B.size() == S.size());
+    REQUIRE(toSet(B) == S);
+}
@@ -1,6 +1,9 @@
+#include <algorithm>
 #include <cassert>
 #include <cstdarg>
 #include <cstdio>
+#include <random>
+#include <set>
 
 #include "test-runner.h"
 #include "test-dg.h"
@@ -160,6 +163,54 @@ public:
         check(IT2.insert(&n2), "unique element wrong retval");
 
         check(IT == IT2, "containers with same content does not equal");
+
+        check(IT.erase(&n1) == 1, "did not erase element");
+        check(IT.erase(&n1) == 0, "erased element twice");
+        check(!IT.contains(&n1), "contains erased element");
+        check(IT.contains(&n2), "does not contain element");
+        check(IT != IT2, "different containers equal");
+
+        // grow over the inline storage
+        TestNode nodes[20] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+                              11, 12, 13, 14, 15, 16, 17, 18, 19};
+        EdgesContainer<TestNode> big;
+        for (int i = 19; i >= 0; i -= 2)
+            check(big.insert(&nodes[i]), "returned false with new element");
+        check(big.size() == 10, "size() bug");
+
+        // batch insert with duplicates
+        TestNode *ptrs[20];
+        for (int i = 0; i < 20; ++i)
+            ptrs[i] = &nodes[(i * 7) % 20];
+        big.insert(ptrs, ptrs + 20);
+        big.insert(ptrs, ptrs + 5);
+        check(big.size() == 20, "batch insert bug");
+
+        TestNode *last = nullptr;
+        for (TestNode *n : big) {
+            check(!last || last < n, "elements are not sorted");
+            last = n;
+        }
+
+        auto copy = big;
+        check(copy == big, "copy differs");
+        for (int i = 0; i < 20; i += 2)
+            copy.erase(&nodes[i]);
+        check(copy.size() == 10, "erase bug");
+        check(copy.contains(&nodes[5]) && !copy.contains(&nodes[4]),
+              "contains bug");
+
+        EdgesContainer<TestNode> moved(std::move(copy));
+        check(moved.size() == 10, "move bug");
+
+        big.intersect(moved);
+        check(big == moved, "intersection bug");
+
+        moved.swap(IT);
+        check(moved.size() == 1 && moved.contains(&n2), "swap bug");
+        check(IT == big, "swap bug");
+        moved.clear();
+        check(moved.empty(), "clear bug");
 #endif
     }
 };
@@ -676,6 +727,212 @@ public:
     }
 };
 
+// N nodes split evenly into the given graphs with random edges,
+// also between the graphs. The types of the edges are control,
+// data, use and interference dependence.
+struct RandomGraph {
+    struct Edge {
+        int from, to, type;
+    };
+
+    std::vector<TestNode *> nodes;
+    std::vector<Edge> edges;
+
+    RandomGraph(const std::vector<TestDG *>& graphs, int N)
+    {
+        const int part = N / graphs.size();
+        for (int i = 0; i < N; ++i) {
+            TestNode *n = new TestNode(i);
+            nodes.push_back(n);
+            graphs[std::min<size_t>(i / part, graphs.size() - 1)]->addNode(n);
+        }
+
+        for (size_t g = 0; g < graphs.size(); ++g)
+            graphs[g]->setEntry(nodes[g * part]);
+    }
+
+    // generate N random edges (N is the number of nodes),
+    // the first 'types' types of edges are used
+    void generateEdges(std::mt19937& gen, int types = 4)
+    {
+        std::uniform_int_distribution<int> dist(0, nodes.size() - 1);
+        for (size_t i = 0; i < nodes.size(); ++i)
+            edges.push_back({dist(gen), dist(gen), static_cast<int>(i % types)});
+    }
+
+    void addEdge(const Edge& e)
+    {
+        TestNode *a = nodes[e.from];
+        TestNode *b = nodes[e.to];
+        switch (e.type) {
+        case 0: a->addControlDependence(b); break;
+        case 1: a->addDataDependence(b); break;
+        case 2: a->addUseDependence(b); break;
+        default: a->addInterferenceDependence(b); break;
+        }
+    }
+
+    void addEdges()
+    {
+        for (const Edge& e : edges)
+            addEdge(e);
+    }
+};
+
+class TestFrozenSlicing : public Test
+{
+public:
+    TestFrozenSlicing() : Test("frozen graph slicing test")
+    {}
+
+    void test()
+    {
+        const int N = 200;
+        TestDG d1, d2;
+        RandomGraph G({&d1, &d2}, N);
+        auto& nodes = G.nodes;
+
+        std::mt19937 gen(7);
+        std::uniform_int_distribution<int> dist(0, N - 1);
+        G.generateEdges(gen);
+        G.addEdges();
+
+        FrozenDependenceGraph<TestNode> frozen({&d1, &d2});
+        check(frozen.size() == N, "frozen graph has %u nodes", frozen.size());
+        analysis::FrozenWalkAndMark<TestNode> wm(frozen);
+
+        uint32_t slice_id = 1;
+        for (int k = 0; k < 20; ++k, slice_id += 2) {
+            std::set<TestNode *> criteria{nodes[dist(gen)], nodes[dist(gen)]};
+
+            analysis::Slicer<TestNode> slicer;
+            for (TestNode *c : criteria)
+                slicer.mark(c, slice_id);
+
+            std::set<TestNode *> expected;
+            for (TestNode *n : nodes) {
+                if (n->getSlice() == slice_id)
+                    expected.insert(n);
+            }
+
+            size_t marked = wm.mark(criteria, slice_id + 1);
+            std::set<TestNode *> got;
+            for (TestNode *n : nodes) {
+                if (n->getSlice() == slice_id + 1)
+                    got.insert(n);
+            }
+
+            check(got == expected, "frozen slicing marked different nodes");
+            check(marked == got.size(), "wrong number of marked nodes");
+            check(d1.getSlice() == slice_id + 1 || !got.count(nodes[0]),
+                  "graph not marked");
+        }
+    }
+};
+
+class TestLazySlicing : public Test
+{
+public:
+    TestLazySlicing() : Test("lazy dependencies slicing test")
+    {}
+
+    void test()
+    {
+        const int N = 100;
+        TestDG d1, d2, l1, l2;
+        RandomGraph G({&d1, &d2}, N), L({&l1, &l2}, N);
+        auto& nodes = G.nodes;
+        auto& lazy = L.nodes;
+
+        std::mt19937 gen(11);
+        std::uniform_int_distribution<int> dist(0, N - 1);
+        G.generateEdges(gen, 3);
+        G.addEdges();
+
+        // add the edges that lead to the nodes of a graph
+        // once the graph is reached
+        std::set<DependenceGraph<TestNode> *> materialized;
+        analysis::Slicer<TestNode> lazySlicer;
+        lazySlicer.setGraphReached([&](DependenceGraph<TestNode> *dg) {
+            if (!materialized.insert(dg).second)
+                return;
+            for (const auto& e : G.edges) {
+                if (lazy[e.to]->getDG() == dg)
+                    L.addEdge(e);
+            }
+        });
+
+        // criteria only in the first graph
+        TestNode *crit = nodes[dist(gen) % (N / 2)];
+        analysis::Slicer<TestNode> slicer;
+        slicer.mark(crit, 1);
+        lazySlicer.mark(lazy[crit->getKey()], 1);
+
+        bool reachedD2 = false;
+        for (int i = 0; i < N; ++i) {
+            check(nodes[i]->getSlice() == lazy[i]->getSlice(),
+                  "node %d marked differently with lazy edges", i);
+            if (i >= N / 2 && nodes[i]->getSlice() == 1)
+                reachedD2 = true;
+        }
+
+        check(materialized.count(&l1) == 1, "the graph with criteria not materialized");
+        check(materialized.count(&l2) == (reachedD2 ? 1u : 0u),
+              "wrong materialization of the second graph");
+    }
+};
+
+class TestFrozenBatchSlicing : public Test
+{
+public:
+    TestFrozenBatchSlicing() : Test("frozen graph batch slicing test")
+    {}
+
+    void test()
+    {
+        const int N = 300;
+        TestDG d1, d2, d3;
+        RandomGraph G({&d1, &d2, &d3}, N);
+        auto& nodes = G.nodes;
+
+        std::mt19937 gen(11);
+        std::uniform_int_distribution<int> dist(0, N - 1);
+        G.generateEdges(gen);
+        G.addEdges();
+
+        FrozenDependenceGraph<TestNode> frozen({&d1, &d2, &d3});
+        analysis::FrozenWalkAndMark<TestNode> wm(frozen);
+        analysis::FrozenBatchWalkAndMark<TestNode> bwm(frozen);
+
+        // more criteria than fit into one word
+        std::vector<std::set<TestNode *>> criteria;
+        for (int k = 0; k < 150; ++k)
+            criteria.push_back({nodes[dist(gen)], nodes[dist(gen)]});
+
+        bwm.mark(criteria);
+        check(bwm.criteriaNum() == criteria.size(), "wrong number of criteria");
+
+        uint32_t slice_id = 1;
+        for (size_t c = 0; c < criteria.size(); ++c, slice_id += 2) {
+            wm.mark(criteria[c], slice_id);
+            std::set<TestNode *> expected;
+            for (TestNode *n : nodes) {
+                if (n->getSlice() == slice_id)
+                    expected.insert(n);
+            }
+
+            auto slice = bwm.getSlice(c);
+            std::set<TestNode *> got(slice.begin(), slice.end());
+            check(got == expected, "batch slicing of criterion %u marked different nodes", (unsigned) c);
+
+            size_t marked = bwm.apply(c, slice_id + 1);
+            check(marked == expected.size(), "wrong number of marked nodes");
+            for (TestNode *n : expected)
+                check(n->getSlice() == slice_id + 1, "node not marked");
+        }
+    }
+};
+
 }; // namespace tests
 }; // namespace dg
 
@@ -689,6 +946,9 @@ int main(void)
     Runner.add(new TestAdd());
     Runner.add(new TestRemove());
     Runner.add(new TestSlicingCFG());
+    Runner.add(new TestFrozenSlicing());
+    Runner.add(new TestFrozenBatchSlicing());
+    Runner.add(new TestLazySlicing());
 
     return Runner();
 }
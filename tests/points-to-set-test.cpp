@@ -4,12 +4,15 @@
 #include "dg/analysis/PointsTo/PSNode.h"
 #include "dg/analysis/PointsTo/PointerSubgraph.h"
 #include "dg/analysis/PointsTo/Pointer.h"
+#include "dg/analysis/PointsTo/MemoryObject.h"
 
 using dg::analysis::pta::PSNode;
 using dg::analysis::pta::PSNodeType;
 using dg::analysis::pta::Pointer;
 using dg::analysis::pta::PointerSubgraph;
 using dg::analysis::pta::PointsToSet;
+using dg::analysis::pta::MemoryObject;
+using dg::analysis::Offset;
 
 TEST_CASE("Querying empty set", "PointsToSet") {
     PointsToSet B;
@@ -83,3 +86,106 @@ TEST_CASE("Merge points-to sets", "PointsToSet") {
     REQUIRE(S1.size() == 2);
 }
 
+
+TEST_CASE("Flat set: add and query", "PointsToSet") {
+    PointsToSet S(PointsToSet::Representation::FLAT);
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+
+    REQUIRE(S.empty());
+    REQUIRE(S.add(Pointer(B, 8)) == true);
+    REQUIRE(S.add(Pointer(A, 20)) == true);
+    REQUIRE(S.add(Pointer(A, 0)) == true);
+    REQUIRE(S.add(Pointer(A, 20)) == false);
+    REQUIRE(S.size() == 3);
+    REQUIRE(S.has({A, 0}));
+    REQUIRE(S.has({A, 20}));
+    REQUIRE(S.has({B, 8}));
+    REQUIRE(!S.has({B, 0}));
+    REQUIRE(S.pointsToTarget(A));
+    REQUIRE(S.pointsToTarget(B));
+
+    REQUIRE(S.remove({A, 20}) == true);
+    REQUIRE(S.remove({A, 20}) == false);
+    REQUIRE(S.removeAny(B) == true);
+    REQUIRE(S.isSingleton());
+    REQUIRE(*S.begin() == Pointer(A, 0));
+}
+
+TEST_CASE("Flat set: unknown offset", "PointsToSet") {
+    PointsToSet S(PointsToSet::Representation::FLAT);
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+
+    REQUIRE(S.add(Pointer(A, 0)) == true);
+    REQUIRE(S.add(Pointer(A, 4)) == true);
+    // unknown offset subsumes the other offsets
+    REQUIRE(S.add(Pointer(A, Offset::UNKNOWN)) == true);
+    REQUIRE(S.size() == 1);
+    REQUIRE(S.add(Pointer(A, 8)) == false);
+    REQUIRE(S.add(Pointer(A, Offset::UNKNOWN)) == false);
+    REQUIRE(S.mayPointTo({A, 8}));
+}
+
+TEST_CASE("Representations give the same results", "PointsToSet") {
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+    PSNode* C = PS.create(PSNodeType::ALLOC);
+
+    PointsToSet BV1(PointsToSet::Representation::BITVECTOR);
+    PointsToSet BV2(PointsToSet::Representation::BITVECTOR);
+    PointsToSet F1(PointsToSet::Representation::FLAT);
+    PointsToSet F2(PointsToSet::Representation::FLAT);
+
+    for (auto *S : {&BV1, &F1}) {
+        S->add({A, 0});
+        S->add({B, 16});
+        S->add({C, Offset::UNKNOWN});
+    }
+    for (auto *S : {&BV2, &F2}) {
+        S->add({A, 8});
+        S->add({B, 16});
+    }
+
+    REQUIRE(BV1.add(BV2) == F1.add(F2));
+    REQUIRE(BV1.add(BV2) == F1.add(F2));
+    REQUIRE(BV1.size() == F1.size());
+    for (const auto& ptr : BV1)
+        REQUIRE(F1.has(ptr));
+
+    // union of sets with different representations
+    PointsToSet M(PointsToSet::Representation::FLAT);
+    REQUIRE(M.add(BV1) == true);
+    REQUIRE(M.size() == BV1.size());
+    REQUIRE(M.add(BV1) == false);
+
+    // copying and swapping keeps the representations
+    PointsToSet cpy = F1;
+    REQUIRE(cpy.getRepresentation() == PointsToSet::Representation::FLAT);
+    cpy.swap(BV2);
+    REQUIRE(cpy.getRepresentation() == PointsToSet::Representation::BITVECTOR);
+    REQUIRE(BV2.getRepresentation() == PointsToSet::Representation::FLAT);
+    REQUIRE(BV2.size() == F1.size());
+}
+
+TEST_CASE("Subgraph sets the representation of its sets", "PointsToSet") {
+    PointerSubgraph PS;
+    PS.setPointsToSetRepresentation(PointsToSet::Representation::FLAT);
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+    REQUIRE(A->pointsTo.getRepresentation() == PointsToSet::Representation::FLAT);
+
+    // memory objects take the representation from their node
+    MemoryObject mo(A);
+    REQUIRE(mo.addPointsTo(0, Pointer(B, 0)) == true);
+    REQUIRE(mo.getPointsTo(0).getRepresentation() ==
+            PointsToSet::Representation::FLAT);
+
+    // the default representation is not touched
+    REQUIRE(PointsToSet::getDefaultRepresentation() ==
+            PointsToSet::Representation::BITVECTOR);
+    REQUIRE(PointsToSet().getRepresentation() ==
+            PointsToSet::Representation::BITVECTOR);
+}
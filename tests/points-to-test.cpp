@@ -9,6 +9,9 @@
 #include "dg/analysis/PointsTo/PointerSubgraph.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFI.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFS.h"
+#include "dg/analysis/PointsTo/PointerAnalysisSFS.h"
+#include "dg/analysis/PointsTo/PointerSubgraphOptimizations.h"
+#include "dg/analysis/PointsTo/DemandPointerAnalysis.h"
 
 namespace dg {
 namespace tests {
@@ -909,6 +912,85 @@ public:
         check(L3->doesPointsTo(NULLPTR), "L3 does not point to NULL");
     }
 
+    void copy_cycle()
+    {
+        using namespace analysis;
+
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *P1 = PS.create(PSNodeType::PHI, A, nullptr);
+        PSNode *C1 = PS.create(PSNodeType::CAST, P1);
+        PSNode *P2 = PS.create(PSNodeType::PHI, B, C1, nullptr);
+        PSNode *C2 = PS.create(PSNodeType::CAST, P2);
+        // close the cycle P1 -> C1 -> P2 -> C2 -> P1
+        P1->addOperand(C2);
+        PSNode *L = PS.create(PSNodeType::LOAD, C2);
+
+        A->addSuccessor(B);
+        B->addSuccessor(P1);
+        P1->addSuccessor(C1);
+        C1->addSuccessor(P2);
+        P2->addSuccessor(C2);
+        C2->addSuccessor(L);
+
+        PS.setRoot(A);
+        PTStoT PA(&PS);
+        PA.run();
+
+        for (PSNode *n : {P1, C1, P2, C2}) {
+            check(n->doesPointsTo(A), "node on the cycle does not point to A");
+            check(n->doesPointsTo(B), "node on the cycle does not point to B");
+            check(n->pointsTo.size() == 2, "node on the cycle has wrong pts");
+        }
+    }
+
+    // check that a write in one branch does not leak into
+    // the other branch (only for flow-sensitive analyses)
+    void branches()
+    {
+        using namespace analysis;
+
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *P = PS.create(PSNodeType::ALLOC);
+        PSNode *S1 = PS.create(PSNodeType::STORE, A, P);
+        PSNode *S2 = PS.create(PSNodeType::STORE, B, P);
+        PSNode *L1 = PS.create(PSNodeType::LOAD, P);
+        PSNode *L2 = PS.create(PSNodeType::LOAD, P);
+        PSNode *L3 = PS.create(PSNodeType::LOAD, P);
+
+        /*
+         *   A -> B -> P -> S1
+         *                 /  \
+         *                S2   L1
+         *                |    |
+         *                L2   |
+         *                 \  /
+         *                  L3
+         */
+        A->addSuccessor(B);
+        B->addSuccessor(P);
+        P->addSuccessor(S1);
+        S1->addSuccessor(S2);
+        S1->addSuccessor(L1);
+        S2->addSuccessor(L2);
+        L1->addSuccessor(L3);
+        L2->addSuccessor(L3);
+
+        PS.setRoot(A);
+        PTStoT PA(&PS);
+        PA.run();
+
+        check(L1->doesPointsTo(A), "L1 does not point to A");
+        check(!L1->doesPointsTo(B), "L1 points to B");
+        check(L2->doesPointsTo(B), "L2 does not point to B");
+        check(!L2->doesPointsTo(A), "L2 points to A");
+        check(L3->doesPointsTo(A), "L3 does not point to A");
+        check(L3->doesPointsTo(B), "L3 does not point to B");
+    }
+
     void test()
     {
         store_load();
@@ -935,6 +1017,7 @@ public:
         memcpy_test6();
         memcpy_test7();
         memcpy_test8();
+        copy_cycle();
     }
 };
 
@@ -947,6 +1030,275 @@ public:
           ("flow-insensitive points-to test") {}
 };
 
+// flow-insensitive analysis with difference propagation
+class PointerAnalysisFIDiff : public analysis::pta::PointerAnalysisFI
+{
+public:
+    PointerAnalysisFIDiff(PointerSubgraph *PS)
+        : PointerAnalysisFI(PS, analysis::PointerAnalysisOptions()
+                                    .setDiffPropagation(true)) {}
+};
+
+class FlowInsensitiveDiffPointsToTest
+    : public PointsToTest<PointerAnalysisFIDiff>
+{
+public:
+    FlowInsensitiveDiffPointsToTest()
+        : PointsToTest<PointerAnalysisFIDiff>
+          ("flow-insensitive points-to test (difference propagation)") {}
+};
+
+// flow-insensitive analysis with difference propagation
+// and collapsing of cycles
+class PointerAnalysisFICollapse : public analysis::pta::PointerAnalysisFI
+{
+public:
+    PointerAnalysisFICollapse(PointerSubgraph *PS)
+        : PointerAnalysisFI(PS, analysis::PointerAnalysisOptions()
+                                    .setDiffPropagation(true)
+                                    .setCollapseCycles(true)) {}
+};
+
+class FlowInsensitiveCollapsePointsToTest
+    : public PointsToTest<PointerAnalysisFICollapse>
+{
+public:
+    FlowInsensitiveCollapsePointsToTest()
+        : PointsToTest<PointerAnalysisFICollapse>
+          ("flow-insensitive points-to test (collapsing cycles)") {}
+
+    // P1 -> C -> P2 -> P1 is a cycle of copies
+    void copy_cycle()
+    {
+        using namespace analysis;
+
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *P1 = PS.create(PSNodeType::PHI, A, nullptr);
+        PSNode *C = PS.create(PSNodeType::CAST, P1);
+        PSNode *P2 = PS.create(PSNodeType::PHI, C, B, nullptr);
+        P1->addOperand(P2);
+
+        A->addSuccessor(B);
+        B->addSuccessor(P1);
+        P1->addSuccessor(C);
+        C->addSuccessor(P2);
+        P2->addSuccessor(P1);
+
+        PS.setRoot(A);
+        PointerAnalysisFICollapse PA(&PS);
+        PA.run();
+
+        check(PA.getCollapsedNodesNum() > 0, "the cycle was not collapsed");
+        for (PSNode *n : {P1, C, P2}) {
+            check(n->doesPointsTo(A), "node does not point to A");
+            check(n->doesPointsTo(B), "node does not point to B");
+            check(n->pointsTo.size() == 2, "node points to too much");
+        }
+    }
+
+    void test()
+    {
+        PointsToTest<PointerAnalysisFICollapse>::test();
+        copy_cycle();
+    }
+};
+
+// flow-insensitive analysis that runs in more threads
+class PointerAnalysisFIParallel : public analysis::pta::PointerAnalysisFI
+{
+public:
+    PointerAnalysisFIParallel(PointerSubgraph *PS)
+        : PointerAnalysisFI(PS, analysis::PointerAnalysisOptions()
+                                    .setSolverThreads(4)) {}
+};
+
+class FlowInsensitiveParallelPointsToTest
+    : public PointsToTest<PointerAnalysisFIParallel>
+{
+public:
+    FlowInsensitiveParallelPointsToTest()
+        : PointsToTest<PointerAnalysisFIParallel>
+          ("flow-insensitive points-to test (parallel)") {}
+
+    // many independent branches, so that the nodes
+    // are really processed by more threads
+    void wide_graph()
+    {
+        using namespace analysis;
+
+        const unsigned num = 100;
+        PointerSubgraph PS;
+        PSNode *P = PS.create(PSNodeType::ALLOC);
+        PSNode *ret = PS.create(PSNodeType::NOOP);
+        std::vector<PSNode *> allocs, loads, geps;
+        for (unsigned i = 0; i < num; ++i) {
+            PSNode *A = PS.create(PSNodeType::ALLOC);
+            A->setSize(8);
+            PSNode *S = PS.create(PSNodeType::STORE, A, P);
+            PSNode *L = PS.create(PSNodeType::LOAD, P);
+            PSNode *G = PS.create(PSNodeType::GEP, L, 4);
+
+            P->addSuccessor(A);
+            A->addSuccessor(S);
+            S->addSuccessor(L);
+            L->addSuccessor(G);
+            G->addSuccessor(ret);
+
+            allocs.push_back(A);
+            loads.push_back(L);
+            geps.push_back(G);
+        }
+
+        PS.setRoot(P);
+        PointerAnalysisFIParallel PA(&PS);
+        PA.run();
+
+        for (unsigned i = 0; i < num; ++i) {
+            for (unsigned j = 0; j < num; ++j) {
+                check(loads[i]->doesPointsTo(allocs[j]),
+                      "load does not point to an alloc");
+                check(geps[i]->doesPointsTo(allocs[j], 4),
+                      "GEP does not point to an alloc + 4");
+            }
+            check(loads[i]->pointsTo.size() == num, "load points to too much");
+        }
+    }
+
+    // the memory is allocated outside of the graph, so the solver
+    // does not create its object beforehand and the threads must
+    // leave the loads and stores to the sequential processing
+    void memory_outside_graph()
+    {
+        using namespace analysis;
+
+        const unsigned num = 100;
+        PointerSubgraph PS, other;
+        PSNode *M = other.create(PSNodeType::ALLOC);
+        PSNode *root = PS.create(PSNodeType::NOOP);
+        PSNode *ret = PS.create(PSNodeType::NOOP);
+        std::vector<PSNode *> allocs, loads;
+        for (unsigned i = 0; i < num; ++i) {
+            PSNode *A = PS.create(PSNodeType::ALLOC);
+            PSNode *C = PS.create(PSNodeType::CONSTANT, M, Offset::type(0));
+            PSNode *S = PS.create(PSNodeType::STORE, A, C);
+            PSNode *L = PS.create(PSNodeType::LOAD, C);
+
+            root->addSuccessor(A);
+            A->addSuccessor(C);
+            C->addSuccessor(S);
+            S->addSuccessor(L);
+            L->addSuccessor(ret);
+
+            allocs.push_back(A);
+            loads.push_back(L);
+        }
+
+        PS.setRoot(root);
+        PointerAnalysisFIParallel PA(&PS);
+        PA.run();
+
+        for (unsigned i = 0; i < num; ++i) {
+            for (unsigned j = 0; j < num; ++j) {
+                check(loads[i]->doesPointsTo(allocs[j]),
+                      "load does not point to an alloc");
+            }
+        }
+    }
+
+    void test()
+    {
+        PointsToTest<PointerAnalysisFIParallel>::test();
+        wide_graph();
+        memory_outside_graph();
+    }
+};
+
+class PSEquivalentNodesMergerTest : public Test
+{
+public:
+    PSEquivalentNodesMergerTest()
+        : Test("PointerSubgraph nodes merger test") {}
+
+    void merge_loads()
+    {
+        using namespace analysis;
+
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        A->setSize(8);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *S = PS.create(PSNodeType::STORE, A, B);
+        PSNode *C = PS.create(PSNodeType::CAST, B);
+        PSNode *L1 = PS.create(PSNodeType::LOAD, B);
+        PSNode *L2 = PS.create(PSNodeType::LOAD, C);
+        PSNode *G1 = PS.create(PSNodeType::GEP, L1, 4);
+        PSNode *G2 = PS.create(PSNodeType::GEP, L2, 4);
+        PSNode *L3 = PS.create(PSNodeType::LOAD, G2);
+
+        A->addSuccessor(B);
+        B->addSuccessor(S);
+        S->addSuccessor(C);
+        C->addSuccessor(L1);
+        L1->addSuccessor(L2);
+        L2->addSuccessor(G1);
+        G1->addSuccessor(G2);
+        G2->addSuccessor(L3);
+
+        PS.setRoot(A);
+        PSEquivalentNodesMerger merger(&PS);
+        merger.runHVN();
+
+        // C, L2 and G2 are merged
+        check(merger.getNumOfMergedNodes() == 3, "wrong number of merged nodes");
+        check(merger.getMapping().get(L2) == L1, "L2 not merged into L1");
+        check(merger.getMapping().get(G2) == G1, "G2 not merged into G1");
+        check(L3->getOperand(0) == G1, "L3 does not use G1");
+
+        PointerAnalysisFI PA(&PS);
+        PA.run();
+
+        check(L1->doesPointsTo(A), "L1 does not point to A");
+        check(G1->doesPointsTo(A, 4), "G1 does not point to A + 4");
+    }
+
+    // null and unknown memory have the same ID (zero),
+    // but the constants pointing to them are different values
+    void merge_constants()
+    {
+        using namespace analysis;
+
+        PointerSubgraph PS;
+        PSNode *C1 = PS.create(PSNodeType::CONSTANT, NULLPTR, Offset::type(0));
+        PSNode *C2 = PS.create(PSNodeType::CONSTANT, UNKNOWN_MEMORY, Offset::type(0));
+        PSNode *C3 = PS.create(PSNodeType::CONSTANT, NULLPTR, Offset::type(0));
+        PSNode *L1 = PS.create(PSNodeType::LOAD, C1);
+        PSNode *L2 = PS.create(PSNodeType::LOAD, C2);
+
+        C1->addSuccessor(C2);
+        C2->addSuccessor(C3);
+        C3->addSuccessor(L1);
+        L1->addSuccessor(L2);
+
+        PS.setRoot(C1);
+        PSEquivalentNodesMerger merger(&PS);
+        merger.runHVN();
+
+        check(merger.getNumOfMergedNodes() == 1, "wrong number of merged nodes");
+        check(merger.getMapping().get(C3) == C1, "C3 not merged into C1");
+        check(merger.getMapping().get(C2) == nullptr, "C2 merged");
+        check(merger.getMapping().get(L2) == nullptr, "L2 merged");
+        check(L2->getOperand(0) == C2, "L2 does not use C2");
+    }
+
+    void test()
+    {
+        merge_loads();
+        merge_constants();
+    }
+};
+
 class FlowSensitivePointsToTest
     : public PointsToTest<analysis::pta::PointerAnalysisFS>
 {
@@ -954,6 +1306,371 @@ public:
     FlowSensitivePointsToTest()
         : PointsToTest<analysis::pta::PointerAnalysisFS>
           ("flow-sensitive points-to test") {}
+
+    void test()
+    {
+        PointsToTest<analysis::pta::PointerAnalysisFS>::test();
+        branches();
+    }
+};
+
+class SparseFlowSensitivePointsToTest
+    : public PointsToTest<analysis::pta::PointerAnalysisSFS>
+{
+public:
+    SparseFlowSensitivePointsToTest()
+        : PointsToTest<analysis::pta::PointerAnalysisSFS>
+          ("sparse flow-sensitive points-to test") {}
+
+    // the stores in the loop and before the loop reach the load
+    // in the loop header through a phi node of memory SSA
+    void loop()
+    {
+        using namespace analysis;
+
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *P = PS.create(PSNodeType::ALLOC);
+        PSNode *S1 = PS.create(PSNodeType::STORE, A, P);
+        PSNode *L1 = PS.create(PSNodeType::LOAD, P);
+        PSNode *S2 = PS.create(PSNodeType::STORE, B, P);
+        PSNode *L2 = PS.create(PSNodeType::LOAD, P);
+        PSNode *L3 = PS.create(PSNodeType::LOAD, P);
+
+        /*
+         *   A -> B -> P -> S1 -> L1 <---
+         *                        /  \    |
+         *                       L2   S2  |
+         *                        \  /    |
+         *                         L3 ----
+         */
+        A->addSuccessor(B);
+        B->addSuccessor(P);
+        P->addSuccessor(S1);
+        S1->addSuccessor(L1);
+        L1->addSuccessor(L2);
+        L2->addSuccessor(L3);
+        L1->addSuccessor(S2);
+        S2->addSuccessor(L3);
+        L3->addSuccessor(L1);
+
+        PS.setRoot(A);
+        analysis::pta::PointerAnalysisSFS PA(&PS);
+        PA.run();
+
+        check(L1->doesPointsTo(A), "L1 does not point to A");
+        check(L1->doesPointsTo(B), "L1 does not point to B");
+        check(L2->doesPointsTo(A), "L2 does not point to A");
+        check(L2->doesPointsTo(B), "L2 does not point to B");
+        check(L3->doesPointsTo(A), "L3 does not point to A");
+        check(L3->doesPointsTo(B), "L3 does not point to B");
+        // S1 and S2 reach L1, L2, L3 and S2
+        check(PA.getMemoryEdgesNum() == 8, "wrong number of memory edges: %zu",
+              PA.getMemoryEdgesNum());
+    }
+
+    void test()
+    {
+        PointsToTest<analysis::pta::PointerAnalysisSFS>::test();
+        branches();
+        loop();
+    }
+};
+
+class DemandPointsToTest : public Test
+{
+    // build the same pseudo-random graph (given by the seed) into every
+    // given subgraph, the nodes are returned in the order of creation
+    static std::vector<PSNode *> createGraph(PointerSubgraph& PS, unsigned seed)
+    {
+        std::vector<PSNode *> nodes;
+        std::vector<PSNode *> values;
+        for (int i = 0; i < 4; ++i) {
+            PSNode *A = PS.create(PSNodeType::ALLOC);
+            A->setSize(16);
+            if (i % 2 == 1)
+                PSNodeAlloc::get(A)->setZeroInitialized();
+            if (!nodes.empty())
+                nodes.back()->addSuccessor(A);
+            nodes.push_back(A);
+            values.push_back(A);
+        }
+
+        auto rand = [&seed](size_t n) {
+            seed = seed * 1103515245 + 12345;
+            return (seed / 65536) % n;
+        };
+
+        for (int i = 0; i < 60; ++i) {
+            PSNode *a = values[rand(values.size())];
+            PSNode *b = values[rand(values.size())];
+            PSNode *n = nullptr;
+            switch (i % 6) {
+            case 0: n = PS.create(PSNodeType::STORE, a, b); break;
+            case 1: n = PS.create(PSNodeType::LOAD, a); break;
+            case 2: n = PS.create(PSNodeType::GEP, a,
+                                  rand(4) == 0 ? Offset::UNKNOWN : (i % 3) * 8);
+                    break;
+            case 3: n = PS.create(PSNodeType::CAST, a); break;
+            case 4: n = PS.create(PSNodeType::MEMCPY, a, b, 8); break;
+            default: n = PS.create(PSNodeType::PHI, a, b, nullptr); break;
+            }
+
+            nodes.back()->addSuccessor(n);
+            nodes.push_back(n);
+            if (n->getType() != PSNodeType::STORE &&
+                n->getType() != PSNodeType::MEMCPY)
+                values.push_back(n);
+        }
+
+        PS.setRoot(nodes[0]);
+        return nodes;
+    }
+
+public:
+    DemandPointsToTest() : Test("demand-driven points-to test") {}
+
+    void covers_fi(unsigned seed)
+    {
+        PointerSubgraph PS1, PS2;
+        auto nodes1 = createGraph(PS1, seed);
+        auto nodes2 = createGraph(PS2, seed);
+
+        analysis::PointerAnalysisOptions opts;
+        opts.setPreprocessGeps(false);
+        PointerAnalysisFI PA(&PS1, opts);
+        PA.run();
+
+        // query the nodes from the last one, so that
+        // the first queries explore most of the graph
+        DemandPointerAnalysis DPA(&PS2);
+        for (size_t i = nodes2.size(); i > 0; --i) {
+            const auto& pts = DPA.query(nodes2[i - 1]);
+
+            // the demand-driven analysis does not follow the order
+            // of the nodes, so it may be less precise than the full one,
+            // but it must cover all its pointers
+            for (const Pointer& ptr : nodes1[i - 1]->pointsTo) {
+                // map the target to the second graph
+                // (null and unknown memory are shared)
+                PSNode *target = ptr.target;
+                if (!ptr.isNull() && !ptr.isUnknown())
+                    target = nodes2[ptr.target->getID() - nodes1[0]->getID()];
+                check(pts.has(Pointer(target, ptr.offset)) ||
+                      pts.has(Pointer(target, Offset::UNKNOWN)),
+                      "seed %u: node %u misses a pointer",
+                      seed, nodes2[i - 1]->getID());
+            }
+        }
+
+        check(DPA.getStatistics().exceeded == 0, "query exceeded the budget");
+    }
+
+    // arr[1] = &B; memmove(arr, arr + 1, 8); x = arr[0]
+    void memcpy_self()
+    {
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        A->setSize(16);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *G = PS.create(PSNodeType::GEP, A, 8);
+        PSNode *S = PS.create(PSNodeType::STORE, B, G);
+        PSNode *CPY = PS.create(PSNodeType::MEMCPY, G, A, 8);
+        PSNode *L = PS.create(PSNodeType::LOAD, A);
+
+        A->addSuccessor(B);
+        B->addSuccessor(G);
+        G->addSuccessor(S);
+        S->addSuccessor(CPY);
+        CPY->addSuccessor(L);
+        PS.setRoot(A);
+
+        DemandPointerAnalysis DPA(&PS);
+        check(DPA.query(L).has(Pointer(B, 0)), "L does not point to B");
+    }
+
+    // the memory is written only at unknown offset,
+    // so the load may read the initial null
+    void zero_initialized()
+    {
+        PointerSubgraph PS;
+        PSNode *Z = PS.create(PSNodeType::ALLOC);
+        Z->setSize(16);
+        PSNodeAlloc::get(Z)->setZeroInitialized();
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *G = PS.create(PSNodeType::GEP, Z, Offset::UNKNOWN);
+        PSNode *S = PS.create(PSNodeType::STORE, B, G);
+        PSNode *L = PS.create(PSNodeType::LOAD, Z);
+
+        Z->addSuccessor(B);
+        B->addSuccessor(G);
+        G->addSuccessor(S);
+        S->addSuccessor(L);
+        PS.setRoot(Z);
+
+        DemandPointerAnalysis DPA(&PS);
+        // resolve the address first, so that the load
+        // sees the store the first time it is computed
+        check(DPA.query(G).has(Pointer(Z, Offset::UNKNOWN)),
+              "G does not point to Z + UNKNOWN");
+        const auto& pts = DPA.query(L);
+        check(pts.has(Pointer(B, 0)), "L does not point to B");
+        check(pts.hasNull(), "L does not point to null");
+    }
+
+    void store_load()
+    {
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *C = PS.create(PSNodeType::ALLOC);
+        PSNode *S1 = PS.create(PSNodeType::STORE, A, B);
+        PSNode *S2 = PS.create(PSNodeType::STORE, B, C);
+        PSNode *L1 = PS.create(PSNodeType::LOAD, C);
+        PSNode *L2 = PS.create(PSNodeType::LOAD, L1);
+        PSNode *P = PS.create(PSNodeType::PHI, L2, C, nullptr);
+
+        A->addSuccessor(B);
+        B->addSuccessor(C);
+        C->addSuccessor(S1);
+        S1->addSuccessor(S2);
+        S2->addSuccessor(L1);
+        L1->addSuccessor(L2);
+        L2->addSuccessor(P);
+        PS.setRoot(A);
+
+        DemandPointerAnalysis DPA(&PS);
+        const auto& pts = DPA.query(P);
+        check(pts.size() == 2, "P points to %u pointers", pts.size());
+        check(pts.has(Pointer(A, 0)), "P does not point to A");
+        check(pts.has(Pointer(C, 0)), "P does not point to C");
+        check(!DPA.isResolved(S1), "a store got a points-to set");
+    }
+
+    void memoization()
+    {
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *S = PS.create(PSNodeType::STORE, A, B);
+        PSNode *C = PS.create(PSNodeType::CAST, B);
+        PSNode *L = PS.create(PSNodeType::LOAD, C);
+
+        A->addSuccessor(B);
+        B->addSuccessor(S);
+        S->addSuccessor(C);
+        C->addSuccessor(L);
+        PS.setRoot(A);
+
+        DemandPointerAnalysis DPA(&PS);
+        check(DPA.query(L).has(Pointer(A, 0)), "L does not point to A");
+        check(DPA.isResolved(C), "the operand of L was not resolved");
+
+        auto queries = DPA.getStatistics().queries;
+        check(DPA.query(C).has(Pointer(B, 0)), "C does not point to B");
+        check(DPA.getStatistics().queries == queries, "the query was not cached");
+    }
+
+    void budget()
+    {
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *S = PS.create(PSNodeType::STORE, A, B);
+        PSNode *L = PS.create(PSNodeType::LOAD, B);
+
+        A->addSuccessor(B);
+        B->addSuccessor(S);
+        S->addSuccessor(L);
+        PS.setRoot(A);
+
+        analysis::PointerAnalysisOptions opts;
+        opts.setQueryBudget(1);
+        DemandPointerAnalysis DPA(&PS, opts);
+        check(DPA.query(L).hasUnknown(), "L does not point to unknown memory");
+        check(!DPA.isResolved(B), "the explored nodes were kept");
+        check(DPA.getStatistics().exceeded == 1, "the budget was not exceeded");
+    }
+
+    // the query of C4 exceeds the budget, but then we resolve
+    // the chain step by step and the store through C4 must be seen
+    void after_budget()
+    {
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *C1 = PS.create(PSNodeType::CAST, B);
+        PSNode *C2 = PS.create(PSNodeType::CAST, C1);
+        PSNode *C3 = PS.create(PSNodeType::CAST, C2);
+        PSNode *C4 = PS.create(PSNodeType::CAST, C3);
+        PSNode *S = PS.create(PSNodeType::STORE, A, C4);
+        PSNode *L = PS.create(PSNodeType::LOAD, B);
+
+        A->addSuccessor(B);
+        B->addSuccessor(C1);
+        C1->addSuccessor(C2);
+        C2->addSuccessor(C3);
+        C3->addSuccessor(C4);
+        C4->addSuccessor(S);
+        S->addSuccessor(L);
+        PS.setRoot(A);
+
+        analysis::PointerAnalysisOptions opts;
+        opts.setQueryBudget(3);
+        DemandPointerAnalysis DPA(&PS, opts);
+        check(DPA.query(C4).hasUnknown(), "C4 does not point to unknown memory");
+        check(!DPA.isResolved(C4), "the unknown pointer was kept");
+
+        for (PSNode *nd : {A, B, C1, C2, C3, C4})
+            DPA.query(nd);
+        check(DPA.query(C4).has(Pointer(B, 0)), "C4 does not point to B");
+        check(DPA.getStatistics().exceeded == 1, "a query exceeded the budget");
+
+        const auto& pts = DPA.query(L);
+        check(!pts.hasUnknown(), "L points to unknown memory");
+        check(pts.has(Pointer(A, 0)), "L does not point to A");
+    }
+
+    // the load does not need the addresses of the stores
+    // that can not write to the loaded memory
+    void unrelated_stores()
+    {
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *C = PS.create(PSNodeType::ALLOC);
+        C->setSize(16);
+        PSNode *G = PS.create(PSNodeType::GEP, C, 8);
+        PSNode *S1 = PS.create(PSNodeType::STORE, A, B);
+        PSNode *S2 = PS.create(PSNodeType::STORE, A, G);
+        PSNode *L = PS.create(PSNodeType::LOAD, B);
+
+        A->addSuccessor(B);
+        B->addSuccessor(C);
+        C->addSuccessor(G);
+        G->addSuccessor(S1);
+        S1->addSuccessor(S2);
+        S2->addSuccessor(L);
+        PS.setRoot(A);
+
+        DemandPointerAnalysis DPA(&PS);
+        check(DPA.query(L).has(Pointer(A, 0)), "L does not point to A");
+        check(!DPA.isResolved(G), "the address of an unrelated store was resolved");
+    }
+
+    void test()
+    {
+        for (unsigned seed = 1; seed <= 200; ++seed)
+            covers_fi(seed);
+        memcpy_self();
+        zero_initialized();
+        store_load();
+        memoization();
+        budget();
+        after_budget();
+        unrelated_stores();
+    }
 };
 
 class PSNodeTest : public Test
@@ -994,7 +1711,13 @@ int main(void)
     TestRunner Runner;
 
     Runner.add(new FlowInsensitivePointsToTest());
+    Runner.add(new FlowInsensitiveDiffPointsToTest());
+    Runner.add(new FlowInsensitiveCollapsePointsToTest());
+    Runner.add(new FlowInsensitiveParallelPointsToTest());
+    Runner.add(new PSEquivalentNodesMergerTest());
     Runner.add(new FlowSensitivePointsToTest());
+    Runner.add(new SparseFlowSensitivePointsToTest());
+    Runner.add(new DemandPointsToTest());
     Runner.add(new PSNodeTest());
 
     return Runner();
@@ -10,19 +10,25 @@ using namespace dg::analysis::pta;
 std::default_random_engine generator;
 std::uniform_int_distribution<uint64_t> distribution(0, ~static_cast<uint64_t>(0));
 
-#define run(func, msg) do { \
-    std::cout << "Running " << msg << "\n"; \
+#define measure(func, PTSetT, msg) do { \
     dg::debug::TimeMeasure tm; \
     tm.start(); \
     for (int i = 0; i < times; ++i) \
-        func<PointsToSet>(); \
-    tm.stop(); \
-    tm.report(" -- PointsToSet bitvector took"); \
-    tm.start(); \
-    for (int i = 0; i < times; ++i) \
-        func<SimplePointsToSet>(); \
+        func<PTSetT>(); \
     tm.stop(); \
-    tm.report(" -- PointsToSet std::set took"); \
+    tm.report(" -- " msg " took"); \
+    } while(0);
+
+#define run(func, msg) do { \
+    std::cout << "Running " << msg << "\n"; \
+    measure(func, BitvectorPointsToSet, "BitvectorPointsToSet"); \
+    measure(func, FlatPointsToSet, "FlatPointsToSet"); \
+    measure(func, SimplePointsToSet, "SimplePointsToSet"); \
+    PointsToSet::setDefaultRepresentation(PointsToSet::Representation::BITVECTOR); \
+    measure(func, PointsToSet, "PointsToSet (bitvector)"); \
+    PointsToSet::setDefaultRepresentation(PointsToSet::Representation::FLAT); \
+    measure(func, PointsToSet, "PointsToSet (flat)"); \
+    PointsToSet::setDefaultRepresentation(PointsToSet::Representation::BITVECTOR); \
     } while(0);
 
 template <typename PTSetT>
@@ -82,10 +88,36 @@ void test5() {
 
     PTSetT S;
     for (int i = 0; i < 1000; ++i) {
-        S.add(reinterpret_cast<PSNode *>(i), i);
+        S.add(reinterpret_cast<PSNode *>(i + 1), i);
+    }
+}
+
+template <typename PTSetT>
+void test6() {
+    PTSetT S1, S2;
+    for (int i = 0; i < 100; ++i) {
+        S1.add(reinterpret_cast<PSNode *>(i + 1), i);
+        S2.add(reinterpret_cast<PSNode *>(i + 51), i);
     }
+
+    // union that adds new elements and union that adds nothing
+    S1.add(S2);
+    S1.add(S2);
 }
 
+template <typename PTSetT>
+void test7() {
+    std::vector<PTSetT> sets(100);
+    for (int i = 0; i < 100; ++i) {
+        sets[i].add(reinterpret_cast<PSNode *>(i + 1), 0);
+    }
+
+    // propagate the pointers along a chain of sets
+    // (like in a chain of CAST nodes)
+    for (int i = 1; i < 100; ++i) {
+        sets[i].add(sets[i - 1]);
+    }
+}
 
 int main()
 {
@@ -104,4 +136,10 @@ int main()
 
     times = 10000;
     run(test5, "Adding 1000 different pointers");
+
+    times = 10000;
+    run(test6, "Union of sets with 100 pointers");
+
+    times = 1000;
+    run(test7, "Propagating pointers along a chain of 100 sets");
 }
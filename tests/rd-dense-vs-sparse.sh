@@ -0,0 +1,27 @@
+#!/bin/bash
+
+TESTS_DIR=`dirname $0`
+source "$TESTS_DIR/test-runner.sh"
+
+set_environment
+
+NAME="$TESTS_DIR/rd-dense-vs-sparse"
+
+# the semi-sparse analysis does strong updates per bytes,
+# so compare it with the dense analysis on interval maps
+for SRC in loop1 loop2 loop3 loop4 loop5 phi1 phi2 phi3 phi4 \
+	   pointers1 pointers2 pointers3 pointers4 sum1 sum2 sum3 \
+	   switch1 switch2 test1 test2 test3 test4 test5; do
+	CODE="$TESTS_DIR/sources/$SRC.c"
+	BCFILE="$NAME.$SRC.bc"
+
+	compile "$CODE" "$BCFILE"
+
+	llvm-rd-dump -rd-interval-maps -dump-uses "$BCFILE" > "$NAME.$SRC.dense" \
+		|| errmsg "Dense reaching definitions failed ($SRC)"
+	llvm-rd-dump -rda ss -dump-uses "$BCFILE" > "$NAME.$SRC.ss" \
+		|| errmsg "Semi-sparse reaching definitions failed ($SRC)"
+
+	diff "$NAME.$SRC.dense" "$NAME.$SRC.ss" \
+		|| errmsg "Dense and semi-sparse reaching definitions differ ($SRC)"
+done
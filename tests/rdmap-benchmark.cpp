@@ -7,6 +7,7 @@
 
 // create two random rd maps of the
 // size 'size' and merge them
+template <typename MapT>
 void run(int size, int times = 100000)
 {
     using namespace dg::analysis::rd;
@@ -14,7 +15,7 @@ void run(int size, int times = 100000)
     std::vector<RDNode> rdnodes(size, RDNode());
 
     while (--times > 0) {
-        RDMap A, B;
+        MapT A, B;
 
         // fill in the maps randomly
         for (int i = 0; i < size; ++i) {
@@ -39,19 +40,30 @@ void run(int size, int times = 100000)
 
 }
 
-void test(int size)
+template <typename MapT>
+void test(int size, const char *name)
 {
     dg::debug::TimeMeasure tm;
-    std::string msg = "[200000 iter] Sets of size max ";
+    std::string msg = "[200000 iter] ";
+    msg += name;
+    msg += ": Sets of size max ";
     msg += std::to_string(size);
     msg += " -- ";
 
     tm.start();
-    run(size, 200000);
+    run<MapT>(size, 200000);
     tm.stop();
     tm.report(msg.c_str());
 }
 
+void test(int size)
+{
+    using namespace dg::analysis::rd;
+
+    test<BasicRDMap>(size, "BasicRDMap");
+    test<IntervalRDMap>(size, "IntervalRDMap");
+}
+
 int main()
 {
     test(1);
@@ -117,3 +117,142 @@ TEST_CASE("iterator", "DisjunctiveIntervalMap") {
 */
 
 
+
+TEST_CASE("Interval map: singleton", "IntervalRDMap") {
+    IntervalRDMap M;
+    REQUIRE(M.empty());
+
+    M.add(DefSite(&A, 0, 4), &B);
+    REQUIRE(!M.empty());
+
+    std::set<RDNode *> rd;
+    // full overlap
+    for (int i = 0; i < 4; ++i) {
+        for (int j = i; j < 4; ++j) {
+            rd.clear();
+            M.get(&A, i, j - i + 1, rd);
+            REQUIRE(rd.size() == 1);
+            REQUIRE(*(rd.begin()) == &B);
+        }
+    }
+
+    // partial overlap
+    for (int i = 0; i < 4; ++i) {
+        rd.clear();
+        M.get(&A, i, 10, rd);
+        REQUIRE(rd.size() == 1);
+    }
+
+    // no overlap
+    rd.clear();
+    M.get(&A, 4, 4, rd);
+    REQUIRE(rd.empty());
+    M.get(&B, 0, 4, rd);
+    REQUIRE(rd.empty());
+
+    // unknown offset
+    M.get(&A, Offset::UNKNOWN, 1, rd);
+    REQUIRE(rd.size() == 1);
+}
+
+TEST_CASE("Interval map: update", "IntervalRDMap") {
+    IntervalRDMap M;
+
+    M.add(DefSite(&A, 0, 8), &B);
+    M.update(DefSite(&A, 2, 2), &C);
+
+    std::set<RDNode *> rd;
+    M.get(&A, 2, 2, rd);
+    REQUIRE(rd.size() == 1);
+    REQUIRE(*(rd.begin()) == &C);
+
+    rd.clear();
+    M.get(&A, 0, 2, rd);
+    REQUIRE(rd.size() == 1);
+    REQUIRE(*(rd.begin()) == &B);
+
+    rd.clear();
+    M.get(&A, 0, 8, rd);
+    REQUIRE(rd.size() == 2);
+}
+
+TEST_CASE("Interval map: iterator", "IntervalRDMap") {
+    IntervalRDMap M;
+    REQUIRE(M.begin() == M.end());
+
+    M.add(DefSite(&A, 0, 4), &B);
+    auto it = M.begin();
+    REQUIRE(it != M.end());
+
+    auto d = *it;
+    REQUIRE(d.first.target == &A);
+    REQUIRE(*d.first.offset == 0);
+    REQUIRE(*d.first.len == 4);
+    REQUIRE(d.second.size() == 1);
+    REQUIRE(*(d.second.begin()) == &B);
+
+    ++it;
+    REQUIRE(it == M.end());
+}
+
+TEST_CASE("Interval map: strong update in merge", "IntervalRDMap") {
+    IntervalRDMap M, N;
+
+    N.add(DefSite(&A, 0, 8), &B);
+    DefSiteSetT overwrites{DefSite(&A, 2, 2)};
+    REQUIRE(M.merge(&N, &overwrites));
+
+    std::set<RDNode *> rd;
+    M.get(&A, 2, 2, rd);
+    REQUIRE(rd.empty());
+    M.get(&A, 0, 2, rd);
+    REQUIRE(rd.size() == 1);
+    rd.clear();
+    M.get(&A, 4, 4, rd);
+    REQUIRE(rd.size() == 1);
+
+    // nothing new
+    REQUIRE(!M.merge(&N, &overwrites));
+}
+
+// without strong updates both maps must give the same definitions
+TEST_CASE("Interval map: random compare with BasicRDMap", "IntervalRDMap") {
+    std::vector<RDNode> nodes(10, RDNode());
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> node(0, 9);
+    std::uniform_int_distribution<int> off(0, 15);
+
+    for (int round = 0; round < 50; ++round) {
+        BasicRDMap B1, B2;
+        IntervalRDMap I1, I2;
+
+        for (int i = 0; i < 10; ++i) {
+            DefSite ds(&nodes[node(gen)], off(gen), off(gen) + 1);
+            RDNode *val = &nodes[node(gen)];
+            B1.add(ds, val);
+            I1.add(ds, val);
+
+            DefSite ds2(&nodes[node(gen)], off(gen), off(gen) + 1);
+            val = &nodes[node(gen)];
+            B2.add(ds2, val);
+            I2.add(ds2, val);
+        }
+
+        B2.merge(&B1);
+        I2.merge(&I1);
+
+        for (auto& n : nodes) {
+            for (int o = 0; o < 32; ++o) {
+                std::set<RDNode *> rd1, rd2;
+                B2.get(&n, o, 1, rd1);
+                I2.get(&n, o, 1, rd2);
+                REQUIRE(rd1 == rd2);
+            }
+
+            std::set<RDNode *> rd1, rd2;
+            B2.get(&n, Offset::UNKNOWN, 1, rd1);
+            I2.get(&n, Offset::UNKNOWN, 1, rd2);
+            REQUIRE(rd1 == rd2);
+        }
+    }
+}
@@ -2,12 +2,17 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstring>
+#include <map>
+#include <memory>
+#include <set>
 
 #include "test-runner.h"
 #include "test-dg.h"
 
 #include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
 #include "dg/analysis/ReachingDefinitions/RDMap.h"
+#include "dg/analysis/ReachingDefinitions/RDFunctionSummaries.h"
+#include "dg/analysis/ReachingDefinitions/SemisparseRda.h"
 
 namespace dg {
 namespace tests {
@@ -41,7 +46,7 @@ public:
     ReachingDefinitionsTest()
         : Test("Reaching definitions test") {}
 
-    void basic1()
+    void basic1(bool intervals)
     {
         RDNode AL1;
         RDNode AL2;
@@ -55,7 +60,8 @@ public:
         AL2.addSuccessor(&S1);
         S1.addSuccessor(&S2);
 
-        ReachingDefinitionsAnalysis RD(&AL1);
+        analysis::ReachingDefinitionsAnalysisOptions opts;
+        ReachingDefinitionsAnalysis RD(&AL1, opts.setIntervalMaps(intervals));
         RD.run();
 
         std::set<RDNode *> rd;
@@ -83,7 +89,7 @@ public:
         check(rd.size() == 0, "Should have had no r.d.");
     }
 
-    void basic2()
+    void basic2(bool intervals)
     {
         RDNode AL1;
         RDNode AL2;
@@ -97,7 +103,8 @@ public:
         AL2.addSuccessor(&S1);
         S1.addSuccessor(&S2);
 
-        ReachingDefinitionsAnalysis RD(&AL1);
+        analysis::ReachingDefinitionsAnalysisOptions opts;
+        ReachingDefinitionsAnalysis RD(&AL1, opts.setIntervalMaps(intervals));
         RD.run();
 
         std::set<RDNode *> rd;
@@ -123,7 +130,7 @@ public:
         check(rd.size() == 0, "Should have had no r.d.");
     }
 
-    void basic3()
+    void basic3(bool intervals)
     {
         RDNode AL1;
         RDNode AL2;
@@ -137,7 +144,8 @@ public:
         AL2.addSuccessor(&S1);
         S1.addSuccessor(&S2);
 
-        ReachingDefinitionsAnalysis RD(&AL1);
+        analysis::ReachingDefinitionsAnalysisOptions opts;
+        ReachingDefinitionsAnalysis RD(&AL1, opts.setIntervalMaps(intervals));
         RD.run();
 
         std::set<RDNode *> rd;
@@ -179,7 +187,7 @@ public:
         check(rd.size() == 0, "Should not have r.d.");
     }
 
-    void basic4()
+    void basic4(bool intervals)
     {
         RDNode AL1;
         RDNode AL2;
@@ -199,7 +207,8 @@ public:
         AL2.addSuccessor(&S1);
         S1.addSuccessor(&S2);
 
-        ReachingDefinitionsAnalysis RD(&AL1);
+        analysis::ReachingDefinitionsAnalysisOptions opts;
+        ReachingDefinitionsAnalysis RD(&AL1, opts.setIntervalMaps(intervals));
         RD.run();
 
         std::set<RDNode *> rd;
@@ -212,13 +221,16 @@ public:
         check(rd.size() == 1, "Should have had one r.d.");
         check(*(rd.begin()) == &S1, "Should be S1");
 
-        // bytes 2 and 3 should be defined on both S1 and S2
+        // bytes 2 and 3 should be defined on both S1 and S2,
+        // the interval map performs the strong update per bytes
+        // and keeps only S2
+        size_t expected = intervals ? 1 : 2;
         rd.clear();
         S2.getReachingDefinitions(&AL1, 2, 1, rd);
-        check(rd.size() == 2, "Should have two r.d.");
+        check(rd.size() == expected, "Wrong number of r.d.");
         rd.clear();
         S2.getReachingDefinitions(&AL1, 3, 1, rd);
-        check(rd.size() == 2, "Should have two r.d.");
+        check(rd.size() == expected, "Wrong number of r.d.");
 
         rd.clear();
         S2.getReachingDefinitions(&AL1, 4, 1, rd);
@@ -237,12 +249,376 @@ public:
         //dumpMap(&S2);
     }
 
+    void loop(bool intervals)
+    {
+        RDNode AL1;
+        RDNode S1;
+        RDNode L;
+        RDNode S2;
+        RDNode E;
+
+        S1.addDef(&AL1, 0, 4, true /* strong update */);
+        S2.addDef(&AL1, 0, 4, true /* strong update */);
+
+        AL1.addSuccessor(&S1);
+        S1.addSuccessor(&L);
+        L.addSuccessor(&S2);
+        L.addSuccessor(&E);
+        S2.addSuccessor(&L);
+
+        analysis::ReachingDefinitionsAnalysisOptions opts;
+        ReachingDefinitionsAnalysis RD(&AL1, opts.setIntervalMaps(intervals));
+        RD.run();
+
+        std::set<RDNode *> rd;
+        E.getReachingDefinitions(&AL1, 0, 4, rd);
+        check(rd.size() == 2, "Should have two r.d.");
+        rd.clear();
+        L.getReachingDefinitions(&AL1, 0, 4, rd);
+        check(rd.size() == 2, "Should have two r.d.");
+        rd.clear();
+        S2.getReachingDefinitions(&AL1, 0, 4, rd);
+        check(rd.size() == 1, "Should have had one r.d.");
+        check(*(rd.begin()) == &S2, "Should be S2");
+
+        // the nodes are processed in RPO, so every node
+        // should be processed at most twice here
+        check(RD.getProcessedNodesNum() >= 5, "Did not process all nodes");
+        check(RD.getProcessedNodesNum() <= 10, "Processed too many nodes");
+    }
+
+    void summaries()
+    {
+        RDNode A, B;
+        // main: root -> S1 -> call1 -> sum1 -> S2 -> call2 -> sum2 -> end
+        RDNode root, S1, call1, sum1, S2, call2, sum2, end;
+        // G: rootG -> SG -> retG
+        RDNode rootG, SG, retG;
+
+        S1.addDef(&B, 0, 4, true /* strong update */);
+        S2.addDef(&B, 0, 4, true /* strong update */);
+        SG.addDef(&A, 0, 4, true /* strong update */);
+
+        root.addSuccessor(&S1);
+        S1.addSuccessor(&call1);
+        call1.addSuccessor(&sum1);
+        sum1.addSuccessor(&S2);
+        S2.addSuccessor(&call2);
+        call2.addSuccessor(&sum2);
+        sum2.addSuccessor(&end);
+        rootG.addSuccessor(&SG);
+        SG.addSuccessor(&retG);
+
+        analysis::ReachingDefinitionsAnalysisOptions opts;
+        RDFunctionSummaries FS(opts);
+        auto *main = FS.addFunction(&root, &end);
+        auto *G = FS.addFunction(&rootG, &retG);
+        FS.addCall(main, &call1, &sum1, G);
+        FS.addCall(main, &call2, &sum2, G);
+        FS.compute();
+
+        check(FS.getAnalyzedFunctionsNum() == 2, "Should analyze every function once");
+        check(G->getSummary().kill.size() == 1, "G should overwrite A");
+
+        ReachingDefinitionsAnalysis RD(&root, opts);
+        RD.run();
+
+        std::set<RDNode *> rd;
+        sum1.getReachingDefinitions(&A, 0, 4, rd);
+        check(rd.size() == 1 && *(rd.begin()) == &SG, "A should be defined by SG");
+        // the definition from S2 does not flow from G
+        // to the first call-site
+        rd.clear();
+        sum1.getReachingDefinitions(&B, 0, 4, rd);
+        check(rd.size() == 1 && *(rd.begin()) == &S1, "B should be defined by S1");
+        rd.clear();
+        sum2.getReachingDefinitions(&B, 0, 4, rd);
+        check(rd.size() == 1 && *(rd.begin()) == &S2, "B should be defined by S2");
+
+        // the definitions from callers reach the nodes in G
+        rd.clear();
+        retG.getReachingDefinitions(&B, 0, 4, rd);
+        check(rd.size() == 2, "B should be defined by S1 and S2 in G");
+    }
+
+    void recursiveSummaries()
+    {
+        RDNode A;
+        // G: rootG -> SG -> call -> sum -> retG, rootG -> retG
+        RDNode rootG, SG, call, sum, retG;
+
+        SG.addDef(&A, 0, 4, true /* strong update */);
+
+        rootG.addSuccessor(&SG);
+        rootG.addSuccessor(&retG);
+        SG.addSuccessor(&call);
+        call.addSuccessor(&sum);
+        sum.addSuccessor(&retG);
+
+        analysis::ReachingDefinitionsAnalysisOptions opts;
+        RDFunctionSummaries FS(opts);
+        auto *G = FS.addFunction(&rootG, &retG);
+        FS.addCall(G, &call, &sum, G);
+        FS.compute();
+
+        check(G->getSummary().kill.empty(), "Recursive functions have no kill");
+
+        ReachingDefinitionsAnalysis RD(&rootG, opts);
+        RD.run();
+
+        std::set<RDNode *> rd;
+        sum.getReachingDefinitions(&A, 0, 4, rd);
+        check(rd.size() == 1 && *(rd.begin()) == &SG, "A should be defined by SG");
+    }
+
+    // a loop with strong and weak updates in basic blocks,
+    // so that we can run both the dense and the sparse analysis
+    struct LoopGraph {
+        RDNode A, B;
+        RDNode S1, W, L1, S2, L2, M, L3;
+        BBlock<RDNode> B1, B2, B3, B4;
+
+        LoopGraph() : M(RDNodeType::CALL) {
+            // B1: S1 W
+            S1.addDef(&A, 0, 4, true /* strong update */);
+            W.addDef(&A, 2, 4, false);
+            // B2: L1
+            L1.addUse(DefSite(&A, 0, 4));
+            // B3: S2 L2 M
+            S2.addDef(&A, 0, 4, true /* strong update */);
+            L2.addUse(DefSite(&A, 0, 2));
+            M.addUse(DefSite(&A, 0, 4));
+            M.addDef(&B, 0, 4, true /* strong update */);
+            // B4: L3
+            L3.addUse(DefSite(&A, 0, 8));
+            L3.addUse(DefSite(&B, 0, 4));
+
+            S1.addSuccessor(&W);
+            W.addSuccessor(&L1);
+            L1.addSuccessor(&S2);
+            S2.addSuccessor(&L2);
+            L2.addSuccessor(&M);
+            M.addSuccessor(&L1);
+            L1.addSuccessor(&L3);
+
+            B1.append(&S1);
+            B1.append(&W);
+            B2.append(&L1);
+            B3.append(&S2);
+            B3.append(&L2);
+            B3.append(&M);
+            B4.append(&L3);
+            B1.addSuccessor(&B2);
+            B2.addSuccessor(&B3);
+            B3.addSuccessor(&B2);
+            B2.addSuccessor(&B4);
+        }
+
+        std::vector<RDNode *> uses() { return {&L1, &L2, &M, &L3}; }
+        std::vector<RDNode *> nodes() {
+            return {&A, &B, &S1, &W, &L1, &S2, &L2, &M, &L3};
+        }
+    };
+
+    void denseVsSparse()
+    {
+        LoopGraph dense, sparse;
+
+        // the sparse analysis does strong updates per bytes,
+        // so compare it with the dense analysis on interval maps
+        analysis::ReachingDefinitionsAnalysisOptions opts;
+        ReachingDefinitionsAnalysis RD(&dense.S1, opts.setIntervalMaps(true));
+        RD.run();
+        SemisparseRda SRD(&sparse.S1);
+        SRD.run();
+
+        auto duses = dense.uses();
+        auto suses = sparse.uses();
+        for (unsigned i = 0; i < duses.size(); ++i) {
+            for (const DefSite& use : duses[i]->getUses()) {
+                std::set<RDNode *> drd, srd;
+                duses[i]->getReachingDefinitions(use.target, use.offset,
+                                                 use.len, drd);
+                // map the sparse nodes to the dense ones
+                RDNode *starget = use.target == &dense.A ? &sparse.A : &sparse.B;
+                suses[i]->getReachingDefinitions(starget, use.offset,
+                                                 use.len, srd);
+
+                std::set<RDNode *> mapped;
+                for (RDNode *n : srd) {
+                    RDNode *dense_nodes[] = {&dense.S1, &dense.W, &dense.S2, &dense.M};
+                    RDNode *sparse_nodes[] = {&sparse.S1, &sparse.W, &sparse.S2, &sparse.M};
+                    for (unsigned j = 0; j < 4; ++j) {
+                        if (sparse_nodes[j] == n)
+                            mapped.insert(dense_nodes[j]);
+                    }
+                }
+
+                check(mapped.size() == srd.size(), "Unexpected sparse r.d.");
+                check(drd == mapped, "Dense and sparse r.d. differ");
+            }
+        }
+
+        std::set<RDNode *> rd;
+        dense.L1.getReachingDefinitions(&dense.A, 0, 4, rd);
+        check(rd.size() == 3, "L1 should have S1, W and S2 as r.d.");
+    }
+
+    // a pseudo-random graph of basic blocks (given by the seed) with
+    // strong and weak updates of two variables and calls that use
+    // and define memory. Every node uses at most one memory.
+    struct RandomGraph {
+        RDNode A, B;
+        std::vector<std::unique_ptr<RDNode>> nodes;
+        std::vector<std::unique_ptr<BBlock<RDNode>>> blocks;
+
+        RandomGraph(unsigned seed) {
+            auto rand = [&seed](unsigned n) {
+                seed = seed * 1103515245 + 12345;
+                return (seed / 65536) % n;
+            };
+            auto site = [&](RDNode *var) {
+                unsigned off = rand(8);
+                return DefSite(var, off, 1 + rand(8 - off));
+            };
+
+            for (unsigned b = 0; b < 8; ++b) {
+                blocks.emplace_back(new BBlock<RDNode>());
+                unsigned num = 1 + rand(3);
+                for (unsigned i = 0; i < num; ++i) {
+                    RDNode *var = rand(2) ? &A : &B;
+                    unsigned kind = rand(4);
+                    nodes.emplace_back(new RDNode(kind == 3 ? RDNodeType::CALL
+                                                            : RDNodeType::NONE));
+                    RDNode *n = nodes.back().get();
+                    if (kind == 0 || kind == 3)
+                        n->addDef(site(var), rand(2) /* strong update */);
+                    if (kind == 1)
+                        n->addDef(site(var), false);
+                    // dense r.d. of a node are the r.d. after the node,
+                    // so a call reads the other variable than it defines
+                    if (kind == 2)
+                        n->addUse(site(rand(2) ? &A : &B));
+                    if (kind == 3)
+                        n->addUse(site(var == &A ? &B : &A));
+
+                    if (!blocks.back()->empty())
+                        blocks.back()->getLastNode()->addSuccessor(n);
+                    blocks.back()->append(n);
+                }
+            }
+
+            // a chain of blocks with random jumps (also back)
+            for (unsigned b = 0; b < blocks.size(); ++b) {
+                std::set<unsigned> succs;
+                if (b + 1 < blocks.size())
+                    succs.insert(b + 1);
+                if (rand(2))
+                    succs.insert(rand(blocks.size()));
+
+                for (unsigned s : succs) {
+                    blocks[b]->addSuccessor(blocks[s].get());
+                    blocks[b]->getLastNode()->addSuccessor(blocks[s]->getFirstNode());
+                }
+            }
+        }
+
+        RDNode *getRoot() { return blocks[0]->getFirstNode(); }
+    };
+
+    void randomDenseVsSparse(unsigned seed)
+    {
+        RandomGraph dense(seed), sparse(seed);
+
+        analysis::ReachingDefinitionsAnalysisOptions opts;
+        ReachingDefinitionsAnalysis RD(dense.getRoot(), opts.setIntervalMaps(true));
+        RD.run();
+        SemisparseRda SRD(sparse.getRoot());
+        SRD.run();
+
+        std::map<RDNode *, RDNode *> map{{&sparse.A, &dense.A},
+                                         {&sparse.B, &dense.B}};
+        for (unsigned i = 0; i < sparse.nodes.size(); ++i)
+            map[sparse.nodes[i].get()] = dense.nodes[i].get();
+
+        for (unsigned i = 0; i < dense.nodes.size(); ++i) {
+            for (const DefSite& use : sparse.nodes[i]->getUses()) {
+                std::set<RDNode *> drd, srd, mapped;
+                sparse.nodes[i]->getReachingDefinitions(use.target, use.offset,
+                                                        use.len, srd);
+                dense.nodes[i]->getReachingDefinitions(map[use.target], use.offset,
+                                                       use.len, drd);
+                for (RDNode *n : srd)
+                    mapped.insert(map[n]);
+
+                check(drd == mapped, "seed %u: dense and sparse r.d. of node %u differ",
+                      seed, i);
+            }
+        }
+    }
+
+    void denseVsBitvectors()
+    {
+        LoopGraph maps, bits;
+
+        ReachingDefinitionsAnalysis RD(&maps.S1);
+        RD.run();
+        analysis::ReachingDefinitionsAnalysisOptions opts;
+        ReachingDefinitionsAnalysis BRD(&bits.S1, opts.setBitvectors(true));
+        BRD.run();
+
+        auto mnodes = maps.nodes();
+        auto bnodes = bits.nodes();
+        auto map = [&](RDNode *n) -> RDNode * {
+            for (unsigned j = 0; j < bnodes.size(); ++j) {
+                if (bnodes[j] == n)
+                    return mnodes[j];
+            }
+            return n;
+        };
+
+        // the whole maps must be the same, not only the r.d. of uses
+        for (unsigned i = 0; i < mnodes.size(); ++i) {
+            std::set<std::pair<DefSite, RDNode *>> mdefs, bdefs;
+            for (const auto& it : mnodes[i]->getReachingDefinitions()) {
+                for (RDNode *n : it.second)
+                    mdefs.emplace(it.first, n);
+            }
+            for (const auto& it : bnodes[i]->getReachingDefinitions()) {
+                const DefSite& ds = it.first;
+                for (RDNode *n : it.second)
+                    bdefs.emplace(DefSite(map(ds.target), ds.offset, ds.len),
+                                  map(n));
+            }
+
+            check(mdefs == bdefs, "Maps and bitvectors give different r.d.");
+        }
+
+        // W is not overwritten by S2 as a whole
+        std::set<RDNode *> rd;
+        bits.L1.getReachingDefinitions(&bits.A, 0, 4, rd);
+        check(rd.size() == 3, "L1 should have S1, W and S2 as r.d.");
+        rd.clear();
+        bits.L2.getReachingDefinitions(&bits.A, 0, 2, rd);
+        check(rd.size() == 1, "L2 should have only S2 as r.d.");
+    }
+
     void test()
     {
-        basic1();
-        basic2();
-        basic3();
-        basic4();
+        for (bool intervals : {false, true}) {
+            basic1(intervals);
+            basic2(intervals);
+            basic3(intervals);
+            basic4(intervals);
+            loop(intervals);
+        }
+
+        summaries();
+        recursiveSummaries();
+        denseVsSparse();
+        for (unsigned seed = 1; seed <= 500; ++seed)
+            randomDenseVsSparse(seed);
+        denseVsBitvectors();
     }
 };
 
@@ -0,0 +1,137 @@
+#include <assert.h>
+#include <cstdarg>
+#include <cstdio>
+
+#include "test-runner.h"
+
+#include "llvm-slicer-json.h"
+
+namespace dg {
+namespace tests {
+
+using RequestT = std::map<std::string, std::string>;
+
+class TestParseFlatJSON : public Test
+{
+public:
+    TestParseFlatJSON() : Test("parsing flat JSON objects")
+    {}
+
+    void test()
+    {
+        RequestT req;
+        check(parseFlatJSON("{}", req), "Failed parsing empty object");
+        check(req.empty(), "Empty object has values");
+
+        check(parseFlatJSON(" { \"type\" : \"slice\", \"criteria\":\"foo,10:x\" } ", req),
+              "Failed parsing object");
+        check(req.size() == 2, "Wrong number of values");
+        check(req["type"] == "slice", "Wrong value: %s", req["type"].c_str());
+        check(req["criteria"] == "foo,10:x", "Wrong value: %s", req["criteria"].c_str());
+
+        // escapes
+        req.clear();
+        check(parseFlatJSON("{\"a\": \"x\\\"y\\\\z\\n\\t\\/\", \"b\": \"\\u0041\\u007e\"}", req),
+              "Failed parsing escapes");
+        check(req["a"] == "x\"y\\z\n\t/", "Wrong value: %s", req["a"].c_str());
+        check(req["b"] == "A~", "Wrong value: %s", req["b"].c_str());
+
+        // the values that are not strings are kept as they are
+        req.clear();
+        check(parseFlatJSON("{\"id\": -12, \"f\": 1.5e+3, \"t\": true, \"n\": null}", req),
+              "Failed parsing literals");
+        check(req["id"] == "-12", "Wrong value: %s", req["id"].c_str());
+        check(req["f"] == "1.5e+3", "Wrong value: %s", req["f"].c_str());
+        check(req["t"] == "true", "Wrong value: %s", req["t"].c_str());
+        check(req["n"] == "null", "Wrong value: %s", req["n"].c_str());
+    }
+};
+
+class TestMalformedJSON : public Test
+{
+public:
+    TestMalformedJSON() : Test("rejecting malformed JSON")
+    {}
+
+    void test()
+    {
+        const char *inputs[] = {
+            "",
+            "   ",
+            "{",
+            "}",
+            "[]",
+            "\"a\"",
+            "{\"a\"}",
+            "{\"a\": }",
+            "{\"a\" \"b\"}",
+            "{a: \"b\"}",
+            "{\"a\": \"b\",}",
+            "{\"a\": \"b\" \"c\": \"d\"}",
+            "{\"a\": \"b}",
+            "{\"a\": \"b\\",
+            // trailing garbage
+            "{\"a\": \"b\"} x",
+            "{\"a\": \"b\"}}",
+            "{} {}",
+            // malformed \u escapes
+            "{\"a\": \"\\u12\"}",
+            "{\"a\": \"\\u12",
+            "{\"a\": \"\\u00g1\"}",
+            "{\"a\": \"\\u-123\"}",
+            // non-ASCII characters in \u escapes
+            "{\"a\": \"\\u00e9\"}",
+            "{\"a\": \"\\u0080\"}",
+            "{\"a\": \"\\uffff\"}",
+            // literals that are not followed by a separator
+            "{\"a\": true false}",
+            "{\"a\": 12 \"b\": 1}",
+            "{\"a\": [1]}",
+            "{\"a\": {}}",
+        };
+
+        for (const char *input : inputs) {
+            RequestT req;
+            check(!parseFlatJSON(input, req), "Parsed malformed input: %s", input);
+        }
+    }
+};
+
+class TestEscapeJSON : public Test
+{
+public:
+    TestEscapeJSON() : Test("escaping JSON strings")
+    {}
+
+    void test()
+    {
+        check(escapeJSON("") == "\"\"", "Wrong escaping");
+        check(escapeJSON("main:10") == "\"main:10\"", "Wrong escaping");
+        check(escapeJSON("a\"b\\c") == "\"a\\\"b\\\\c\"", "Wrong escaping");
+        check(escapeJSON("\n\t\r\b\f") == "\"\\n\\t\\r\\b\\f\"", "Wrong escaping");
+        check(escapeJSON(std::string("\x01\x1f\x00", 3)) == "\"\\u0001\\u001f\\u0000\"",
+              "Wrong escaping: %s", escapeJSON(std::string("\x01\x1f\x00", 3)).c_str());
+
+        // the escaped strings are parsed back to the original
+        const std::string str("x\"\\\r\x02\x7f y", 8);
+        RequestT req;
+        check(parseFlatJSON("{\"s\": " + escapeJSON(str) + "}", req),
+              "Failed parsing escaped string");
+        check(req["s"] == str, "Wrong value: %s", req["s"].c_str());
+    }
+};
+
+}; // namespace tests
+}; // namespace dg
+
+int main()
+{
+    using namespace dg::tests;
+    TestRunner Runner;
+
+    Runner.add(new TestParseFlatJSON());
+    Runner.add(new TestMalformedJSON());
+    Runner.add(new TestEscapeJSON());
+
+    return Runner();
+}
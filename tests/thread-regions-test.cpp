@@ -5,6 +5,7 @@
 
 #include "../include/dg/llvm/analysis/ThreadRegions/ControlFlowGraph.h"
 #include "../include/dg/llvm/analysis/ThreadRegions/ThreadRegion.h"
+#include "../include/dg/llvm/analysis/ThreadRegions/MayHappenInParallel.h"
 #include "../lib/llvm/analysis/ThreadRegions/include/Graphs/GraphBuilder.h"
 
 #include "../lib/llvm/analysis/ThreadRegions/include/Nodes/Nodes.h"
@@ -249,6 +250,51 @@ TEST_CASE("Test of ThreadRegion class methods", "[ThreadRegion]") {
     }
 }
 
+TEST_CASE("Test of MayHappenInParallel class methods", "[MayHappenInParallel]") {
+    ThreadRegion * threadRegion0 = new ThreadRegion(createNode<NodeType::GENERAL>());
+    ThreadRegion * threadRegion1 = new ThreadRegion(createNode<NodeType::GENERAL>());
+    ThreadRegion * threadRegion2 = new ThreadRegion(createNode<NodeType::GENERAL>());
+    ThreadRegion * unknownRegion = new ThreadRegion(createNode<NodeType::GENERAL>());
+
+    MayHappenInParallel mhp({threadRegion2, threadRegion0, threadRegion1});
+
+    REQUIRE(mhp.regionsNum() == 3);
+    REQUIRE(mhp.rowWords() == 1);
+
+    SECTION("Regions are indexed in the order of their ids") {
+        REQUIRE(mhp.region(0) == threadRegion0);
+        REQUIRE(mhp.region(1) == threadRegion1);
+        REQUIRE(mhp.region(2) == threadRegion2);
+        REQUIRE(mhp.regionIndex(threadRegion2) == 2);
+        REQUIRE(mhp.regionIndex(unknownRegion) == MayHappenInParallel::NONE);
+    }
+
+    SECTION("The relation is symmetric") {
+        for (unsigned i = 0; i < mhp.regionsNum(); ++i) {
+            for (unsigned j = 0; j < mhp.regionsNum(); ++j) {
+                REQUIRE(mhp.mayHappenInParallel(i, j) == mhp.mayHappenInParallel(j, i));
+            }
+        }
+    }
+
+    SECTION("Parallel regions from a set of regions") {
+        auto row = mhp.emptyRow();
+        REQUIRE(mhp.parallelRegions(0, row).empty());
+
+        mhp.addToRow(row, 2);
+        auto parallel = mhp.parallelRegions(0, row);
+        REQUIRE(parallel.size() == 1);
+        REQUIRE(parallel[0] == 2);
+
+        REQUIRE(mhp.parallelRegions(threadRegion1).size() == 3);
+        REQUIRE(mhp.parallelRegions(unknownRegion).empty());
+    }
+
+    SECTION("Artificial nodes are not in any region") {
+        REQUIRE(mhp.regionIndices(nullptr).empty());
+    }
+}
+
 TEST_CASE("Test of EntryNode class methods", "[EntryNode]") {
     ForkNode * forkNode = createNode<NodeType::FORK>();
     EntryNode * entryNode = createNode<NodeType::ENTRY>();
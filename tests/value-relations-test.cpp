@@ -0,0 +1,427 @@
+#include <assert.h>
+#include <cstdarg>
+#include <cstdio>
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+// include LLVM headers before test-runner.h,
+// its color macros clash with the names in raw_ostream.h
+#include "dg/llvm/analysis/ValueRelations/Relations.h"
+#include "dg/llvm/analysis/ValueRelations/EqualityMap.h"
+#include "dg/llvm/analysis/ValueRelations/ValueRelations.h"
+
+#include "test-runner.h"
+
+namespace dg {
+namespace tests {
+
+// the maps never dereference the values, so we can use
+// any distinct addresses as the values
+static const llvm::Value *V(unsigned i)
+{
+    static char values[16];
+    assert(i < sizeof(values));
+    return reinterpret_cast<const llvm::Value *>(&values[i]);
+}
+
+class TestRelationsMapClosure : public Test
+{
+public:
+    TestRelationsMapClosure() : Test("relations map: equalities and closure")
+    {}
+
+    void test()
+    {
+        RelationsMap R;
+        check(R.empty(), "New map is not empty");
+
+        // a < b = c <= d
+        check(R.add(VRRelation::Lt(V(0), V(1))), "Did not add a < b");
+        check(R.add(VRRelation::Le(V(2), V(3))), "Did not add c <= d");
+        check(R.add(VRRelation::Eq(V(1), V(2))), "Did not add b = c");
+        check(!R.add(VRRelation::Eq(V(2), V(1))), "Added c = b again");
+        check(!R.add(VRRelation::Gt(V(1), V(0))), "Added b > a again");
+
+        // the relations of the members of a class hold for the whole class
+        check(R.has(VRRelation::Lt(V(0), V(2))), "Do not have a < c");
+        check(R.has(VRRelation::Gt(V(2), V(0))), "Do not have c > a");
+        check(R.has(VRRelation::Neq(V(0), V(2))), "Do not have a != c");
+        check(R.has(VRRelation::Le(V(1), V(3))), "Do not have b <= d");
+        check(R.has(VRRelation::Eq(V(3), V(3))), "Do not have d = d");
+        check(!R.has(VRRelation::Eq(V(0), V(1))), "Have a = b");
+
+        // a < d follows only from the transitivity
+        check(!R.has(VRRelation::Lt(V(0), V(3))), "Have a < d before closure");
+        R.transitivelyClose();
+        check(R.has(VRRelation::Lt(V(0), V(3))), "Do not have a < d");
+        check(R.has(VRRelation::Le(V(0), V(3))), "Do not have a <= d");
+        check(R.has(VRRelation::Ge(V(3), V(0))), "Do not have d >= a");
+        check(R.has(VRRelation::Neq(V(3), V(0))), "Do not have d != a");
+        check(!R.has(VRRelation::Lt(V(1), V(3))), "Have b < d");
+
+        // equality of values from different classes merges the relations
+        check(R.add(VRRelation::Eq(V(4), V(3))), "Did not add e = d");
+        check(R.add(VRRelation::Lt(V(4), V(5))), "Did not add e < f");
+        check(R.has(VRRelation::Lt(V(3), V(5))), "Do not have d < f");
+        check(R.has(VRRelation::Lt(V(0), V(4))), "Do not have a < e");
+
+        // the map that is kept closed derives the relations right away
+        RelationsMap C(true /* keep transitively closed */);
+        C.add(VRRelation::Le(V(0), V(1)));
+        C.add(VRRelation::Le(V(1), V(2)));
+        C.add(VRRelation::Lt(V(2), V(3)));
+        check(C.has(VRRelation::Le(V(0), V(2))), "Do not have a <= c");
+        check(C.has(VRRelation::Lt(V(0), V(3))), "Do not have a < d");
+        check(!C.has(VRRelation::Lt(V(0), V(2))), "Have a < c");
+
+        unsigned num = 0;
+        C.forEachRelation([&](const VRRelation& rel) {
+            check(C.has(rel), "Enumerated relation is not in the map");
+            ++num;
+        });
+        check(num == 6, "Wrong number of relations: %u", num);
+    }
+};
+
+class TestRelationsMapContradiction : public Test
+{
+public:
+    TestRelationsMapContradiction() : Test("relations map: contradictory relations")
+    {}
+
+    void test()
+    {
+        // the map does not check the consistency of the relations,
+        // the contradictory relations come from unreachable code
+        // and the map just keeps them all
+        RelationsMap R;
+        check(R.add(VRRelation::Lt(V(0), V(1))), "Did not add a < b");
+        check(R.add(VRRelation::Ge(V(0), V(1))), "Did not add a >= b");
+        check(R.has(VRRelation::Lt(V(0), V(1))), "Lost a < b");
+        check(R.has(VRRelation::Ge(V(0), V(1))), "Lost a >= b");
+
+        check(R.add(VRRelation::Eq(V(0), V(1))), "Did not add a = b");
+        check(R.has(VRRelation::Lt(V(0), V(1))), "Lost a < b");
+        check(R.has(VRRelation::Eq(V(1), V(0))), "Do not have b = a");
+        check(R.has(VRRelation::Neq(V(0), V(1))), "Do not have a != b");
+        check(!R.add(VRRelation::Neq(V(1), V(0))), "Added b != a again");
+
+        // a cycle of < gives a < a after the closure
+        RelationsMap C;
+        C.add(VRRelation::Lt(V(2), V(3)));
+        C.add(VRRelation::Lt(V(3), V(4)));
+        C.add(VRRelation::Lt(V(4), V(2)));
+        C.transitivelyClose();
+        check(C.has(VRRelation::Lt(V(2), V(4))), "Do not have a < c");
+        check(C.has(VRRelation::Lt(V(4), V(3))), "Do not have c < b");
+        check(C.has(VRRelation::Neq(V(3), V(3))), "Do not have b != b");
+        check(C.has(VRRelation::Eq(V(3), V(3))), "Do not have b = b");
+    }
+};
+
+class TestRelationsMapCopyOnWrite : public Test
+{
+public:
+    TestRelationsMapCopyOnWrite() : Test("relations map: copy-on-write")
+    {}
+
+    void test()
+    {
+        RelationsMap A;
+        A.add(VRRelation::Lt(V(0), V(1)));
+        A.add(VRRelation::Le(V(1), V(2)));
+
+        RelationsMap B(A);
+        RelationsMap C;
+        C = A;
+
+        check(B.add(VRRelation::Eq(V(2), V(3))), "Did not add c = d");
+        check(B.has(VRRelation::Eq(V(2), V(3))), "Do not have c = d");
+        check(!A.has(VRRelation::Eq(V(2), V(3))), "The original map changed");
+        check(!C.has(VRRelation::Eq(V(2), V(3))), "The sibling map changed");
+
+        check(A.add(VRRelation::Neq(V(0), V(4))), "Did not add a != e");
+        check(!B.has(VRRelation::Neq(V(0), V(4))), "The copy changed");
+        check(!C.has(VRRelation::Neq(V(0), V(4))), "The sibling map changed");
+
+        // the closure modifies only the map that is closed
+        C.transitivelyClose();
+        check(C.has(VRRelation::Lt(V(0), V(2))), "Do not have a < c");
+        check(!A.has(VRRelation::Lt(V(0), V(2))), "The original map got closed");
+        check(!B.has(VRRelation::Lt(V(0), V(2))), "The copy got closed");
+
+        // the relations that are already in the map do not modify it
+        RelationsMap D(C);
+        check(!D.add(VRRelation::Lt(V(0), V(1))), "Added a < b again");
+        D.add(VRRelation::Lt(V(5), V(6)));
+        check(!C.has(VRRelation::Lt(V(5), V(6))), "The original map changed");
+    }
+};
+
+class TestRelationsMapMerge : public Test
+{
+public:
+    TestRelationsMapMerge() : Test("relations map: adding maps")
+    {}
+
+    void test()
+    {
+        RelationsMap A;
+        A.add(VRRelation::Lt(V(0), V(1)));
+        A.add(VRRelation::Eq(V(1), V(2)));
+        A.add(VRRelation::Neq(V(3), V(4)));
+
+        // an empty map takes the relations of the other map
+        RelationsMap E;
+        check(!E.add(RelationsMap()), "Adding empty map changed the map");
+        check(E.add(A), "Adding to empty map did not change it");
+        check(E.has(VRRelation::Lt(V(0), V(2))), "Do not have a < c");
+        check(E.has(VRRelation::Neq(V(4), V(3))), "Do not have e != d");
+        check(!E.add(A), "Adding the same map changed the map");
+
+        // and does not share the modifications with it
+        E.add(VRRelation::Le(V(2), V(5)));
+        check(!A.has(VRRelation::Le(V(2), V(5))), "The added map changed");
+
+        RelationsMap B;
+        B.add(VRRelation::Le(V(5), V(6)));
+        B.add(VRRelation::Eq(V(2), V(7)));
+        check(B.add(A), "Adding map did not change the map");
+        check(B.has(VRRelation::Lt(V(0), V(7))), "Do not have a < h");
+        check(B.has(VRRelation::Eq(V(1), V(7))), "Do not have b = h");
+        check(B.has(VRRelation::Neq(V(3), V(4))), "Do not have d != e");
+        check(B.has(VRRelation::Le(V(5), V(6))), "Lost f <= g");
+        check(!B.add(A), "Adding the same map twice changed the map");
+        check(!A.has(VRRelation::Le(V(5), V(6))), "The added map changed");
+        check(!A.has(VRRelation::Eq(V(1), V(7))), "The added map changed");
+
+        // every relation of the merged maps is in the result
+        A.forEachRelation([&](const VRRelation& rel) {
+            check(B.has(rel), "Lost a relation of the added map");
+        });
+    }
+};
+
+class TestEqualityMapCopyOnWrite : public Test
+{
+public:
+    TestEqualityMapCopyOnWrite() : Test("equality map: copy-on-write")
+    {}
+
+    void test()
+    {
+        // the maps of a location and of its two successors
+        EqualityMap<const llvm::Value *> loc;
+        loc.add(V(0), V(1));
+        loc.add(V(2), V(3));
+
+        EqualityMap<const llvm::Value *> succ1, succ2;
+        check(succ1.add(loc), "Adding to empty map did not change it");
+        check(succ2.add(loc), "Adding to empty map did not change it");
+        check(!succ1.add(loc), "Adding the same map changed the map");
+        check(succ1.get(V(0)) == loc.get(V(0)), "The map is not shared");
+
+        // merge the classes in one successor
+        check(succ1.add(V(1), V(2)), "Did not add b = c");
+        check(succ1.get(V(0))->count(V(3)) > 0, "Do not have a = d");
+        check(succ1.get(V(0)) != loc.get(V(0)), "The map is still shared");
+
+        // the other maps still have the old classes
+        for (auto *map : {&loc, &succ2}) {
+            check(map->get(V(0))->size() == 2, "The shared class changed");
+            check(map->get(V(2))->size() == 2, "The shared class changed");
+            check(map->get(V(0))->count(V(2)) == 0, "Have a = c");
+            check(map->get(V(3))->count(V(1)) == 0, "Have d = b");
+        }
+
+        // extend a class in the other successor
+        check(succ2.add(V(4), V(0)), "Did not add e = a");
+        check(succ2.get(V(1))->count(V(4)) > 0, "Do not have b = e");
+        check(loc.get(V(4)) == nullptr, "The original map changed");
+        check(succ1.get(V(4)) == nullptr, "The sibling map changed");
+        check(loc.get(V(0))->size() == 2, "The shared class changed");
+
+        // equalities that are in the map do not unshare it
+        EqualityMap<const llvm::Value *> succ3(loc);
+        check(!succ3.add(V(1), V(0)), "Added b = a again");
+        check(succ3.get(V(0)) == loc.get(V(0)), "The map is not shared");
+    }
+};
+
+// a loop with a load of memory that is written in the loop,
+// the relations and equalities must be recomputed a few times
+static const char *loopModule = R"(
+define i32 @f(i32 %n) {
+entry:
+  %a = alloca i32
+  %b = alloca i32
+  store i32 0, i32* %a
+  store i32 %n, i32* %b
+  br label %loop
+loop:
+  %i = load i32, i32* %a
+  %c = icmp slt i32 %i, %n
+  br i1 %c, label %body, label %exit
+body:
+  %x = add i32 %i, 1
+  store i32 %x, i32* %a
+  %y = load i32, i32* %a
+  %m = load i32, i32* %b
+  %e = icmp eq i32 %y, %m
+  br i1 %e, label %exit, label %inner
+inner:
+  %z = load i32, i32* %a
+  %d = icmp sgt i32 %z, 10
+  br i1 %d, label %loop, label %body
+exit:
+  %r = load i32, i32* %a
+  %s = load i32, i32* %b
+  %t = add i32 %r, %s
+  ret i32 %t
+}
+)";
+
+class TestValueRelationsWorklist : public Test
+{
+    using BlocksT = decltype(std::declval<analysis::LLVMValueRelations>().getBlocks());
+
+    static std::vector<analysis::VRLocation *> getLocations(BlocksT blocks) {
+        std::vector<analysis::VRLocation *> ret;
+        for (const auto& B : blocks) {
+            for (const auto& loc : B.second->locations)
+                ret.push_back(loc.get());
+        }
+        return ret;
+    }
+
+    // the solver that was used before the worklist:
+    // process all locations until nothing changes
+    static void runRoundRobin(const llvm::Module *M, BlocksT blocks) {
+        analysis::LLVMValueRelationsAnalysis VRA(M);
+        auto locations = getLocations(blocks);
+        bool changed;
+        do {
+            changed = false;
+            for (auto *loc : locations)
+                changed |= VRA.collect(loc);
+        } while (changed);
+    }
+
+    bool sameEqualities(const analysis::VRLocation *A, const analysis::VRLocation *B) {
+        unsigned num = 0;
+        for (const auto& it : A->equalities) {
+            auto cls = B->equalities.get(it.first);
+            if (!cls || *cls != *it.second)
+                return false;
+            ++num;
+        }
+        for (const auto& it : B->equalities) {
+            (void) it;
+            --num;
+        }
+        return num == 0;
+    }
+
+    bool sameRelations(const analysis::VRLocation *A, const analysis::VRLocation *B) {
+        bool same = true;
+        A->relations.forEachRelation([&](const VRRelation& rel) {
+            same &= B->relations.has(rel);
+        });
+        B->relations.forEachRelation([&](const VRRelation& rel) {
+            same &= A->relations.has(rel);
+        });
+        return same;
+    }
+
+    bool sameReads(const analysis::VRLocation *A, const analysis::VRLocation *B) {
+        unsigned num = 0;
+        for (const auto& it : A->reads) {
+            if (B->reads.get(it.first) != it.second)
+                return false;
+            ++num;
+        }
+        for (const auto& it : B->reads) {
+            (void) it;
+            --num;
+        }
+        return num == 0;
+    }
+
+public:
+    TestValueRelationsWorklist() : Test("value relations: worklist fixpoint")
+    {}
+
+    void test()
+    {
+        llvm::LLVMContext context;
+        llvm::SMDiagnostic SMD;
+        auto M = llvm::parseIR(llvm::MemoryBuffer::getMemBuffer(loopModule)->getMemBufferRef(),
+                               SMD, context);
+        check(M, "Failed parsing the module");
+
+        analysis::LLVMValueRelations worklist(M.get()), roundRobin(M.get());
+        worklist.build();
+        roundRobin.build();
+
+        analysis::LLVMValueRelationsAnalysis VRA(M.get());
+        check(!VRA.run(worklist.getBlocks()), "The worklist did not reach the fixpoint");
+        runRoundRobin(M.get(), roundRobin.getBlocks());
+
+        auto wlocs = getLocations(worklist.getBlocks());
+        auto rlocs = getLocations(roundRobin.getBlocks());
+        check(wlocs.size() == rlocs.size(), "Different graphs");
+
+        bool haveRelations = false;
+        for (unsigned i = 0; i < wlocs.size(); ++i) {
+            check(sameEqualities(wlocs[i], rlocs[i]),
+                  "Equalities in location %u differ", wlocs[i]->id);
+            check(sameRelations(wlocs[i], rlocs[i]),
+                  "Relations in location %u differ", wlocs[i]->id);
+            check(sameReads(wlocs[i], rlocs[i]),
+                  "Reads in location %u differ", wlocs[i]->id);
+            haveRelations |= !wlocs[i]->relations.empty();
+        }
+        check(haveRelations, "No relations were computed");
+
+        // the fixpoint is stable
+        for (auto *loc : wlocs)
+            check(!VRA.collect(loc), "Location %u changed after the fixpoint", loc->id);
+    }
+};
+
+}; // namespace tests
+}; // namespace dg
+
+int main()
+{
+    using namespace dg::tests;
+    TestRunner Runner;
+
+    Runner.add(new TestRelationsMapClosure());
+    Runner.add(new TestRelationsMapContradiction());
+    Runner.add(new TestRelationsMapCopyOnWrite());
+    Runner.add(new TestRelationsMapMerge());
+    Runner.add(new TestEqualityMapCopyOnWrite());
+    Runner.add(new TestValueRelationsWorklist());
+
+    return Runner();
+}
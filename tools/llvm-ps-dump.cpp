@@ -44,6 +44,7 @@
 #include "dg/analysis/PointsTo/PointerAnalysisFI.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFS.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFSInv.h"
+#include "dg/analysis/PointsTo/PointerAnalysisSFS.h"
 #include "dg/analysis/PointsTo/Pointer.h"
 
 #include "TimeMeasure.h"
@@ -64,6 +65,7 @@ static uint64_t dump_iteration = 0;
 static const char *entry_func = "main";
 
 static char *display_only = nullptr;
+static char *demand = nullptr;
 static std::vector<const llvm::Function *> display_only_func;
 
 std::unique_ptr<PointerAnalysis> PA;
@@ -72,6 +74,7 @@ enum PTType {
     FLOW_SENSITIVE = 1,
     FLOW_INSENSITIVE,
     WITH_INVALIDATE,
+    SPARSE_FLOW_SENSITIVE,
 };
 
 static std::string
@@ -180,7 +183,7 @@ static void dumpPointer(const Pointer& ptr, bool dot)
 }
 
 static void
-dumpMemoryObject(MemoryObject *mo, int ind, bool dot)
+dumpMemoryObject(const MemoryObject *mo, int ind, bool dot)
 {
     bool printed_multi = false;
     for (auto& it : mo->pointsTo) {
@@ -261,6 +264,10 @@ static void
 dumpPointerSubgraphData(PSNode *n, PTType type, bool dot = false)
 {
     assert(n && "No node given");
+    // sparse analysis keeps the memory only in the analysis
+    if (type == SPARSE_FLOW_SENSITIVE)
+        return;
+
     if (type == FLOW_INSENSITIVE) {
         MemoryObject *mo = n->getData<MemoryObject>();
         if (!mo)
@@ -391,7 +398,9 @@ dumpNodeEdgesToDot(PSNode *node)
 }
 
 PSNode *getNodePtr(PSNode *ptr) { return ptr; }
-PSNode *getNodePtr(const std::unique_ptr<PSNode>& ptr) { return ptr.get(); }
+// the nodes of the graph are held by pointers into its arena
+template <typename DeleterT>
+PSNode *getNodePtr(const std::unique_ptr<PSNode, DeleterT>& ptr) { return ptr.get(); }
 
 
 template <typename ContT> static void
@@ -677,6 +686,66 @@ dumpStats(LLVMPointerAnalysis *pta)
     printf("Maximum pt-set size: %lu\n", maximum);
 }
 
+// find the named values (globals, arguments and instructions)
+static std::vector<const llvm::Value *>
+findValues(llvm::Module *M, const std::string& name)
+{
+    std::vector<const llvm::Value *> ret;
+    if (auto G = M->getNamedValue(name))
+        ret.push_back(G);
+
+    for (auto& F : *M) {
+        for (auto& A : F.args()) {
+            if (A.getName() == name)
+                ret.push_back(&A);
+        }
+        for (auto& B : F) {
+            for (auto& I : B) {
+                if (I.getName() == name)
+                    ret.push_back(&I);
+            }
+        }
+    }
+
+    return ret;
+}
+
+// compute the points-to sets of the given values on demand
+static int
+dumpDemand(llvm::Module *M, LLVMPointerAnalysis& PTA, PTType type)
+{
+    TimeMeasure tm;
+    tm.start();
+    PTA.runOnDemand();
+
+    for (const auto& name : splitList(demand)) {
+        auto values = findValues(M, name);
+        if (values.empty()) {
+            llvm::errs() << "Value not found in the module: " << name << "\n";
+            return 1;
+        }
+
+        for (auto val : values) {
+            PSNode *node = PTA.getPointsTo(val);
+            if (!node) {
+                llvm::errs() << "No points-to set for: " << name << "\n";
+                continue;
+            }
+            dumpPSNode(node, type);
+        }
+    }
+
+    tm.stop();
+    tm.report("INFO: Points-to queries took");
+
+    auto st = PTA.getDemandStatistics();
+    printf("Queries: %lu\n", st->queries);
+    printf("Queries over budget: %lu\n", st->exceeded);
+    printf("Steps: %lu\n", st->steps);
+    printf("Resolved nodes: %lu\n", st->resolvedNodes);
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
     llvm::Module *M;
@@ -687,6 +756,13 @@ int main(int argc, char *argv[])
     const char *module = nullptr;
     PTType type = FLOW_INSENSITIVE;
     uint64_t field_senitivity = Offset::UNKNOWN;
+    auto ptset = PointsToSet::Representation::BITVECTOR;
+    bool diff_propagation = false;
+    bool collapse_cycles = false;
+    bool value_numbering = false;
+    unsigned solver_threads = 1;
+    uint64_t query_budget = 0;
+    bool query_budget_given = false;
 
     // parse options
     for (int i = 1; i < argc; ++i) {
@@ -696,8 +772,23 @@ int main(int argc, char *argv[])
                 type = FLOW_SENSITIVE;
             else if (strcmp(argv[i+1], "inv") == 0)
                 type = WITH_INVALIDATE;
+            else if (strcmp(argv[i+1], "sfs") == 0)
+                type = SPARSE_FLOW_SENSITIVE;
         } else if (strcmp(argv[i], "-pta-field-sensitive") == 0) {
             field_senitivity = static_cast<uint64_t>(atoll(argv[i + 1]));
+        } else if (strcmp(argv[i], "-pta-set") == 0) {
+            if (strcmp(argv[i+1], "flat") == 0)
+                ptset = PointsToSet::Representation::FLAT;
+            else if (strcmp(argv[i+1], "bv") == 0)
+                ptset = PointsToSet::Representation::BITVECTOR;
+        } else if (strcmp(argv[i], "-pta-diff-propagation") == 0) {
+            diff_propagation = true;
+        } else if (strcmp(argv[i], "-pta-collapse-cycles") == 0) {
+            collapse_cycles = true;
+        } else if (strcmp(argv[i], "-pta-hvn") == 0) {
+            value_numbering = true;
+        } else if (strcmp(argv[i], "-pta-threads") == 0) {
+            solver_threads = static_cast<unsigned>(atoi(argv[i + 1]));
         } else if (strcmp(argv[i], "-dot") == 0) {
             todot = true;
         } else if (strcmp(argv[i], "-threads") == 0) {
@@ -723,6 +814,11 @@ int main(int argc, char *argv[])
             entry_func = argv[i + 1];
         } else if (strcmp(argv[i], "-display-only") == 0) {
             display_only = argv[i + 1];
+        } else if (strcmp(argv[i], "-demand") == 0) {
+            demand = argv[i + 1];
+        } else if (strcmp(argv[i], "-query-budget") == 0) {
+            query_budget = static_cast<uint64_t>(atoll(argv[i + 1]));
+            query_budget_given = true;
         } else {
             module = argv[i];
         }
@@ -760,7 +856,24 @@ int main(int argc, char *argv[])
         }
     }
 
-    LLVMPointerAnalysis PTA(M, entry_func, field_senitivity, threads);
+    LLVMPointerAnalysisOptions opts;
+    opts.threads = threads;
+    opts.setFieldSensitivity(field_senitivity);
+    opts.setEntryFunction(entry_func);
+    opts.setPTSetRepresentation(ptset);
+    opts.setDiffPropagation(diff_propagation);
+    opts.setCollapseCycles(collapse_cycles);
+    opts.setValueNumbering(value_numbering);
+    opts.setSolverThreads(solver_threads);
+    // zero means no limit, so we can not use it for "not given"
+    if (query_budget_given)
+        opts.setQueryBudget(query_budget);
+
+    LLVMPointerAnalysis PTA(M, opts);
+
+    // compute only the points-to sets of the given values
+    if (demand)
+        return dumpDemand(M, PTA, type);
 
     tm.start();
 
@@ -774,6 +887,10 @@ int main(int argc, char *argv[])
         PA = std::unique_ptr<PointerAnalysis>(
             PTA.createPTA<analysis::pta::PointerAnalysisFSInv>()
             );
+    } else if (type == SPARSE_FLOW_SENSITIVE) {
+        PA = std::unique_ptr<PointerAnalysis>(
+            PTA.createPTA<analysis::pta::PointerAnalysisSFS>()
+            );
     } else {
         PA = std::unique_ptr<PointerAnalysis>(
             PTA.createPTA<analysis::pta::PointerAnalysisFS>()
@@ -425,6 +425,7 @@ int main(int argc, char *argv[])
     const char *entry_func = "main";
     PTType type = FLOW_INSENSITIVE;
     uint64_t field_senitivity = Offset::UNKNOWN;
+    unsigned solver_threads = 1;
 
     // parse options
     for (int i = 1; i < argc; ++i) {
@@ -436,6 +437,8 @@ int main(int argc, char *argv[])
                 type = WITH_INVALIDATE;
         } else if (strcmp(argv[i], "-pta-field-sensitive") == 0) {
             field_senitivity = static_cast<uint64_t>(atoll(argv[i + 1]));
+        } else if (strcmp(argv[i], "-pta-threads") == 0) {
+            solver_threads = static_cast<unsigned>(atoi(argv[i + 1]));
         } else if (strcmp(argv[i], "-entry") == 0) {
             entry_func = argv[i + 1];
         } else {
@@ -464,7 +467,12 @@ int main(int argc, char *argv[])
 
     TimeMeasure tm;
 
-    LLVMPointerAnalysis PTA(M, entry_func, field_senitivity);
+    LLVMPointerAnalysisOptions opts;
+    opts.setFieldSensitivity(field_senitivity);
+    opts.setEntryFunction(entry_func);
+    opts.setSolverThreads(solver_threads);
+
+    LLVMPointerAnalysis PTA(M, opts);
 
     tm.start();
 
@@ -2,6 +2,7 @@
 #error "This code needs LLVM enabled"
 #endif
 
+#include <chrono>
 #include <set>
 #include <iostream>
 #include <sstream>
@@ -284,6 +285,70 @@ dumpRD(LLVMReachingDefinitions *RD, bool todot, bool dump_rd)
     }
 }
 
+// a name of the value that does not depend on the analysis
+// or on the addresses of the objects: function and the position
+// of the instruction in the function
+static std::string
+getValueId(const llvm::Value *val)
+{
+    if (!val)
+        return "<none>";
+
+    const auto *I = llvm::dyn_cast<llvm::Instruction>(val);
+    if (!I)
+        return val->getName().str();
+
+    const llvm::Function *F = I->getParent()->getParent();
+    unsigned idx = 0;
+    for (const llvm::BasicBlock& B : *F) {
+        for (const llvm::Instruction& Inst : B) {
+            if (&Inst == I)
+                return F->getName().str() + ":" + std::to_string(idx);
+            ++idx;
+        }
+    }
+
+    assert(0 && "Did not find the instruction");
+    abort();
+}
+
+// print the definitions that reach every load in the module,
+// so that the results of different analyses can be compared
+static void
+dumpUses(llvm::Module *M, LLVMReachingDefinitions *RD)
+{
+    for (const llvm::Function& F : *M) {
+        for (const llvm::BasicBlock& B : F) {
+            for (const llvm::Instruction& I : B) {
+                if (!llvm::isa<llvm::LoadInst>(&I))
+                    continue;
+
+                RDNode *node = RD->getMapping(&I);
+                if (!node)
+                    continue;
+
+                std::set<RDNode *> defs;
+                for (const DefSite& use : node->getUses())
+                    node->getReachingDefinitions(use.target, use.offset,
+                                                 use.len, defs);
+
+                std::set<std::string> names;
+                for (RDNode *def : defs) {
+                    if (def == rd::UNKNOWN_MEMORY)
+                        names.insert("UNKNOWN MEMORY");
+                    else
+                        names.insert(getValueId(def->getUserData<llvm::Value>()));
+                }
+
+                printf("%s:", getValueId(&I).c_str());
+                for (const std::string& name : names)
+                    printf(" %s", name.c_str());
+                printf("\n");
+            }
+        }
+    }
+}
+
 int main(int argc, char *argv[])
 {
     llvm::Module *M;
@@ -292,9 +357,14 @@ int main(int argc, char *argv[])
     bool todot = false;
     bool threads = false;
     bool dump_rd = false;
+    bool dump_uses = false;
     const char *module = nullptr;
     Offset::type field_senitivity = Offset::UNKNOWN;
     bool rd_strong_update_unknown = false;
+    bool rd_interval_maps = false;
+    bool rd_function_summaries = false;
+    bool rd_bitvectors = false;
+    unsigned rd_build_threads = 1;
     Offset::type max_set_size = Offset::UNKNOWN;
 
     enum {
@@ -326,6 +396,18 @@ int main(int argc, char *argv[])
             }
         } else if (strcmp(argv[i], "-rd-strong-update-unknown") == 0) {
             rd_strong_update_unknown = true;
+        } else if (strcmp(argv[i], "-rd-interval-maps") == 0) {
+            rd_interval_maps = true;
+        } else if (strcmp(argv[i], "-rd-function-summaries") == 0) {
+            rd_function_summaries = true;
+        } else if (strcmp(argv[i], "-rd-bitvectors") == 0) {
+            rd_bitvectors = true;
+        } else if (strcmp(argv[i], "-rd-build-threads") == 0) {
+            rd_build_threads = static_cast<unsigned>(atoi(argv[i + 1]));
+            if (rd_build_threads == 0) {
+                llvm::errs() << "Invalid -rd-build-threads argument\n";
+                abort();
+            }
         } else if (strcmp(argv[i], "-dot") == 0) {
             todot = true;
         } else if (strcmp(argv[i], "-threads") == 0) {
@@ -334,6 +416,8 @@ int main(int argc, char *argv[])
             verbose = true;
         } else if (strcmp(argv[i], "-dump-rd") == 0) {
             dump_rd = true;
+        } else if (strcmp(argv[i], "-dump-uses") == 0) {
+            dump_uses = true;
         } else if (strcmp(argv[i], "-entry") == 0) {
             entryFunc = argv[i+1];
         } else {
@@ -341,8 +425,13 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (rd_bitvectors && rd_interval_maps) {
+        errs() << "-rd-bitvectors and -rd-interval-maps cannot be used together\n";
+        return 1;
+    }
+
     if (!module) {
-        errs() << "Usage: % IR_module [-pts fs|fi] [-dot] [-v] [output_file]\n";
+        errs() << "Usage: % IR_module [-pts fs|fi] [-dot] [-v] [-rd-interval-maps] [-rd-function-summaries] [-rd-bitvectors] [-rd-build-threads N] [-dump-uses] [output_file]\n";
         return 1;
     }
 
@@ -379,6 +468,10 @@ int main(int argc, char *argv[])
     opts.threads = threads;
     opts.entryFunction = entryFunc;
     opts.strongUpdateUnknown = rd_strong_update_unknown;
+    opts.intervalMaps = rd_interval_maps;
+    opts.functionSummaries = rd_function_summaries;
+    opts.bitvectors = rd_bitvectors;
+    opts.buildThreads = rd_build_threads;
     opts.maxSetSize = max_set_size;
 
     LLVMReachingDefinitions RD(M, &PTA, opts);
@@ -390,7 +483,24 @@ int main(int argc, char *argv[])
     tm.stop();
     tm.report("INFO: Reaching definitions analysis took");
 
-    dumpRD(&RD, todot, dump_rd);
+    if (verbose) {
+        for (const auto& phase : RD.getPhaseTimes()) {
+            errs() << "INFO: RD phase " << phase.first << " took "
+                   << std::chrono::duration_cast<std::chrono::milliseconds>(phase.second).count()
+                   << " ms\n";
+        }
+    }
+
+    if (verbose && rda != RdaType::SEMISPARSE) {
+        errs() << "INFO: Processed nodes: "
+               << RD.getRDA()->getProcessedNodesNum()
+               << ", merges: " << RD.getRDA()->getMergesNum() << "\n";
+    }
+
+    if (dump_uses)
+        dumpUses(M, &RD);
+    else
+        dumpRD(&RD, todot, dump_rd);
 
     return 0;
 }
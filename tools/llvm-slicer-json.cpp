@@ -0,0 +1,159 @@
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+#include "llvm-slicer-json.h"
+
+namespace {
+
+class FlatJSONParser {
+    const std::string& input;
+    size_t pos{0};
+
+    void skipSpaces() {
+        while (pos < input.size() &&
+               isspace(static_cast<unsigned char>(input[pos])))
+            ++pos;
+    }
+
+    bool expect(char c) {
+        skipSpaces();
+        if (pos < input.size() && input[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    // there is nothing but spaces after the object
+    bool atEnd() {
+        skipSpaces();
+        return pos == input.size();
+    }
+
+    bool parseString(std::string& out) {
+        if (!expect('"'))
+            return false;
+
+        while (pos < input.size()) {
+            char c = input[pos++];
+            if (c == '"')
+                return true;
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+
+            if (pos >= input.size())
+                return false;
+            c = input[pos++];
+            switch (c) {
+            case 'n': out.push_back('\n'); break;
+            case 't': out.push_back('\t'); break;
+            case 'r': out.push_back('\r'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'u': {
+                if (pos + 4 > input.size())
+                    return false;
+                for (size_t i = pos; i < pos + 4; ++i) {
+                    if (!isxdigit(static_cast<unsigned char>(input[i])))
+                        return false;
+                }
+                // we do not need anything but ASCII in the criteria
+                auto code = strtoul(input.substr(pos, 4).c_str(), nullptr, 16);
+                if (code > 0x7f)
+                    return false;
+                out.push_back(static_cast<char>(code));
+                pos += 4;
+                break;
+            }
+            default: out.push_back(c); break;
+            }
+        }
+
+        return false;
+    }
+
+    // numbers, true, false and null are kept as they are
+    bool parseLiteral(std::string& out) {
+        skipSpaces();
+        size_t start = pos;
+        while (pos < input.size() &&
+               (isalnum(static_cast<unsigned char>(input[pos])) ||
+                input[pos] == '-' || input[pos] == '+' || input[pos] == '.'))
+            ++pos;
+
+        out = input.substr(start, pos - start);
+        return !out.empty();
+    }
+
+public:
+    FlatJSONParser(const std::string& in) : input(in) {}
+
+    bool parse(std::map<std::string, std::string>& out) {
+        if (!expect('{'))
+            return false;
+        if (expect('}'))
+            return atEnd();
+
+        do {
+            std::string key, value;
+            if (!parseString(key) || !expect(':'))
+                return false;
+
+            skipSpaces();
+            if (pos < input.size() && input[pos] == '"') {
+                if (!parseString(value))
+                    return false;
+            } else if (!parseLiteral(value)) {
+                return false;
+            }
+
+            out[key] = value;
+        } while (expect(','));
+
+        if (!expect('}'))
+            return false;
+
+        return atEnd();
+    }
+};
+
+} // anonymous namespace
+
+bool parseFlatJSON(const std::string& input,
+                   std::map<std::string, std::string>& out)
+{
+    return FlatJSONParser(input).parse(out);
+}
+
+std::string escapeJSON(const std::string& str)
+{
+    std::string out;
+    out.reserve(str.size() + 2);
+    out.push_back('"');
+    for (char c : str) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        case '\r': out += "\\r"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        default:
+            // the other control characters must be escaped too
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[7];
+                snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                out += buf;
+            } else {
+                out.push_back(c);
+            }
+            break;
+        }
+    }
+    out.push_back('"');
+    return out;
+}
@@ -0,0 +1,17 @@
+#ifndef _DG_TOOL_LLVM_SLICER_JSON_H_
+#define _DG_TOOL_LLVM_SLICER_JSON_H_
+
+#include <map>
+#include <string>
+
+// parse a flat JSON object into the map from keys to values,
+// returns false if the input is not a flat JSON object.
+// Strings are unescaped, numbers, true, false and null are kept
+// as they are. Only ASCII characters may be given by \u escapes.
+bool parseFlatJSON(const std::string& input,
+                   std::map<std::string, std::string>& out);
+
+// get the string as a quoted JSON string
+std::string escapeJSON(const std::string& str);
+
+#endif // _DG_TOOL_LLVM_SLICER_JSON_H_
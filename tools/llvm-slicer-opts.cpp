@@ -1,3 +1,5 @@
+#include <cstdlib>
+
 #include "dg/analysis/Offset.h"
 #include "dg/llvm/LLVMDependenceGraph.h"
 #include "dg/llvm/LLVMDependenceGraphBuilder.h"
@@ -84,6 +86,34 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
                        "the whole memory. May be unsound for out-of-bound access\n"),
                        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<bool> rdaIntervalMaps("rd-interval-maps",
+        llvm::cl::desc("Keep reaching definitions in maps of byte intervals\n"
+                       "(dense analysis only, default=false).\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> rdaFunctionSummaries("rd-function-summaries",
+        llvm::cl::desc("Apply summaries of functions at call-sites in reaching\n"
+                       "definitions analysis (dense analysis only, default=false).\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> rdaBitvectors("rd-bitvectors",
+        llvm::cl::desc("Solve reaching definitions with bitvectors of definitions\n"
+                       "(dense analysis only, cannot be used with -rd-interval-maps,\n"
+                       "default=false).\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> rdaBuildThreads("rd-build-threads",
+        llvm::cl::desc("The number of threads that build the graphs of functions\n"
+                       "for reaching definitions (dense analysis only, default=1).\n"),
+                       llvm::cl::init(1), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<std::string> analysesCache("analyses-cache",
+        llvm::cl::desc("Directory where the results of pointer analysis and\n"
+                       "reaching definitions are cached. The results are reused\n"
+                       "for the same module and options (default=no caching).\n"),
+                       llvm::cl::value_desc("dir"), llvm::cl::init(""),
+                       llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<bool> undefinedArePure("undefined-are-pure",
         llvm::cl::desc("Assume that undefined functions have no side-effects\n"),
                        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
@@ -96,6 +126,18 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
         llvm::cl::desc("Perform forward slicing\n"),
                        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<bool> frozenDG("frozen-dg",
+        llvm::cl::desc("Mark the slice on a read-only compressed copy\n"
+                       "of the dependence graph. Faster with many slicing\n"
+                       "criteria, not used with forward slicing (default=false).\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> lazyDeps("lazy-deps",
+        llvm::cl::desc("Compute the dependencies of a function only when\n"
+                       "the backward slice reaches the function. Not used with\n"
+                       "forward slicing, frozen graph or threads (default=false).\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<bool> threads("threads",
         llvm::cl::desc("Consider threads are in input file (default=false)."),
         llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
@@ -105,13 +147,52 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
         llvm::cl::values(
             clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::fi, "fi", "Flow-insensitive PTA (default)"),
             clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::fs, "fs", "Flow-sensitive PTA"),
-            clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::inv, "inv", "PTA with invalidate nodes")
+            clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::inv, "inv", "PTA with invalidate nodes"),
+            clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::sfs, "sfs", "Sparse flow-sensitive PTA")
     #if LLVM_VERSION_MAJOR < 4
             , nullptr
     #endif
             ),
         llvm::cl::init(LLVMPointerAnalysisOptions::AnalysisType::fi), llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<dg::analysis::pta::PointsToSet::Representation> ptaSet("pta-set",
+        llvm::cl::desc("Choose the representation of points-to sets:"),
+        llvm::cl::values(
+            clEnumValN(dg::analysis::pta::PointsToSet::Representation::BITVECTOR, "bv",
+                       "Map of targets to bitvectors of offsets (default)"),
+            clEnumValN(dg::analysis::pta::PointsToSet::Representation::FLAT, "flat",
+                       "Sorted array of pointers")
+    #if LLVM_VERSION_MAJOR < 4
+            , nullptr
+    #endif
+            ),
+        llvm::cl::init(dg::analysis::pta::PointsToSet::Representation::BITVECTOR),
+        llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaDiffPropagation("pta-diff-propagation",
+        llvm::cl::desc("Use difference propagation in flow-insensitive PTA:\n"
+                       "process nodes in the topological order of SCCs and\n"
+                       "propagate only newly added pointers (default=false).\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaCollapseCycles("pta-collapse-cycles",
+        llvm::cl::desc("Detect and collapse cycles of copy edges during\n"
+                       "flow-insensitive PTA with difference propagation\n"
+                       "(default=false).\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaValueNumbering("pta-hvn",
+        llvm::cl::desc("Merge the nodes of the pointer graph that compute\n"
+                       "the same value before flow-insensitive PTA\n"
+                       "(hash-based value numbering, default=false).\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> ptaThreads("pta-threads",
+        llvm::cl::desc("The number of threads used by flow-insensitive PTA.\n"
+                       "Independent parts of the graph are processed\n"
+                       "in parallel (default=1).\n"),
+                       llvm::cl::init(1), llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<LLVMReachingDefinitionsAnalysisOptions::AnalysisType> rdaType("rda",
         llvm::cl::desc("Choose reaching definitions analysis to use:"),
         llvm::cl::values(
@@ -151,6 +232,12 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
 #endif
     llvm::cl::ParseCommandLineOptions(argc, argv);
 
+    if (rdaBitvectors && rdaIntervalMaps) {
+        llvm::errs() << "-rd-bitvectors and -rd-interval-maps "
+                        "cannot be used together\n";
+        exit(1);
+    }
+
     /// Fill the structure
     SlicerOptions options;
 
@@ -161,19 +248,31 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
     options.preservedFunctions = splitList(preservedFuns);
     options.removeSlicingCriteria = removeSlicingCriteria;
     options.forwardSlicing = forwardSlicing;
+    options.frozenDG = frozenDG;
 
     options.dgOptions.entryFunction = entryFunction;
     options.dgOptions.PTAOptions.entryFunction = entryFunction;
     options.dgOptions.PTAOptions.fieldSensitivity
                                     = dg::analysis::Offset(ptaFieldSensitivity);
     options.dgOptions.PTAOptions.analysisType = ptaType;
-
+    options.dgOptions.PTAOptions.ptSetRepresentation = ptaSet;
+    options.dgOptions.PTAOptions.diffPropagation = ptaDiffPropagation;
+    options.dgOptions.PTAOptions.collapseCycles = ptaCollapseCycles;
+    options.dgOptions.PTAOptions.valueNumbering = ptaValueNumbering;
+    options.dgOptions.PTAOptions.solverThreads = ptaThreads;
+
+    options.dgOptions.cacheDir = analysesCache;
+    options.dgOptions.lazyDependencies = lazyDeps;
     options.dgOptions.threads = threads;
     options.dgOptions.PTAOptions.threads = threads;
     options.dgOptions.RDAOptions.threads = threads;
 
     options.dgOptions.RDAOptions.entryFunction = entryFunction;
     options.dgOptions.RDAOptions.strongUpdateUnknown = rdaStrongUpdateUnknown;
+    options.dgOptions.RDAOptions.intervalMaps = rdaIntervalMaps;
+    options.dgOptions.RDAOptions.functionSummaries = rdaFunctionSummaries;
+    options.dgOptions.RDAOptions.bitvectors = rdaBitvectors;
+    options.dgOptions.RDAOptions.buildThreads = rdaBuildThreads;
     options.dgOptions.RDAOptions.undefinedArePure = undefinedArePure;
     options.dgOptions.RDAOptions.analysisType = rdaType;
 
@@ -27,6 +27,9 @@ struct SlicerOptions {
     // do we perform forward slicing?
     bool forwardSlicing{false};
 
+    // mark the slice on a frozen copy of the dependence graph
+    bool frozenDG{false};
+
     std::string slicingCriteria{};
     std::string secondarySlicingCriteria{};
     std::string inputFile{};
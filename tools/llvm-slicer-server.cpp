@@ -0,0 +1,344 @@
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/IR/Instruction.h>
+#include <llvm/IR/Function.h>
+#include <llvm/Support/raw_ostream.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "llvm-slicer-server.h"
+#include "llvm-slicer-json.h"
+#include "TimeMeasure.h"
+
+using dg::LLVMNode;
+
+std::set<std::pair<std::string, unsigned>>
+getSourceLines(const std::vector<LLVMNode *>& nodes)
+{
+    std::set<std::pair<std::string, unsigned>> lines;
+    for (LLVMNode *nd : nodes) {
+        auto I = llvm::dyn_cast<llvm::Instruction>(nd->getValue());
+        if (!I)
+            continue;
+        auto& Loc = I->getDebugLoc();
+        if (Loc.isUnknown())
+            continue;
+        lines.emplace(I->getParent()->getParent()->getName().str(),
+                      Loc.getLine());
+    }
+
+    return lines;
+}
+
+/// ------------------------------------------------------------------
+// JSON
+/// ------------------------------------------------------------------
+
+namespace {
+
+// the id of the query is returned as it was given (a number or a string)
+static std::string formatId(const std::string& id)
+{
+    if (!id.empty() && id.find_first_not_of("0123456789-") == std::string::npos)
+        return id;
+    return escapeJSON(id);
+}
+
+static std::string errorResponse(const std::string& id, const std::string& msg)
+{
+    std::string out = "{";
+    if (!id.empty())
+        out += "\"id\": " + formatId(id) + ", ";
+    return out + "\"ok\": false, \"error\": " + escapeJSON(msg) + "}";
+}
+
+} // anonymous namespace
+
+/// ------------------------------------------------------------------
+// Queries
+/// ------------------------------------------------------------------
+
+void SlicingServer::_initialize()
+{
+    if (_frozen)
+        return;
+
+    if (!_slicer.dependenciesComputed())
+        _slicer.computeDependencies();
+
+    std::vector<dg::LLVMDependenceGraph *> graphs;
+    for (auto& it : dg::getConstructedFunctions())
+        graphs.push_back(it.second);
+    graphs.push_back(&_slicer.getDG());
+
+    _frozen.reset(new dg::FrozenDependenceGraph<LLVMNode>(graphs));
+}
+
+std::vector<LLVMNode *>
+SlicingServer::_backwardSlice(const std::set<LLVMNode *>& criteria)
+{
+    dg::analysis::FrozenBatchWalkAndMark<LLVMNode> wm(*_frozen);
+    wm.mark({criteria});
+    return wm.getSlice(0);
+}
+
+std::vector<LLVMNode *>
+SlicingServer::_forwardSlice(const std::set<LLVMNode *>& criteria,
+                             bool only_forward)
+{
+    // a new slice id for every query, so that we can distinguish
+    // the nodes marked by this query from the previous ones
+    uint32_t id = ++_slice_id;
+    if (only_forward) {
+        dg::analysis::WalkAndMark<LLVMNode> wm(true /* forward */);
+        wm.mark(criteria, id);
+    } else {
+        for (LLVMNode *nd : criteria)
+            _marker.mark(nd, id, true /* forward */);
+    }
+
+    std::vector<LLVMNode *> nodes;
+    for (size_t i = 0; i < _frozen->size(); ++i) {
+        LLVMNode *nd = _frozen->getNode(i);
+        if (nd->getSlice() == id)
+            nodes.push_back(nd);
+    }
+
+    return nodes;
+}
+
+std::string SlicingServer::_handle(const RequestT& request)
+{
+    auto get = [&request](const char *key) -> std::string {
+        auto it = request.find(key);
+        return it == request.end() ? "" : it->second;
+    };
+
+    const std::string id = get("id");
+    const std::string type = get("type").empty() ? "slice" : get("type");
+
+    if (type == "quit") {
+        _quit = true;
+        return id.empty() ? "{\"ok\": true}" : "{\"id\": " + formatId(id) + ", \"ok\": true}";
+    }
+
+    if (type != "slice" && type != "chop")
+        return errorResponse(id, "Unknown type of query: " + type);
+
+    const std::string criteria = get("criteria");
+    if (criteria.empty())
+        return errorResponse(id, "Missing criteria");
+
+    _initialize();
+
+    dg::debug::TimeMeasure tm;
+    tm.start();
+
+    auto criteriaNodes = _getCriteria(criteria);
+    if (criteriaNodes.empty())
+        return errorResponse(id, "Did not find slicing criteria: " + criteria);
+
+    std::vector<LLVMNode *> nodes;
+    if (type == "slice") {
+        const std::string direction = get("direction");
+        if (direction.empty() || direction == "backward")
+            nodes = _backwardSlice(criteriaNodes);
+        else if (direction == "forward")
+            nodes = _forwardSlice(criteriaNodes, false);
+        else
+            return errorResponse(id, "Unknown direction: " + direction);
+    } else {
+        // the chop are the nodes that depend on the nodes 'from'
+        // and the nodes 'criteria' depend on
+        const std::string from = get("from");
+        if (from.empty())
+            return errorResponse(id, "Missing the source criteria of the chop");
+
+        auto fromNodes = _getCriteria(from);
+        if (fromNodes.empty())
+            return errorResponse(id, "Did not find slicing criteria: " + from);
+
+        auto backward = _backwardSlice(criteriaNodes);
+        auto forward = _forwardSlice(fromNodes, true);
+        std::set<LLVMNode *> fwd(forward.begin(), forward.end());
+        for (LLVMNode *nd : backward) {
+            if (fwd.count(nd) > 0)
+                nodes.push_back(nd);
+        }
+    }
+
+    tm.stop();
+
+    std::ostringstream out;
+    out << "{";
+    if (!id.empty())
+        out << "\"id\": " << formatId(id) << ", ";
+    out << "\"ok\": true, \"nodes\": " << nodes.size()
+        << ", \"time_ms\": "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(tm.duration()).count()
+        << ", \"lines\": [";
+
+    bool first = true;
+    for (const auto& l : getSourceLines(nodes)) {
+        if (!first)
+            out << ", ";
+        first = false;
+        out << escapeJSON(l.first + ":" + std::to_string(l.second));
+    }
+    out << "]}";
+
+    return out.str();
+}
+
+std::string SlicingServer::handle(const std::string& line)
+{
+    RequestT request;
+    if (!parseFlatJSON(line, request))
+        return errorResponse("", "Invalid request: " + line);
+
+    return _handle(request);
+}
+
+int SlicingServer::serve(std::istream& in, std::ostream& out)
+{
+    std::string line;
+    while (!_quit && std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        out << handle(line) << std::endl;
+    }
+
+    return 0;
+}
+
+// answer the queries of one client, returns false
+// if the connection was broken
+static bool serveClient(SlicingServer& server, int fd)
+{
+    std::string buffer;
+    char chunk[4096];
+    while (!server.shouldQuit()) {
+        auto len = read(fd, chunk, sizeof(chunk));
+        if (len < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        if (len == 0)
+            return true;
+
+        buffer.append(chunk, len);
+        size_t nl;
+        while ((nl = buffer.find('\n')) != std::string::npos) {
+            std::string line = buffer.substr(0, nl);
+            buffer.erase(0, nl + 1);
+            if (line.find_first_not_of(" \t\r") == std::string::npos)
+                continue;
+
+            std::string response = server.handle(line) + "\n";
+
+            const char *data = response.data();
+            size_t left = response.size();
+            while (left > 0) {
+                auto written = write(fd, data, left);
+                if (written < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    return false;
+                }
+                data += written;
+                left -= written;
+            }
+
+            if (server.shouldQuit())
+                break;
+        }
+    }
+
+    return true;
+}
+
+int SlicingServer::serveSocket(const std::string& path)
+{
+    sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        llvm::errs() << "The path of the socket is too long: " << path << "\n";
+        return 1;
+    }
+
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) {
+        llvm::errs() << "Failed creating the socket: " << strerror(errno) << "\n";
+        return 1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    // remove the socket left by a previous run, but nothing else
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            llvm::errs() << "The file " << path << " exists and is not a socket\n";
+            close(sock);
+            return 1;
+        }
+        unlink(path.c_str());
+    }
+
+    if (bind(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        listen(sock, 1) < 0) {
+        llvm::errs() << "Failed listening on " << path << ": "
+                     << strerror(errno) << "\n";
+        close(sock);
+        return 1;
+    }
+
+    // build the graph before accepting the first client
+    _initialize();
+    llvm::errs() << "INFO: Listening on " << path << "\n";
+
+    while (!_quit) {
+        int fd = accept(sock, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR)
+                continue;
+            llvm::errs() << "Failed accepting a client: " << strerror(errno) << "\n";
+            break;
+        }
+
+        if (!serveClient(*this, fd))
+            llvm::errs() << "WARNING: the connection with a client was broken\n";
+        close(fd);
+    }
+
+    close(sock);
+    unlink(path.c_str());
+    return 0;
+}
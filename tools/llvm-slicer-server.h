@@ -0,0 +1,85 @@
+#ifndef _DG_TOOL_LLVM_SLICER_SERVER_H_
+#define _DG_TOOL_LLVM_SLICER_SERVER_H_
+
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dg/FrozenDependenceGraph.h"
+
+#include "llvm-slicer.h"
+
+/// --------------------------------------------------------------------
+//   - SlicingServer -
+//
+//  Answers slicing queries on one dependence graph that is built
+//  (and whose dependencies are computed) only once. The queries are
+//  read one per line, every query and answer is a flat JSON object:
+//
+//  {"id": 1, "type": "slice", "criteria": "foo,10:x", "direction": "backward"}
+//  {"id": 2, "type": "chop", "from": "source", "criteria": "sink"}
+//  {"type": "quit"}
+//
+//  The answer contains the number of nodes in the slice and the lines
+//  of the slice as "function:line" strings:
+//
+//  {"id": 1, "ok": true, "nodes": 42, "lines": ["main:10", "foo:3"]}
+//  {"id": 3, "ok": false, "error": "..."}
+//
+//  The graph is never sliced, the queries only mark the nodes. Backward
+//  slices are computed on a frozen copy of the graph without touching
+//  the marks in nodes and the forward walks use a new slice id for every
+//  query, so the marks of the previous queries do not need to be erased.
+/// --------------------------------------------------------------------
+class SlicingServer {
+public:
+    using CriteriaFunT = std::function<std::set<dg::LLVMNode *>(const std::string&)>;
+    using RequestT = std::map<std::string, std::string>;
+
+private:
+    Slicer& _slicer;
+    CriteriaFunT _getCriteria;
+
+    std::unique_ptr<dg::FrozenDependenceGraph<dg::LLVMNode>> _frozen;
+    dg::LLVMSlicer _marker;
+    uint32_t _slice_id{0};
+    bool _quit{false};
+
+    void _initialize();
+
+    std::vector<dg::LLVMNode *> _backwardSlice(const std::set<dg::LLVMNode *>& criteria);
+    std::vector<dg::LLVMNode *> _forwardSlice(const std::set<dg::LLVMNode *>& criteria,
+                                              bool only_forward);
+
+    std::string _handle(const RequestT& request);
+
+public:
+    SlicingServer(Slicer& slicer, CriteriaFunT getCriteria)
+    : _slicer(slicer), _getCriteria(std::move(getCriteria)) {}
+
+    // answer the query given as a line of JSON
+    std::string handle(const std::string& line);
+
+    // was the "quit" query received?
+    bool shouldQuit() const { return _quit; }
+
+    // answer the queries from 'in' until the end of the stream
+    // or until the "quit" query
+    int serve(std::istream& in, std::ostream& out);
+
+    // listen on the unix socket 'path' and answer the queries
+    // of the connected clients (one client at a time)
+    int serveSocket(const std::string& path);
+};
+
+// get the source lines ("function", line) of the instructions
+// from the given nodes (the nodes without debug info are skipped)
+std::set<std::pair<std::string, unsigned>>
+getSourceLines(const std::vector<dg::LLVMNode *>& nodes);
+
+#endif // _DG_TOOL_LLVM_SLICER_SERVER_H_
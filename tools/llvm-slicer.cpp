@@ -20,6 +20,7 @@
 #include "llvm-slicer.h"
 #include "llvm-slicer-opts.h"
 #include "llvm-slicer-utils.h"
+#include "llvm-slicer-server.h"
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -102,6 +103,26 @@ llvm::cl::opt<bool> dump_bb_only("dump-bb-only",
                    " (default=false)."),
     llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<std::string> batch_criteria("batch-criteria",
+    llvm::cl::desc("Compute the slices for many slicing criteria at once and\n"
+                   "print the lines in every slice instead of slicing the module.\n"
+                   "Every line of the file is 'name criteria' where the criteria\n"
+                   "have the same format as for the -c option."),
+    llvm::cl::value_desc("file"), llvm::cl::init(""),
+    llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<bool> server("server",
+    llvm::cl::desc("Build the dependence graph once and answer slicing queries\n"
+                   "(one JSON object per line) from the standard input\n"
+                   "instead of slicing the module (default=false)."),
+    llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<std::string> server_socket("server-socket",
+    llvm::cl::desc("The same as -server, but read the queries from\n"
+                   "the clients of the given unix socket."),
+    llvm::cl::value_desc("path"), llvm::cl::init(""),
+    llvm::cl::cat(SlicingOpts));
+
 llvm::cl::opt<std::string> annotationOpts("annotate",
     llvm::cl::desc("Save annotated version of module as a text (.ll).\n"
                    "(dd: data dependencies, cd:control dependencies,\n"
@@ -388,6 +409,9 @@ public:
         else if (options.dgOptions.PTAOptions.analysisType
                     == LLVMPointerAnalysisOptions::AnalysisType::inv)
             module_comment += "flow-sensitive with invalidate\n";
+        else if (options.dgOptions.PTAOptions.analysisType
+                    == LLVMPointerAnalysisOptions::AnalysisType::sfs)
+            module_comment += "sparse flow-sensitive\n";
 
         module_comment+= ";   * PTA field sensitivity: ";
         if (options.dgOptions.PTAOptions.fieldSensitivity == Offset::UNKNOWN)
@@ -526,7 +550,11 @@ static void getLineCriteriaNodes(LLVMDependenceGraph& dg,
     std::vector<std::pair<int, std::string>> parsedCrit;
     for (auto& crit : criteria) {
         auto parts = splitList(crit, ':');
-        assert(parts.size() == 2);
+        if (parts.size() != 2) {
+            llvm::errs() << "Invalid criterion: '" << crit << "'. "
+                         << "Needs to be in the form line:variable.\n";
+            continue;
+        }
 
         // parse the line number
         if (parts[0].empty()) {
@@ -542,7 +570,10 @@ static void getLineCriteriaNodes(LLVMDependenceGraph& dg,
         }
     }
 
-    assert(!parsedCrit.empty() && "Failed parsing criteria");
+    // no nodes for invalid criteria, the caller reports
+    // that the criteria were not found
+    if (parsedCrit.empty())
+        return;
 
     // create the mapping from LLVM values to C variable names
     for (auto& it : getConstructedFunctions()) {
@@ -746,6 +777,112 @@ bool findSecondarySlicingCriteria(std::set<LLVMNode *>& criteria_nodes,
     return true;
 }
 
+// the number of criteria whose slices are computed in one walk
+// of the graph (the size of the masks of nodes is bounded by this)
+static const size_t BATCH_SIZE = 512;
+
+static bool parseBatchCriteria(const std::string& file,
+                               std::vector<std::pair<std::string, std::string>>& criteria)
+{
+    std::ifstream in(file);
+    if (!in.is_open()) {
+        llvm::errs() << "Failed opening the file with criteria: " << file << "\n";
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(in, line)) {
+        auto b = line.find_first_not_of(" \t");
+        if (b == std::string::npos || line[b] == '#')
+            continue;
+
+        auto e = line.find_first_of(" \t", b);
+        auto c = e == std::string::npos ? e : line.find_first_not_of(" \t", e);
+        if (c == std::string::npos) {
+            llvm::errs() << "Missing criteria in the line: '" << line << "'\n";
+            return false;
+        }
+
+        criteria.emplace_back(line.substr(b, e - b), line.substr(c));
+    }
+
+    return true;
+}
+
+///
+// Compute the slices of all criteria from the file at once and print
+// the source lines of every slice (the module is not sliced).
+static int sliceBatch(Slicer& slicer, const SlicerOptions& options,
+                      const std::string& file)
+{
+    // the batch only marks the nodes of the backward slices,
+    // it does not support the options that change the sliced module
+    if (options.forwardSlicing || options.removeSlicingCriteria ||
+        !options.preservedFunctions.empty()) {
+        llvm::errs() << "ERROR: -forward, -remove-slicing-criteria and "
+                     << "-preserved-functions cannot be used "
+                     << "with -batch-criteria\n";
+        return 1;
+    }
+
+    std::vector<std::pair<std::string, std::string>> named;
+    if (!parseBatchCriteria(file, named))
+        return 1;
+
+    auto& dg = slicer.getDG();
+    auto secondaryCriteria
+        = parseSecondarySlicingCriteria(options.secondarySlicingCriteria);
+
+    std::vector<std::set<LLVMNode *>> criteria;
+    criteria.reserve(named.size());
+    for (const auto& it : named) {
+        auto nodes = getSlicingCriteriaNodes(dg, it.second);
+        if (!nodes.empty()) {
+            findSecondarySlicingCriteria(nodes, secondaryCriteria.first,
+                                         secondaryCriteria.second);
+            dg.getCallSites(options.additionalSlicingCriteria, &nodes);
+        }
+        criteria.push_back(std::move(nodes));
+    }
+
+    slicer.computeDependencies();
+
+    std::vector<dg::LLVMDependenceGraph *> graphs;
+    for (auto& it : dg::getConstructedFunctions())
+        graphs.push_back(it.second);
+    graphs.push_back(&dg);
+
+    dg::debug::TimeMeasure tm;
+    tm.start();
+
+    dg::FrozenDependenceGraph<dg::LLVMNode> frozen(graphs);
+    dg::analysis::FrozenBatchWalkAndMark<dg::LLVMNode> wm(frozen);
+
+    for (size_t first = 0; first < criteria.size(); first += BATCH_SIZE) {
+        auto last = std::min(criteria.size(), first + BATCH_SIZE);
+        wm.mark(std::vector<std::set<LLVMNode *>>(criteria.begin() + first,
+                                                  criteria.begin() + last));
+
+        for (size_t c = first; c < last; ++c) {
+            llvm::outs() << named[c].first << ":";
+            if (criteria[c].empty()) {
+                llvm::outs() << " criteria not found\n";
+                continue;
+            }
+
+            for (const auto& l : getSourceLines(wm.getSlice(c - first)))
+                llvm::outs() << " " << l.first << ":" << l.second;
+            llvm::outs() << "\n";
+        }
+    }
+
+    tm.stop();
+    tm.report("INFO: Computing the slices of " + std::to_string(criteria.size())
+              + " criteria took");
+
+    return 0;
+}
+
 static AnnotationOptsT parseAnnotationOptions(const std::string& annot)
 {
     if (annot.empty())
@@ -860,6 +997,28 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (!batch_criteria.empty())
+        return sliceBatch(slicer, options, batch_criteria);
+
+    if (server || !server_socket.empty()) {
+        auto secondaryCriteria
+            = parseSecondarySlicingCriteria(options.secondarySlicingCriteria);
+        SlicingServer srv(slicer, [&](const std::string& criteria) {
+            auto& dg = slicer.getDG();
+            auto nodes = getSlicingCriteriaNodes(dg, criteria);
+            if (!nodes.empty()) {
+                findSecondarySlicingCriteria(nodes, secondaryCriteria.first,
+                                             secondaryCriteria.second);
+                dg.getCallSites(options.additionalSlicingCriteria, &nodes);
+            }
+            return nodes;
+        });
+
+        if (!server_socket.empty())
+            return srv.serveSocket(server_socket);
+        return srv.serve(std::cin, std::cout);
+    }
+
     ModuleAnnotator annotator(options, &slicer.getDG(),
                               parseAnnotationOptions(annotationOpts));
 
@@ -69,6 +69,7 @@ public:
       _builder(mod, _options.dgOptions) { assert(mod && "Need module"); }
 
     const dg::LLVMDependenceGraph& getDG() const { return *_dg.get(); }
+    bool dependenciesComputed() const { return _computed_deps; }
     dg::LLVMDependenceGraph& getDG() { return *_dg.get(); }
 
     // Mirror LLVM to nodes of dependence graph,
@@ -94,13 +95,25 @@ public:
     // This method can be used to compute dependencies without
     // calling mark() afterwards (mark() calls this function).
     // It must not be called before calling mark() in the future.
-    void computeDependencies() {
+    // If 'on_demand' is set and the dependencies are lazy, the dependencies
+    // of functions are computed only when the marking reaches them.
+    void computeDependencies(bool on_demand = false) {
         assert(!_computed_deps && "Already called computeDependencies()");
         // must call buildDG() before this function
         assert(_dg && "Must build dg before computing dependencies");
 
         _dg = _builder.computeDependencies(std::move(_dg));
         _computed_deps = true;
+
+        if (_builder.isLazy() && !on_demand)
+            _builder.materializeAll();
+
+        if (_options.dgOptions.threads) {
+            const auto& st = _dg->getInterferenceStatistics();
+            llvm::errs() << "INFO: Interference: checked " << st.pairsChecked
+                         << " and pruned " << st.pairsPruned << " from "
+                         << st.pairsTotal << " pairs of load and store\n";
+        }
     }
 
     // Mark the nodes from the slice.
@@ -113,8 +126,16 @@ public:
 
         dg::debug::TimeMeasure tm;
 
-        // compute dependece edges
-        computeDependencies();
+        // compute dependece edges, with lazy dependencies only
+        // the backward walk on the graph itself computes them on demand
+        const bool on_demand = _builder.isLazy() &&
+                               !_options.forwardSlicing && !_options.frozenDG;
+        computeDependencies(on_demand);
+        if (on_demand) {
+            slicer.setGraphReached([this](dg::DependenceGraph<dg::LLVMNode> *graph) {
+                _builder.materialize(static_cast<dg::LLVMDependenceGraph *>(graph));
+            });
+        }
 
         // unmark this set of nodes after marking the relevant ones.
         // Used to mimic the Weissers algorithm
@@ -131,8 +152,19 @@ public:
         slice_id = 0xdead;
 
         tm.start();
-        for (dg::LLVMNode *start : criteria_nodes)
-            slice_id = slicer.mark(start, slice_id, _options.forwardSlicing);
+        if (_options.frozenDG && !_options.forwardSlicing) {
+            std::vector<dg::LLVMDependenceGraph *> graphs;
+            for (auto& it : dg::getConstructedFunctions())
+                graphs.push_back(it.second);
+            graphs.push_back(_dg.get());
+
+            dg::FrozenDependenceGraph<dg::LLVMNode> frozen(graphs);
+            dg::analysis::FrozenWalkAndMark<dg::LLVMNode> wm(frozen);
+            wm.mark(criteria_nodes, slice_id);
+        } else {
+            for (dg::LLVMNode *start : criteria_nodes)
+                slice_id = slicer.mark(start, slice_id, _options.forwardSlicing);
+        }
 
         assert(slice_id != 0 && "Somethig went wrong when marking nodes");
 
@@ -143,6 +175,12 @@ public:
         tm.stop();
         tm.report("INFO: Finding dependent nodes took");
 
+        if (on_demand) {
+            llvm::errs() << "INFO: Computed dependencies of "
+                         << _builder.getMaterializedFunctionsNum() << " from "
+                         << dg::getConstructedFunctions().size() << " functions\n";
+        }
+
         return true;
     }
 